@@ -8,60 +8,68 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
  */
 #include "kernel_operator.h"
-
-constexpr int32_t TOTAL_LENGTH = 8 * 2048;                            // total length of data
-constexpr int32_t USE_CORE_NUM = 8;                                   // num of core used
-constexpr int32_t BLOCK_LENGTH = TOTAL_LENGTH / USE_CORE_NUM;         // length computed of each core
-constexpr int32_t TILE_NUM = 8;                                       // split data into 8 tiles for each core
-constexpr int32_t BUFFER_NUM = 2;                                     // tensor num for each queue
-constexpr int32_t TILE_LENGTH = BLOCK_LENGTH / TILE_NUM / BUFFER_NUM; // separate to 2 parts, due to double buffer
+#include "add_custom_tiling.h"
 
 class KernelAdd {
 public:
     __aicore__ inline KernelAdd() {}
-    __aicore__ inline void Init(GM_ADDR x, GM_ADDR y, GM_ADDR z)
+    __aicore__ inline void Init(GM_ADDR x, GM_ADDR y, GM_ADDR z, const AddCustomTilingData &tiling)
     {
-        xGm.SetGlobalBuffer((__gm__ half *)x + BLOCK_LENGTH * AscendC::GetBlockIdx(), BLOCK_LENGTH);
-        yGm.SetGlobalBuffer((__gm__ half *)y + BLOCK_LENGTH * AscendC::GetBlockIdx(), BLOCK_LENGTH);
-        zGm.SetGlobalBuffer((__gm__ half *)z + BLOCK_LENGTH * AscendC::GetBlockIdx(), BLOCK_LENGTH);
-        pipe.InitBuffer(inQueueX, BUFFER_NUM, TILE_LENGTH * sizeof(half));
-        pipe.InitBuffer(inQueueY, BUFFER_NUM, TILE_LENGTH * sizeof(half));
-        pipe.InitBuffer(outQueueZ, BUFFER_NUM, TILE_LENGTH * sizeof(half));
+        const uint32_t blockIdx = AscendC::GetBlockIdx();
+        const bool former = blockIdx < tiling.formerNum;
+        const uint32_t offset = former ? tiling.formerLength * blockIdx
+                                       : tiling.formerLength * tiling.formerNum +
+                                             tiling.tailLength * (blockIdx - tiling.formerNum);
+        const uint32_t blockLength = former ? tiling.formerLength : tiling.tailLength;
+        this->tileNum = former ? tiling.formerTileNum : tiling.tailTileNum;
+        this->lastTileLength = former ? tiling.formerLastTileLength : tiling.tailLastTileLength;
+        this->tileLength = tiling.tileLength;
+        xGm.SetGlobalBuffer((__gm__ half *)x + offset, blockLength);
+        yGm.SetGlobalBuffer((__gm__ half *)y + offset, blockLength);
+        zGm.SetGlobalBuffer((__gm__ half *)z + offset, blockLength);
+        pipe.InitBuffer(inQueueX, BUFFER_NUM, this->tileLength * sizeof(half));
+        pipe.InitBuffer(inQueueY, BUFFER_NUM, this->tileLength * sizeof(half));
+        pipe.InitBuffer(outQueueZ, BUFFER_NUM, this->tileLength * sizeof(half));
     }
     __aicore__ inline void Process()
     {
-        int32_t loopCount = TILE_NUM * BUFFER_NUM;
-        for (int32_t i = 0; i < loopCount; i++) {
-            CopyIn(i);
-            Compute(i);
-            CopyOut(i);
+        // Full tiles, then the shorter tail tile; the queues keep BUFFER_NUM tiles in flight across both.
+        for (uint32_t i = 0; i < this->tileNum; i++) {
+            CopyIn(i * this->tileLength, this->tileLength);
+            Compute(this->tileLength);
+            CopyOut(i * this->tileLength, this->tileLength);
+        }
+        if (this->lastTileLength > 0) {
+            CopyIn(this->tileNum * this->tileLength, this->lastTileLength);
+            Compute(this->lastTileLength);
+            CopyOut(this->tileNum * this->tileLength, this->lastTileLength);
         }
     }
 
 private:
-    __aicore__ inline void CopyIn(int32_t progress)
+    __aicore__ inline void CopyIn(uint32_t offset, uint32_t length)
     {
         AscendC::LocalTensor<half> xLocal = inQueueX.AllocTensor<half>();
         AscendC::LocalTensor<half> yLocal = inQueueY.AllocTensor<half>();
-        AscendC::DataCopy(xLocal, xGm[progress * TILE_LENGTH], TILE_LENGTH);
-        AscendC::DataCopy(yLocal, yGm[progress * TILE_LENGTH], TILE_LENGTH);
+        AscendC::DataCopy(xLocal, xGm[offset], length);
+        AscendC::DataCopy(yLocal, yGm[offset], length);
         inQueueX.EnQue(xLocal);
         inQueueY.EnQue(yLocal);
     }
-    __aicore__ inline void Compute(int32_t progress)
+    __aicore__ inline void Compute(uint32_t length)
     {
         AscendC::LocalTensor<half> xLocal = inQueueX.DeQue<half>();
         AscendC::LocalTensor<half> yLocal = inQueueY.DeQue<half>();
         AscendC::LocalTensor<half> zLocal = outQueueZ.AllocTensor<half>();
-        AscendC::Add(zLocal, xLocal, yLocal, TILE_LENGTH);
+        AscendC::Add(zLocal, xLocal, yLocal, length);
         outQueueZ.EnQue<half>(zLocal);
         inQueueX.FreeTensor(xLocal);
         inQueueY.FreeTensor(yLocal);
     }
-    __aicore__ inline void CopyOut(int32_t progress)
+    __aicore__ inline void CopyOut(uint32_t offset, uint32_t length)
     {
         AscendC::LocalTensor<half> zLocal = outQueueZ.DeQue<half>();
-        AscendC::DataCopy(zGm[progress * TILE_LENGTH], zLocal, TILE_LENGTH);
+        AscendC::DataCopy(zGm[offset], zLocal, length);
         outQueueZ.FreeTensor(zLocal);
     }
 
@@ -72,18 +80,32 @@ private:
     AscendC::GlobalTensor<half> xGm;
     AscendC::GlobalTensor<half> yGm;
     AscendC::GlobalTensor<half> zGm;
+    uint32_t tileNum;
+    uint32_t tileLength;
+    uint32_t lastTileLength;
 };
 
-extern "C" __global__ __aicore__ void add_custom(GM_ADDR x, GM_ADDR y, GM_ADDR z)
+__aicore__ inline void CopyTiling(AddCustomTilingData *tiling, GM_ADDR tilingGm)
+{
+    uint32_t *ptr = reinterpret_cast<uint32_t *>(tiling);
+    auto tiling32 = reinterpret_cast<__gm__ uint32_t *>(tilingGm);
+    for (uint32_t i = 0; i < sizeof(AddCustomTilingData) / sizeof(uint32_t); i++, ptr++) {
+        *ptr = *(tiling32 + i);
+    }
+}
+
+extern "C" __global__ __aicore__ void add_custom(GM_ADDR x, GM_ADDR y, GM_ADDR z, GM_ADDR tiling)
 {
+    AddCustomTilingData tilingData;
+    CopyTiling(&tilingData, tiling);
     KernelAdd op;
-    op.Init(x, y, z);
+    op.Init(x, y, z, tilingData);
     op.Process();
 }
 
 #ifndef ASCENDC_CPU_DEBUG
-void add_custom_do(uint32_t blockDim, void *stream, uint8_t *x, uint8_t *y, uint8_t *z)
+void add_custom_do(uint32_t blockDim, void *stream, uint8_t *x, uint8_t *y, uint8_t *z, uint8_t *tiling)
 {
-    add_custom<<<blockDim, nullptr, stream>>>(x, y, z);
+    add_custom<<<blockDim, nullptr, stream>>>(x, y, z, tiling);
 }
 #endif
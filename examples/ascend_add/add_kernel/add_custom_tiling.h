@@ -0,0 +1,30 @@
+/**
+ * @file add_custom_tiling.h
+ *
+ * Runtime tiling shared by the host (main.cpp) and the kernel (add_custom.cpp).
+ */
+#ifndef ADD_CUSTOM_TILING_H
+#define ADD_CUSTOM_TILING_H
+#include <cstdint>
+
+constexpr uint32_t BUFFER_NUM = 2;                     // tensor num for each queue (double buffer)
+constexpr uint32_t BLOCK_BYTES = 32;                   // DataCopy moves whole 32-byte blocks
+constexpr uint32_t ALIGN_NUM = BLOCK_BYTES / sizeof(uint16_t); // half elements per block
+
+// All lengths are in elements and, except totalLength, multiples of ALIGN_NUM: the host pads the
+// GM buffers up to ALIGN_NUM. The first formerNum cores take formerLength elements, the remaining
+// ones tailLength (= formerLength - ALIGN_NUM). Each core walks its share in tiles of tileLength,
+// followed by one shorter tile of *LastTileLength when that is non-zero.
+struct AddCustomTilingData {
+    uint32_t totalLength;
+    uint32_t blockDim;
+    uint32_t formerNum;
+    uint32_t formerLength;
+    uint32_t tailLength;
+    uint32_t tileLength;
+    uint32_t formerTileNum;
+    uint32_t formerLastTileLength;
+    uint32_t tailTileNum;
+    uint32_t tailLastTileLength;
+};
+#endif // ADD_CUSTOM_TILING_H
@@ -7,37 +7,141 @@
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
  */
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
 #include "data_utils.h"
+#include "tiling_utils.h"
 #ifndef ASCENDC_CPU_DEBUG
 #include "acl/acl.h"
-extern void add_custom_do(uint32_t blockDim, void *stream, uint8_t *x, uint8_t *y, uint8_t *z);
+extern void add_custom_do(uint32_t blockDim, void *stream, uint8_t *x, uint8_t *y, uint8_t *z, uint8_t *tiling);
 #else
 #include "tikicpulib.h"
-extern "C" __global__ __aicore__ void add_custom(GM_ADDR x, GM_ADDR y, GM_ADDR z);
+extern "C" __global__ __aicore__ void add_custom(GM_ADDR x, GM_ADDR y, GM_ADDR z, GM_ADDR tiling);
 #endif
 
-int32_t main(int32_t argc, char *argv[])
-{
+struct Options {
+    std::string inputX = "./input/input_x.bin";
+    std::string inputY = "./input/input_y.bin";
+    std::string output = "./output/output_z.bin";
+    std::string shapes = "{\"inputs\": [[8, 2048], [8, 2048]], \"outputs\": [[8, 2048]]}";
     uint32_t blockDim = 8;
-    size_t inputByteSize = 8 * 2048 * sizeof(uint16_t);
-    size_t outputByteSize = 8 * 2048 * sizeof(uint16_t);
+    uint32_t tileLength = 0; // 0: chosen by GenerateTiling
+    int32_t iterations = 1;
+};
 
-#ifdef ASCENDC_CPU_DEBUG
-    uint8_t *x = (uint8_t *)AscendC::GmAlloc(inputByteSize);
-    uint8_t *y = (uint8_t *)AscendC::GmAlloc(inputByteSize);
-    uint8_t *z = (uint8_t *)AscendC::GmAlloc(outputByteSize);
+/**
+ * @brief Parse command line arguments (paths and {shapes} as passed by optest)
+ * @param [out] opts: parsed options; ADD_TILE_LENGTH in the environment sets the default tile length
+ * @return parse result
+ */
+bool ParseArgs(int32_t argc, char *argv[], Options &opts)
+{
+    const char *envTile = std::getenv("ADD_TILE_LENGTH");
+    if (envTile != nullptr && envTile[0] != '\0') {
+        opts.tileLength = static_cast<uint32_t>(std::stoul(envTile));
+    }
+    for (int32_t i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            ERROR_LOG("missing value for %s", arg.c_str());
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--input-x") {
+            opts.inputX = value;
+        } else if (arg == "--input-y") {
+            opts.inputY = value;
+        } else if (arg == "--output") {
+            opts.output = value;
+        } else if (arg == "--shapes") {
+            opts.shapes = value;
+        } else if (arg == "--block-dim") {
+            opts.blockDim = static_cast<uint32_t>(std::stoul(value));
+        } else if (arg == "--tile-length") {
+            opts.tileLength = static_cast<uint32_t>(std::stoul(value));
+        } else if (arg == "--iterations") {
+            opts.iterations = std::stoi(value);
+        } else {
+            ERROR_LOG("unknown argument %s", arg.c_str());
+            return false;
+        }
+    }
+    return opts.iterations > 0;
+}
+
+/**
+ * @brief Read one input into a (padded, zero-filled) buffer and check its size
+ */
+bool ReadInput(const std::string &path, size_t expectedBytes, void *buffer, size_t bufferSize)
+{
+    std::memset(buffer, 0, bufferSize);
+    size_t fileSize = 0;
+    if (!ReadFile(path, fileSize, buffer, bufferSize)) {
+        return false;
+    }
+    if (fileSize != expectedBytes) {
+        ERROR_LOG("%s holds %zu bytes, the shapes need %zu", path.c_str(), fileSize, expectedBytes);
+        return false;
+    }
+    return true;
+}
+
+void PrintMetrics(const AddCustomTilingData &tiling, double totalMs, int32_t iterations)
+{
+    const double kernelMs = totalMs / iterations;
+    const double bytes = 3.0 * tiling.totalLength * sizeof(uint16_t); // read x, y; write z
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << kernelMs << " add_gbps=" << bytes / 1e6 / kernelMs
+              << " tile_length=" << tiling.tileLength << " block_dim=" << tiling.blockDim << std::endl;
+}
 
-    ReadFile("./input/input_x.bin", inputByteSize, x, inputByteSize);
-    ReadFile("./input/input_y.bin", inputByteSize, y, inputByteSize);
+int32_t main(int32_t argc, char *argv[])
+{
+    Options opts;
+    AddCustomTilingData tiling{};
+    try {
+        if (!ParseArgs(argc, argv, opts)) {
+            return 1;
+        }
+        tiling = GenerateTiling(ParseTotalLength(opts.shapes), opts.blockDim, opts.tileLength);
+    } catch (const std::exception &e) {
+        ERROR_LOG("%s", e.what());
+        return 1;
+    }
+    uint32_t blockDim = tiling.blockDim;
+    size_t inputByteSize = tiling.totalLength * sizeof(uint16_t);
+    size_t outputByteSize = tiling.totalLength * sizeof(uint16_t);
+    // The kernel moves whole 32-byte blocks: device buffers are padded, files keep the exact size.
+    size_t paddedByteSize = AlignUp(tiling.totalLength, ALIGN_NUM) * sizeof(uint16_t);
+    size_t tilingSize = sizeof(AddCustomTilingData);
+    bool ok = true;
 
-    AscendC::SetKernelMode(KernelMode::AIV_MODE);
-    ICPU_RUN_KF(add_custom, blockDim, x, y, z); // use this macro for cpu debug
+#ifdef ASCENDC_CPU_DEBUG
+    uint8_t *x = (uint8_t *)AscendC::GmAlloc(paddedByteSize);
+    uint8_t *y = (uint8_t *)AscendC::GmAlloc(paddedByteSize);
+    uint8_t *z = (uint8_t *)AscendC::GmAlloc(paddedByteSize);
+    uint8_t *tilingGm = (uint8_t *)AscendC::GmAlloc(tilingSize);
+    std::memcpy(tilingGm, &tiling, tilingSize);
 
-    WriteFile("./output/output_z.bin", z, outputByteSize);
+    ok = ReadInput(opts.inputX, inputByteSize, x, paddedByteSize) &&
+         ReadInput(opts.inputY, inputByteSize, y, paddedByteSize);
+    if (ok) {
+        AscendC::SetKernelMode(KernelMode::AIV_MODE);
+        auto start = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < opts.iterations; ++i) {
+            ICPU_RUN_KF(add_custom, blockDim, x, y, z, tilingGm); // use this macro for cpu debug
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        PrintMetrics(tiling, elapsed.count(), opts.iterations); // CPU emulation: only the tiling is meaningful
+        ok = WriteFile(opts.output, z, outputByteSize);
+    }
 
     AscendC::GmFree((void *)x);
     AscendC::GmFree((void *)y);
     AscendC::GmFree((void *)z);
+    AscendC::GmFree((void *)tilingGm);
 #else
     CHECK_ACL(aclInit(nullptr));
     int32_t deviceId = 0;
@@ -46,30 +150,48 @@ int32_t main(int32_t argc, char *argv[])
     CHECK_ACL(aclrtCreateStream(&stream));
 
     uint8_t *xHost, *yHost, *zHost;
-    uint8_t *xDevice, *yDevice, *zDevice;
-
-    CHECK_ACL(aclrtMallocHost((void **)(&xHost), inputByteSize));
-    CHECK_ACL(aclrtMallocHost((void **)(&yHost), inputByteSize));
-    CHECK_ACL(aclrtMallocHost((void **)(&zHost), outputByteSize));
-    CHECK_ACL(aclrtMalloc((void **)&xDevice, inputByteSize, ACL_MEM_MALLOC_HUGE_FIRST));
-    CHECK_ACL(aclrtMalloc((void **)&yDevice, inputByteSize, ACL_MEM_MALLOC_HUGE_FIRST));
-    CHECK_ACL(aclrtMalloc((void **)&zDevice, outputByteSize, ACL_MEM_MALLOC_HUGE_FIRST));
+    uint8_t *xDevice, *yDevice, *zDevice, *tilingDevice;
 
-    ReadFile("./input/input_x.bin", inputByteSize, xHost, inputByteSize);
-    ReadFile("./input/input_y.bin", inputByteSize, yHost, inputByteSize);
+    CHECK_ACL(aclrtMallocHost((void **)(&xHost), paddedByteSize));
+    CHECK_ACL(aclrtMallocHost((void **)(&yHost), paddedByteSize));
+    CHECK_ACL(aclrtMallocHost((void **)(&zHost), paddedByteSize));
+    CHECK_ACL(aclrtMalloc((void **)&xDevice, paddedByteSize, ACL_MEM_MALLOC_HUGE_FIRST));
+    CHECK_ACL(aclrtMalloc((void **)&yDevice, paddedByteSize, ACL_MEM_MALLOC_HUGE_FIRST));
+    CHECK_ACL(aclrtMalloc((void **)&zDevice, paddedByteSize, ACL_MEM_MALLOC_HUGE_FIRST));
+    CHECK_ACL(aclrtMalloc((void **)&tilingDevice, tilingSize, ACL_MEM_MALLOC_HUGE_FIRST));
 
-    CHECK_ACL(aclrtMemcpy(xDevice, inputByteSize, xHost, inputByteSize, ACL_MEMCPY_HOST_TO_DEVICE));
-    CHECK_ACL(aclrtMemcpy(yDevice, inputByteSize, yHost, inputByteSize, ACL_MEMCPY_HOST_TO_DEVICE));
+    ok = ReadInput(opts.inputX, inputByteSize, xHost, paddedByteSize) &&
+         ReadInput(opts.inputY, inputByteSize, yHost, paddedByteSize);
+    if (ok) {
+        CHECK_ACL(aclrtMemcpy(xDevice, paddedByteSize, xHost, paddedByteSize, ACL_MEMCPY_HOST_TO_DEVICE));
+        CHECK_ACL(aclrtMemcpy(yDevice, paddedByteSize, yHost, paddedByteSize, ACL_MEMCPY_HOST_TO_DEVICE));
+        CHECK_ACL(aclrtMemcpy(tilingDevice, tilingSize, &tiling, tilingSize, ACL_MEMCPY_HOST_TO_DEVICE));
 
-    add_custom_do(blockDim, stream, xDevice, yDevice, zDevice);
-    CHECK_ACL(aclrtSynchronizeStream(stream));
+        add_custom_do(blockDim, stream, xDevice, yDevice, zDevice, tilingDevice); // warm-up
+        CHECK_ACL(aclrtSynchronizeStream(stream));
+        aclrtEvent start, stop;
+        CHECK_ACL(aclrtCreateEvent(&start));
+        CHECK_ACL(aclrtCreateEvent(&stop));
+        CHECK_ACL(aclrtRecordEvent(start, stream));
+        for (int32_t i = 0; i < opts.iterations; ++i) {
+            add_custom_do(blockDim, stream, xDevice, yDevice, zDevice, tilingDevice);
+        }
+        CHECK_ACL(aclrtRecordEvent(stop, stream));
+        CHECK_ACL(aclrtSynchronizeEvent(stop));
+        float elapsedMs = 0.0f;
+        CHECK_ACL(aclrtEventElapsedTime(&elapsedMs, start, stop));
+        PrintMetrics(tiling, elapsedMs, opts.iterations);
+        CHECK_ACL(aclrtDestroyEvent(start));
+        CHECK_ACL(aclrtDestroyEvent(stop));
 
-    CHECK_ACL(aclrtMemcpy(zHost, outputByteSize, zDevice, outputByteSize, ACL_MEMCPY_DEVICE_TO_HOST));
-    WriteFile("./output/output_z.bin", zHost, outputByteSize);
+        CHECK_ACL(aclrtMemcpy(zHost, outputByteSize, zDevice, outputByteSize, ACL_MEMCPY_DEVICE_TO_HOST));
+        ok = WriteFile(opts.output, zHost, outputByteSize);
+    }
 
     CHECK_ACL(aclrtFree(xDevice));
     CHECK_ACL(aclrtFree(yDevice));
     CHECK_ACL(aclrtFree(zDevice));
+    CHECK_ACL(aclrtFree(tilingDevice));
     CHECK_ACL(aclrtFreeHost(xHost));
     CHECK_ACL(aclrtFreeHost(yHost));
     CHECK_ACL(aclrtFreeHost(zHost));
@@ -78,5 +200,5 @@ int32_t main(int32_t argc, char *argv[])
     CHECK_ACL(aclrtResetDevice(deviceId));
     CHECK_ACL(aclFinalize());
 #endif
-    return 0;
+    return ok ? 0 : 1;
 }
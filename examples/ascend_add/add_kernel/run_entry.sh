@@ -7,11 +7,12 @@ CURRENT_DIR=$(
 BUILD_TYPE="Debug"
 INSTALL_PREFIX="${CURRENT_DIR}/out"
 
-SHORT=r:,v:,i:,b:,p:,
-LONG=run-mode:,soc-version:,install-path:,build-type:,install-prefix:,
+SHORT=r:,v:,i:,b:,p:,k
+LONG=run-mode:,soc-version:,install-path:,build-type:,install-prefix:,keep-build
 OPTS=$(getopt -a --options $SHORT --longoptions $LONG -- "$@")
 eval set -- "$OPTS"
 SOC_VERSION="Ascend310P3"
+KEEP_BUILD=0
 
 while :; do
     case "$1" in
@@ -35,6 +36,10 @@ while :; do
         INSTALL_PREFIX="$2"
         shift 2
         ;;
+    -k | --keep-build)
+        KEEP_BUILD=1
+        shift
+        ;;
     --)
         shift
         break
@@ -82,31 +87,34 @@ elif [ "${RUN_MODE}" = "cpu" ]; then
 fi
 
 set -e
-rm -rf build out
-mkdir -p build
-cmake -B build \
-    -DRUN_MODE=${RUN_MODE} \
-    -DSOC_VERSION=${SOC_VERSION} \
-    -DCMAKE_BUILD_TYPE=${BUILD_TYPE} \
-    -DCMAKE_INSTALL_PREFIX=${INSTALL_PREFIX} \
-    -DASCEND_CANN_PACKAGE_PATH=${_ASCEND_INSTALL_PATH}
-cmake --build build -j
-cmake --install build
+# Shapes and tiling are runtime arguments, so -k can reuse one binary for a whole shape sweep.
+if [ "${KEEP_BUILD}" -ne 1 ] || [ ! -x ./ascendc_kernels_bbit ]; then
+    rm -rf build out
+    mkdir -p build
+    cmake -B build \
+        -DRUN_MODE=${RUN_MODE} \
+        -DSOC_VERSION=${SOC_VERSION} \
+        -DCMAKE_BUILD_TYPE=${BUILD_TYPE} \
+        -DCMAKE_INSTALL_PREFIX=${INSTALL_PREFIX} \
+        -DASCEND_CANN_PACKAGE_PATH=${_ASCEND_INSTALL_PATH}
+    cmake --build build -j
+    cmake --install build
 
-rm -f ascendc_kernels_bbit
-cp ./out/bin/ascendc_kernels_bbit ./
+    rm -f ascendc_kernels_bbit
+    cp ./out/bin/ascendc_kernels_bbit ./
+fi
 mkdir -p input output
 (
     export LD_LIBRARY_PATH=$(pwd)/out/lib:$(pwd)/out/lib64:${_ASCEND_INSTALL_PATH}/lib64:$LD_LIBRARY_PATH
     if [[ "$RUN_WITH_TOOLCHAIN" -eq 1 ]]; then
         if [ "${RUN_MODE}" = "npu" ]; then
-            msprof op --application=./ascendc_kernels_bbit
+            msprof op --application="./ascendc_kernels_bbit $*"
         elif [ "${RUN_MODE}" = "sim" ]; then
-            msprof op simulator --application=./ascendc_kernels_bbit
+            msprof op simulator --application="./ascendc_kernels_bbit $*"
         elif [ "${RUN_MODE}" = "cpu" ]; then
-            ./ascendc_kernels_bbit
+            ./ascendc_kernels_bbit "$@"
         fi
     else
-        ./ascendc_kernels_bbit
+        ./ascendc_kernels_bbit "$@"
     fi
 )
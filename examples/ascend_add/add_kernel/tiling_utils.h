@@ -0,0 +1,110 @@
+/**
+ * @file tiling_utils.h
+ *
+ * Host-side tiling: splits a runtime length across cores and Unified Buffer tiles.
+ */
+#ifndef TILING_UTILS_H
+#define TILING_UTILS_H
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "add_custom_tiling.h"
+
+// Unified Buffer bytes available to the three queues (Atlas A2 has 192 KB; 310P has more).
+constexpr uint32_t UB_BUDGET_BYTES = 192 * 1024;
+constexpr uint32_t QUEUE_NUM = 3; // x, y in; z out
+
+inline uint32_t CeilDiv(uint32_t a, uint32_t b)
+{
+    return (a + b - 1) / b;
+}
+
+inline uint32_t AlignUp(uint32_t a, uint32_t b)
+{
+    return CeilDiv(a, b) * b;
+}
+
+inline uint32_t MaxTileLength()
+{
+    return UB_BUDGET_BYTES / (QUEUE_NUM * BUFFER_NUM * sizeof(uint16_t)) / ALIGN_NUM * ALIGN_NUM;
+}
+
+/**
+ * @brief Compute the tiling of an add over totalLength half elements
+ * @param [in] totalLength: elements per input
+ * @param [in] blockDim: requested cores (fewer are used when there is not one block per core)
+ * @param [in] tileLength: elements per tile, 0 picks the largest tile that still gives every core
+ *             two tiles to overlap (capped by the Unified Buffer budget)
+ * @return tiling data for the kernel
+ */
+inline AddCustomTilingData GenerateTiling(uint32_t totalLength, uint32_t blockDim, uint32_t tileLength)
+{
+    if (totalLength == 0 || blockDim == 0) {
+        throw std::invalid_argument("totalLength and blockDim must be positive");
+    }
+    AddCustomTilingData tiling{};
+    const uint32_t blocks = CeilDiv(totalLength, ALIGN_NUM);
+    tiling.totalLength = totalLength;
+    tiling.blockDim = blockDim < blocks ? blockDim : blocks;
+    tiling.formerNum = blocks % tiling.blockDim;
+    tiling.tailLength = blocks / tiling.blockDim * ALIGN_NUM;
+    tiling.formerLength = tiling.tailLength + ALIGN_NUM;
+    const uint32_t coreLength = tiling.formerNum > 0 ? tiling.formerLength : tiling.tailLength;
+    if (tileLength == 0) {
+        tileLength = AlignUp(CeilDiv(coreLength, BUFFER_NUM), ALIGN_NUM);
+        tileLength = tileLength < MaxTileLength() ? tileLength : MaxTileLength();
+    }
+    if (tileLength % ALIGN_NUM != 0 || tileLength > MaxTileLength()) {
+        throw std::invalid_argument("tile length must be a multiple of " + std::to_string(ALIGN_NUM) +
+                                    " and at most " + std::to_string(MaxTileLength()));
+    }
+    tiling.tileLength = tileLength;
+    tiling.formerTileNum = tiling.formerLength / tiling.tileLength;
+    tiling.formerLastTileLength = tiling.formerLength % tiling.tileLength;
+    tiling.tailTileNum = tiling.tailLength / tiling.tileLength;
+    tiling.tailLastTileLength = tiling.tailLength % tiling.tileLength;
+    return tiling;
+}
+
+/**
+ * @brief Element count shared by every tensor in an optest {shapes} token
+ * @param [in] shapesJson: e.g. {"inputs": [[8, 2048], [8, 2048]], "outputs": [[8, 2048]]}
+ * @return elements per tensor (inputs and outputs must all have the same count)
+ */
+inline uint32_t ParseTotalLength(const std::string &shapesJson)
+{
+    std::vector<uint64_t> counts;
+    uint64_t count = 1;
+    int depth = 0;
+    for (size_t i = 0; i < shapesJson.size(); ++i) {
+        const char c = shapesJson[i];
+        if (c == '[') {
+            ++depth;
+            count = 1;
+        } else if (c == ']') {
+            if (depth == 2) {
+                counts.push_back(count); // a scalar shape [] counts one element
+            }
+            --depth;
+        } else if (depth == 2 && c >= '0' && c <= '9') {
+            size_t end = i;
+            count *= std::stoull(shapesJson.substr(i), &end);
+            i += end - 1;
+        }
+    }
+    if (counts.empty()) {
+        throw std::invalid_argument("no shapes in " + shapesJson);
+    }
+    for (uint64_t other : counts) {
+        if (other != counts[0]) {
+            throw std::invalid_argument("add_custom needs inputs and output of the same size: " + shapesJson);
+        }
+    }
+    if (counts[0] == 0 || counts[0] > UINT32_MAX - ALIGN_NUM) {
+        throw std::invalid_argument("unsupported element count in " + shapesJson);
+    }
+    return static_cast<uint32_t>(counts[0]);
+}
+#endif // TILING_UTILS_H
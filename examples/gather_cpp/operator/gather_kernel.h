@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Row gather / embedding-bag / scatter-add kernels for irregular memory access.
+//
+// Table rows are addressed through an index tensor, so hardware prefetchers
+// cannot predict the stream. The gathers therefore issue software prefetches
+// for the row `prefetch` positions ahead (every cache line of it), which keeps
+// several misses in flight per thread. Work is split into contiguous chunks
+// across std::threads; scatter-add buckets updates by destination row and
+// partitions the rows instead, so each row is updated by one thread in index
+// order (no atomics, deterministic sums).
+
+namespace gather {
+
+constexpr std::size_t kCacheLine = 64;
+
+template <typename T>
+inline void prefetch_row(const T* row, std::size_t width) {
+#if defined(__GNUC__) || defined(__clang__)
+    const auto* bytes = reinterpret_cast<const char*>(row);
+    for (std::size_t offset = 0; offset < width * sizeof(T); offset += kCacheLine) {
+        __builtin_prefetch(bytes + offset, 0, 1);
+    }
+#else
+    (void)row;
+    (void)width;
+#endif
+}
+
+template <typename F>
+void parallel_for(std::size_t count, unsigned threads, F&& body) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<std::size_t>(count, 1))));
+    if (threads == 1) {
+        body(std::size_t{0}, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    const std::size_t chunk = (count + threads - 1) / threads;
+    for (std::size_t begin = 0; begin < count; begin += chunk) {
+        pool.emplace_back(body, begin, std::min(count, begin + chunk));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// out[i, :] = table[idx[i], :]
+template <typename T, typename I>
+void gather_rows(const T* table, std::size_t width, const I* idx, std::size_t count, T* out, std::size_t prefetch,
+                 unsigned threads) {
+    parallel_for(count, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (prefetch != 0 && i + prefetch < end) {
+                prefetch_row(table + static_cast<std::size_t>(idx[i + prefetch]) * width, width);
+            }
+            std::memcpy(out + i * width, table + static_cast<std::size_t>(idx[i]) * width, width * sizeof(T));
+        }
+    });
+}
+
+enum class BagMode { kSum, kMean, kMax };
+
+// out[b, :] = reduce(table[idx[offsets[b] : offsets[b + 1]], :]); empty bags are zero.
+template <typename T, typename I>
+void embedding_bag(const T* table, std::size_t width, const I* idx, std::size_t count, const I* offsets,
+                   std::size_t bags, BagMode mode, T* out, std::size_t prefetch, unsigned threads) {
+    parallel_for(bags, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+            const auto first = static_cast<std::size_t>(offsets[b]);
+            const auto last = b + 1 < bags ? static_cast<std::size_t>(offsets[b + 1]) : count;
+            T* acc = out + b * width;
+            std::fill(acc, acc + width, T{});
+            for (std::size_t j = first; j < last; ++j) {
+                if (prefetch != 0 && j + prefetch < count) {
+                    prefetch_row(table + static_cast<std::size_t>(idx[j + prefetch]) * width, width);
+                }
+                const T* row = table + static_cast<std::size_t>(idx[j]) * width;
+                if (mode == BagMode::kMax) {
+                    for (std::size_t c = 0; c < width; ++c) {
+                        acc[c] = j == first ? row[c] : std::max(acc[c], row[c]);
+                    }
+                } else {
+                    for (std::size_t c = 0; c < width; ++c) {
+                        acc[c] += row[c];
+                    }
+                }
+            }
+            if (mode == BagMode::kMean && last > first) {
+                const T scale = static_cast<T>(last - first);
+                for (std::size_t c = 0; c < width; ++c) {
+                    acc[c] /= scale;
+                }
+            }
+        }
+    });
+}
+
+// out[idx[i], :] += updates[i, :], with `out` already holding the data tensor.
+template <typename T, typename I>
+void scatter_add(T* out, std::size_t rows, std::size_t width, const I* idx, const T* updates, std::size_t count,
+                 unsigned threads) {
+    auto add_row = [&](std::size_t i) {
+        const auto row = static_cast<std::size_t>(idx[i]);
+        T* dst = out + row * width;
+        const T* src = updates + i * width;
+        for (std::size_t c = 0; c < width; ++c) {
+            dst[c] += src[c];
+        }
+    };
+    if (std::min<std::size_t>(threads, rows) <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (static_cast<std::size_t>(idx[i]) < rows) {
+                add_row(i);
+            }
+        }
+        return;
+    }
+    // Bucket update positions by destination row (a stable counting sort), so each thread visits only the updates
+    // for its own rows, still in index order, instead of scanning the whole index tensor.
+    std::vector<std::size_t> starts(rows + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto row = static_cast<std::size_t>(idx[i]);
+        if (row < rows) {
+            ++starts[row + 1];
+        }
+    }
+    for (std::size_t row = 0; row < rows; ++row) {
+        starts[row + 1] += starts[row];
+    }
+    std::vector<std::size_t> order(starts[rows]);
+    std::vector<std::size_t> next(starts.begin(), starts.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto row = static_cast<std::size_t>(idx[i]);
+        if (row < rows) {
+            order[next[row]++] = i;
+        }
+    }
+    parallel_for(rows, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = starts[begin]; k < starts[end]; ++k) {
+            add_row(order[k]);
+        }
+    });
+}
+
+}  // namespace gather
@@ -0,0 +1,246 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gather_kernel.h"
+#include "optest/tensor_file.h"
+
+namespace {
+
+struct Options {
+    std::string op = "auto";
+    std::string mode = "sum";
+    std::string inputs;
+    std::string output0;
+    std::string dtypes;
+    std::string shapes_json;
+    std::string format = "raw";
+    std::size_t prefetch = 8;
+    unsigned threads = 0;
+    int iterations = 1;
+};
+
+Options parse_args(int argc, char** argv) {
+    Options opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--op" && i + 1 < argc) {
+            opt.op = argv[++i];
+        } else if (arg == "--mode" && i + 1 < argc) {
+            opt.mode = argv[++i];
+        } else if (arg == "--inputs" && i + 1 < argc) {
+            opt.inputs = argv[++i];
+        } else if (arg == "--output0" && i + 1 < argc) {
+            opt.output0 = argv[++i];
+        } else if (arg == "--dtypes" && i + 1 < argc) {
+            opt.dtypes = argv[++i];
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            opt.shapes_json = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            opt.prefetch = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.iterations = std::stoi(argv[++i]);
+        }
+    }
+    if (opt.inputs.empty() || opt.output0.empty() || opt.dtypes.empty() || opt.shapes_json.empty()) {
+        throw std::runtime_error("--inputs, --output0, --dtypes and --shapes are required");
+    }
+    if (opt.iterations < 1) {
+        throw std::runtime_error("--iterations must be positive");
+    }
+    if (opt.threads == 0) {
+        opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return opt;
+}
+
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        parts.push_back(item);
+    }
+    return parts;
+}
+
+// Innermost integer lists of the `{shapes}` JSON, in order: inputs first, then outputs.
+std::vector<std::vector<int64_t>> parse_shape_lists(const std::string& text) {
+    std::vector<std::vector<int64_t>> lists;
+    std::vector<int64_t> current;
+    bool in_list = false;
+    int64_t value = 0;
+    bool in_number = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            in_number = true;
+            continue;
+        }
+        if (in_number) {
+            current.push_back(value);
+            value = 0;
+            in_number = false;
+        }
+        if (c == '[') {
+            current.clear();
+            in_list = true;
+        } else if (c == ']' && in_list) {
+            lists.push_back(current);
+            in_list = false;
+        }
+    }
+    return lists;
+}
+
+int64_t numel(const std::vector<int64_t>& shape) {
+    int64_t count = 1;
+    for (int64_t dim : shape) {
+        count *= dim;
+    }
+    return count;
+}
+
+// Elements per leading-axis row.
+std::size_t row_width(const std::vector<int64_t>& shape) {
+    return shape.empty() || shape[0] == 0 ? 0 : static_cast<std::size_t>(numel(shape) / shape[0]);
+}
+
+template <typename I>
+void check_indices(const I* idx, std::size_t count, int64_t extent) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (idx[i] < 0 || idx[i] >= extent) {
+            throw std::runtime_error("index " + std::to_string(idx[i]) + " out of range [0, " +
+                                     std::to_string(extent) + ")");
+        }
+    }
+}
+
+template <typename F>
+double time_ms(int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < iterations; ++iter) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void report(double per_call_ms, double bytes, unsigned threads) {
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << per_call_ms << " gather_gbps=" << bytes / 1e9 / (per_call_ms / 1e3)
+              << " threads=" << threads << std::endl;
+}
+
+template <typename T, typename I>
+void run(const Options& opts, const std::string& op, const std::vector<std::string>& inputs,
+         const std::vector<std::vector<int64_t>>& shapes) {
+    const auto& table_shape = shapes[0];
+    const auto& out_shape = shapes.back();
+    optest::TensorMap<T> table(inputs[0], table_shape);
+    optest::TensorMap<I> idx(inputs[1], shapes[1]);
+    if (!table.contiguous() || !idx.contiguous()) {
+        throw std::runtime_error("inputs must be contiguous");
+    }
+    check_indices(idx.data(), idx.size(), table_shape[0]);
+    const std::size_t width = row_width(table_shape);
+    const std::size_t row_bytes = width * sizeof(T);
+    std::vector<T> out(static_cast<std::size_t>(numel(out_shape)), T{});
+    double per_call_ms = 0.0;
+    double bytes = 0.0;
+    if (op == "gather") {
+        if (numel(out_shape) != static_cast<int64_t>(idx.size() * width)) {
+            throw std::runtime_error("gather output must be indices.shape + data.shape[1:]");
+        }
+        per_call_ms = time_ms(opts.iterations, [&] {
+            gather::gather_rows(table.data(), width, idx.data(), idx.size(), out.data(), opts.prefetch, opts.threads);
+        });
+        // Rows read from the table + rows written + the index stream.
+        bytes = static_cast<double>(idx.size()) * (2.0 * row_bytes + sizeof(I));
+    } else if (op == "embedding_bag") {
+        optest::TensorMap<I> offsets(inputs[2], shapes[2]);
+        const std::size_t bags = offsets.size();
+        for (std::size_t b = 0; b < bags; ++b) {
+            const int64_t end = b + 1 < bags ? offsets.data()[b + 1] : static_cast<int64_t>(idx.size());
+            if (offsets.data()[b] < 0 || offsets.data()[b] > end) {
+                throw std::runtime_error("offsets must be non-decreasing and within the indices");
+            }
+        }
+        if (numel(out_shape) != static_cast<int64_t>(bags * width)) {
+            throw std::runtime_error("embedding_bag output must be [bags] + weight.shape[1:]");
+        }
+        gather::BagMode mode = gather::BagMode::kSum;
+        if (opts.mode == "mean") {
+            mode = gather::BagMode::kMean;
+        } else if (opts.mode == "max") {
+            mode = gather::BagMode::kMax;
+        } else if (opts.mode != "sum") {
+            throw std::runtime_error("--mode must be sum, mean or max");
+        }
+        per_call_ms = time_ms(opts.iterations, [&] {
+            gather::embedding_bag(table.data(), width, idx.data(), idx.size(), offsets.data(), bags, mode, out.data(),
+                                  opts.prefetch, opts.threads);
+        });
+        bytes = static_cast<double>(idx.size()) * (row_bytes + sizeof(I)) + static_cast<double>(bags) * row_bytes;
+    } else {
+        optest::TensorMap<T> updates(inputs[2], shapes[2]);
+        if (updates.size() != idx.size() * width || out.size() != table.size()) {
+            throw std::runtime_error("scatter_add needs updates of indices.shape + data.shape[1:] and output == data");
+        }
+        per_call_ms = time_ms(opts.iterations, [&] {
+            std::copy(table.data(), table.data() + table.size(), out.begin());
+            gather::scatter_add(out.data(), static_cast<std::size_t>(table_shape[0]), width, idx.data(), updates.data(),
+                                idx.size(), opts.threads);
+        });
+        // Copy of data (read + write) plus read-modify-write of one row per update.
+        bytes = 2.0 * table.size() * sizeof(T) + static_cast<double>(idx.size()) * (3.0 * row_bytes + sizeof(I));
+    }
+    report(per_call_ms, bytes, opts.threads);
+    optest::write_tensor<T>(opts.output0, out.data(), out_shape, opts.format == "optt");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opts = parse_args(argc, argv);
+        const auto inputs = split_list(opts.inputs);
+        const auto dtypes = split_list(opts.dtypes);
+        const auto shapes = parse_shape_lists(opts.shapes_json);
+        if (inputs.size() < 2 || inputs.size() > 3 || dtypes.size() != inputs.size() ||
+            shapes.size() != inputs.size() + 1) {
+            throw std::runtime_error("expected 2 (gather) or 3 (scatter_add, embedding_bag) inputs and one output");
+        }
+        std::string op = opts.op;
+        if (op == "auto") {
+            // 2 inputs: gather; 3 inputs: scatter_add takes row updates, embedding_bag 1-D offsets.
+            op = inputs.size() == 2 ? "gather" : (shapes[2].size() >= 2 ? "scatter_add" : "embedding_bag");
+        }
+        if (op != "gather" && op != "scatter_add" && op != "embedding_bag") {
+            throw std::runtime_error("unsupported --op " + op);
+        }
+        if (dtypes[0] != "float32") {
+            throw std::runtime_error("unsupported data dtype: " + dtypes[0]);
+        }
+        if (dtypes[1] == "int64") {
+            run<float, int64_t>(opts, op, inputs, shapes);
+        } else if (dtypes[1] == "int32") {
+            run<float, int32_t>(opts, op, inputs, shapes);
+        } else {
+            throw std::runtime_error("unsupported index dtype: " + dtypes[1]);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "gather_runner failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
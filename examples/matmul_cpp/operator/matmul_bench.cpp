@@ -0,0 +1,472 @@
+// In-memory benchmark of matmul_kernel / matmul_dispatch, without the runner's file I/O.
+//
+//   matmul_bench --case float_small --shape 2x3x4 --shape 4x2x1 --case small_fixed --shape 16x16x16
+//                --threads 1,2,4 --warmup 3 --repeat 20 --output bench.json   (one command line)
+//
+// Every `--case` opens a group; its `--shape MxKxN` entries are numbered shape0, shape1, ... in order, so with the
+// plan's case names and shape order the identifiers match `optest bench` ("case@backend:chip/shapeN") and the JSON
+// (the `optest bench --report json` layout) can be fed to `optest bench --ingest`. A sweep over several thread counts
+// tags the chip with the count ("local-t4") so every run stays a separate result.
+//
+// `--cache-state cold` (default: $OPTEST_CACHE_STATE, else warm) rotates every call through enough copies of A, B
+// and C to exceed the last-level cache and flushes the caches before each sample; `both` measures warm and cold and
+// writes the cold samples next to the warm ones (`cold_samples_s`).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "matmul_kernel.h"
+#include "matmul_small.h"
+#include "optest/cache_state.h"
+
+namespace {
+
+struct BenchShape {
+    std::string case_name;
+    int index;
+    std::size_t m;
+    std::size_t k;
+    std::size_t n;
+};
+
+struct Options {
+    std::string dtype = "float32";
+    std::string kernel = "auto";
+    std::string target = "cuda:local";
+    std::string output;
+    std::string cache_state = optest::cache_state_name(optest::cache_state_from_env());
+    std::vector<BenchShape> shapes;
+    std::vector<unsigned> threads{1};
+    int warmup = 3;
+    int repeat = 10;
+    double min_sample_ms = 1.0;
+};
+
+std::vector<std::string> split(const std::string& text, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, sep)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+BenchShape parse_shape(const std::string& text, const std::string& case_name, int index) {
+    const auto dims = split(text, 'x');
+    if (dims.size() != 3) {
+        throw std::runtime_error("--shape must be MxKxN, got: " + text);
+    }
+    const auto m = std::stoll(dims[0]);
+    const auto k = std::stoll(dims[1]);
+    const auto n = std::stoll(dims[2]);
+    if (m <= 0 || k <= 0 || n <= 0) {
+        throw std::runtime_error("--shape dimensions must be positive: " + text);
+    }
+    return BenchShape{case_name, index, static_cast<std::size_t>(m), static_cast<std::size_t>(k),
+                      static_cast<std::size_t>(n)};
+}
+
+Options parse_args(int argc, char** argv) {
+    Options opt{};
+    std::string case_name = "matmul";
+    int index = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--dtype" || arg == "-t") && i + 1 < argc) {
+            opt.dtype = argv[++i];
+        } else if (arg == "--kernel" && i + 1 < argc) {
+            opt.kernel = argv[++i];
+        } else if (arg == "--target" && i + 1 < argc) {
+            opt.target = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            opt.output = argv[++i];
+        } else if (arg == "--case" && i + 1 < argc) {
+            case_name = argv[++i];
+            index = 0;
+        } else if (arg == "--shape" && i + 1 < argc) {
+            opt.shapes.push_back(parse_shape(argv[++i], case_name, index++));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads.clear();
+            for (const auto& item : split(argv[++i], ',')) {
+                opt.threads.push_back(static_cast<unsigned>(std::stoul(item)));
+            }
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            opt.warmup = std::stoi(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            opt.repeat = std::stoi(argv[++i]);
+        } else if (arg == "--min-sample-ms" && i + 1 < argc) {
+            opt.min_sample_ms = std::stod(argv[++i]);
+        } else if (arg == "--cache-state" && i + 1 < argc) {
+            opt.cache_state = argv[++i];
+        } else {
+            throw std::runtime_error("unknown or incomplete argument: " + arg);
+        }
+    }
+    if (opt.shapes.empty()) {
+        throw std::runtime_error("at least one --shape is required");
+    }
+    if (opt.kernel != "auto" && opt.kernel != "generic") {
+        throw std::runtime_error("--kernel must be auto or generic");
+    }
+    if (opt.cache_state != "warm" && opt.cache_state != "cold" && opt.cache_state != "both") {
+        throw std::runtime_error("--cache-state must be warm, cold or both");
+    }
+    if (opt.target.find(':') == std::string::npos) {
+        throw std::runtime_error("--target must be backend:chip");
+    }
+    if (opt.warmup < 0 || opt.repeat < 1 || opt.threads.empty() ||
+        std::count(opt.threads.begin(), opt.threads.end(), 0u) != 0) {
+        throw std::runtime_error("--warmup must be >= 0, --repeat and --threads positive");
+    }
+    return opt;
+}
+
+// Rows of C are split into one contiguous block per worker; each block is an independent (rows x k x n) product.
+// A registered shape is split only when its blocks are registered too, otherwise it runs whole on one worker: the
+// sweep must not trade the specialized kernel for threads.
+struct RowSplit {
+    unsigned workers;
+    std::size_t chunk;
+};
+
+template <typename T>
+RowSplit split_rows(const Options& opt, const BenchShape& shape, unsigned threads) {
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, shape.m));
+    const std::size_t chunk = (shape.m + threads - 1) / threads;
+    const auto workers = static_cast<unsigned>((shape.m + chunk - 1) / chunk);
+    if (opt.kernel == "auto" && workers > 1 && find_small_matmul<T>(shape.m, shape.k, shape.n) != nullptr) {
+        const std::size_t last = shape.m - (workers - 1) * chunk;
+        if (find_small_matmul<T>(chunk, shape.k, shape.n) == nullptr ||
+            find_small_matmul<T>(last, shape.k, shape.n) == nullptr) {
+            return RowSplit{1, shape.m};
+        }
+    }
+    return RowSplit{workers, chunk};
+}
+
+// Workers started once per measurement; the calling thread is worker 0. run() hands every worker the same job and
+// returns when all of them have finished it.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned workers) {
+        for (unsigned worker = 1; worker < workers; ++worker) {
+            threads_.emplace_back([this, worker] { loop(worker); });
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void run(const std::function<void(unsigned)>& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            pending_ = threads_.size();
+            ++generation_;
+        }
+        start_.notify_all();
+        job(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    void loop(unsigned worker) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(unsigned)>* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                job = job_;
+            }
+            (*job)(worker);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(unsigned)>* job_ = nullptr;
+    std::uint64_t generation_ = 0;
+    std::size_t pending_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+// Spinning barrier for workers that are already running: far cheaper than a condition variable wake-up, so the
+// timed region between two barriers holds only kernel calls.
+class SpinBarrier {
+public:
+    explicit SpinBarrier(unsigned count) : count_(count) {}
+
+    void arrive_and_wait() {
+        const unsigned phase = phase_.load(std::memory_order_acquire);
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+            waiting_.store(0, std::memory_order_relaxed);
+            phase_.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        while (phase_.load(std::memory_order_acquire) == phase) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    const unsigned count_;
+    std::atomic<unsigned> waiting_{0};
+    std::atomic<unsigned> phase_{0};
+};
+
+struct Result {
+    std::string id;
+    std::vector<double> samples_s;       // per kernel call
+    std::vector<double> cold_samples_s;  // --cache-state both
+    double flops;
+    bool specialized;
+    unsigned threads;
+};
+
+// Copies of A, B and C: one for warm runs, enough to cycle through more than the last-level cache for cold ones.
+template <typename T>
+struct Operands {
+    std::vector<std::vector<T>> a;
+    std::vector<std::vector<T>> b;
+    std::vector<std::vector<T>> c;
+};
+
+template <typename T>
+Operands<T> make_operands(const BenchShape& shape, std::size_t copies) {
+    Operands<T> ops;
+    std::vector<T> a(shape.m * shape.k);
+    std::vector<T> b(shape.k * shape.n);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<T>(static_cast<int>(i % 7) - 3);
+    }
+    for (std::size_t i = 0; i < b.size(); ++i) {
+        b[i] = static_cast<T>(static_cast<int>(i % 5) - 2);
+    }
+    ops.a.assign(copies, a);
+    ops.b.assign(copies, b);
+    ops.c.assign(copies, std::vector<T>(shape.m * shape.n));
+    return ops;
+}
+
+// Per-call samples; cold samples start from flushed caches and never reuse a copy that could still be cached.
+// Every worker runs its row block of each call; a sample is timed between two barriers, so neither thread start-up
+// nor the pool's wake-up is measured.
+template <typename T>
+std::vector<double> measure(const Options& opt, const BenchShape& shape, const RowSplit& split, bool cold,
+                            bool& specialized) {
+    const std::size_t bytes = sizeof(T) * (shape.m * shape.k + shape.k * shape.n + shape.m * shape.n);
+    Operands<T> ops = make_operands<T>(shape, cold ? optest::rotation_copies(bytes) : 1);
+    WorkerPool pool(split.workers);
+    SpinBarrier barrier(split.workers);
+    std::vector<char> hits(split.workers, 0);
+    std::size_t next = 0;
+    using clock = std::chrono::steady_clock;
+    // Seconds per call over `calls` calls.
+    const auto run = [&](int calls) {
+        clock::time_point start;
+        clock::time_point stop;
+        const std::size_t first = next;
+        next += static_cast<std::size_t>(calls);
+        pool.run([&](unsigned worker) {
+            const std::size_t row = worker * split.chunk;
+            const std::size_t rows = std::min(split.chunk, shape.m - row);
+            barrier.arrive_and_wait();
+            if (worker == 0) {
+                start = clock::now();
+            }
+            bool hit = false;
+            for (int i = 0; i < calls; ++i) {
+                const std::size_t copy = (first + static_cast<std::size_t>(i)) % ops.a.size();
+                const T* a = ops.a[copy].data() + row * shape.k;
+                T* c = ops.c[copy].data() + row * shape.n;
+                if (opt.kernel == "generic") {
+                    matmul_kernel<T>(a, ops.b[copy].data(), c, rows, shape.k, shape.n);
+                } else {
+                    hit = matmul_dispatch<T>(a, ops.b[copy].data(), c, rows, shape.k, shape.n);
+                }
+            }
+            barrier.arrive_and_wait();
+            if (worker == 0) {
+                stop = clock::now();
+            }
+            hits[worker] = hit;
+        });
+        // Row blocks are dispatched on their own (rows, K, N), so report specialized only when every block was.
+        specialized = std::all_of(hits.begin(), hits.end(), [](char hit) { return hit != 0; });
+        const std::chrono::duration<double> elapsed = stop - start;
+        return elapsed.count() / calls;
+    };
+    if (opt.warmup > 0) {
+        run(opt.warmup);
+    }
+    // Tiny shapes run in nanoseconds: batch calls so one sample spans at least min_sample_ms.
+    int calls = 1;
+    for (;;) {
+        const double elapsed_ms = run(calls) * calls * 1e3;
+        if (elapsed_ms >= opt.min_sample_ms || calls >= (1 << 24)) {
+            break;
+        }
+        const double grow = elapsed_ms > 0 ? opt.min_sample_ms / elapsed_ms + 1.0 : 16.0;
+        calls = static_cast<int>(std::min<double>(1 << 24, calls * std::max(2.0, grow)));
+    }
+    std::vector<double> samples;
+    for (int rep = 0; rep < opt.repeat; ++rep) {
+        if (cold) {
+            optest::flush_caches();
+        }
+        samples.push_back(run(calls));
+    }
+    return samples;
+}
+
+template <typename T>
+Result bench_shape(const Options& opt, const BenchShape& shape, unsigned threads) {
+    Result result{};
+    bool specialized = false;
+    const RowSplit split = split_rows<T>(opt, shape, threads);
+    result.samples_s = measure<T>(opt, shape, split, opt.cache_state == "cold", specialized);
+    if (opt.cache_state == "both") {
+        result.cold_samples_s = measure<T>(opt, shape, split, true, specialized);
+    }
+    std::string target = opt.target;
+    if (opt.threads.size() > 1) {
+        target += "-t" + std::to_string(threads);
+    }
+    result.id = shape.case_name + "@" + target + "/shape" + std::to_string(shape.index);
+    result.flops = 2.0 * static_cast<double>(shape.m) * static_cast<double>(shape.k) * static_cast<double>(shape.n);
+    result.specialized = specialized;
+    result.threads = split.workers;  // what ran: a registered shape kept whole uses one
+    return result;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    return values.size() % 2 != 0 ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+        }
+        out += ch;
+    }
+    return out + "\"";
+}
+
+// Same layout as `optest bench --report json`, readable by `optest bench --ingest`.
+void write_json(std::ostream& out, const Options& opt, const std::vector<Result>& results) {
+    out.precision(9);
+    out << "{\n  \"summary\": {\"total\": " << results.size() << ", \"failures\": 0, \"warmup\": " << opt.warmup
+        << ", \"repeat\": " << opt.repeat << ", \"source\": \"matmul_bench\", \"dtype\": " << quoted(opt.dtype)
+        << ", \"kernel\": " << quoted(opt.kernel) << ", \"cache_state\": " << quoted(opt.cache_state)
+        << "},\n  \"cases\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const double med = median(r.samples_s);
+        out << (i == 0 ? "\n" : ",\n") << "    {\"id\": " << quoted(r.id) << ", \"status\": \"ok\", \"details\": \"\", "
+            << "\"samples_s\": [";
+        for (std::size_t j = 0; j < r.samples_s.size(); ++j) {
+            out << (j == 0 ? "" : ", ") << r.samples_s[j];
+        }
+        out << "]";
+        if (!r.cold_samples_s.empty()) {
+            out << ", \"cold_samples_s\": [";
+            for (std::size_t j = 0; j < r.cold_samples_s.size(); ++j) {
+                out << (j == 0 ? "" : ", ") << r.cold_samples_s[j];
+            }
+            out << "], \"cold_median_s\": " << median(r.cold_samples_s);
+        }
+        out << ", \"median_s\": " << med << ", \"min_s\": " << *std::min_element(r.samples_s.begin(), r.samples_s.end())
+            << ", \"metrics\": {\"kernel_ms\": " << med * 1e3 << ", \"gflops\": " << r.flops / med / 1e9
+            << ", \"threads\": " << r.threads << ", \"specialized\": " << (r.specialized ? 1 : 0) << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+template <typename T>
+std::vector<Result> bench_all(const Options& opt) {
+    std::vector<Result> results;
+    for (const auto& shape : opt.shapes) {
+        for (unsigned threads : opt.threads) {
+            results.push_back(bench_shape<T>(opt, shape, threads));
+            const Result& r = results.back();
+            std::cerr << r.id << " median=" << median(r.samples_s) * 1e3 << "ms gflops="
+                      << r.flops / median(r.samples_s) / 1e9;
+            if (!r.cold_samples_s.empty()) {
+                std::cerr << " cold_median=" << median(r.cold_samples_s) * 1e3 << "ms";
+            }
+            std::cerr << std::endl;
+        }
+    }
+    return results;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options opts = parse_args(argc, argv);
+        std::vector<Result> results;
+        if (opts.dtype == "float32") {
+            results = bench_all<float>(opts);
+        } else if (opts.dtype == "int32") {
+            results = bench_all<int32_t>(opts);
+        } else {
+            throw std::runtime_error("unsupported dtype: " + opts.dtype);
+        }
+        if (opts.output.empty()) {
+            write_json(std::cout, opts, results);
+        } else {
+            std::ofstream file(opts.output);
+            write_json(file, opts, results);
+            if (!file) {
+                throw std::runtime_error("cannot write " + opts.output);
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "matmul_bench failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "matmul_kernel.h"
 
+#include "matmul_small.h"
+
 #include <cstddef>
 #include <cstdint>
 
@@ -16,6 +18,18 @@ void matmul_kernel(const T* a, const T* b, T* c, std::size_t m, std::size_t k, s
     }
 }
 
+template <typename T>
+bool matmul_dispatch(const T* a, const T* b, T* c, std::size_t m, std::size_t k, std::size_t n) {
+    if (SmallMatmulFn<T> fn = find_small_matmul<T>(m, k, n)) {
+        fn(a, b, c);
+        return true;
+    }
+    matmul_kernel<T>(a, b, c, m, k, n);
+    return false;
+}
+
 // Explicit instantiations for the dtypes used in this example.
 template void matmul_kernel<float>(const float*, const float*, float*, std::size_t, std::size_t, std::size_t);
 template void matmul_kernel<int32_t>(const int32_t*, const int32_t*, int32_t*, std::size_t, std::size_t, std::size_t);
+template bool matmul_dispatch<float>(const float*, const float*, float*, std::size_t, std::size_t, std::size_t);
+template bool matmul_dispatch<int32_t>(const int32_t*, const int32_t*, int32_t*, std::size_t, std::size_t, std::size_t);
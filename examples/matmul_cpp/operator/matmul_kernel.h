@@ -5,3 +5,9 @@
 // Simple CPU matmul: C[m x n] = A[m x k] x B[k x n]
 template <typename T>
 void matmul_kernel(const T* a, const T* b, T* c, std::size_t m, std::size_t k, std::size_t n);
+
+// Dispatches to a compile-time specialized kernel when (m, k, n) is registered in
+// matmul_small.h and falls back to matmul_kernel otherwise. Returns true when a
+// specialized kernel ran.
+template <typename T>
+bool matmul_dispatch(const T* a, const T* b, T* c, std::size_t m, std::size_t k, std::size_t n);
@@ -1,12 +1,13 @@
+#include <chrono>
 #include <cstdint>
-#include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "matmul_kernel.h"
+#include "optest/float_mode.h"
+#include "optest/tensor_file.h"
 
 namespace {
 
@@ -16,6 +17,10 @@ struct Options {
     std::string input1 = "data/input1.bin";
     std::string output0 = "out/output0.bin";
     std::string shapes_json;
+    std::string layouts_json;
+    std::string format = "raw";
+    std::string kernel = "auto";
+    int iterations = 1;
 };
 
 Options parse_args(int argc, char** argv) {
@@ -32,8 +37,22 @@ Options parse_args(int argc, char** argv) {
             opt.output0 = argv[++i];
         } else if (arg == "--shapes" && i + 1 < argc) {
             opt.shapes_json = argv[++i];
+        } else if (arg == "--layouts" && i + 1 < argc) {
+            opt.layouts_json = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--kernel" && i + 1 < argc) {
+            opt.kernel = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.iterations = std::stoi(argv[++i]);
         }
     }
+    if (opt.kernel != "auto" && opt.kernel != "generic") {
+        throw std::runtime_error("--kernel must be auto or generic");
+    }
+    if (opt.iterations < 1) {
+        throw std::runtime_error("--iterations must be positive");
+    }
     return opt;
 }
 
@@ -87,52 +106,43 @@ MatmulShape parse_shapes(const std::string& shapes_json) {
     return MatmulShape{m, k, n};
 }
 
-template <typename T>
-std::vector<T> read_file(const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("failed to open " + path);
-    }
-    file.seekg(0, std::ios::end);
-    const std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    if (size % static_cast<std::streamsize>(sizeof(T)) != 0) {
-        throw std::runtime_error("file size not aligned to dtype for " + path);
-    }
-    std::vector<T> data(static_cast<size_t>(size) / sizeof(T));
-    if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
-        throw std::runtime_error("failed to read " + path);
-    }
-    return data;
-}
-
-template <typename T>
-void write_file(const std::string& path, const std::vector<T>& data) {
-    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
-    std::ofstream file(path, std::ios::binary | std::ios::trunc);
-    if (!file) {
-        throw std::runtime_error("failed to open " + path + " for write");
-    }
-    file.write(reinterpret_cast<const char*>(data.data()),
-               static_cast<std::streamsize>(data.size() * sizeof(T)));
-    if (!file) {
-        throw std::runtime_error("failed to write " + path);
-    }
-}
-
 template <typename T>
 void run_matmul(const Options& opts, const MatmulShape& shape) {
-    const size_t count_a = static_cast<size_t>(shape.m * shape.k);
-    const size_t count_b = static_cast<size_t>(shape.k * shape.n);
-    auto a = read_file<T>(opts.input0);
-    auto b = read_file<T>(opts.input1);
-    if (a.size() != count_a || b.size() != count_b) {
-        throw std::runtime_error("input sizes do not match shapes");
+    // Inputs are mapped zero-copy; raw and .optt container files are both accepted.
+    // Pitched/strided inputs are packed once up front so the kernels stay dense.
+    const auto layouts = optest::parse_layouts(opts.layouts_json);
+    optest::TensorMap<T> a_map(opts.input0, {shape.m, shape.k}, layouts.input(0));
+    optest::TensorMap<T> b_map(opts.input1, {shape.k, shape.n}, layouts.input(1));
+    std::vector<T> a_packed;
+    std::vector<T> b_packed;
+    const T* a_data = a_map.data();
+    const T* b_data = b_map.data();
+    if (!a_map.contiguous()) {
+        a_packed = optest::to_contiguous(a_map);
+        a_data = a_packed.data();
+    }
+    if (!b_map.contiguous()) {
+        b_packed = optest::to_contiguous(b_map);
+        b_data = b_packed.data();
     }
     std::vector<T> out(static_cast<size_t>(shape.m * shape.n), static_cast<T>(0));
-    matmul_kernel<T>(a.data(), b.data(), out.data(), static_cast<size_t>(shape.m), static_cast<size_t>(shape.k),
-                     static_cast<size_t>(shape.n));
-    write_file<T>(opts.output0, out);
+    const auto m = static_cast<size_t>(shape.m);
+    const auto k = static_cast<size_t>(shape.k);
+    const auto n = static_cast<size_t>(shape.n);
+    bool specialized = false;
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < opts.iterations; ++iter) {
+        if (opts.kernel == "generic") {
+            matmul_kernel<T>(a_data, b_data, out.data(), m, k, n);
+        } else {
+            specialized = matmul_dispatch<T>(a_data, b_data, out.data(), m, k, n);
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << elapsed.count() / opts.iterations
+              << " specialized=" << (specialized ? 1 : 0) << std::endl;
+    optest::write_tensor<T>(opts.output0, out.data(), {shape.m, shape.n}, opts.format == "optt", layouts.output(0));
 }
 
 }  // namespace
@@ -144,6 +154,8 @@ int main(int argc, char** argv) {
             throw std::runtime_error("--shapes is required");
         }
         MatmulShape shape = parse_shapes(opts.shapes_json);
+        // `optest bench --ftz` flushes subnormals for the whole (single-threaded) run.
+        optest::ScopedFloatMode float_mode(optest::float_mode_from_env());
         if (opts.dtype == "float32") {
             run_matmul<float>(opts, shape);
         } else if (opts.dtype == "int32") {
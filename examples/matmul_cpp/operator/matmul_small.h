@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Compile-time specialized kernels for small, fixed GEMM shapes.
+//
+// For tiny matmuls the generic triple loop is dominated by loop overhead and
+// index math. Here M, N and K are template parameters: the K loop is fully
+// unrolled and each output row is accumulated in a fixed-size local array the
+// compiler keeps in vector registers. Summation order over K matches
+// matmul_kernel, so results are bit-identical to the generic path.
+
+// Shapes with a specialized kernel, as X(M, N, K). Add production shapes here.
+#define OPTEST_SMALL_GEMM_SHAPES(X) \
+    X(4, 4, 4)                      \
+    X(4, 4, 16)                     \
+    X(4, 4, 64)                     \
+    X(8, 8, 8)                      \
+    X(8, 8, 32)                     \
+    X(16, 16, 16)                   \
+    X(32, 32, 32)
+
+namespace small_gemm {
+
+template <typename F, std::size_t... I>
+inline void unroll_impl(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<std::size_t, I>{}), ...);
+}
+
+template <std::size_t Count, typename F>
+inline void unroll(F&& f) {
+    unroll_impl(std::forward<F>(f), std::make_index_sequence<Count>{});
+}
+
+}  // namespace small_gemm
+
+template <typename T, std::size_t M, std::size_t N, std::size_t K>
+void small_matmul(const T* __restrict a, const T* __restrict b, T* __restrict c) {
+    for (std::size_t i = 0; i < M; ++i) {
+        alignas(64) T acc[N] = {};
+        const T* a_row = a + i * K;
+        small_gemm::unroll<K>([&](auto kk) {
+            const T a_ik = a_row[kk];
+            const T* b_row = b + kk * N;
+            for (std::size_t j = 0; j < N; ++j) {
+                acc[j] += a_ik * b_row[j];
+            }
+        });
+        for (std::size_t j = 0; j < N; ++j) {
+            c[i * N + j] = acc[j];
+        }
+    }
+}
+
+template <typename T>
+using SmallMatmulFn = void (*)(const T*, const T*, T*);
+
+template <typename T>
+struct SmallMatmulEntry {
+    std::size_t m;
+    std::size_t n;
+    std::size_t k;
+    SmallMatmulFn<T> fn;
+};
+
+// Returns the specialized kernel for (m, k, n), or nullptr when the shape is not registered.
+template <typename T>
+SmallMatmulFn<T> find_small_matmul(std::size_t m, std::size_t k, std::size_t n) {
+#define OPTEST_SMALL_GEMM_ENTRY(M, N, K) SmallMatmulEntry<T>{M, N, K, &small_matmul<T, M, N, K>},
+    static constexpr SmallMatmulEntry<T> kTable[] = {OPTEST_SMALL_GEMM_SHAPES(OPTEST_SMALL_GEMM_ENTRY)};
+#undef OPTEST_SMALL_GEMM_ENTRY
+    for (const auto& entry : kTable) {
+        if (entry.m == m && entry.n == n && entry.k == k) {
+            return entry.fn;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// Prefix scans (cumsum / cumprod) over one axis of a [outer, length, inner] tensor.
+//
+// inner == 1 (scanning the contiguous axis): each line is scanned 8 floats at a
+// time with an in-register (in-lane) scan: two shifted combines inside each
+// 128-bit half, then the low half's total is folded into the high half, then
+// the running carry is applied. With fewer lines than threads, a line is
+// split into one chunk per thread and scanned in two passes (reduce-then-scan):
+// pass 1 reduces every chunk in parallel, a serial scan of the chunk totals
+// gives each chunk its carry-in, and pass 2 scans the chunks in parallel.
+// inner > 1: rows are combined element-wise (out[i, :] = out[i - 1, :] op x[i, :]),
+// which vectorizes across `inner`; column blocks are split across threads.
+// Accumulation stays in T, so float results drift from an exact scan by up to
+// ~length * eps * max|x| (the bound optest's reference tolerance uses).
+
+namespace scan {
+
+struct Add {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a + b;
+    }
+#if defined(__AVX__)
+    static __m256 apply(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+#endif
+    static constexpr int kIdentity = 0;
+};
+
+struct Mul {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a * b;
+    }
+#if defined(__AVX__)
+    static __m256 apply(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+#endif
+    static constexpr int kIdentity = 1;
+};
+
+constexpr std::size_t kChunkAlign = 64;  // chunk boundaries on whole cache lines (and SIMD blocks)
+
+template <typename F>
+void parallel_for(std::size_t count, unsigned threads, F&& body) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<std::size_t>(count, 1))));
+    if (threads == 1) {
+        body(std::size_t{0}, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    const std::size_t chunk = (count + threads - 1) / threads;
+    for (std::size_t begin = 0; begin < count; begin += chunk) {
+        pool.emplace_back(body, begin, std::min(count, begin + chunk));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+namespace detail {
+
+#if defined(__AVX__)
+// Inclusive scan of 8 lanes.
+template <typename Op>
+inline __m256 lane_scan(__m256 x, __m256 identity) {
+    // Within each 128-bit half: shift by one, then by two, shifting in the identity.
+    x = Op::apply(x, _mm256_blend_ps(_mm256_permute_ps(x, _MM_SHUFFLE(2, 1, 0, 0)), identity, 0x11));
+    x = Op::apply(x, _mm256_blend_ps(_mm256_permute_ps(x, _MM_SHUFFLE(1, 0, 0, 0)), identity, 0x33));
+    // Fold the low half's total (lane 3) into every lane of the high half.
+    __m256 low_total = _mm256_permute_ps(x, _MM_SHUFFLE(3, 3, 3, 3));
+    low_total = _mm256_blend_ps(_mm256_permute2f128_ps(low_total, low_total, 0x08), identity, 0x0F);
+    return Op::apply(x, low_total);
+}
+#endif
+
+// out[i] = carry op x[0] op ... op x[i]; returns the final carry.
+template <typename Op, typename T>
+T scan_contiguous(const T* in, T* out, std::size_t count, T carry) {
+    std::size_t i = 0;
+#if defined(__AVX__)
+    if constexpr (std::is_same_v<T, float>) {
+        const __m256 identity = _mm256_set1_ps(static_cast<float>(Op::kIdentity));
+        __m256 running = _mm256_set1_ps(carry);
+        for (; i + 8 <= count; i += 8) {
+            const __m256 v = Op::apply(lane_scan<Op>(_mm256_loadu_ps(in + i), identity), running);
+            _mm256_storeu_ps(out + i, v);
+            const __m256 last = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+            running = _mm256_permute2f128_ps(last, last, 0x11);
+        }
+        carry = _mm256_cvtss_f32(running);
+    }
+#endif
+    for (; i < count; ++i) {
+        carry = Op::apply(carry, in[i]);
+        out[i] = carry;
+    }
+    return carry;
+}
+
+template <typename Op, typename T>
+T reduce_contiguous(const T* in, std::size_t count) {
+    T total = static_cast<T>(Op::kIdentity);
+    for (std::size_t i = 0; i < count; ++i) {
+        total = Op::apply(total, in[i]);
+    }
+    return total;
+}
+
+// Inclusive scan of one contiguous line with all threads (reduce-then-scan).
+template <typename Op, typename T>
+void scan_line_parallel(const T* in, T* out, std::size_t count, unsigned threads) {
+    std::size_t chunk = (count + threads - 1) / threads;
+    chunk = (chunk + kChunkAlign - 1) / kChunkAlign * kChunkAlign;
+    const std::size_t chunks = (count + chunk - 1) / chunk;
+    std::vector<T> carry_in(chunks, static_cast<T>(Op::kIdentity));
+    parallel_for(chunks, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            carry_in[c] = reduce_contiguous<Op>(in + c * chunk, std::min(chunk, count - c * chunk));
+        }
+    });
+    T running = static_cast<T>(Op::kIdentity);  // exclusive scan of the chunk totals
+    for (auto& value : carry_in) {
+        const T total = value;
+        value = running;
+        running = Op::apply(running, total);
+    }
+    parallel_for(chunks, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            scan_contiguous<Op>(in + c * chunk, out + c * chunk, std::min(chunk, count - c * chunk), carry_in[c]);
+        }
+    });
+}
+
+}  // namespace detail
+
+// Scan axis 1 of a contiguous [outer, length, inner] tensor. `exclusive` shifts the
+// result by one along the axis and starts each line at the identity.
+template <typename Op, typename T>
+void scan_axis(const T* in, T* out, std::size_t outer, std::size_t length, std::size_t inner, bool exclusive,
+               unsigned threads) {
+    if (length == 0) {
+        return;
+    }
+    const T identity = static_cast<T>(Op::kIdentity);
+    // An exclusive scan is the inclusive scan of x[0 : length - 1] written to out[1 : length].
+    const std::size_t span = exclusive ? length - 1 : length;
+    const std::size_t shift = exclusive ? inner : 0;
+    if (inner == 1) {
+        if (outer < threads && span >= threads * kChunkAlign) {
+            for (std::size_t line = 0; line < outer; ++line) {
+                out[line * length] = identity;  // overwritten unless exclusive
+                detail::scan_line_parallel<Op>(in + line * length, out + line * length + shift, span, threads);
+            }
+            return;
+        }
+        parallel_for(outer, threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t line = begin; line < end; ++line) {
+                out[line * length] = identity;
+                detail::scan_contiguous<Op>(in + line * length, out + line * length + shift, span, identity);
+            }
+        });
+        return;
+    }
+    constexpr std::size_t kColumns = 256;
+    const std::size_t blocks = (inner + kColumns - 1) / kColumns;
+    parallel_for(outer * blocks, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t task = begin; task < end; ++task) {
+            const std::size_t base = (task / blocks) * length * inner;
+            const std::size_t first = (task % blocks) * kColumns;
+            const std::size_t last = std::min(inner, first + kColumns);
+            const T* src = in + base;
+            T* dst = out + base;
+            std::fill(dst + first, dst + last, identity);
+            if (span > 0) {
+                std::copy(src + first, src + last, dst + shift + first);
+            }
+            for (std::size_t i = 1; i < span; ++i) {
+                const T* x = src + i * inner;
+                const T* prev = dst + shift + (i - 1) * inner;
+                T* row = dst + shift + i * inner;
+                for (std::size_t j = first; j < last; ++j) {
+                    row[j] = Op::apply(prev[j], x[j]);
+                }
+            }
+        }
+    });
+}
+
+}  // namespace scan
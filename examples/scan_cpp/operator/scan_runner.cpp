@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "optest/tensor_file.h"
+#include "scan_kernel.h"
+
+namespace {
+
+struct Options {
+    std::string op = "cumsum";
+    std::string dtype = "float32";
+    std::string input0;
+    std::string output0;
+    std::string shapes_json;
+    std::string params_json;
+    std::string format = "raw";
+    unsigned threads = 0;
+    int iterations = 1;
+};
+
+Options parse_args(int argc, char** argv) {
+    Options opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--op" && i + 1 < argc) {
+            opt.op = argv[++i];
+        } else if (arg == "--dtype" && i + 1 < argc) {
+            opt.dtype = argv[++i];
+        } else if (arg == "--input0" && i + 1 < argc) {
+            opt.input0 = argv[++i];
+        } else if (arg == "--output0" && i + 1 < argc) {
+            opt.output0 = argv[++i];
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            opt.shapes_json = argv[++i];
+        } else if (arg == "--params" && i + 1 < argc) {
+            opt.params_json = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.iterations = std::stoi(argv[++i]);
+        }
+    }
+    if (opt.input0.empty() || opt.output0.empty() || opt.shapes_json.empty()) {
+        throw std::runtime_error("--input0, --output0 and --shapes are required");
+    }
+    if (opt.iterations < 1) {
+        throw std::runtime_error("--iterations must be positive");
+    }
+    if (opt.threads == 0) {
+        opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // `--op {assertion}` passes e.g. "builtin.cumprod".
+    const auto dot = opt.op.rfind('.');
+    if (dot != std::string::npos) {
+        opt.op = opt.op.substr(dot + 1);
+    }
+    return opt;
+}
+
+// Innermost integer lists of the `{shapes}` JSON, in order: inputs first, then outputs.
+std::vector<std::vector<int64_t>> parse_shape_lists(const std::string& text) {
+    std::vector<std::vector<int64_t>> lists;
+    std::vector<int64_t> current;
+    bool in_list = false;
+    int64_t value = 0;
+    bool in_number = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            in_number = true;
+            continue;
+        }
+        if (in_number) {
+            current.push_back(value);
+            value = 0;
+            in_number = false;
+        }
+        if (c == '[') {
+            current.clear();
+            in_list = true;
+        } else if (c == ']' && in_list) {
+            lists.push_back(current);
+            in_list = false;
+        }
+    }
+    return lists;
+}
+
+// Text after `"key":` in the flat `{params}` JSON, or empty when the key is absent.
+std::string param_value(const std::string& params, const std::string& key) {
+    const auto at = params.find("\"" + key + "\"");
+    if (at == std::string::npos) {
+        return {};
+    }
+    auto begin = params.find(':', at);
+    begin = params.find_first_not_of(" ", begin + 1);
+    return params.substr(begin, params.find_first_of(",}", begin) - begin);
+}
+
+template <typename F>
+double time_ms(int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < iterations; ++iter) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+template <typename T>
+void run(const Options& opts, const std::vector<int64_t>& shape) {
+    const auto rank = static_cast<int64_t>(shape.size());
+    const std::string axis_text = param_value(opts.params_json, "axis");
+    int64_t axis = axis_text.empty() || axis_text == "null" ? -1 : std::stoll(axis_text);
+    axis += axis < 0 ? rank : 0;
+    if (axis < 0 || axis >= rank) {
+        throw std::runtime_error("axis out of range");
+    }
+    const bool exclusive = param_value(opts.params_json, "exclusive") == "true";
+    std::size_t outer = 1;
+    std::size_t inner = 1;
+    for (int64_t d = 0; d < axis; ++d) {
+        outer *= static_cast<std::size_t>(shape[d]);
+    }
+    for (int64_t d = axis + 1; d < rank; ++d) {
+        inner *= static_cast<std::size_t>(shape[d]);
+    }
+    const auto length = static_cast<std::size_t>(shape[axis]);
+    optest::TensorMap<T> input(opts.input0, shape);
+    if (!input.contiguous()) {
+        throw std::runtime_error("input must be contiguous");
+    }
+    std::vector<T> out(input.size());
+    double per_call_ms = 0.0;
+    if (opts.op == "cumsum") {
+        per_call_ms = time_ms(opts.iterations, [&] {
+            scan::scan_axis<scan::Add>(input.data(), out.data(), outer, length, inner, exclusive, opts.threads);
+        });
+    } else if (opts.op == "cumprod") {
+        per_call_ms = time_ms(opts.iterations, [&] {
+            scan::scan_axis<scan::Mul>(input.data(), out.data(), outer, length, inner, exclusive, opts.threads);
+        });
+    } else {
+        throw std::runtime_error("unsupported --op " + opts.op);
+    }
+    const double bytes = 2.0 * static_cast<double>(input.size() * sizeof(T));  // read + write
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << per_call_ms << " scan_gbps=" << bytes / 1e9 / (per_call_ms / 1e3)
+              << " threads=" << opts.threads << std::endl;
+    optest::write_tensor<T>(opts.output0, out.data(), shape, opts.format == "optt");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opts = parse_args(argc, argv);
+        const auto shapes = parse_shape_lists(opts.shapes_json);
+        if (shapes.size() != 2 || shapes[0] != shapes[1]) {
+            throw std::runtime_error("expected one input and one output of the same shape");
+        }
+        if (opts.dtype == "float32") {
+            run<float>(opts, shapes[0]);
+        } else if (opts.dtype == "float64") {
+            run<double>(opts, shapes[0]);
+        } else if (opts.dtype == "int32") {
+            run<int32_t>(opts, shapes[0]);
+        } else if (opts.dtype == "int64") {
+            run<int64_t>(opts, shapes[0]);
+        } else {
+            throw std::runtime_error("unsupported dtype: " + opts.dtype);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "scan_runner failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// LSD radix sort of 32-bit keys (optionally carrying a 32-bit index payload).
+//
+// Keys are mapped to unsigned integers whose order is the IEEE total order for
+// floats (-NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN) and the usual order for
+// signed integers; descending sorts complement the key. Four 8-bit passes move
+// the data; LSD passes are stable, so descending sorts keep equal keys in input
+// order. One read of the input builds the histograms of all four digits, and a
+// pass is skipped when every key shares its digit (narrow value ranges, small
+// integers). With several threads each one histograms its own chunk (again before
+// each pass once keys have moved); an exclusive scan over (bucket, thread) gives
+// every thread private, ordered write cursors, so the scatter is parallel and
+// still stable.
+
+namespace radix {
+
+constexpr int kDigits = 4;
+constexpr std::size_t kBuckets = 256;
+constexpr std::size_t kMinPerThread = std::size_t{1} << 16;  // below this, thread start-up dominates
+
+using Histogram = std::array<std::array<std::size_t, kBuckets>, kDigits>;
+
+template <typename T>
+inline uint32_t encode(T value, bool descending) {
+    static_assert(sizeof(T) == 4, "32-bit keys only");
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if constexpr (std::is_floating_point_v<T>) {
+        bits ^= (bits >> 31) != 0 ? 0xFFFFFFFFu : 0x80000000u;
+    } else {
+        bits ^= 0x80000000u;
+    }
+    return descending ? ~bits : bits;
+}
+
+template <typename T>
+inline T decode(uint32_t key, bool descending) {
+    uint32_t bits = descending ? ~key : key;
+    if constexpr (std::is_floating_point_v<T>) {
+        bits ^= (bits >> 31) != 0 ? 0x80000000u : 0xFFFFFFFFu;
+    } else {
+        bits ^= 0x80000000u;
+    }
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template <typename F>
+void parallel_for(std::size_t count, unsigned threads, F&& body) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<std::size_t>(count, 1))));
+    if (threads == 1) {
+        body(std::size_t{0}, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    const std::size_t chunk = (count + threads - 1) / threads;
+    for (std::size_t begin = 0; begin < count; begin += chunk) {
+        pool.emplace_back(body, begin, std::min(count, begin + chunk));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// Sorts keys[0, n) (and idx alongside when non-null); tmp buffers hold n elements each.
+inline void sort_keys(uint32_t* keys, uint32_t* idx, uint32_t* keys_tmp, uint32_t* idx_tmp, std::size_t n,
+                      unsigned threads) {
+    uint32_t* const sorted_keys = keys;
+    uint32_t* const sorted_idx = idx;
+    threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, n / kMinPerThread)));
+    const std::size_t chunk = (n + threads - 1) / threads;
+    std::vector<Histogram> hist(threads);
+    parallel_for(threads, threads, [&](std::size_t first, std::size_t last) {
+        for (std::size_t t = first; t < last; ++t) {
+            Histogram& h = hist[t];
+            for (auto& digit : h) {
+                digit.fill(0);
+            }
+            const std::size_t end = std::min(n, (t + 1) * chunk);
+            for (std::size_t i = t * chunk; i < end; ++i) {
+                const uint32_t key = keys[i];
+                ++h[0][key & 0xFF];
+                ++h[1][(key >> 8) & 0xFF];
+                ++h[2][(key >> 16) & 0xFF];
+                ++h[3][key >> 24];
+            }
+        }
+    });
+    std::vector<std::array<std::size_t, kBuckets>> cursors(threads);
+    bool moved = false;
+    for (int digit = 0; digit < kDigits; ++digit) {
+        const int shift = 8 * digit;
+        bool trivial = false;
+        for (std::size_t bucket = 0; bucket < kBuckets && !trivial; ++bucket) {
+            std::size_t total = 0;
+            for (unsigned t = 0; t < threads; ++t) {
+                total += hist[t][digit][bucket];
+            }
+            trivial = total == n;
+        }
+        if (trivial) {
+            continue;  // every key has the same digit: the pass would not move anything
+        }
+        if (moved && threads > 1) {
+            // Earlier passes moved keys between chunks: the per-chunk counts of this digit changed
+            // (the totals, and so the skip test above, did not).
+            parallel_for(threads, threads, [&](std::size_t first, std::size_t last) {
+                for (std::size_t t = first; t < last; ++t) {
+                    auto& h = hist[t][digit];
+                    h.fill(0);
+                    const std::size_t end = std::min(n, (t + 1) * chunk);
+                    for (std::size_t i = t * chunk; i < end; ++i) {
+                        ++h[(keys[i] >> shift) & 0xFF];
+                    }
+                }
+            });
+        }
+        std::size_t offset = 0;
+        for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+            for (unsigned t = 0; t < threads; ++t) {
+                cursors[t][bucket] = offset;
+                offset += hist[t][digit][bucket];
+            }
+        }
+        parallel_for(threads, threads, [&](std::size_t first, std::size_t last) {
+            for (std::size_t t = first; t < last; ++t) {
+                auto& cursor = cursors[t];
+                const std::size_t end = std::min(n, (t + 1) * chunk);
+                for (std::size_t i = t * chunk; i < end; ++i) {
+                    const std::size_t to = cursor[(keys[i] >> shift) & 0xFF]++;
+                    keys_tmp[to] = keys[i];
+                    if (idx != nullptr) {
+                        idx_tmp[to] = idx[i];
+                    }
+                }
+            }
+        });
+        std::swap(keys, keys_tmp);
+        std::swap(idx, idx_tmp);
+        moved = true;
+    }
+    if (keys != sorted_keys) {
+        // An odd number of executed passes left the result in the tmp buffers.
+        parallel_for(n, threads, [&](std::size_t first, std::size_t last) {
+            std::memcpy(sorted_keys + first, keys + first, (last - first) * sizeof(uint32_t));
+            if (idx != nullptr) {
+                std::memcpy(sorted_idx + first, idx + first, (last - first) * sizeof(uint32_t));
+            }
+        });
+    }
+}
+
+}  // namespace radix
@@ -0,0 +1,217 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "optest/tensor_file.h"
+#include "radix_kernel.h"
+
+namespace {
+
+struct Options {
+    std::string op = "sort";
+    std::string dtype = "float32";
+    std::string input0;
+    std::string output0;
+    std::string shapes_json;
+    std::string params_json;
+    std::string format = "raw";
+    unsigned threads = 0;
+    int iterations = 1;
+};
+
+Options parse_args(int argc, char** argv) {
+    Options opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--op" && i + 1 < argc) {
+            opt.op = argv[++i];
+        } else if (arg == "--dtype" && i + 1 < argc) {
+            opt.dtype = argv[++i];
+        } else if (arg == "--input0" && i + 1 < argc) {
+            opt.input0 = argv[++i];
+        } else if (arg == "--output0" && i + 1 < argc) {
+            opt.output0 = argv[++i];
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            opt.shapes_json = argv[++i];
+        } else if (arg == "--params" && i + 1 < argc) {
+            opt.params_json = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.iterations = std::stoi(argv[++i]);
+        }
+    }
+    if (opt.input0.empty() || opt.output0.empty() || opt.shapes_json.empty()) {
+        throw std::runtime_error("--input0, --output0 and --shapes are required");
+    }
+    if (opt.iterations < 1) {
+        throw std::runtime_error("--iterations must be positive");
+    }
+    if (opt.threads == 0) {
+        opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // `--op {assertion}` passes e.g. "builtin.argsort".
+    const auto dot = opt.op.rfind('.');
+    if (dot != std::string::npos) {
+        opt.op = opt.op.substr(dot + 1);
+    }
+    return opt;
+}
+
+// Innermost integer lists of the `{shapes}` JSON, in order: inputs first, then outputs.
+std::vector<std::vector<int64_t>> parse_shape_lists(const std::string& text) {
+    std::vector<std::vector<int64_t>> lists;
+    std::vector<int64_t> current;
+    bool in_list = false;
+    int64_t value = 0;
+    bool in_number = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            in_number = true;
+            continue;
+        }
+        if (in_number) {
+            current.push_back(value);
+            value = 0;
+            in_number = false;
+        }
+        if (c == '[') {
+            current.clear();
+            in_list = true;
+        } else if (c == ']' && in_list) {
+            lists.push_back(current);
+            in_list = false;
+        }
+    }
+    return lists;
+}
+
+// Text after `"key":` in the flat `{params}` JSON, or empty when the key is absent.
+std::string param_value(const std::string& params, const std::string& key) {
+    const auto at = params.find("\"" + key + "\"");
+    if (at == std::string::npos) {
+        return {};
+    }
+    auto begin = params.find(':', at);
+    begin = params.find_first_not_of(" ", begin + 1);
+    return params.substr(begin, params.find_first_of(",}", begin) - begin);
+}
+
+template <typename F>
+double time_ms(int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < iterations; ++iter) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// Scratch for sorting `width`-element rows; one slot per concurrently sorted row.
+struct Buffers {
+    std::vector<uint32_t> keys, idx, keys_tmp, idx_tmp;
+
+    Buffers(std::size_t elements, bool with_index)
+        : keys(elements), idx(with_index ? elements : 0), keys_tmp(elements), idx_tmp(with_index ? elements : 0) {}
+};
+
+template <typename T>
+void run(const Options& opts, const std::vector<int64_t>& shape, const std::vector<int64_t>& out_shape) {
+    const std::string axis = param_value(opts.params_json, "axis");
+    if (!axis.empty() && axis != "-1" && axis != "null" && std::stoll(axis) != static_cast<int64_t>(shape.size()) - 1) {
+        throw std::runtime_error("the runner sorts along the last axis only");
+    }
+    const bool descending = param_value(opts.params_json, "descending") == "true";
+    const bool with_index = opts.op == "argsort";
+    if (!with_index && opts.op != "sort") {
+        throw std::runtime_error("unsupported --op " + opts.op);
+    }
+    optest::TensorMap<T> input(opts.input0, shape);
+    if (!input.contiguous()) {
+        throw std::runtime_error("input must be contiguous");
+    }
+    const std::size_t width = shape.empty() ? 1 : static_cast<std::size_t>(shape.back());
+    const std::size_t rows = width == 0 ? 0 : input.size() / width;
+    // Many rows: one row per thread at a time. Few long rows: every thread works on each row.
+    const bool row_parallel = rows >= opts.threads || width < radix::kMinPerThread;
+    const unsigned slots =
+        row_parallel ? static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(opts.threads, rows))) : 1;
+    const unsigned inner_threads = row_parallel ? 1 : opts.threads;
+    Buffers buffers(slots * width, with_index);
+    std::vector<T> values(with_index ? 0 : input.size());
+    std::vector<int64_t> indices(with_index ? input.size() : 0);
+    auto sort_row = [&](std::size_t row, unsigned slot) {
+        const T* src = input.data() + row * width;
+        uint32_t* keys = buffers.keys.data() + slot * width;
+        uint32_t* idx = with_index ? buffers.idx.data() + slot * width : nullptr;
+        for (std::size_t i = 0; i < width; ++i) {
+            keys[i] = radix::encode(src[i], descending);
+        }
+        if (idx != nullptr) {
+            std::iota(idx, idx + width, uint32_t{0});
+        }
+        radix::sort_keys(keys, idx, buffers.keys_tmp.data() + slot * width,
+                         with_index ? buffers.idx_tmp.data() + slot * width : nullptr, width, inner_threads);
+        if (with_index) {
+            std::copy(idx, idx + width, indices.begin() + row * width);
+        } else {
+            for (std::size_t i = 0; i < width; ++i) {
+                values[row * width + i] = radix::decode<T>(keys[i], descending);
+            }
+        }
+    };
+    const double per_call_ms = time_ms(opts.iterations, [&] {
+        if (!row_parallel) {
+            for (std::size_t row = 0; row < rows; ++row) {
+                sort_row(row, 0);
+            }
+            return;
+        }
+        radix::parallel_for(rows, slots, [&](std::size_t begin, std::size_t end) {
+            const auto slot = static_cast<unsigned>(begin / ((rows + slots - 1) / slots));
+            for (std::size_t row = begin; row < end; ++row) {
+                sort_row(row, slot);
+            }
+        });
+    });
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << per_call_ms
+              << " mkeys_per_s=" << static_cast<double>(input.size()) / 1e3 / per_call_ms
+              << " threads=" << opts.threads << std::endl;
+    if (with_index) {
+        optest::write_tensor<int64_t>(opts.output0, indices.data(), out_shape, opts.format == "optt");
+    } else {
+        optest::write_tensor<T>(opts.output0, values.data(), out_shape, opts.format == "optt");
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opts = parse_args(argc, argv);
+        const auto shapes = parse_shape_lists(opts.shapes_json);
+        if (shapes.size() != 2 || shapes[0] != shapes[1]) {
+            throw std::runtime_error("expected one input and one output of the same shape");
+        }
+        if (opts.dtype == "float32") {
+            run<float>(opts, shapes[0], shapes[1]);
+        } else if (opts.dtype == "int32") {
+            run<int32_t>(opts, shapes[0], shapes[1]);
+        } else {
+            throw std::runtime_error("unsupported dtype (32-bit keys only): " + opts.dtype);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "sort_runner failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
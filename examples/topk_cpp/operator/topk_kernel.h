@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Row-wise top-k selection.
+//
+// Each row keeps a bounded heap of its k best candidates whose front is the
+// current worst. Most elements of a long row cannot enter the heap, so the row
+// is scanned in fixed-size blocks first: a branch-free count of elements that
+// beat the heap threshold vectorizes, and only blocks with hits fall back to
+// the scalar heap update. Rows are independent and split across threads.
+//
+// Results are ordered best first; equal values are ordered by index, and an
+// element equal to the current threshold never displaces an earlier one.
+
+namespace topk {
+
+constexpr std::size_t kFilterBlock = 16;
+
+template <typename T>
+struct Candidate {
+    T value;
+    int64_t index;
+};
+
+template <bool Largest, typename T>
+inline bool beats(T a, T b) {
+    return Largest ? a > b : a < b;
+}
+
+// True when `a` ranks before `b`.
+template <bool Largest, typename T>
+inline bool ranks_before(const Candidate<T>& a, const Candidate<T>& b) {
+    if (a.value != b.value) {
+        return beats<Largest>(a.value, b.value);
+    }
+    return a.index < b.index;
+}
+
+template <bool Largest, typename T>
+void select_row(const T* row, std::size_t n, std::size_t k, T* values, int64_t* indices,
+                std::vector<Candidate<T>>& heap) {
+    // With ranks_before as "less", the heap front is the candidate ranking last.
+    const auto order = [](const Candidate<T>& a, const Candidate<T>& b) { return ranks_before<Largest>(a, b); };
+    heap.clear();
+    for (std::size_t i = 0; i < k; ++i) {
+        heap.push_back({row[i], static_cast<int64_t>(i)});
+    }
+    std::make_heap(heap.begin(), heap.end(), order);
+    std::size_t i = k;
+    while (i < n) {
+        const std::size_t end = std::min(n, i + kFilterBlock);
+        const T threshold = heap.front().value;
+        if (end - i == kFilterBlock) {
+            int hits = 0;
+            for (std::size_t j = 0; j < kFilterBlock; ++j) {
+                hits += beats<Largest>(row[i + j], threshold) ? 1 : 0;
+            }
+            if (hits == 0) {
+                i = end;
+                continue;
+            }
+        }
+        for (; i < end; ++i) {
+            if (beats<Largest>(row[i], heap.front().value)) {
+                std::pop_heap(heap.begin(), heap.end(), order);
+                heap.back() = {row[i], static_cast<int64_t>(i)};
+                std::push_heap(heap.begin(), heap.end(), order);
+            }
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), order);
+    for (std::size_t j = 0; j < k; ++j) {
+        if (values != nullptr) {
+            values[j] = heap[j].value;
+        }
+        indices[j] = heap[j].index;
+    }
+}
+
+// Top-k over the last axis of a (rows x n) matrix. `values` may be null (argmax/argmin).
+template <typename T>
+void topk_rows(const T* data, std::size_t rows, std::size_t n, std::size_t k, bool largest, T* values,
+               int64_t* indices, unsigned threads) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(rows)));
+    const auto work = [&](std::size_t begin, std::size_t end) {
+        std::vector<Candidate<T>> heap;
+        heap.reserve(k);
+        for (std::size_t r = begin; r < end; ++r) {
+            T* row_values = values != nullptr ? values + r * k : nullptr;
+            if (largest) {
+                select_row<true>(data + r * n, n, k, row_values, indices + r * k, heap);
+            } else {
+                select_row<false>(data + r * n, n, k, row_values, indices + r * k, heap);
+            }
+        }
+    };
+    if (threads == 1) {
+        work(0, rows);
+        return;
+    }
+    std::vector<std::thread> pool;
+    const std::size_t chunk = (rows + threads - 1) / threads;
+    for (std::size_t begin = 0; begin < rows; begin += chunk) {
+        pool.emplace_back(work, begin, std::min(rows, begin + chunk));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+}  // namespace topk
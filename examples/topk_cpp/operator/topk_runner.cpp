@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "optest/tensor_file.h"
+#include "topk_kernel.h"
+
+namespace {
+
+struct Options {
+    std::string op = "auto";
+    std::string dtype = "float32";
+    std::string input0;
+    std::string outputs;
+    std::string shapes_json;
+    std::string format = "raw";
+    unsigned threads = 0;
+    int iterations = 1;
+};
+
+Options parse_args(int argc, char** argv) {
+    Options opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--op" && i + 1 < argc) {
+            opt.op = argv[++i];
+        } else if (arg == "--dtype" && i + 1 < argc) {
+            opt.dtype = argv[++i];
+        } else if (arg == "--input0" && i + 1 < argc) {
+            opt.input0 = argv[++i];
+        } else if (arg == "--outputs" && i + 1 < argc) {
+            opt.outputs = argv[++i];
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            opt.shapes_json = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.iterations = std::stoi(argv[++i]);
+        }
+    }
+    if (opt.input0.empty() || opt.outputs.empty() || opt.shapes_json.empty()) {
+        throw std::runtime_error("--input0, --outputs and --shapes are required");
+    }
+    if (opt.iterations < 1) {
+        throw std::runtime_error("--iterations must be positive");
+    }
+    if (opt.threads == 0) {
+        opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return opt;
+}
+
+std::vector<std::string> split_paths(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        parts.push_back(item);
+    }
+    return parts;
+}
+
+// Innermost integer lists of the `{shapes}` JSON, in order: inputs first, then outputs.
+std::vector<std::vector<int64_t>> parse_shape_lists(const std::string& text) {
+    std::vector<std::vector<int64_t>> lists;
+    std::vector<int64_t> current;
+    bool in_list = false;
+    int64_t value = 0;
+    bool in_number = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            in_number = true;
+            continue;
+        }
+        if (in_number) {
+            current.push_back(value);
+            value = 0;
+            in_number = false;
+        }
+        if (c == '[') {
+            current.clear();
+            in_list = true;
+        } else if (c == ']' && in_list) {
+            lists.push_back(current);
+            in_list = false;
+        }
+    }
+    return lists;
+}
+
+template <typename T>
+void run_topk(const Options& opts, const std::vector<int64_t>& in_shape, const std::vector<int64_t>& out_shape,
+              const std::vector<std::string>& outputs, bool largest) {
+    optest::TensorMap<T> input(opts.input0, in_shape);
+    if (!input.contiguous()) {
+        throw std::runtime_error("input must be contiguous");
+    }
+    const auto n = static_cast<std::size_t>(in_shape.back());
+    const std::size_t rows = n == 0 ? 0 : input.size() / n;
+    const bool with_values = outputs.size() == 2;
+    // topk outputs keep the rank ([..., k]); argmax/argmin drop the axis unless keepdims.
+    const auto k = static_cast<std::size_t>(
+        with_values || out_shape.size() == in_shape.size() ? (out_shape.empty() ? 1 : out_shape.back()) : 1);
+    if (k == 0 || k > n) {
+        throw std::runtime_error("k must be within [1, " + std::to_string(n) + "]");
+    }
+    std::vector<T> values(with_values ? rows * k : 0);
+    std::vector<int64_t> indices(rows * k);
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < opts.iterations; ++iter) {
+        topk::topk_rows<T>(input.data(), rows, n, k, largest, with_values ? values.data() : nullptr, indices.data(),
+                           opts.threads);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    const double per_call_ms = elapsed.count() / opts.iterations;
+    const double scanned_gb = static_cast<double>(rows * n * sizeof(T)) / 1e9;
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << per_call_ms << " scan_gbps=" << scanned_gb / (per_call_ms / 1e3)
+              << " threads=" << opts.threads << std::endl;
+    const bool container = opts.format == "optt";
+    if (with_values) {
+        optest::write_tensor<T>(outputs[0], values.data(), out_shape, container);
+    }
+    optest::write_tensor<int64_t>(outputs.back(), indices.data(), out_shape, container);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opts = parse_args(argc, argv);
+        const auto outputs = split_paths(opts.outputs);
+        const auto shapes = parse_shape_lists(opts.shapes_json);
+        if (outputs.empty() || outputs.size() > 2 || shapes.size() != 1 + outputs.size()) {
+            throw std::runtime_error("expected one input and 1 (indices) or 2 (values, indices) outputs");
+        }
+        std::string op = opts.op;
+        if (op == "auto") {
+            op = outputs.size() == 2 ? "topk" : "argmax";
+        }
+        if ((op == "topk") != (outputs.size() == 2) || (op != "topk" && op != "argmax" && op != "argmin")) {
+            throw std::runtime_error("--op " + op + " does not match " + std::to_string(outputs.size()) + " outputs");
+        }
+        const bool largest = op != "argmin";
+        if (shapes[0].empty()) {
+            throw std::runtime_error("input must have at least one dim");
+        }
+        if (opts.dtype == "float32") {
+            run_topk<float>(opts, shapes[0], shapes.back(), outputs, largest);
+        } else if (opts.dtype == "int32") {
+            run_topk<int32_t>(opts, shapes[0], shapes.back(), outputs, largest);
+        } else {
+            throw std::runtime_error("unsupported dtype: " + opts.dtype);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "topk_runner failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
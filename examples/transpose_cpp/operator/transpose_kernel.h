@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// N-D permute (transpose) kernels: pure memory movement.
+//
+// A permutation is first simplified: unit dims are dropped and output dims that
+// stay adjacent in the input are merged, so e.g. [0, 2, 1, 3] on a 4-D tensor
+// becomes a batched 2-D transpose of (d2 x d1) blocks of d3-element rows. If the
+// innermost output dim is also innermost in the input, the permute is a set of
+// contiguous row copies. Otherwise it is a batch of 2-D transposes between the
+// input's innermost dim and the output's innermost dim: each is tiled with a
+// cache-oblivious recursive split (halve the longer side until the tile fits in
+// L1), and leaf tiles use 8x8 (AVX) or 4x4 (SSE) in-register transposes for
+// 4-byte elements. Batches x row-blocks are split across std::threads.
+
+namespace transpose {
+
+constexpr std::size_t kLeaf = 64;       // leaf tile edge: 2 * 64 * 64 * 4 B = 32 KiB fits a typical L1d
+constexpr std::size_t kTaskRows = 256;  // input-contiguous extent per thread task
+
+struct Permutation {
+    std::vector<std::size_t> shape;       // simplified output dims
+    std::vector<std::size_t> in_strides;  // input stride (elements) of each output dim
+};
+
+inline Permutation simplify(const std::vector<int64_t>& in_shape, const std::vector<int64_t>& perm) {
+    const std::size_t rank = in_shape.size();
+    if (perm.size() != rank) {
+        throw std::runtime_error("perm rank does not match the input rank");
+    }
+    std::vector<std::size_t> strides(rank, 1);
+    for (std::size_t i = rank; i-- > 1;) {
+        strides[i - 1] = strides[i] * static_cast<std::size_t>(in_shape[i]);
+    }
+    std::vector<bool> seen(rank, false);
+    Permutation out;
+    for (int64_t axis : perm) {
+        if (axis < 0 || static_cast<std::size_t>(axis) >= rank || seen[axis]) {
+            throw std::runtime_error("perm is not a permutation of the input axes");
+        }
+        seen[axis] = true;
+        const auto extent = static_cast<std::size_t>(in_shape[axis]);
+        if (extent == 1) {
+            continue;
+        }
+        if (!out.shape.empty() && out.in_strides.back() == strides[axis] * extent) {
+            out.shape.back() *= extent;  // adjacent in both tensors
+            out.in_strides.back() = strides[axis];
+        } else {
+            out.shape.push_back(extent);
+            out.in_strides.push_back(strides[axis]);
+        }
+    }
+    return out;
+}
+
+template <typename F>
+void parallel_for(std::size_t count, unsigned threads, F&& body) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<std::size_t>(count, 1))));
+    if (threads == 1) {
+        body(std::size_t{0}, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    const std::size_t chunk = (count + threads - 1) / threads;
+    for (std::size_t begin = 0; begin < count; begin += chunk) {
+        pool.emplace_back(body, begin, std::min(count, begin + chunk));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// Parallel memcpy: the reference bandwidth a permute is measured against.
+inline void parallel_copy(const void* src, void* dst, std::size_t bytes, unsigned threads) {
+    constexpr std::size_t kBlock = 1 << 16;
+    parallel_for((bytes + kBlock - 1) / kBlock, threads, [&](std::size_t begin, std::size_t end) {
+        const std::size_t first = begin * kBlock;
+        const std::size_t last = std::min(bytes, end * kBlock);
+        std::memcpy(static_cast<char*>(dst) + first, static_cast<const char*>(src) + first, last - first);
+    });
+}
+
+namespace detail {
+
+// out[r * out_ld + c] = in[c * in_ld + r] for r < rows, c < cols.
+template <typename T>
+inline void scalar_tile(const T* in, std::size_t in_ld, T* out, std::size_t out_ld, std::size_t rows,
+                        std::size_t cols) {
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            out[r * out_ld + c] = in[c * in_ld + r];
+        }
+    }
+}
+
+#if defined(__AVX__)
+constexpr std::size_t kMicro = 8;
+
+inline void micro_tile(const float* in, std::size_t in_ld, float* out, std::size_t out_ld) {
+    __m256 r0 = _mm256_loadu_ps(in + 0 * in_ld), r1 = _mm256_loadu_ps(in + 1 * in_ld);
+    __m256 r2 = _mm256_loadu_ps(in + 2 * in_ld), r3 = _mm256_loadu_ps(in + 3 * in_ld);
+    __m256 r4 = _mm256_loadu_ps(in + 4 * in_ld), r5 = _mm256_loadu_ps(in + 5 * in_ld);
+    __m256 r6 = _mm256_loadu_ps(in + 6 * in_ld), r7 = _mm256_loadu_ps(in + 7 * in_ld);
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+    r0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    r1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    r2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    r3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    r4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    r5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    r6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    r7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+    _mm256_storeu_ps(out + 0 * out_ld, _mm256_permute2f128_ps(r0, r4, 0x20));
+    _mm256_storeu_ps(out + 1 * out_ld, _mm256_permute2f128_ps(r1, r5, 0x20));
+    _mm256_storeu_ps(out + 2 * out_ld, _mm256_permute2f128_ps(r2, r6, 0x20));
+    _mm256_storeu_ps(out + 3 * out_ld, _mm256_permute2f128_ps(r3, r7, 0x20));
+    _mm256_storeu_ps(out + 4 * out_ld, _mm256_permute2f128_ps(r0, r4, 0x31));
+    _mm256_storeu_ps(out + 5 * out_ld, _mm256_permute2f128_ps(r1, r5, 0x31));
+    _mm256_storeu_ps(out + 6 * out_ld, _mm256_permute2f128_ps(r2, r6, 0x31));
+    _mm256_storeu_ps(out + 7 * out_ld, _mm256_permute2f128_ps(r3, r7, 0x31));
+}
+#elif defined(__SSE__)
+constexpr std::size_t kMicro = 4;
+
+inline void micro_tile(const float* in, std::size_t in_ld, float* out, std::size_t out_ld) {
+    __m128 r0 = _mm_loadu_ps(in), r1 = _mm_loadu_ps(in + in_ld);
+    __m128 r2 = _mm_loadu_ps(in + 2 * in_ld), r3 = _mm_loadu_ps(in + 3 * in_ld);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + out_ld, r1);
+    _mm_storeu_ps(out + 2 * out_ld, r2);
+    _mm_storeu_ps(out + 3 * out_ld, r3);
+}
+#else
+constexpr std::size_t kMicro = 0;
+#endif
+
+template <typename T>
+inline void leaf_tile(const T* in, std::size_t in_ld, T* out, std::size_t out_ld, std::size_t rows,
+                      std::size_t cols) {
+#if defined(__AVX__) || defined(__SSE__)
+    if constexpr (sizeof(T) == sizeof(float)) {
+        // Bit-exact for any 4-byte type: the shuffles only move lanes.
+        const auto* src = reinterpret_cast<const float*>(in);
+        auto* dst = reinterpret_cast<float*>(out);
+        const std::size_t full_rows = rows - rows % kMicro;
+        const std::size_t full_cols = cols - cols % kMicro;
+        for (std::size_t r = 0; r < full_rows; r += kMicro) {
+            for (std::size_t c = 0; c < full_cols; c += kMicro) {
+                micro_tile(src + c * in_ld + r, in_ld, dst + r * out_ld + c, out_ld);
+            }
+        }
+        scalar_tile(in + full_cols * in_ld, in_ld, out + full_cols, out_ld, full_rows, cols - full_cols);
+        scalar_tile(in + full_rows, in_ld, out + full_rows * out_ld, out_ld, rows - full_rows, cols);
+        return;
+    }
+#endif
+    scalar_tile(in, in_ld, out, out_ld, rows, cols);
+}
+
+// Split point on a multiple of 8, so only the outermost tiles have scalar edges.
+inline std::size_t split(std::size_t extent) {
+    return std::max<std::size_t>(8, extent / 2 / 8 * 8);
+}
+
+// Cache-oblivious: split the longer side until the tile is a leaf.
+template <typename T>
+void recursive_tile(const T* in, std::size_t in_ld, T* out, std::size_t out_ld, std::size_t rows, std::size_t cols) {
+    if (rows <= kLeaf && cols <= kLeaf) {
+        leaf_tile(in, in_ld, out, out_ld, rows, cols);
+    } else if (rows >= cols) {
+        const std::size_t half = split(rows);
+        recursive_tile(in, in_ld, out, out_ld, half, cols);
+        recursive_tile(in + half, in_ld, out + half * out_ld, out_ld, rows - half, cols);
+    } else {
+        const std::size_t half = split(cols);
+        recursive_tile(in, in_ld, out, out_ld, rows, half);
+        recursive_tile(in + half * in_ld, in_ld, out + half, out_ld, rows, cols - half);
+    }
+}
+
+// Input offset of flat position `index` over `dims` (output order) with input `strides`.
+inline std::size_t input_offset(std::size_t index, const std::vector<std::size_t>& dims,
+                                const std::vector<std::size_t>& strides) {
+    std::size_t offset = 0;
+    for (std::size_t d = dims.size(); d-- > 0;) {
+        offset += (index % dims[d]) * strides[d];
+        index /= dims[d];
+    }
+    return offset;
+}
+
+}  // namespace detail
+
+// out = in.transpose(perm); `in` and `out` are contiguous.
+template <typename T>
+void permute(const T* in, const std::vector<int64_t>& in_shape, const std::vector<int64_t>& perm, T* out,
+             unsigned threads) {
+    for (int64_t extent : in_shape) {
+        if (extent == 0) {
+            return;  // nothing to move; the row/batch counts below would divide by zero
+        }
+    }
+    const Permutation plan = simplify(in_shape, perm);
+    std::size_t total = 1;
+    for (std::size_t extent : plan.shape) {
+        total *= extent;
+    }
+    if (plan.shape.empty() || plan.in_strides.back() == 1) {
+        // Identity or row copies: the innermost output run is contiguous in the input.
+        const std::size_t width = plan.shape.empty() ? total : plan.shape.back();
+        std::vector<std::size_t> outer_dims(plan.shape.begin(), plan.shape.end() - (plan.shape.empty() ? 0 : 1));
+        std::vector<std::size_t> outer_strides(plan.in_strides.begin(),
+                                               plan.in_strides.end() - (plan.shape.empty() ? 0 : 1));
+        parallel_for(total / width, threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t row = begin; row < end; ++row) {
+                std::memcpy(out + row * width, in + detail::input_offset(row, outer_dims, outer_strides),
+                            width * sizeof(T));
+            }
+        });
+        return;
+    }
+    // Batched 2-D transpose between output dim `q` (input-contiguous) and the last output dim.
+    const std::size_t last = plan.shape.size() - 1;
+    const auto q = static_cast<std::size_t>(
+        std::find(plan.in_strides.begin(), plan.in_strides.end(), std::size_t{1}) - plan.in_strides.begin());
+    std::vector<std::size_t> out_strides(plan.shape.size(), 1);
+    for (std::size_t i = last; i-- > 0;) {
+        out_strides[i] = out_strides[i + 1] * plan.shape[i + 1];
+    }
+    std::vector<std::size_t> batch_dims, batch_in, batch_out;
+    for (std::size_t d = 0; d < last; ++d) {
+        if (d != q) {
+            batch_dims.push_back(plan.shape[d]);
+            batch_in.push_back(plan.in_strides[d]);
+            batch_out.push_back(out_strides[d]);
+        }
+    }
+    const std::size_t rows = plan.shape[q];
+    const std::size_t cols = plan.shape[last];
+    const std::size_t in_ld = plan.in_strides[last];
+    const std::size_t out_ld = out_strides[q];
+    const std::size_t row_blocks = (rows + kTaskRows - 1) / kTaskRows;
+    const std::size_t batches = total / (rows * cols);
+    parallel_for(batches * row_blocks, threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t task = begin; task < end; ++task) {
+            const std::size_t batch = task / row_blocks;
+            const std::size_t row = (task % row_blocks) * kTaskRows;
+            const std::size_t in_base = detail::input_offset(batch, batch_dims, batch_in) + row;
+            const std::size_t out_base = detail::input_offset(batch, batch_dims, batch_out) + row * out_ld;
+            detail::recursive_tile(in + in_base, in_ld, out + out_base, out_ld, std::min(kTaskRows, rows - row), cols);
+        }
+    });
+}
+
+}  // namespace transpose
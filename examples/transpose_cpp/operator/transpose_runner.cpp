@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "optest/tensor_file.h"
+#include "transpose_kernel.h"
+
+namespace {
+
+struct Options {
+    std::string dtype = "float32";
+    std::string input0;
+    std::string output0;
+    std::string shapes_json;
+    std::string params_json;
+    std::string format = "raw";
+    unsigned threads = 0;
+    int iterations = 1;
+};
+
+Options parse_args(int argc, char** argv) {
+    Options opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dtype" && i + 1 < argc) {
+            opt.dtype = argv[++i];
+        } else if (arg == "--input0" && i + 1 < argc) {
+            opt.input0 = argv[++i];
+        } else if (arg == "--output0" && i + 1 < argc) {
+            opt.output0 = argv[++i];
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            opt.shapes_json = argv[++i];
+        } else if (arg == "--params" && i + 1 < argc) {
+            opt.params_json = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opt.iterations = std::stoi(argv[++i]);
+        }
+    }
+    if (opt.input0.empty() || opt.output0.empty() || opt.shapes_json.empty()) {
+        throw std::runtime_error("--input0, --output0 and --shapes are required");
+    }
+    if (opt.iterations < 1) {
+        throw std::runtime_error("--iterations must be positive");
+    }
+    if (opt.threads == 0) {
+        opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return opt;
+}
+
+// Innermost integer lists of a JSON text, in order (`-` signs allowed).
+std::vector<std::vector<int64_t>> parse_int_lists(const std::string& text) {
+    std::vector<std::vector<int64_t>> lists;
+    std::vector<int64_t> current;
+    bool in_list = false;
+    int64_t value = 0;
+    int64_t sign = 1;
+    bool in_number = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            in_number = true;
+            continue;
+        }
+        if (in_number) {
+            current.push_back(sign * value);
+            value = 0;
+            sign = 1;
+            in_number = false;
+        }
+        if (c == '-') {
+            sign = -1;
+        } else if (c == '[') {
+            current.clear();
+            in_list = true;
+        } else if (c == ']' && in_list) {
+            lists.push_back(current);
+            in_list = false;
+        }
+    }
+    return lists;
+}
+
+// `perm` from the `{params}` JSON; absent means reversing the axes (like numpy.transpose).
+std::vector<int64_t> parse_perm(const std::string& params, std::size_t rank) {
+    const auto key = params.find("\"perm\"");
+    std::vector<int64_t> perm;
+    if (key != std::string::npos) {
+        const auto lists = parse_int_lists(params.substr(key, params.find(']', key) + 1 - key));
+        if (!lists.empty()) {
+            perm = lists.front();
+        }
+    }
+    if (perm.empty()) {
+        perm.resize(rank);
+        std::iota(perm.rbegin(), perm.rend(), int64_t{0});
+    }
+    for (auto& axis : perm) {
+        axis += axis < 0 ? static_cast<int64_t>(rank) : 0;
+    }
+    return perm;
+}
+
+template <typename F>
+double time_ms(int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < iterations; ++iter) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+template <typename T>
+void run(const Options& opts, const std::vector<int64_t>& in_shape, const std::vector<int64_t>& out_shape) {
+    const auto perm = parse_perm(opts.params_json, in_shape.size());
+    if (perm.size() != in_shape.size() || out_shape.size() != in_shape.size()) {
+        throw std::runtime_error("perm, input and output ranks differ");
+    }
+    for (std::size_t k = 0; k < perm.size(); ++k) {
+        if (perm[k] < 0 || perm[k] >= static_cast<int64_t>(in_shape.size()) || out_shape[k] != in_shape[perm[k]]) {
+            throw std::runtime_error("output shape is not the input shape permuted by perm");
+        }
+    }
+    optest::TensorMap<T> input(opts.input0, in_shape);
+    if (!input.contiguous()) {
+        throw std::runtime_error("input must be contiguous");
+    }
+    std::vector<T> out(input.size());
+    const double bytes = 2.0 * static_cast<double>(input.size() * sizeof(T));  // read + write
+    const double kernel_ms = time_ms(opts.iterations, [&] {
+        transpose::permute(input.data(), in_shape, perm, out.data(), opts.threads);
+    });
+    // Same bytes through memcpy: the ceiling a pure data-movement kernel is judged against.
+    std::vector<T> scratch(input.size());
+    const double copy_ms = time_ms(opts.iterations, [&] {
+        transpose::parallel_copy(input.data(), scratch.data(), input.size() * sizeof(T), opts.threads);
+    });
+    const double gbps = bytes / 1e9 / (kernel_ms / 1e3);
+    const double copy_gbps = bytes / 1e9 / (copy_ms / 1e3);
+    // Picked up by `optest bench`; ignored by `optest run`.
+    std::cout << "OPTEST_METRIC kernel_ms=" << kernel_ms << " transpose_gbps=" << gbps << " copy_gbps=" << copy_gbps
+              << " copy_fraction=" << gbps / copy_gbps << " threads=" << opts.threads << std::endl;
+    optest::write_tensor<T>(opts.output0, out.data(), out_shape, opts.format == "optt");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options opts = parse_args(argc, argv);
+        const auto shapes = parse_int_lists(opts.shapes_json);
+        if (shapes.size() != 2) {
+            throw std::runtime_error("expected one input and one output");
+        }
+        // Permutes only move bits, so dispatch on the element type the container format expects.
+        if (opts.dtype == "float32") {
+            run<float>(opts, shapes[0], shapes[1]);
+        } else if (opts.dtype == "int32") {
+            run<int32_t>(opts, shapes[0], shapes[1]);
+        } else if (opts.dtype == "int16") {
+            run<int16_t>(opts, shapes[0], shapes[1]);
+        } else if (opts.dtype == "int8") {
+            run<int8_t>(opts, shapes[0], shapes[1]);
+        } else if (opts.dtype == "float16" && opts.format != "optt") {
+            run<uint16_t>(opts, shapes[0], shapes[1]);  // raw half bits
+        } else {
+            throw std::runtime_error("unsupported dtype: " + opts.dtype);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "transpose_runner failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+# Profile-guided optimization and LTO switches for optest C++ runners.
+#
+#   OPTEST_PGO_MODE  off | generate | use (default off)
+#   OPTEST_PGO_DIR   directory holding the collected profile
+#   OPTEST_LTO       enable interprocedural optimization when supported
+#
+# `optest pgo` drives these cache variables; call optest_enable_pgo(<target>)
+# after add_executable() to apply them.
+
+set(OPTEST_PGO_MODE "off" CACHE STRING "Profile-guided optimization stage (off, generate, use)")
+set_property(CACHE OPTEST_PGO_MODE PROPERTY STRINGS off generate use)
+set(OPTEST_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH "Profile directory for OPTEST_PGO_MODE")
+option(OPTEST_LTO "Build optest runners with link-time optimization" OFF)
+
+include(CheckIPOSupported)
+
+function(optest_enable_pgo target)
+  set(flags "")
+  if(OPTEST_PGO_MODE STREQUAL "generate")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+      # Runners are multi-threaded; atomic counter updates keep the profile consistent.
+      set(flags "-fprofile-generate=${OPTEST_PGO_DIR}" "-fprofile-update=atomic")
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+      set(flags "-fprofile-generate=${OPTEST_PGO_DIR}")
+    endif()
+  elseif(OPTEST_PGO_MODE STREQUAL "use")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+      set(flags "-fprofile-use=${OPTEST_PGO_DIR}" "-fprofile-correction" "-Wno-missing-profile")
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+      set(flags "-fprofile-use=${OPTEST_PGO_DIR}/default.profdata" "-Wno-profile-instr-unprofiled")
+    endif()
+  elseif(NOT OPTEST_PGO_MODE STREQUAL "off")
+    message(FATAL_ERROR "OPTEST_PGO_MODE must be off, generate or use (got '${OPTEST_PGO_MODE}')")
+  endif()
+  if(NOT OPTEST_PGO_MODE STREQUAL "off" AND NOT flags)
+    message(WARNING "PGO is not supported for ${CMAKE_CXX_COMPILER_ID}; building ${target} without it")
+  endif()
+  if(flags)
+    target_compile_options(${target} PRIVATE ${flags})
+    # Link flags via target_link_libraries keeps CMake 3.10 compatibility.
+    target_link_libraries(${target} PRIVATE ${flags})
+  endif()
+  if(OPTEST_LTO)
+    check_ipo_supported(RESULT ipo_ok OUTPUT ipo_message LANGUAGES CXX)
+    if(ipo_ok)
+      set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    else()
+      message(WARNING "LTO requested but unsupported: ${ipo_message}")
+    endif()
+  endif()
+endfunction()
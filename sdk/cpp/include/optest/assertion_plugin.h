@@ -0,0 +1,119 @@
+#pragma once
+
+// Native assertion plugins: a shared library named by `assertion.source` (a `.so`) that optest loads in-process and
+// calls with the tensors it already holds (generated inputs, mapped output files), so an expensive golden needs no
+// extra process and no copy of the data.
+//
+//     #include <optest/assertion_plugin.h>
+//
+//     OPTEST_ASSERTION(check_relu) {
+//         double max_abs = 0;
+//         for (int64_t i = 0; i < optest::numel(inputs[0]); ++i) {
+//             const float want = std::max(optest::element<float>(inputs[0], i), 0.0f);
+//             max_abs = std::max(max_abs, double(std::fabs(optest::element<float>(outputs[0], i) - want)));
+//         }
+//         optest::add_metric(result, "output0_max_abs", max_abs);
+//         result->ok = max_abs <= (std::isnan(atol) ? 1e-4 : atol);
+//         return 0;
+//     }
+//
+// optest looks the function up by `assertion.name` (`check_relu` above). It fills `result` and returns 0; the case then
+// passes only if `ok` is set. When it could not check at all it returns non-zero with `details` explaining why, which
+// always fails the case, whatever `ok` holds.
+// Tensors are read-only views valid for the duration of the call: `data` points at element [0, ..., 0], `strides` are
+// in bytes and need not be contiguous (plan layouts), and `dtype` is the tensor-file code (optest::DType).
+// `params_json` is `assertion.params` as JSON; `rtol`/`atol` are NaN and `metric` is empty when the plan leaves them
+// unset. The library stays loaded for the whole optest process, so state kept between calls persists across cases.
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "tensor_file.h"
+
+#define OPTEST_ASSERTION_ABI_VERSION 1
+#define OPTEST_DETAILS_SIZE 1024
+#define OPTEST_METRIC_NAME_SIZE 64
+#define OPTEST_MAX_METRICS 32
+
+extern "C" {
+
+struct optest_tensor {
+    const void* data;
+    uint16_t dtype;
+    int32_t ndim;
+    const int64_t* shape;
+    const int64_t* strides;
+};
+
+struct optest_metric {
+    char name[OPTEST_METRIC_NAME_SIZE];
+    double value;
+};
+
+struct optest_result {
+    int32_t ok;
+    char details[OPTEST_DETAILS_SIZE];
+    int32_t num_metrics;
+    optest_metric metrics[OPTEST_MAX_METRICS];
+};
+
+// Checked by optest before the first call; weak, so every translation unit of a plugin may include this header.
+__attribute__((weak, visibility("default"))) int32_t optest_assertion_abi_version() {
+    return OPTEST_ASSERTION_ABI_VERSION;
+}
+
+}  // extern "C"
+
+#define OPTEST_ASSERTION(name)                                                                                  \
+    extern "C" __attribute__((visibility("default"))) int32_t name(                                            \
+        [[maybe_unused]] const optest_tensor* inputs, [[maybe_unused]] int32_t num_inputs,                     \
+        [[maybe_unused]] const optest_tensor* outputs, [[maybe_unused]] int32_t num_outputs,                   \
+        [[maybe_unused]] const char* params_json, [[maybe_unused]] double rtol, [[maybe_unused]] double atol,  \
+        [[maybe_unused]] const char* metric, optest_result* result)
+
+namespace optest {
+
+inline DType dtype_of(const optest_tensor& tensor) { return static_cast<DType>(tensor.dtype); }
+
+inline int64_t numel(const optest_tensor& tensor) {
+    int64_t count = 1;
+    for (int32_t dim = 0; dim < tensor.ndim; ++dim) {
+        count *= tensor.shape[dim];
+    }
+    return count;
+}
+
+// Element `index` in row-major order, following the tensor's strides.
+template <typename T>
+T element(const optest_tensor& tensor, int64_t index) {
+    int64_t offset = 0;
+    for (int32_t dim = tensor.ndim - 1; dim >= 0; --dim) {
+        offset += (index % tensor.shape[dim]) * tensor.strides[dim];
+        index /= tensor.shape[dim];
+    }
+    T value;
+    std::memcpy(&value, static_cast<const char*>(tensor.data) + offset, sizeof(T));
+    return value;
+}
+
+inline void set_details(optest_result* result, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(result->details, sizeof(result->details), format, args);
+    va_end(args);
+}
+
+// Returns false when the result already holds OPTEST_MAX_METRICS metrics.
+inline bool add_metric(optest_result* result, const char* name, double value) {
+    if (result->num_metrics >= OPTEST_MAX_METRICS) {
+        return false;
+    }
+    optest_metric& slot = result->metrics[result->num_metrics++];
+    std::snprintf(slot.name, sizeof(slot.name), "%s", name);
+    slot.value = value;
+    return true;
+}
+
+}  // namespace optest
@@ -0,0 +1,111 @@
+#pragma once
+
+// Cold-cache benchmarking helpers for runners that time a kernel in-process.
+//
+// `optest bench --cache-state cold` sets OPTEST_CACHE_STATE=cold for the runner (warm is the default). A cold runner
+// should not let its repetitions find the inputs in cache: it keeps several copies of its tensors and rotates among
+// them (rotation_copies() picks enough copies to exceed the last-level cache), and calls flush_caches() outside the
+// timed region before every sample. flush_range() evicts one tensor with clflush where the CPU has it.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace optest {
+
+enum class CacheState { kWarm, kCold };
+
+inline CacheState parse_cache_state(const std::string& text) {
+    if (text == "warm") {
+        return CacheState::kWarm;
+    }
+    if (text == "cold") {
+        return CacheState::kCold;
+    }
+    throw std::runtime_error("cache state must be warm or cold, got: " + text);
+}
+
+inline CacheState cache_state_from_env(CacheState fallback = CacheState::kWarm) {
+    const char* value = std::getenv("OPTEST_CACHE_STATE");
+    return value != nullptr && *value != '\0' ? parse_cache_state(value) : fallback;
+}
+
+inline const char* cache_state_name(CacheState state) { return state == CacheState::kCold ? "cold" : "warm"; }
+
+// Largest data/unified cache of CPU 0 (sysfs sizes such as "32768K"); 32 MiB when it cannot be read.
+inline std::size_t last_level_cache_bytes() {
+    std::size_t largest = 0;
+    const std::filesystem::path root = "/sys/devices/system/cpu/cpu0/cache";
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(root, error)) {
+        std::ifstream type_file(entry.path() / "type");
+        std::ifstream size_file(entry.path() / "size");
+        std::string type;
+        std::string size;
+        if (!(type_file >> type) || !(size_file >> size) || type == "Instruction" || size.empty()) {
+            continue;
+        }
+        std::size_t bytes = std::strtoull(size.c_str(), nullptr, 10);
+        const char unit = size.back();
+        bytes *= unit == 'K' ? std::size_t{1} << 10 : unit == 'M' ? std::size_t{1} << 20 : 1;
+        largest = std::max(largest, bytes);
+    }
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    if (largest == 0) {
+        const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        largest = l3 > 0 ? static_cast<std::size_t>(l3) : 0;
+    }
+#endif
+    return largest != 0 ? largest : std::size_t{32} << 20;
+}
+
+// Copies of a working set of `bytes` needed so that cycling through them touches twice the last-level cache.
+inline std::size_t rotation_copies(std::size_t bytes, std::size_t max_copies = 256) {
+    const std::size_t target = 2 * last_level_cache_bytes();
+    const std::size_t copies = (target + std::max<std::size_t>(bytes, 1) - 1) / std::max<std::size_t>(bytes, 1);
+    return std::clamp<std::size_t>(copies, 2, max_copies);
+}
+
+// Evicts everything by writing a buffer twice the last-level cache size (one store per cache line).
+inline void flush_caches() {
+    static std::vector<unsigned char> buffer(2 * last_level_cache_bytes());
+    static unsigned char round = 0;
+    ++round;
+    for (std::size_t i = 0; i < buffer.size(); i += 64) {
+        buffer[i] = static_cast<unsigned char>(round + i);
+    }
+    volatile unsigned char sink = buffer[buffer.size() / 2];
+    (void)sink;
+}
+
+// Evicts one range; falls back to flush_caches() where clflush is unavailable.
+inline void flush_range(const void* data, std::size_t bytes) {
+#if defined(__x86_64__) || defined(__i386__)
+    const auto* bytes_ptr = static_cast<const char*>(data);
+    for (std::size_t i = 0; i < bytes; i += 64) {
+        _mm_clflush(bytes_ptr + i);
+    }
+    if (bytes != 0) {
+        _mm_clflush(bytes_ptr + bytes - 1);  // an unaligned range ends in one more line
+    }
+    _mm_mfence();
+#else
+    (void)data;
+    (void)bytes;
+    flush_caches();
+#endif
+}
+
+}  // namespace optest
@@ -0,0 +1,108 @@
+#pragma once
+
+// Subnormal (denormal) floating-point handling for runners.
+//
+// `optest bench --ftz MODE` sets OPTEST_FTZ (and the {ftz} token) to off, ftz (flush subnormal results to zero),
+// daz (treat subnormal inputs as zero) or on (both). A runner applies it with
+//
+//     optest::ScopedFloatMode mode(optest::float_mode_from_env());
+//
+// before its kernel runs. The mode lives in a per-thread control register (MXCSR on x86, FPCR on AArch64), so
+// threads started by the runner must set it themselves; they do not inherit it from the thread that spawns them.
+// AArch64 has a single flush-to-zero bit that covers inputs and results, so ftz, daz and on all set it there.
+
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace optest {
+
+struct FloatMode {
+    bool ftz = false;
+    bool daz = false;
+};
+
+inline FloatMode parse_float_mode(const std::string& text) {
+    if (text == "off") {
+        return FloatMode{};
+    }
+    if (text == "ftz") {
+        return FloatMode{true, false};
+    }
+    if (text == "daz") {
+        return FloatMode{false, true};
+    }
+    if (text == "on") {
+        return FloatMode{true, true};
+    }
+    throw std::runtime_error("float mode must be off, ftz, daz or on, got: " + text);
+}
+
+inline FloatMode float_mode_from_env(FloatMode fallback = FloatMode{}) {
+    const char* value = std::getenv("OPTEST_FTZ");
+    return value != nullptr && *value != '\0' ? parse_float_mode(value) : fallback;
+}
+
+inline const char* float_mode_name(FloatMode mode) {
+    return mode.ftz ? (mode.daz ? "on" : "ftz") : (mode.daz ? "daz" : "off");
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+constexpr unsigned kMxcsrFtz = 0x8000;
+constexpr unsigned kMxcsrDaz = 0x0040;
+
+inline FloatMode current_float_mode() {
+    const unsigned csr = _mm_getcsr();
+    return FloatMode{(csr & kMxcsrFtz) != 0, (csr & kMxcsrDaz) != 0};
+}
+
+inline void set_float_mode(FloatMode mode) {
+    unsigned csr = _mm_getcsr() & ~(kMxcsrFtz | kMxcsrDaz);
+    csr |= (mode.ftz ? kMxcsrFtz : 0) | (mode.daz ? kMxcsrDaz : 0);
+    _mm_setcsr(csr);
+}
+#elif defined(__aarch64__)
+constexpr std::uint64_t kFpcrFz = std::uint64_t{1} << 24;
+
+inline FloatMode current_float_mode() {
+    std::uint64_t fpcr = 0;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    const bool flush = (fpcr & kFpcrFz) != 0;
+    return FloatMode{flush, flush};
+}
+
+inline void set_float_mode(FloatMode mode) {
+    std::uint64_t fpcr = 0;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    fpcr = (mode.ftz || mode.daz) ? (fpcr | kFpcrFz) : (fpcr & ~kFpcrFz);
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+}
+#else
+// No portable control: subnormals are always handled per IEEE 754.
+inline FloatMode current_float_mode() { return FloatMode{}; }
+
+inline void set_float_mode(FloatMode mode) {
+    if (mode.ftz || mode.daz) {
+        throw std::runtime_error("flush-to-zero is not supported on this architecture");
+    }
+}
+#endif
+
+// Sets a mode for the calling thread and restores the previous one on scope exit.
+class ScopedFloatMode {
+public:
+    explicit ScopedFloatMode(FloatMode mode) : previous_(current_float_mode()) { set_float_mode(mode); }
+    ~ScopedFloatMode() { set_float_mode(previous_); }
+    ScopedFloatMode(const ScopedFloatMode&) = delete;
+    ScopedFloatMode& operator=(const ScopedFloatMode&) = delete;
+
+private:
+    FloatMode previous_;
+};
+
+}  // namespace optest
@@ -0,0 +1,558 @@
+#pragma once
+
+// Reader/writer for optest tensor files: headerless little-endian binaries and
+// the self-describing `.optt` container (see optest/storage/tensorfile.py for
+// the byte layout). Readers detect the container by its magic, so runners can
+// accept either form without an extra flag. Raw files may also hold a strided
+// or pitched tensor described by a TensorLayout (the plan's `{layouts}` token).
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace optest {
+
+constexpr char kTensorMagic[8] = {'O', 'P', 'T', 'T', 'E', 'N', 'S', 'R'};
+constexpr uint16_t kTensorVersion = 1;
+constexpr std::size_t kTensorAlignment = 64;
+constexpr std::size_t kFixedHeaderSize = 64;
+
+enum class DType : uint16_t {
+    kBool = 1,
+    kInt8 = 2,
+    kUInt8 = 3,
+    kInt16 = 4,
+    kUInt16 = 5,
+    kInt32 = 6,
+    kUInt32 = 7,
+    kInt64 = 8,
+    kUInt64 = 9,
+    kFloat16 = 10,
+    kFloat32 = 11,
+    kFloat64 = 12,
+};
+
+template <typename T>
+struct DTypeOf;
+template <> struct DTypeOf<bool> { static constexpr DType value = DType::kBool; };
+template <> struct DTypeOf<int8_t> { static constexpr DType value = DType::kInt8; };
+template <> struct DTypeOf<uint8_t> { static constexpr DType value = DType::kUInt8; };
+template <> struct DTypeOf<int16_t> { static constexpr DType value = DType::kInt16; };
+template <> struct DTypeOf<uint16_t> { static constexpr DType value = DType::kUInt16; };
+template <> struct DTypeOf<int32_t> { static constexpr DType value = DType::kInt32; };
+template <> struct DTypeOf<uint32_t> { static constexpr DType value = DType::kUInt32; };
+template <> struct DTypeOf<int64_t> { static constexpr DType value = DType::kInt64; };
+template <> struct DTypeOf<uint64_t> { static constexpr DType value = DType::kUInt64; };
+template <> struct DTypeOf<float> { static constexpr DType value = DType::kFloat32; };
+template <> struct DTypeOf<double> { static constexpr DType value = DType::kFloat64; };
+
+inline std::size_t dtype_size(DType dtype) {
+    switch (dtype) {
+        case DType::kBool:
+        case DType::kInt8:
+        case DType::kUInt8:
+            return 1;
+        case DType::kInt16:
+        case DType::kUInt16:
+        case DType::kFloat16:
+            return 2;
+        case DType::kInt32:
+        case DType::kUInt32:
+        case DType::kFloat32:
+            return 4;
+        case DType::kInt64:
+        case DType::kUInt64:
+        case DType::kFloat64:
+            return 8;
+    }
+    throw std::runtime_error("unknown dtype code");
+}
+
+struct TensorHeader {
+    DType dtype = DType::kFloat32;
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;  // bytes
+    uint64_t data_offset = 0;
+    uint64_t nbytes = 0;
+    uint16_t hash_algo = 0;  // 0 = none, 1 = blake2b-256
+    std::array<uint8_t, 32> digest{};
+
+    int64_t numel() const {
+        int64_t count = 1;
+        for (int64_t dim : shape) {
+            count *= dim;
+        }
+        return count;
+    }
+};
+
+inline uint64_t data_offset_for(std::size_t ndim) {
+    const uint64_t raw = kFixedHeaderSize + 16 * ndim;
+    return (raw + kTensorAlignment - 1) / kTensorAlignment * kTensorAlignment;
+}
+
+inline std::vector<int64_t> contiguous_strides(const std::vector<int64_t>& shape, std::size_t itemsize) {
+    std::vector<int64_t> strides(shape.size());
+    int64_t step = static_cast<int64_t>(itemsize);
+    for (std::size_t i = shape.size(); i-- > 0;) {
+        strides[i] = step;
+        step *= shape[i] > 0 ? shape[i] : 1;
+    }
+    return strides;
+}
+
+// Placement of a tensor inside a raw file, in elements. Empty strides mean
+// C-contiguous; padding between rows (a pitch) or a leading offset is left zero.
+struct TensorLayout {
+    std::vector<int64_t> strides;
+    int64_t offset = 0;
+
+    bool dense() const { return strides.empty() && offset == 0; }
+};
+
+// Element strides for `shape` under `layout`.
+inline std::vector<int64_t> layout_strides(const std::vector<int64_t>& shape, const TensorLayout& layout) {
+    if (layout.strides.empty()) {
+        return contiguous_strides(shape, 1);
+    }
+    if (layout.strides.size() != shape.size()) {
+        throw std::runtime_error("layout strides must have one entry per dim");
+    }
+    return layout.strides;
+}
+
+// Elements spanned from the first to the last element (0 for empty tensors).
+inline int64_t strided_extent(const std::vector<int64_t>& shape, const std::vector<int64_t>& strides) {
+    int64_t last = 0;
+    for (std::size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] == 0) {
+            return 0;
+        }
+        last += (shape[i] - 1) * strides[i];
+    }
+    return last + 1;
+}
+
+namespace detail {
+
+template <typename T>
+T load_le(const unsigned char* p) {
+    T value{};
+    std::memcpy(&value, p, sizeof(T));  // x86/aarch64 hosts are little-endian
+    return value;
+}
+
+template <typename T>
+void store_le(std::vector<unsigned char>& out, std::size_t pos, T value) {
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+}  // namespace detail
+
+inline bool is_tensor_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(kTensorMagic)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kTensorMagic, sizeof(magic)) == 0;
+}
+
+inline TensorHeader parse_header(const unsigned char* base, std::size_t size, const std::string& path) {
+    if (size < kFixedHeaderSize || std::memcmp(base, kTensorMagic, sizeof(kTensorMagic)) != 0) {
+        throw std::runtime_error(path + " is not an optest tensor file");
+    }
+    TensorHeader header;
+    const auto version = detail::load_le<uint16_t>(base + 8);
+    if (version != kTensorVersion) {
+        throw std::runtime_error(path + ": unsupported tensor file version " + std::to_string(version));
+    }
+    header.dtype = static_cast<DType>(detail::load_le<uint16_t>(base + 10));
+    const auto ndim = detail::load_le<uint16_t>(base + 12);
+    header.hash_algo = detail::load_le<uint16_t>(base + 14);
+    header.data_offset = detail::load_le<uint64_t>(base + 16);
+    header.nbytes = detail::load_le<uint64_t>(base + 24);
+    std::memcpy(header.digest.data(), base + 32, header.digest.size());
+    // Written so that no sum can wrap: a hostile header must not pass by overflowing.
+    if (header.data_offset % kTensorAlignment != 0 || header.data_offset < data_offset_for(ndim) ||
+        header.data_offset > size || header.nbytes > size - header.data_offset) {
+        throw std::runtime_error(path + ": corrupt or truncated tensor header");
+    }
+    for (uint16_t i = 0; i < ndim; ++i) {
+        header.shape.push_back(detail::load_le<int64_t>(base + kFixedHeaderSize + 8 * i));
+        header.strides.push_back(detail::load_le<int64_t>(base + kFixedHeaderSize + 8 * (ndim + i)));
+    }
+    const auto itemsize = static_cast<int64_t>(dtype_size(header.dtype));  // rejects unknown codes
+    for (int64_t dim : header.shape) {
+        if (dim < 0) {
+            throw std::runtime_error(path + ": negative dimension in tensor shape");
+        }
+    }
+    for (int64_t dim : header.shape) {
+        if (dim == 0) {
+            return header;  // empty: nothing is ever read
+        }
+    }
+    // Bytes from the first to the last element, as in the Python reader's _validate_header.
+    int64_t extent = itemsize;
+    for (std::size_t i = 0; i < header.shape.size(); ++i) {
+        int64_t span = 0;
+        if (header.strides[i] < 0 || __builtin_mul_overflow(header.shape[i] - 1, header.strides[i], &span) ||
+            __builtin_add_overflow(extent, span, &extent)) {
+            throw std::runtime_error(path + ": invalid tensor strides");
+        }
+    }
+    if (static_cast<uint64_t>(extent) > header.nbytes) {
+        throw std::runtime_error(path + ": strides exceed the data region of " + std::to_string(header.nbytes) +
+                                 " bytes");
+    }
+    return header;
+}
+
+// Read-only memory mapping of a whole file (RAII).
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) : path_(path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open " + path);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("failed to stat " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("failed to mmap " + path);
+            }
+            data_ = static_cast<const unsigned char*>(addr);
+        }
+        ::close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<unsigned char*>(data_), size_);
+        }
+    }
+
+    const unsigned char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+
+private:
+    void swap(MappedFile& other) noexcept {
+        std::swap(path_, other.path_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+
+    std::string path_;
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Zero-copy view of a tensor file. Raw files are described by the caller's
+// expected shape; container files must agree with it.
+template <typename T>
+class TensorMap {
+public:
+    // Raw files placed with `layout` (strides/offset in elements); containers describe
+    // their own strides, so `layout` is ignored for them.
+    TensorMap(const std::string& path, const std::vector<int64_t>& expected_shape, const TensorLayout& layout)
+        : TensorMap(path, expected_shape, layout.dense() ? nullptr : &layout) {}
+
+    TensorMap(const std::string& path, const std::vector<int64_t>& expected_shape)
+        : TensorMap(path, expected_shape, nullptr) {}
+
+    const T* data() const { return reinterpret_cast<const T*>(file_.data() + header_.data_offset); }
+    // Elements in the mapped region (the strided extent for laid-out raw files).
+    std::size_t size() const { return static_cast<std::size_t>(header_.nbytes / sizeof(T)); }
+    const TensorHeader& header() const { return header_; }
+    bool contiguous() const { return header_.strides == contiguous_strides(header_.shape, sizeof(T)); }
+
+    std::vector<int64_t> element_strides() const {
+        std::vector<int64_t> strides(header_.strides);
+        for (auto& stride : strides) {
+            stride /= static_cast<int64_t>(sizeof(T));
+        }
+        return strides;
+    }
+
+private:
+    TensorMap(const std::string& path, const std::vector<int64_t>& expected_shape, const TensorLayout* layout)
+        : file_(path) {
+        const bool container =
+            file_.size() >= kFixedHeaderSize && std::memcmp(file_.data(), kTensorMagic, sizeof(kTensorMagic)) == 0;
+        if (container) {
+            header_ = parse_header(file_.data(), file_.size(), path);
+            if (header_.dtype != DTypeOf<T>::value) {
+                throw std::runtime_error(path + ": dtype does not match the runner's dtype");
+            }
+            if (!expected_shape.empty() && header_.shape != expected_shape) {
+                throw std::runtime_error(path + ": shape does not match the expected shape");
+            }
+        } else if (layout != nullptr) {
+            const auto strides = layout_strides(expected_shape, *layout);
+            const int64_t extent = strided_extent(expected_shape, strides);
+            const auto needed = static_cast<uint64_t>(layout->offset + extent) * sizeof(T);
+            if (file_.size() < needed) {
+                throw std::runtime_error(path + ": file holds " + std::to_string(file_.size()) +
+                                         " bytes, strided layout needs " + std::to_string(needed));
+            }
+            header_.dtype = DTypeOf<T>::value;
+            header_.shape = expected_shape;
+            for (int64_t stride : strides) {
+                header_.strides.push_back(stride * static_cast<int64_t>(sizeof(T)));
+            }
+            header_.data_offset = static_cast<uint64_t>(layout->offset) * sizeof(T);
+            header_.nbytes = static_cast<uint64_t>(extent) * sizeof(T);
+        } else {
+            header_.dtype = DTypeOf<T>::value;
+            header_.shape = expected_shape;
+            header_.strides = contiguous_strides(expected_shape, sizeof(T));
+            header_.nbytes = file_.size();
+            const auto expected = static_cast<uint64_t>(header_.numel()) * sizeof(T);
+            if (!expected_shape.empty() && header_.nbytes != expected) {
+                throw std::runtime_error(path + ": file holds " + std::to_string(header_.nbytes) +
+                                         " bytes, expected " + std::to_string(expected));
+            }
+            if (header_.nbytes % sizeof(T) != 0) {
+                throw std::runtime_error("file size not aligned to dtype for " + path);
+            }
+        }
+    }
+
+    MappedFile file_;
+    TensorHeader header_;
+};
+
+namespace detail {
+
+// Visits every element of `shape` in row-major order with its offset under `strides`.
+template <typename F>
+void for_each_strided(const std::vector<int64_t>& shape, const std::vector<int64_t>& strides, F&& f) {
+    int64_t count = 1;
+    for (int64_t dim : shape) {
+        count *= dim;
+    }
+    std::vector<int64_t> index(shape.size(), 0);
+    int64_t offset = 0;
+    for (int64_t flat = 0; flat < count; ++flat) {
+        f(flat, offset);
+        for (std::size_t d = shape.size(); d-- > 0;) {
+            offset += strides[d];
+            if (++index[d] < shape[d]) {
+                break;
+            }
+            offset -= strides[d] * shape[d];
+            index[d] = 0;
+        }
+    }
+}
+
+}  // namespace detail
+
+// Copies a (possibly strided) mapped tensor into a dense row-major vector.
+template <typename T>
+std::vector<T> to_contiguous(const TensorMap<T>& map) {
+    if (map.contiguous()) {
+        return std::vector<T>(map.data(), map.data() + map.size());
+    }
+    const auto& shape = map.header().shape;
+    std::vector<T> out(static_cast<std::size_t>(map.header().numel()));
+    const T* src = map.data();
+    detail::for_each_strided(shape, map.element_strides(), [&](int64_t flat, int64_t offset) {
+        out[static_cast<std::size_t>(flat)] = src[offset];
+    });
+    return out;
+}
+
+template <typename T>
+std::vector<T> read_tensor(const std::string& path, const std::vector<int64_t>& expected_shape = {},
+                           const TensorLayout& layout = {}) {
+    return to_contiguous(TensorMap<T>(path, expected_shape, layout));
+}
+
+// Writes `count` contiguous elements. With `container` set the file gets an
+// `.optt` header (no content hash; optest computes it lazily when needed).
+template <typename T>
+void write_tensor(const std::string& path, const T* data, const std::vector<int64_t>& shape, bool container) {
+    const auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("failed to open " + path + " for write");
+    }
+    int64_t count = 1;
+    for (int64_t dim : shape) {
+        count *= dim;
+    }
+    const uint64_t nbytes = static_cast<uint64_t>(count) * sizeof(T);
+    if (container) {
+        const uint64_t offset = data_offset_for(shape.size());
+        std::vector<unsigned char> header(offset, 0);
+        std::memcpy(header.data(), kTensorMagic, sizeof(kTensorMagic));
+        detail::store_le<uint16_t>(header, 8, kTensorVersion);
+        detail::store_le<uint16_t>(header, 10, static_cast<uint16_t>(DTypeOf<T>::value));
+        detail::store_le<uint16_t>(header, 12, static_cast<uint16_t>(shape.size()));
+        detail::store_le<uint16_t>(header, 14, 0);
+        detail::store_le<uint64_t>(header, 16, offset);
+        detail::store_le<uint64_t>(header, 24, nbytes);
+        const auto strides = contiguous_strides(shape, sizeof(T));
+        for (std::size_t i = 0; i < shape.size(); ++i) {
+            detail::store_le<int64_t>(header, kFixedHeaderSize + 8 * i, shape[i]);
+            detail::store_le<int64_t>(header, kFixedHeaderSize + 8 * (shape.size() + i), strides[i]);
+        }
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    }
+    file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(nbytes));
+    if (!file) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+// Writes dense row-major `data` into a raw file placed with `layout`; the gaps
+// (pitch padding, leading offset) are zero-filled. Dense layouts fall back to
+// write_tensor, and containers always store the tensor contiguously.
+template <typename T>
+void write_tensor(const std::string& path, const T* data, const std::vector<int64_t>& shape, bool container,
+                  const TensorLayout& layout) {
+    if (container || layout.dense()) {
+        write_tensor<T>(path, data, shape, container);
+        return;
+    }
+    const auto strides = layout_strides(shape, layout);
+    std::vector<T> buffer(static_cast<std::size_t>(layout.offset + strided_extent(shape, strides)), T{});
+    T* dst = buffer.data() + layout.offset;
+    detail::for_each_strided(shape, strides, [&](int64_t flat, int64_t offset) { dst[offset] = data[flat]; });
+    write_tensor<T>(path, buffer.data(), {static_cast<int64_t>(buffer.size())}, false);
+}
+
+namespace detail {
+
+inline void skip_space(const std::string& text, std::size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+        ++pos;
+    }
+}
+
+inline bool consume(const std::string& text, std::size_t& pos, const char* token) {
+    skip_space(text, pos);
+    const std::size_t len = std::strlen(token);
+    if (text.compare(pos, len, token) != 0) {
+        return false;
+    }
+    pos += len;
+    return true;
+}
+
+inline void expect(const std::string& text, std::size_t& pos, const char* token) {
+    if (!consume(text, pos, token)) {
+        throw std::runtime_error(std::string("layouts JSON: expected '") + token + "' at offset " +
+                                 std::to_string(pos));
+    }
+}
+
+inline int64_t parse_int(const std::string& text, std::size_t& pos) {
+    skip_space(text, pos);
+    std::size_t used = 0;
+    const int64_t value = std::stoll(text.substr(pos, 32), &used);
+    pos += used;
+    return value;
+}
+
+inline TensorLayout parse_layout(const std::string& text, std::size_t& pos) {
+    TensorLayout layout;
+    if (consume(text, pos, "null")) {
+        return layout;
+    }
+    expect(text, pos, "{");
+    while (!consume(text, pos, "}")) {
+        consume(text, pos, ",");
+        if (consume(text, pos, "\"strides\"")) {
+            expect(text, pos, ":");
+            if (!consume(text, pos, "null")) {
+                expect(text, pos, "[");
+                while (!consume(text, pos, "]")) {
+                    consume(text, pos, ",");
+                    layout.strides.push_back(parse_int(text, pos));
+                }
+            }
+        } else if (consume(text, pos, "\"offset\"")) {
+            expect(text, pos, ":");
+            layout.offset = parse_int(text, pos);
+        } else {
+            throw std::runtime_error("layouts JSON: unknown key at offset " + std::to_string(pos));
+        }
+    }
+    return layout;
+}
+
+inline std::vector<TensorLayout> parse_layout_list(const std::string& text, const char* key) {
+    std::vector<TensorLayout> layouts;
+    const auto found = text.find(std::string("\"") + key + "\"");
+    if (found == std::string::npos) {
+        return layouts;
+    }
+    std::size_t pos = found + std::strlen(key) + 2;
+    expect(text, pos, ":");
+    expect(text, pos, "[");
+    while (!consume(text, pos, "]")) {
+        consume(text, pos, ",");
+        layouts.push_back(parse_layout(text, pos));
+    }
+    return layouts;
+}
+
+}  // namespace detail
+
+struct TensorLayouts {
+    std::vector<TensorLayout> inputs;
+    std::vector<TensorLayout> outputs;
+
+    const TensorLayout& input(std::size_t index) const { return pick(inputs, index); }
+    const TensorLayout& output(std::size_t index) const { return pick(outputs, index); }
+
+private:
+    static const TensorLayout& pick(const std::vector<TensorLayout>& items, std::size_t index) {
+        static const TensorLayout kDense{};
+        return index < items.size() ? items[index] : kDense;
+    }
+};
+
+// Parses the plan's `{layouts}` token: {"inputs": [null | {"strides": [...], "offset": n}], "outputs": [...]}.
+// An empty string yields dense layouts everywhere.
+inline TensorLayouts parse_layouts(const std::string& json) {
+    TensorLayouts layouts;
+    if (!json.empty()) {
+        layouts.inputs = detail::parse_layout_list(json, "inputs");
+        layouts.outputs = detail::parse_layout_list(json, "outputs");
+    }
+    return layouts;
+}
+
+}  // namespace optest
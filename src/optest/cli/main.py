@@ -2,13 +2,18 @@
 from __future__ import annotations
 
 import sys
-from typing import Dict, Optional, Tuple
+import time
+from typing import Any, Callable, Dict, Optional, Tuple
 
 import click
 import yaml
 
 from optest import __version__, bootstrap
-from optest.plan import PlanOptions, load_plan, run_plan
+from optest.machine import calibrate, default_profile_path, load_profile, save_profile
+from optest.plan import BenchSettings, PlanOptions, load_plan, run_bench, run_plan, run_pgo
+from optest.plan.history import default_history_path
+from optest.plan.profile import DEFAULT_FREQUENCY, PROFILERS, parse_profile_spec
+from optest.plan.report import print_matrix, print_regressions, write_html_report
 
 
 CONTEXT_SETTINGS = {"help_option_names": ["-h", "--help"]}
@@ -46,35 +51,196 @@ def cli(ctx: click.Context, verbose: bool) -> None:
     ctx.obj = CliState(verbose=verbose)
 
 
+def _plan_options(func: Callable[..., Any]) -> Callable[..., Any]:
+    """Plan path, case selection and report options shared by run/bench/pgo."""
+
+    options = [
+        click.option(
+            "--plan",
+            "--config",
+            "plan_path",
+            type=click.Path(exists=True, dir_okay=False),
+            required=True,
+            help="YAML plan file (new format).",
+        ),
+        click.option("--backend", type=str, help="Backend type to run (overrides plan when multiple are present)."),
+        click.option("--chip", type=str, help="Chip identifier to run (overrides plan when multiple are present)."),
+        click.option("--cases", "case_filters", type=str, help="Comma-separated case filters (supports globs)."),
+        click.option("--tags", "tag_filters", type=str, help="Comma-separated tags to include."),
+        click.option("--skip-tags", "skip_tag_filters", type=str, help="Comma-separated tags to skip."),
+        click.option("--priority-max", type=int, help="Maximum priority to run."),
+        click.option("--cache", "cache_policy", type=click.Choice(["reuse", "regen"]), help="Cache policy override."),
+        click.option(
+            "--report",
+            "report_format",
+            type=click.Choice(["terminal", "json"]),
+            default="terminal",
+            show_default=True,
+            help="Report format (terminal by default).",
+        ),
+        click.option("--report-path", type=str, help="When --report json, write to this path."),
+        click.option("--no-color", is_flag=True, help="Disable ANSI colors in terminal output."),
+    ]
+    for option in reversed(options):
+        func = option(func)
+    return func
+
+
+def _bench_options(func: Callable[..., Any]) -> Callable[..., Any]:
+    options = [
+        click.option(
+            "--warmup", type=click.IntRange(min=0), default=1, show_default=True, help="Untimed runs per case."
+        ),
+        click.option("--repeat", type=click.IntRange(min=1), default=5, show_default=True, help="Timed runs per case."),
+        click.option("--no-verify", is_flag=True, help="Skip checking outputs after the timed runs."),
+        click.option(
+            "--speedup-metric",
+            type=str,
+            help="Runner metric (OPTEST_METRIC, lower is better) used for speedups instead of wall time.",
+        ),
+    ]
+    for option in reversed(options):
+        func = option(func)
+    return func
+
+
+def _plan_selection(
+    backend: Optional[str],
+    chip: Optional[str],
+    case_filters: Optional[str],
+    tag_filters: Optional[str],
+    skip_tag_filters: Optional[str],
+    priority_max: Optional[int],
+    cache_policy: Optional[str],
+    list_only: bool = False,
+) -> PlanOptions:
+    return PlanOptions(
+        backend=backend,
+        chip=chip,
+        cases=_split_csv(case_filters),
+        tags=_split_csv(tag_filters),
+        skip_tags=_split_csv(skip_tag_filters),
+        priority_max=priority_max,
+        cache=cache_policy,
+        list_only=list_only,
+    )
+
+
 @cli.command()
+@_plan_options
+@click.option("--list", "list_only", is_flag=True, help="List matched cases without running.")
+@click.pass_obj
+def run(
+    state: CliState,
+    plan_path: Optional[str],
+    backend: Optional[str],
+    chip: Optional[str],
+    report_format: Optional[str],
+    report_path: Optional[str],
+    no_color: bool,
+    case_filters: Optional[str],
+    tag_filters: Optional[str],
+    skip_tag_filters: Optional[str],
+    priority_max: Optional[int],
+    cache_policy: Optional[str],
+    list_only: bool,
+) -> None:
+    """Execute operator test cases defined via CLI or plan files."""
+
+    assert plan_path  # required by click
+    options = _plan_selection(
+        backend, chip, case_filters, tag_filters, skip_tag_filters, priority_max, cache_policy, list_only
+    )
+    try:
+        plan = load_plan(plan_path)
+        exit_code = run_plan(
+            plan,
+            options,
+            report_format=report_format or "terminal",
+            report_path=report_path,
+            use_color=not no_color,
+        )
+    except Exception as exc:  # pragma: no cover - CLI error translation
+        raise click.ClickException(str(exc)) from exc
+    raise click.exceptions.Exit(exit_code)
+
+
+@cli.command()
+@_plan_options
+@_bench_options
 @click.option(
-    "--plan",
-    "--config",
-    "plan_path",
+    "--baseline",
+    "baseline_path",
     type=click.Path(exists=True, dir_okay=False),
-    required=True,
-    help="YAML plan file (new format).",
-)
-@click.option("--backend", type=str, help="Backend type to run (overrides plan when multiple are present).")
-@click.option("--chip", type=str, help="Chip identifier to run (overrides plan when multiple are present).")
-@click.option("--cases", "case_filters", type=str, help="Comma-separated case filters (supports globs).")
-@click.option("--tags", "tag_filters", type=str, help="Comma-separated tags to include.")
-@click.option("--skip-tags", "skip_tag_filters", type=str, help="Comma-separated tags to skip.")
-@click.option("--priority-max", type=int, help="Maximum priority to run.")
-@click.option("--cache", "cache_policy", type=click.Choice(["reuse", "regen"]), help="Cache policy override.")
-@click.option("--list", "list_only", is_flag=True, help="List matched cases without running.")
+    help="Earlier JSON bench report to compute speedups against.",
+)
+@click.option("--baseline-chip", type=str, help="Compute speedups against the same cases run on this chip.")
 @click.option(
-    "--report",
-    "report_format",
-    type=click.Choice(["terminal", "json"]),
-    default="terminal",
+    "--history",
+    "history_path",
+    type=click.Path(dir_okay=False),
+    help="Run history to append to [default: $OPTEST_HISTORY or .optest/history.jsonl next to the plan].",
+)
+@click.option("--no-history", is_flag=True, help="Do not record this run in the history.")
+@click.option(
+    "--ingest",
+    "ingest_paths",
+    type=click.Path(exists=True, dir_okay=False),
+    multiple=True,
+    help="Take results from JSON bench reports (e.g. matmul_bench) instead of running commands; repeatable.",
+)
+@click.option(
+    "--profile",
+    "profile_spec",
+    type=str,
+    help="Rerun slowest:N cases, or cases:GLOB[,GLOB], under a sampling profiler (folded stacks + flame graph SVG).",
+)
+@click.option(
+    "--profile-dir",
+    type=click.Path(file_okay=False),
+    default="optest_profiles",
+    show_default=True,
+    help="Directory for profile artifacts.",
+)
+@click.option(
+    "--profiler",
+    type=click.Choice(["auto", *PROFILERS]),
+    default="auto",
     show_default=True,
-    help="Report format (terminal by default).",
+    help="Sampling profiler; auto picks the first one on PATH.",
+)
+@click.option(
+    "--profile-frequency", type=click.IntRange(min=1), default=DEFAULT_FREQUENCY, show_default=True, help="Samples/s."
 )
-@click.option("--report-path", type=str, help="When --report json, write to this path.")
-@click.option("--no-color", is_flag=True, help="Disable ANSI colors in terminal output.")
+@click.option(
+    "--machine-profile",
+    type=click.Path(exists=True, dir_okay=False),
+    help="Machine profile for percent-of-peak [default: $OPTEST_MACHINE_PROFILE or ~/.optest/machine-<host>.json].",
+)
+@click.option(
+    "--cache-state",
+    type=click.Choice(["warm", "cold", "both"]),
+    default="warm",
+    envvar="OPTEST_CACHE_STATE",
+    show_default=True,
+    help="Flush caches before each timed run (cold); both reports cold next to warm.",
+)
+@click.option(
+    "--denormals",
+    type=click.FloatRange(min=0.0, max=1.0, min_open=True),
+    help="Also time every case with this fraction of its float inputs subnormal and check the outputs.",
+)
+@click.option(
+    "--ftz",
+    type=click.Choice(["off", "ftz", "daz", "on"]),
+    default="off",
+    envvar="OPTEST_FTZ",
+    show_default=True,
+    help="Ask runners to flush subnormal results (ftz), inputs (daz) or both (on), via OPTEST_FTZ / {ftz}.",
+)
+@click.option("--list", "list_only", is_flag=True, help="List matched cases without running.")
 @click.pass_obj
-def run(
+def bench(
     state: CliState,
     plan_path: Optional[str],
     backend: Optional[str],
@@ -87,28 +253,57 @@ def run(
     skip_tag_filters: Optional[str],
     priority_max: Optional[int],
     cache_policy: Optional[str],
+    warmup: int,
+    repeat: int,
+    no_verify: bool,
+    speedup_metric: Optional[str],
+    baseline_path: Optional[str],
+    baseline_chip: Optional[str],
+    history_path: Optional[str],
+    no_history: bool,
+    ingest_paths: Tuple[str, ...],
+    profile_spec: Optional[str],
+    profile_dir: str,
+    profiler: str,
+    profile_frequency: int,
+    machine_profile: Optional[str],
+    cache_state: str,
+    denormals: Optional[float],
+    ftz: str,
     list_only: bool,
 ) -> None:
-    """Execute operator test cases defined via CLI or plan files."""
+    """Time backend commands for plan cases (warmup + repeated runs)."""
 
     assert plan_path  # required by click
-    options = PlanOptions(
-        backend=backend,
-        chip=chip,
-        cases=_split_csv(case_filters),
-        tags=_split_csv(tag_filters),
-        skip_tags=_split_csv(skip_tag_filters),
-        priority_max=priority_max,
-        cache=cache_policy,
-        list_only=list_only,
+    options = _plan_selection(
+        backend, chip, case_filters, tag_filters, skip_tag_filters, priority_max, cache_policy, list_only
+    )
+    settings = BenchSettings(
+        warmup=warmup,
+        repeat=repeat,
+        verify=not no_verify,
+        cache_state=cache_state,
+        denormals=denormals,
+        ftz=ftz,
     )
     try:
         plan = load_plan(plan_path)
-        exit_code = run_plan(
+        exit_code = run_bench(
             plan,
             options,
+            settings,
+            baseline_path=baseline_path,
+            baseline_chip=baseline_chip,
+            speedup_metric=speedup_metric,
             report_format=report_format or "terminal",
             report_path=report_path,
+            history_path=None if no_history else history_path or default_history_path(plan),
+            ingest_paths=ingest_paths,
+            profile=parse_profile_spec(profile_spec) if profile_spec else None,
+            profile_dir=profile_dir,
+            profiler=profiler,
+            profile_frequency=profile_frequency,
+            machine=load_profile(machine_profile),
             use_color=not no_color,
         )
     except Exception as exc:  # pragma: no cover - CLI error translation
@@ -116,6 +311,197 @@ def run(
     raise click.exceptions.Exit(exit_code)
 
 
+@cli.command("calibrate-machine")
+@click.option(
+    "--output",
+    type=click.Path(dir_okay=False),
+    help="Profile path [default: $OPTEST_MACHINE_PROFILE or ~/.optest/machine-<host>.json].",
+)
+@click.option("--threads", type=str, help="Comma-separated thread counts [default: 1, 2, 4, ... up to all CPUs].")
+@click.option(
+    "--stream-mib", type=click.IntRange(min=1), default=256, show_default=True, help="MiB per STREAM array."
+)
+@click.option("--fma-ms", type=click.FloatRange(min=1), default=200.0, show_default=True, help="Time per FMA run.")
+@click.option("--compiler", type=str, help="C++ compiler for the microbenchmarks [default: $CXX, c++, g++, clang++].")
+@click.pass_obj
+def calibrate_machine(
+    state: CliState,
+    output: Optional[str],
+    threads: Optional[str],
+    stream_mib: int,
+    fma_ms: float,
+    compiler: Optional[str],
+) -> None:
+    """Measure memory bandwidth and peak FLOP/s; bench and report use them as ceilings."""
+
+    path = output or str(default_profile_path())
+    try:
+        counts = [int(part) for part in _split_csv(threads)] or None
+        if counts and min(counts) < 1:
+            raise ValueError("--threads must be positive")
+        profile = calibrate(threads=counts, stream_mib=stream_mib, fma_ms=fma_ms, compiler=compiler, log=click.echo)
+        save_profile(profile, path)
+    except (OSError, RuntimeError, ValueError) as exc:  # pragma: no cover - CLI error translation
+        raise click.ClickException(str(exc)) from exc
+    peaks = ", ".join(f"{dtype} {profile.peak_gflops(dtype):.1f}" for dtype in ("float32", "float64"))
+    click.echo(f"Wrote {path}: {profile.peak_gbps:.1f} GB/s triad, GFLOP/s {peaks}")
+
+
+@cli.command()
+@_plan_options
+@_bench_options
+@click.option(
+    "--train-repeat",
+    type=click.IntRange(min=1),
+    default=1,
+    show_default=True,
+    help="Training runs per case with the instrumented runner.",
+)
+@click.option("--no-lto", is_flag=True, help="Skip link-time optimization in the final build.")
+@click.pass_obj
+def pgo(
+    state: CliState,
+    plan_path: Optional[str],
+    backend: Optional[str],
+    chip: Optional[str],
+    report_format: Optional[str],
+    report_path: Optional[str],
+    no_color: bool,
+    case_filters: Optional[str],
+    tag_filters: Optional[str],
+    skip_tag_filters: Optional[str],
+    priority_max: Optional[int],
+    cache_policy: Optional[str],
+    warmup: int,
+    repeat: int,
+    no_verify: bool,
+    speedup_metric: Optional[str],
+    train_repeat: int,
+    no_lto: bool,
+) -> None:
+    """Rebuild runners with profile-guided optimization trained on plan cases."""
+
+    assert plan_path  # required by click
+    options = _plan_selection(backend, chip, case_filters, tag_filters, skip_tag_filters, priority_max, cache_policy)
+    settings = BenchSettings(warmup=warmup, repeat=repeat, verify=not no_verify)
+    try:
+        plan = load_plan(plan_path)
+        exit_code = run_pgo(
+            plan,
+            options,
+            settings,
+            training_repeat=train_repeat,
+            lto=not no_lto,
+            speedup_metric=speedup_metric,
+            report_format=report_format or "terminal",
+            report_path=report_path,
+            use_color=not no_color,
+        )
+    except Exception as exc:  # pragma: no cover - CLI error translation
+        raise click.ClickException(str(exc)) from exc
+    raise click.exceptions.Exit(exit_code)
+
+
+@cli.command()
+@click.option(
+    "--history",
+    "history_paths",
+    type=click.Path(dir_okay=False),
+    multiple=True,
+    help="Run history file(s) to read; repeat to merge [default: $OPTEST_HISTORY or .optest/history.jsonl].",
+)
+@click.option("--html", "html_output", is_flag=True, help="Write a static HTML page instead of a terminal summary.")
+@click.option(
+    "--matrix", is_flag=True, help="Join the latest run of every case across backends/chips with per-category geomeans."
+)
+@click.option("--baseline-target", type=str, help="BACKEND:CHIP the matrix speedups are relative to.")
+@click.option(
+    "--report",
+    "report_format",
+    type=click.Choice(["terminal", "json"]),
+    default="terminal",
+    show_default=True,
+    help="Matrix output format.",
+)
+@click.option("--report-path", type=click.Path(dir_okay=False), help="Write the matrix to this file.")
+@click.option(
+    "--output", type=click.Path(dir_okay=False), default="optest_report.html", show_default=True, help="HTML path."
+)
+@click.option("--metric", type=str, help="Runner metric used as latency (lower is better) instead of wall time.")
+@click.option(
+    "--window", type=click.IntRange(min=1), default=5, show_default=True, help="Earlier runs forming the baseline."
+)
+@click.option(
+    "--threshold", type=float, default=0.05, show_default=True, help="Relative change that counts as a regression."
+)
+@click.option("--since-days", type=float, help="Only read runs from the last N days.")
+@click.option(
+    "--peak-gflops", type=float, help="Compute roof of the roofline plot [default: machine profile, float32]."
+)
+@click.option("--peak-gbps", type=float, help="Memory roof of the roofline plot [default: machine profile triad].")
+@click.option(
+    "--machine-profile",
+    type=click.Path(exists=True, dir_okay=False),
+    help="Machine profile providing the roofs [default: $OPTEST_MACHINE_PROFILE or ~/.optest/machine-<host>.json].",
+)
+@click.pass_obj
+def report(
+    state: CliState,
+    history_paths: Tuple[str, ...],
+    html_output: bool,
+    matrix: bool,
+    baseline_target: Optional[str],
+    report_format: str,
+    report_path: Optional[str],
+    output: str,
+    metric: Optional[str],
+    window: int,
+    threshold: float,
+    since_days: Optional[float],
+    peak_gflops: Optional[float],
+    peak_gbps: Optional[float],
+    machine_profile: Optional[str],
+) -> None:
+    """Summarize the bench run history: regressions, cross-backend matrix, trends, distributions, roofline."""
+
+    paths = list(history_paths) or [str(default_history_path())]
+    since = time.time() - since_days * 86400 if since_days is not None else None
+    try:
+        if matrix and not html_output:
+            raise click.exceptions.Exit(
+                print_matrix(
+                    paths,
+                    metric=metric,
+                    baseline=baseline_target,
+                    since=since,
+                    report_format=report_format,
+                    report_path=report_path,
+                )
+            )
+        if not html_output:
+            raise click.exceptions.Exit(
+                print_regressions(paths, metric=metric, window=window, threshold=threshold, since=since)
+            )
+        machine = load_profile(machine_profile)
+        if machine is not None:
+            peak_gflops = peak_gflops or machine.peak_gflops("float32")
+            peak_gbps = peak_gbps or machine.peak_gbps
+        count = write_html_report(
+            paths,
+            output,
+            metric=metric,
+            window=window,
+            threshold=threshold,
+            since=since,
+            peak_gflops=peak_gflops,
+            peak_gbps=peak_gbps,
+            baseline=baseline_target,
+        )
+    except (OSError, ValueError) as exc:  # pragma: no cover - CLI error translation
+        raise click.ClickException(str(exc)) from exc
+    click.echo(f"Wrote {output} ({count} cases)")
+
+
 def _parse_dtype_option(value: Optional[str]) -> Optional[Tuple[str, ...]]:
     if not value:
         return None
@@ -0,0 +1,23 @@
+"""Machine calibration: measured bandwidth and FLOP ceilings of the host."""
+
+from .calibration import (
+    MachineProfile,
+    calibrate,
+    default_profile_path,
+    last_level_cache_bytes,
+    load_profile,
+    percent_of_peak,
+    rates,
+    save_profile,
+)
+
+__all__ = [
+    "MachineProfile",
+    "calibrate",
+    "default_profile_path",
+    "last_level_cache_bytes",
+    "load_profile",
+    "percent_of_peak",
+    "rates",
+    "save_profile",
+]
@@ -0,0 +1,260 @@
+"""Measured machine ceilings (``optest calibrate-machine``).
+
+The packaged ``microbench.cpp`` is compiled once per compiler and source
+version into the user cache, then run for every thread count: STREAM copy/triad
+unpinned (the bandwidth ceiling) and, when ``numactl`` is available and the host
+has several NUMA nodes, pinned to each node; and multiply-add peak loops per ISA
+and dtype. The results form a machine profile, a JSON file stored per host;
+benchmark reports load it automatically to express runner rates as percent of
+the measured peak.
+"""
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import platform
+import shutil
+import subprocess
+import time
+from dataclasses import asdict, dataclass, field
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Mapping, Optional, Sequence, Tuple
+
+PROFILE_ENV = "OPTEST_MACHINE_PROFILE"
+SOURCE = Path(__file__).with_name("microbench.cpp")
+DTYPES = ("float32", "float64")
+CALIB_PREFIX = "OPTEST_CALIB"
+
+
+@dataclass
+class MachineProfile:
+    """Best measured rates; ``bandwidth`` and ``flops`` keep every individual measurement."""
+
+    host: str
+    created: float
+    cpu: str
+    cores: int
+    isas: List[str] = field(default_factory=list)
+    numa_nodes: List[int] = field(default_factory=list)
+    bandwidth: List[Dict[str, Any]] = field(default_factory=list)  # {op, threads, node, gbps}
+    flops: List[Dict[str, Any]] = field(default_factory=list)  # {isa, dtype, threads, gflops}
+
+    @property
+    def peak_gbps(self) -> Optional[float]:
+        """Best unpinned triad bandwidth (the usual roofline memory ceiling), spanning every NUMA node.
+
+        Per-node measurements only bound runners pinned to one node, so they are used only when a profile has no
+        unpinned run.
+        """
+
+        triad = [item for item in self.bandwidth if item["op"] == "triad"]
+        rates = [item["gbps"] for item in triad if item.get("node") is None] or [item["gbps"] for item in triad]
+        return max(rates) if rates else None
+
+    def peak_gflops(self, dtype: str = "float32") -> Optional[float]:
+        rates = [item["gflops"] for item in self.flops if item["dtype"] == dtype]
+        return max(rates) if rates else None
+
+
+def default_profile_path() -> Path:
+    """``$OPTEST_MACHINE_PROFILE``, else ``~/.optest/machine-<host>.json``."""
+
+    if os.environ.get(PROFILE_ENV):
+        return Path(os.environ[PROFILE_ENV])
+    return Path.home() / ".optest" / f"machine-{platform.node() or 'localhost'}.json"
+
+
+def load_profile(path: str | Path | None = None) -> Optional[MachineProfile]:
+    """The stored profile, or None when there is none (reports then skip percent-of-peak)."""
+
+    target = Path(path) if path is not None else default_profile_path()
+    if not target.exists():
+        return None
+    data = json.loads(target.read_text(encoding="utf-8"))
+    return MachineProfile(**{key: data[key] for key in MachineProfile.__dataclass_fields__ if key in data})
+
+
+def save_profile(profile: MachineProfile, path: str | Path) -> None:
+    target = Path(path)
+    target.parent.mkdir(parents=True, exist_ok=True)
+    payload = asdict(profile)
+    payload["peak_gbps"] = profile.peak_gbps
+    payload["peak_gflops"] = {dtype: profile.peak_gflops(dtype) for dtype in DTYPES}
+    target.write_text(json.dumps(payload, indent=2), encoding="utf-8")
+
+
+def rates(metrics: Mapping[str, float]) -> Tuple[Optional[float], Optional[float]]:
+    """(GFLOP/s, GB/s) reported by a runner: ``gflops``/``tflops`` and a ``*gbps`` metric, or per-call
+    ``flops``/``bytes`` next to ``kernel_ms``."""
+
+    gflops = metrics.get("gflops") or (metrics["tflops"] * 1e3 if "tflops" in metrics else None)
+    gbps = next((value for key, value in metrics.items() if key.endswith("gbps")), None)
+    kernel_ms = metrics.get("kernel_ms")
+    if kernel_ms and gflops is None and "flops" in metrics:
+        gflops = metrics["flops"] / kernel_ms / 1e6
+    if kernel_ms and gbps is None and "bytes" in metrics:
+        gbps = metrics["bytes"] / kernel_ms / 1e6
+    return gflops, gbps
+
+
+def percent_of_peak(metrics: Mapping[str, float], profile: MachineProfile, dtype: str = "float32") -> Dict[str, float]:
+    """Runner rates as percent of the machine ceilings (FLOP peak of ``dtype``, float32 for other dtypes)."""
+
+    gflops, gbps = rates(metrics)
+    peak_flops = profile.peak_gflops(dtype if dtype in DTYPES else "float32")
+    found: Dict[str, float] = {}
+    if gflops and peak_flops:
+        found["gflops"] = 100.0 * gflops / peak_flops
+    if gbps and profile.peak_gbps:
+        found["gbps"] = 100.0 * gbps / profile.peak_gbps
+    return found
+
+
+def default_thread_counts() -> List[int]:
+    cores = os.cpu_count() or 1
+    counts = [1]
+    while counts[-1] * 2 < cores:
+        counts.append(counts[-1] * 2)
+    return counts + ([cores] if cores > 1 else [])
+
+
+def last_level_cache_bytes() -> int:
+    """Largest data/unified cache of CPU 0 from sysfs (32 MiB when unknown)."""
+
+    largest = 0
+    for index in Path("/sys/devices/system/cpu/cpu0/cache").glob("index[0-9]*"):
+        try:
+            kind = (index / "type").read_text(encoding="utf-8").strip()
+            size = (index / "size").read_text(encoding="utf-8").strip()
+        except OSError:
+            continue
+        if kind == "Instruction" or not size:
+            continue
+        scale = {"K": 1 << 10, "M": 1 << 20}.get(size[-1], 1)
+        largest = max(largest, int(size.rstrip("KM")) * scale)
+    return largest or 32 << 20
+
+
+def numa_nodes() -> Dict[int, int]:
+    """NUMA node -> CPU count, only when there are several nodes and ``numactl`` can pin to them."""
+
+    root = Path("/sys/devices/system/node")
+    nodes: Dict[int, int] = {}
+    for entry in sorted(root.glob("node[0-9]*")):
+        cpulist = entry / "cpulist"
+        if cpulist.exists():
+            nodes[int(entry.name[4:])] = _count_cpus(cpulist.read_text(encoding="utf-8"))
+    if len(nodes) < 2 or not shutil.which("numactl"):
+        return {}
+    return nodes
+
+
+def _count_cpus(cpulist: str) -> int:
+    # "0-11,24-35" -> 24
+    count = 0
+    for part in cpulist.strip().split(","):
+        if part:
+            first, _, last = part.partition("-")
+            count += int(last or first) - int(first) + 1
+    return count
+
+
+def build_microbench(compiler: str | None = None) -> Path:
+    """Compile ``microbench.cpp`` into the user cache (reused while source and compiler are unchanged)."""
+
+    cxx = compiler or os.environ.get("CXX") or next(
+        (name for name in ("c++", "g++", "clang++") if shutil.which(name)), None
+    )
+    if cxx is None:
+        raise RuntimeError("No C++ compiler found (set CXX or pass --compiler)")
+    flags = ["-O2", "-std=c++17", "-ffp-contract=fast", "-pthread"]
+    digest = hashlib.sha256(SOURCE.read_bytes() + " ".join([cxx, *flags]).encode("utf-8")).hexdigest()[:16]
+    cache_root = Path(os.environ.get("XDG_CACHE_HOME") or Path.home() / ".cache")
+    binary = cache_root / "optest" / "microbench" / digest / "microbench"
+    if not binary.exists():
+        binary.parent.mkdir(parents=True, exist_ok=True)
+        partial = binary.with_suffix(".tmp")
+        proc = subprocess.run([cxx, *flags, str(SOURCE), "-o", str(partial)], capture_output=True, text=True)
+        if proc.returncode != 0:
+            raise RuntimeError(f"Building the microbenchmark failed: {proc.stderr.strip()}")
+        partial.replace(binary)
+    return binary
+
+
+def parse_calibration(text: str) -> List[Dict[str, Any]]:
+    records = []
+    for line in text.splitlines():
+        parts = line.split()
+        if not parts or parts[0] != CALIB_PREFIX:
+            continue
+        record: Dict[str, Any] = {}
+        for item in parts[1:]:
+            key, _, value = item.partition("=")
+            try:
+                record[key] = int(value) if value.isdigit() else float(value)
+            except ValueError:
+                record[key] = value
+        records.append(record)
+    return records
+
+
+def calibrate(
+    *,
+    threads: Sequence[int] | None = None,
+    stream_mib: int = 256,
+    stream_reps: int = 5,
+    fma_ms: float = 200.0,
+    compiler: str | None = None,
+    log: Callable[[str], None] = print,
+) -> MachineProfile:
+    """Run every microbenchmark and collect the results into a profile."""
+
+    binary = build_microbench(compiler)
+    counts = list(threads or default_thread_counts())
+
+    def run(args: Sequence[str], prefix: Sequence[str] = ()) -> List[Dict[str, Any]]:
+        proc = subprocess.run([*prefix, str(binary), *args], capture_output=True, text=True)
+        if proc.returncode != 0:
+            raise RuntimeError(f"microbench {' '.join(args)} failed: {proc.stderr.strip()}")
+        return parse_calibration(proc.stdout)
+
+    isas = [record["isa"] for record in run(["isas"])]
+    nodes = numa_nodes()
+    profile = MachineProfile(
+        host=platform.node(),
+        created=time.time(),
+        cpu=_cpu_model(),
+        cores=os.cpu_count() or 1,
+        isas=isas,
+        numa_nodes=sorted(nodes),
+    )
+    # The unpinned run gives the whole-machine ceiling; per-node runs show what one socket sustains on its own.
+    placements: List[Tuple[Optional[int], Sequence[str], int]] = [(None, (), profile.cores)] + [
+        (node, ["numactl", f"--cpunodebind={node}", f"--membind={node}"], cpus) for node, cpus in nodes.items()
+    ]
+    for node, prefix, cpus in placements:
+        for count in sorted({min(count, cpus) for count in counts}):
+            for record in run(["stream", "--threads", str(count), "--mib", str(stream_mib), "--reps", str(stream_reps)],
+                              prefix):
+                entry = {"op": record["op"], "threads": count, "node": node, "gbps": record["gbps"]}
+                profile.bandwidth.append(entry)
+                log(f"[calibrate] stream {entry['op']:<5} threads={count:<3} node={node} {entry['gbps']:.1f} GB/s")
+    for isa in isas:
+        for dtype in DTYPES:
+            for count in counts:
+                args = ["fma", "--threads", str(count), "--isa", isa, "--dtype", dtype, "--ms", str(fma_ms)]
+                for record in run(args):
+                    entry = {"isa": isa, "dtype": dtype, "threads": count, "gflops": record["gflops"]}
+                    profile.flops.append(entry)
+                    log(f"[calibrate] fma {isa:<7} {dtype} threads={count:<3} {entry['gflops']:.1f} GFLOP/s")
+    return profile
+
+
+def _cpu_model() -> str:
+    cpuinfo = Path("/proc/cpuinfo")
+    if cpuinfo.exists():
+        for line in cpuinfo.read_text(encoding="utf-8", errors="replace").splitlines():
+            if line.startswith("model name"):
+                return line.partition(":")[2].strip()
+    return platform.processor() or platform.machine()
@@ -0,0 +1,249 @@
+// Machine-ceiling microbenchmarks for `optest calibrate-machine`.
+//
+//   microbench isas
+//   microbench stream --threads 4 --mib 256 --reps 5
+//   microbench fma --threads 4 --isa avx2 --dtype float32 --ms 200
+//
+// Results are printed as `OPTEST_CALIB key=value ...` lines.
+//
+// stream: STREAM-style copy (c = a) and triad (a = b + s * c) over double arrays of
+//   --mib MiB each, split into one contiguous chunk per thread. Every thread first
+//   touches its own chunk, so pages land on the NUMA node it runs on (the caller pins
+//   the process with numactl per node). Bytes follow the STREAM convention (copy 16,
+//   triad 24 bytes per element; write-allocate traffic not counted); best of --reps.
+// fma: every thread runs a loop of independent multiply-add chains on GCC/Clang vector
+//   types, enough of them to cover FMA latency on two pipes. The ISA variants are
+//   compiled with target attributes and picked at run time, so one binary covers every
+//   x86 level the CPU supports; other architectures get a portable 128-bit variant.
+//   FLOPs count 2 per lane per multiply-add (fused or not).
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kChains = 12;  // independent accumulators: latency 4-6 x 2 FMA pipes
+
+template <typename F>
+double timed_parallel(unsigned threads, F&& body) {
+    std::vector<std::thread> pool;
+    const auto start = Clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back(body, t);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// ---- stream -------------------------------------------------------------------------
+
+void run_stream(unsigned threads, std::size_t mib, int reps) {
+    const std::size_t n = mib * (std::size_t{1} << 20) / sizeof(double);
+    // Plain new[]: no value-initialization, so the first write happens in the owning thread.
+    double* a = new double[n];
+    double* b = new double[n];
+    double* c = new double[n];
+    const std::size_t chunk = (n + threads - 1) / threads;
+    const auto range = [&](unsigned t) {
+        const std::size_t begin = std::min(n, t * chunk);
+        return std::make_pair(begin, std::min(n, begin + chunk));
+    };
+    timed_parallel(threads, [&](unsigned t) {
+        const auto [begin, end] = range(t);
+        for (std::size_t i = begin; i < end; ++i) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.0;
+        }
+    });
+    const double scalar = 3.0;
+    double best_copy = 1e30;
+    double best_triad = 1e30;
+    for (int rep = 0; rep < reps; ++rep) {
+        best_copy = std::min(best_copy, timed_parallel(threads, [&](unsigned t) {
+                                 const auto [begin, end] = range(t);
+                                 for (std::size_t i = begin; i < end; ++i) {
+                                     c[i] = a[i];
+                                 }
+                             }));
+        best_triad = std::min(best_triad, timed_parallel(threads, [&](unsigned t) {
+                                  const auto [begin, end] = range(t);
+                                  for (std::size_t i = begin; i < end; ++i) {
+                                      a[i] = b[i] + scalar * c[i];
+                                  }
+                              }));
+    }
+    volatile double sink = a[n / 2] + c[n / 3];
+    (void)sink;
+    std::printf("OPTEST_CALIB kind=stream op=copy threads=%u mib=%zu gbps=%.3f\n", threads, mib,
+                2.0 * sizeof(double) * n / best_copy / 1e9);
+    std::printf("OPTEST_CALIB kind=stream op=triad threads=%u mib=%zu gbps=%.3f\n", threads, mib,
+                3.0 * sizeof(double) * n / best_triad / 1e9);
+    delete[] a;
+    delete[] b;
+    delete[] c;
+}
+
+// ---- fma ----------------------------------------------------------------------------
+
+template <typename T, int Bytes>
+__attribute__((always_inline)) inline T fma_chains(std::size_t iters) {
+    typedef T V __attribute__((vector_size(Bytes)));
+    V acc[kChains];
+    V mul;
+    V add;
+    for (int lane = 0; lane < Bytes / static_cast<int>(sizeof(T)); ++lane) {
+        mul[lane] = static_cast<T>(0.9999999);
+        add[lane] = static_cast<T>(1e-7);
+    }
+    for (int j = 0; j < kChains; ++j) {
+        acc[j] = add * static_cast<T>(j + 1);
+    }
+    for (std::size_t i = 0; i < iters; ++i) {
+#pragma GCC unroll 16  // keeps every chain in a register
+        for (int j = 0; j < kChains; ++j) {
+            acc[j] = acc[j] * mul + add;
+        }
+    }
+    T sum = 0;
+    for (int j = 0; j < kChains; ++j) {
+        for (int lane = 0; lane < Bytes / static_cast<int>(sizeof(T)); ++lane) {
+            sum += acc[j][lane];
+        }
+    }
+    return sum;
+}
+
+using FmaFn = double (*)(std::size_t);
+
+struct FmaVariant {
+    const char* isa;
+    const char* dtype;
+    int lanes;
+    FmaFn fn;
+    bool (*supported)();
+};
+
+double generic_f32(std::size_t iters) { return fma_chains<float, 16>(iters); }
+double generic_f64(std::size_t iters) { return fma_chains<double, 16>(iters); }
+bool always() { return true; }
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma"))) double avx2_f32(std::size_t iters) { return fma_chains<float, 32>(iters); }
+__attribute__((target("avx2,fma"))) double avx2_f64(std::size_t iters) { return fma_chains<double, 32>(iters); }
+__attribute__((target("avx512f"))) double avx512_f32(std::size_t iters) { return fma_chains<float, 64>(iters); }
+__attribute__((target("avx512f"))) double avx512_f64(std::size_t iters) { return fma_chains<double, 64>(iters); }
+bool has_avx2() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+bool has_avx512() { return __builtin_cpu_supports("avx512f"); }
+constexpr const char* kBaseIsa = "sse2";
+#else
+constexpr const char* kBaseIsa = "generic";
+#endif
+
+const std::vector<FmaVariant>& variants() {
+    static const std::vector<FmaVariant> all = {
+        {kBaseIsa, "float32", 4, generic_f32, always},
+        {kBaseIsa, "float64", 2, generic_f64, always},
+#if defined(__x86_64__) || defined(__i386__)
+        {"avx2", "float32", 8, avx2_f32, has_avx2},
+        {"avx2", "float64", 4, avx2_f64, has_avx2},
+        {"avx512", "float32", 16, avx512_f32, has_avx512},
+        {"avx512", "float64", 8, avx512_f64, has_avx512},
+#endif
+    };
+    return all;
+}
+
+void run_fma(unsigned threads, const std::string& isa, const std::string& dtype, double ms) {
+    const FmaVariant* variant = nullptr;
+    for (const auto& item : variants()) {
+        if (isa == item.isa && dtype == item.dtype && item.supported()) {
+            variant = &item;
+        }
+    }
+    if (variant == nullptr) {
+        throw std::runtime_error("unsupported isa/dtype on this CPU: " + isa + "/" + dtype);
+    }
+    // Size the loop on one thread, then time all threads running it together.
+    std::size_t iters = 1 << 14;
+    for (;;) {
+        const auto start = Clock::now();
+        volatile double sink = variant->fn(iters);
+        (void)sink;
+        const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (elapsed >= ms / 4 || iters >= (std::size_t{1} << 40)) {
+            iters = static_cast<std::size_t>(iters * std::max(1.0, ms / std::max(elapsed, 1e-3)));
+            break;
+        }
+        iters *= 4;
+    }
+    double best = 1e30;
+    for (int rep = 0; rep < 3; ++rep) {
+        best = std::min(best, timed_parallel(threads, [&](unsigned) {
+                            volatile double sink = variant->fn(iters);
+                            (void)sink;
+                        }));
+    }
+    const double flops = 2.0 * kChains * variant->lanes * static_cast<double>(iters) * threads;
+    std::printf("OPTEST_CALIB kind=fma isa=%s dtype=%s threads=%u gflops=%.3f\n", variant->isa, variant->dtype,
+                threads, flops / best / 1e9);
+}
+
+// ---- main ---------------------------------------------------------------------------
+
+const char* option(int argc, char** argv, const char* name, const char* fallback) {
+    for (int i = 2; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return fallback;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const std::string mode = argc > 1 ? argv[1] : "";
+        const unsigned threads = static_cast<unsigned>(std::max(1L, std::atol(option(argc, argv, "--threads", "1"))));
+        if (mode == "isas") {
+            std::string seen;
+            for (const auto& item : variants()) {
+                if (item.supported() && seen.find(std::string(item.isa) + " ") == std::string::npos) {
+                    seen += std::string(item.isa) + " ";
+                    std::printf("OPTEST_CALIB kind=isa isa=%s\n", item.isa);
+                }
+            }
+        } else if (mode == "stream") {
+            const long mib = std::atol(option(argc, argv, "--mib", "256"));
+            const int reps = std::atoi(option(argc, argv, "--reps", "5"));
+            if (mib < 1 || reps < 1) {
+                throw std::runtime_error("--mib and --reps must be positive");
+            }
+            run_stream(threads, static_cast<std::size_t>(mib), reps);
+        } else if (mode == "fma") {
+            run_fma(threads, option(argc, argv, "--isa", kBaseIsa), option(argc, argv, "--dtype", "float32"),
+                    std::atof(option(argc, argv, "--ms", "200")));
+        } else {
+            throw std::runtime_error("usage: microbench isas | stream [--threads N --mib M --reps R] | "
+                                     "fma [--threads N --isa ISA --dtype float32|float64 --ms MS]");
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "microbench failed: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
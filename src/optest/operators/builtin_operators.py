@@ -31,6 +31,11 @@ POOL_DTYPES = UNARY_FLOAT_DTYPES
 ACTIVATION_DTYPES = UNARY_ELEMENTWISE_DTYPES
 REDUCTION_DTYPES = UNARY_ELEMENTWISE_DTYPES
 REDUCTION_FLOAT_DTYPES = UNARY_FLOAT_DTYPES
+SELECTION_DTYPES = UNARY_FLOAT_DTYPES + (("int32",),)
+INDEX_DTYPES = ("int32", "int64")
+GATHER_DTYPES = tuple((dtype, index) for dtype in COMMON_FLOAT_DTYPES for index in INDEX_DTYPES)
+SCATTER_DTYPES = tuple((dtype, index, dtype) for dtype in COMMON_FLOAT_DTYPES for index in INDEX_DTYPES)
+EMBEDDING_BAG_DTYPES = tuple((dtype, index, index) for dtype in COMMON_FLOAT_DTYPES for index in INDEX_DTYPES)
 
 
 class BuiltinOperator:
@@ -44,6 +49,9 @@ class BuiltinOperator:
     description: str = ""
     tags: tuple = ()
     default_tolerance: Tolerance = Tolerance()
+    # Outputs holding positions along ``attrs["axis"]`` of input 0. They are checked through
+    # the input values they select, so a backend may break ties differently.
+    index_outputs: tuple = ()
 
     @classmethod
     def reference_path(cls) -> str:
@@ -63,6 +71,31 @@ class BuiltinOperator:
             default_reference=cls.reference_path(),
         )
 
+    @classmethod
+    def indexed_values(cls, inputs: ArraySeq, indices: np.ndarray, attrs: AttrMap) -> np.ndarray:
+        """Values of input 0 selected by an index output; raises ValueError on invalid indices."""
+
+        x = np.asarray(inputs[0])
+        idx = np.asarray(indices)
+        if not np.issubdtype(idx.dtype, np.integer):
+            raise ValueError(f"indices must be integers, got {idx.dtype}")
+        axis = _axis(attrs, x.ndim)
+        if idx.ndim == x.ndim - 1:
+            idx = np.expand_dims(idx, axis)
+        extent = x.shape[axis]
+        if idx.size and (int(idx.min()) < 0 or int(idx.max()) >= extent):
+            raise ValueError(f"indices out of range [0, {extent})")
+        if idx.ndim == x.ndim and idx.shape[axis] > 1:
+            if np.any(np.diff(np.sort(idx, axis=axis), axis=axis) == 0):
+                raise ValueError("indices repeat an element")
+        return np.take_along_axis(x, idx.astype(np.intp), axis=axis)
+
+    @classmethod
+    def tolerance(cls, inputs: ArraySeq, attrs: AttrMap) -> Tolerance:
+        """Tolerance for these inputs; operators whose error grows with the problem size override this."""
+
+        return cls.default_tolerance
+
 
 class ElementwiseAdd(BuiltinOperator):
     name = "elementwise_add"
@@ -329,6 +362,59 @@ class ReduceMean(BuiltinOperator):
         return (np.mean(x, axis=axis, keepdims=keepdims),)
 
 
+class CumSum(BuiltinOperator):
+    name = "cumsum"
+    num_inputs = 1
+    dtype_variants = REDUCTION_DTYPES
+    category = "scan"
+    attribute_names = ("axis", "exclusive")
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        """Inclusive (or ``exclusive``) prefix sum, accumulated in float64 / int64 and cast back."""
+
+        (x,) = inputs
+        return (_scan(np.cumsum, x, attrs, identity=0),)
+
+    @classmethod
+    def tolerance(cls, inputs: ArraySeq, attrs: AttrMap) -> Tolerance:
+        # A length-n scan in the input dtype differs from the exact sum by up to ~n * eps * max|x|,
+        # whatever order (sequential, blocked, tree) the backend adds in.
+        x = np.asarray(inputs[0])
+        if not np.issubdtype(x.dtype, np.floating) or x.size == 0:
+            return Tolerance(absolute=0.0, relative=0.0)
+        length = x.shape[_axis(attrs, x.ndim)] if x.ndim else 1
+        bound = 2.0 * float(np.finfo(x.dtype).eps) * length * float(np.max(np.abs(x)))
+        default = cls.default_tolerance
+        return Tolerance(absolute=max(default.absolute, bound), relative=default.relative)
+
+
+class CumProd(BuiltinOperator):
+    name = "cumprod"
+    num_inputs = 1
+    dtype_variants = REDUCTION_DTYPES
+    category = "scan"
+    attribute_names = ("axis", "exclusive")
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        (x,) = inputs
+        return (_scan(np.cumprod, x, attrs, identity=1),)
+
+    @classmethod
+    def tolerance(cls, inputs: ArraySeq, attrs: AttrMap) -> Tolerance:
+        # Each multiply adds at most eps of relative error, so prefix k is within ~k * eps.
+        x = np.asarray(inputs[0])
+        if not np.issubdtype(x.dtype, np.floating) or x.size == 0:
+            return Tolerance(absolute=0.0, relative=0.0)
+        length = x.shape[_axis(attrs, x.ndim)] if x.ndim else 1
+        default = cls.default_tolerance
+        return Tolerance(
+            absolute=default.absolute,
+            relative=max(default.relative, 2.0 * float(np.finfo(x.dtype).eps) * length),
+        )
+
+
 class BroadcastTo(BuiltinOperator):
     name = "broadcast_to"
     num_inputs = 1
@@ -345,6 +431,190 @@ class BroadcastTo(BuiltinOperator):
         return (np.broadcast_to(x, target_shape),)
 
 
+class TopK(BuiltinOperator):
+    name = "topk"
+    num_inputs = 1
+    dtype_variants = SELECTION_DTYPES
+    category = "selection"
+    attribute_names = ("k", "axis", "largest")
+    index_outputs = (1,)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        (x,) = inputs
+        largest = bool(attrs.get("largest", True))
+        return topk(x, int(attrs.get("k", 1)), axis=_axis(attrs, np.ndim(x)), largest=largest)
+
+
+class ArgMax(BuiltinOperator):
+    name = "argmax"
+    num_inputs = 1
+    dtype_variants = SELECTION_DTYPES
+    category = "selection"
+    attribute_names = ("axis", "keepdims")
+    index_outputs = (0,)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        (x,) = inputs
+        keepdims = bool(attrs.get("keepdims", False))
+        return (np.argmax(x, axis=_axis(attrs, np.ndim(x)), keepdims=keepdims),)
+
+
+class ArgMin(BuiltinOperator):
+    name = "argmin"
+    num_inputs = 1
+    dtype_variants = SELECTION_DTYPES
+    category = "selection"
+    attribute_names = ("axis", "keepdims")
+    index_outputs = (0,)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        (x,) = inputs
+        keepdims = bool(attrs.get("keepdims", False))
+        return (np.argmin(x, axis=_axis(attrs, np.ndim(x)), keepdims=keepdims),)
+
+
+class Sort(BuiltinOperator):
+    name = "sort"
+    num_inputs = 1
+    dtype_variants = SELECTION_DTYPES
+    category = "selection"
+    attribute_names = ("axis", "descending", "stable")
+    default_tolerance = Tolerance(absolute=0.0, relative=0.0)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        """Values in IEEE total order (-NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN)."""
+
+        (x,) = inputs
+        x = np.asarray(x)
+        return (np.take_along_axis(x, argsort(x, **_sort_options(attrs, x.ndim)), axis=_axis(attrs, x.ndim)),)
+
+
+class ArgSort(BuiltinOperator):
+    name = "argsort"
+    num_inputs = 1
+    dtype_variants = SELECTION_DTYPES
+    category = "selection"
+    attribute_names = ("axis", "descending", "stable")
+    default_tolerance = Tolerance(absolute=0.0, relative=0.0)
+    index_outputs = (0,)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        (x,) = inputs
+        x = np.asarray(x)
+        return (argsort(x, **_sort_options(attrs, x.ndim)),)
+
+    @classmethod
+    def indexed_values(cls, inputs: ArraySeq, indices: np.ndarray, attrs: AttrMap) -> np.ndarray:
+        values = super().indexed_values(inputs, indices, attrs)  # also rejects non-permutations
+        # A stable sort has exactly one answer, so compare the indices themselves.
+        return np.asarray(indices) if attrs.get("stable", False) else values
+
+
+class Gather(BuiltinOperator):
+    name = "gather"
+    num_inputs = 2
+    dtype_variants = GATHER_DTYPES
+    category = "indexing"
+    attribute_names = ("axis",)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        data, indices = inputs
+        axis = _axis(attrs, np.ndim(data)) if "axis" in attrs else 0
+        return (np.take(data, _checked_indices(indices, np.shape(data)[axis]), axis=axis),)
+
+
+class ScatterAdd(BuiltinOperator):
+    name = "scatter_add"
+    num_inputs = 3
+    dtype_variants = SCATTER_DTYPES
+    category = "indexing"
+    default_tolerance = Tolerance(absolute=1e-4, relative=1e-4)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        """``out = data; out[indices[i]] += updates[i]`` along axis 0 (duplicates accumulate)."""
+
+        data, indices, updates = inputs
+        out = np.array(data, copy=True)
+        idx = _checked_indices(indices, out.shape[0]).reshape(-1)
+        updates = np.asarray(updates).reshape((idx.size,) + out.shape[1:])
+        if idx.size:
+            # Sort once and reduce each run of equal indices, instead of the unbuffered np.add.at.
+            order = np.argsort(idx, kind="stable")
+            sorted_idx = idx[order]
+            starts = np.flatnonzero(np.r_[True, sorted_idx[1:] != sorted_idx[:-1]])
+            out[sorted_idx[starts]] += np.add.reduceat(updates[order], starts, axis=0)
+        return (out,)
+
+
+class EmbeddingBag(BuiltinOperator):
+    name = "embedding_bag"
+    num_inputs = 3
+    dtype_variants = EMBEDDING_BAG_DTYPES
+    category = "indexing"
+    attribute_names = ("mode",)
+    default_tolerance = Tolerance(absolute=1e-4, relative=1e-4)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        """Reduce ``weight[indices]`` per bag; bag ``b`` spans ``indices[offsets[b]:offsets[b + 1]]``."""
+
+        weight, indices, offsets = inputs
+        mode = str(attrs.get("mode", "sum"))
+        if mode not in {"sum", "mean", "max"}:
+            raise ValueError(f"embedding_bag mode must be sum, mean or max, got '{mode}'")
+        weight = np.asarray(weight)
+        idx = _checked_indices(indices, weight.shape[0]).reshape(-1)
+        offsets = np.asarray(offsets, dtype=np.int64).reshape(-1)
+        if offsets.size and (offsets[0] != 0 or np.any(np.diff(offsets) < 0) or offsets[-1] > idx.size):
+            raise ValueError("embedding_bag offsets must start at 0, be non-decreasing and within the indices")
+        out = np.zeros((offsets.size,) + weight.shape[1:], dtype=weight.dtype)
+        lengths = np.diff(np.r_[offsets, idx.size])
+        filled = lengths > 0
+        if idx.size and filled.any():
+            rows = np.take(weight, idx, axis=0)
+            reduce = np.maximum if mode == "max" else np.add
+            out[filled] = reduce.reduceat(rows, offsets[filled], axis=0)
+            if mode == "mean":
+                out[filled] /= lengths[filled].reshape((-1,) + (1,) * (weight.ndim - 1)).astype(weight.dtype)
+        return (out,)
+
+
+class Transpose(BuiltinOperator):
+    name = "transpose"
+    num_inputs = 1
+    dtype_variants = ACTIVATION_DTYPES
+    category = "layout"
+    attribute_names = ("perm",)
+    default_tolerance = Tolerance(absolute=0.0, relative=0.0)
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        """``out.shape[k] == x.shape[perm[k]]``; ``perm`` defaults to reversing the axes.
+
+        Returns a view of the (memory-mapped) input: the golden is never materialized.
+        """
+
+        (x,) = inputs
+        return (np.transpose(x, _permutation(attrs, np.ndim(x))),)
+
+
+class Permute(Transpose):
+    name = "permute"
+
+    @staticmethod
+    def run(inputs: ArraySeq, attrs: AttrMap) -> ArraySeq:
+        if attrs.get("perm") is None:
+            raise ValueError("permute requires 'perm' attribute")
+        return Transpose.run(inputs, attrs)
+
+
 class MaxPool2d(BuiltinOperator):
     name = "maxpool2d"
     num_inputs = 1
@@ -431,6 +701,106 @@ class Conv2d(BuiltinOperator):
         return (output,)
 
 
+def topk(x: np.ndarray, k: int, *, axis: int = -1, largest: bool = True) -> tuple[np.ndarray, np.ndarray]:
+    """Top-``k`` values and int64 indices along ``axis``, best first.
+
+    ``np.argpartition`` selects the candidates in linear time; only the ``k`` winners
+    are sorted (equal values by index), so the cost is O(n + k log k) per row instead
+    of a full sort. Which of several equal values at the cut is selected is unspecified,
+    which is why ``TopK`` compares its indices tie-aware.
+    """
+
+    x = np.asarray(x)
+    axis = axis % x.ndim
+    extent = x.shape[axis]
+    if not 0 < k <= extent:
+        raise ValueError(f"topk k={k} must be within [1, {extent}]")
+    if k == extent:
+        candidates = np.broadcast_to(
+            np.arange(extent).reshape([-1 if dim == axis else 1 for dim in range(x.ndim)]), x.shape
+        )
+    else:
+        kth = extent - k if largest else k - 1
+        part = np.argpartition(x, kth, axis=axis)
+        candidates = np.take(part, range(extent - k, extent) if largest else range(k), axis=axis)
+    # Order the winners by value with ties to the lower index: a stable sort over ascending
+    # indices, run on the reversed order (then reversed back) when the largest come first.
+    candidates = np.sort(candidates, axis=axis)
+    if largest:
+        candidates = np.flip(candidates, axis=axis)
+    order = np.argsort(np.take_along_axis(x, candidates, axis=axis), axis=axis, kind="stable")
+    indices = np.take_along_axis(candidates, order, axis=axis)
+    if largest:
+        indices = np.flip(indices, axis=axis)
+    indices = np.ascontiguousarray(indices, dtype=np.int64)
+    return np.take_along_axis(x, indices, axis=axis), indices
+
+
+def sort_keys(x: np.ndarray) -> np.ndarray:
+    """Signed integer keys whose order is the IEEE total order of ``x`` (integers map to themselves)."""
+
+    x = np.asarray(x)
+    if not np.issubdtype(x.dtype, np.floating):
+        return x.astype(np.uint8) if x.dtype == np.bool_ else x
+    bits = x.view(np.dtype(f"int{x.dtype.itemsize * 8}"))
+    # Negative floats: flip the magnitude bits so larger magnitudes sort first.
+    return bits ^ ((bits >> (x.dtype.itemsize * 8 - 1)) & np.iinfo(bits.dtype).max)
+
+
+def argsort(x: np.ndarray, *, axis: int = -1, descending: bool = False) -> np.ndarray:
+    """Stable argsort in total order; descending keeps equal keys in input order. Returns int64."""
+
+    keys = sort_keys(x)
+    if descending:
+        keys = ~keys  # reverses the order without the overflow of negation
+    return np.argsort(keys, axis=axis, kind="stable").astype(np.int64, copy=False)
+
+
+def _sort_options(attrs: AttrMap, ndim: int) -> dict:
+    return {"axis": _axis(attrs, ndim), "descending": bool(attrs.get("descending", False))}
+
+
+def _checked_indices(indices: np.ndarray, extent: int) -> np.ndarray:
+    idx = np.asarray(indices)
+    if not np.issubdtype(idx.dtype, np.integer):
+        raise ValueError(f"indices must be integers, got {idx.dtype}")
+    if idx.size and (int(idx.min()) < 0 or int(idx.max()) >= extent):
+        raise ValueError(f"indices out of range [0, {extent})")
+    return idx.astype(np.intp, copy=False)
+
+
+def _scan(accumulate, x: np.ndarray, attrs: AttrMap, *, identity: int) -> np.ndarray:
+    x = np.asarray(x)
+    if x.ndim == 0:
+        x = x.reshape(1)
+    axis = _axis(attrs, x.ndim)
+    wide = np.float64 if np.issubdtype(x.dtype, np.floating) else np.int64
+    out = accumulate(x, axis=axis, dtype=wide)
+    if attrs.get("exclusive", False):
+        # Shift right by one along the axis and seed with the identity.
+        out = np.roll(out, 1, axis=axis)
+        out[(slice(None),) * axis + (0,)] = identity
+    return out.astype(x.dtype)
+
+
+def _permutation(attrs: AttrMap, ndim: int) -> tuple[int, ...]:
+    value = attrs.get("perm")
+    if value is None:
+        return tuple(reversed(range(ndim)))
+    perm = tuple(int(axis) + ndim if int(axis) < 0 else int(axis) for axis in value)
+    if sorted(perm) != list(range(ndim)):
+        raise ValueError(f"perm {list(value)} is not a permutation of {ndim} axes")
+    return perm
+
+
+def _axis(attrs: AttrMap, ndim: int) -> int:
+    value = attrs.get("axis", -1)
+    axis = int(value) if value is not None else -1
+    if not -ndim <= axis < ndim:
+        raise ValueError(f"axis {axis} is out of range for rank {ndim}")
+    return axis % ndim
+
+
 def pool2d(x: np.ndarray, attrs: AttrMap, mode: str) -> np.ndarray:
     kernel_size = _pair(attrs.get("kernel_size"), default=(2, 2))
     stride = _pair(attrs.get("stride"), default=kernel_size)
@@ -551,4 +921,16 @@ BUILTIN_OPERATOR_CLASSES = (
     ReduceSum,
     ReduceMean,
     BroadcastTo,
+    TopK,
+    ArgMax,
+    ArgMin,
+    Gather,
+    ScatterAdd,
+    EmbeddingBag,
+    Transpose,
+    Permute,
+    CumSum,
+    CumProd,
+    Sort,
+    ArgSort,
 )
@@ -4,24 +4,42 @@ from .loader import load_plan
 from .models import (
     AssertionConfig,
     BackendConfig,
+    BenchResult,
+    BenchSettings,
+    BuildConfig,
     CaseConfig,
     CaseShape,
+    DenormalRun,
     ExecutionPlan,
     GeneratorConfig,
+    PipelineConfig,
+    PipelineNode,
     PlanOptions,
     ResolvedCase,
+    SessionConfig,
 )
+from .bench import run_bench
+from .pgo import run_pgo
 from .runner import run_plan
 
 __all__ = [
     "AssertionConfig",
     "BackendConfig",
+    "BenchResult",
+    "BenchSettings",
+    "BuildConfig",
     "CaseConfig",
     "CaseShape",
+    "DenormalRun",
     "ExecutionPlan",
     "GeneratorConfig",
+    "PipelineConfig",
+    "PipelineNode",
     "PlanOptions",
     "ResolvedCase",
+    "SessionConfig",
     "load_plan",
+    "run_bench",
+    "run_pgo",
     "run_plan",
 ]
@@ -0,0 +1,681 @@
+"""Benchmark executor: times backend commands for the cases selected from a plan.
+
+Each case is prepared exactly like ``optest run`` (generator, cache, tokens),
+then the backend command runs ``warmup + repeat`` times. Wall time is measured
+around every invocation; runners may additionally print lines of the form::
+
+    OPTEST_METRIC kernel_ms=0.42 gflops=118.3
+
+which are collected per sample and reported as medians.
+
+With ``cache_state`` cold, every timed run is preceded by a cache flush in the
+harness and the runner gets ``OPTEST_CACHE_STATE=cold`` (and the
+``{cache_state}`` token) so in-process loops can rotate input copies (see
+``sdk/cpp/include/optest/cache_state.h``); ``both`` times a warm and a cold pass
+and reports them side by side.
+
+With ``denormals`` every case is timed again on inputs where that fraction of
+the float elements is subnormal, and the slowdown is reported together with
+whether the outputs still match the reference. ``ftz`` is passed to the runner
+as ``OPTEST_FTZ`` (see ``sdk/cpp/include/optest/float_mode.h``); with it set,
+the difference an FTZ/DAZ run makes on the subnormal inputs is measured too.
+"""
+from __future__ import annotations
+
+import dataclasses
+import json
+import os
+import statistics
+import tempfile
+import time
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Mapping, Optional, Sequence
+
+import numpy as np
+from colorama import Fore, Style, init as colorama_init
+
+from optest.machine import MachineProfile, last_level_cache_bytes, percent_of_peak
+from optest.storage.cache import ArtifactCache
+
+from . import generators, pipeline, runner
+from .history import record_bench
+from .models import (
+    AssertionConfig,
+    AssertionResult,
+    BenchResult,
+    BenchSettings,
+    DenormalRun,
+    ExecutionPlan,
+    PlanOptions,
+    ResolvedCase,
+)
+from .profile import DEFAULT_FREQUENCY, ProfileArtifact, ProfileCollector, ProfileSpec
+from .session import SessionPool, print_sessions
+
+METRIC_PREFIX = "OPTEST_METRIC"
+CACHE_STATE_ENV = "OPTEST_CACHE_STATE"
+FTZ_ENV = "OPTEST_FTZ"
+CACHE_STATE_PASSES = {"warm": ("warm",), "cold": ("cold",), "both": ("warm", "cold")}
+_eviction_buffer: Optional[np.ndarray] = None
+
+
+def parse_metrics(text: str) -> Dict[str, float]:
+    """Collect ``OPTEST_METRIC key=value`` pairs from runner output (later values win)."""
+
+    metrics: Dict[str, float] = {}
+    for line in text.splitlines():
+        parts = line.strip().split()
+        if not parts or parts[0] != METRIC_PREFIX:
+            continue
+        for item in parts[1:]:
+            key, sep, value = item.partition("=")
+            if not sep:
+                continue
+            try:
+                metrics[key] = float(value)
+            except ValueError:
+                continue
+    return metrics
+
+
+def flush_caches() -> None:
+    """Evict the CPU caches by writing a buffer twice the last-level cache (one store per line)."""
+
+    global _eviction_buffer
+    if _eviction_buffer is None:
+        _eviction_buffer = np.zeros(2 * last_level_cache_bytes(), dtype=np.uint8)
+    _eviction_buffer[::64] += 1
+
+
+def run_bench(
+    plan: ExecutionPlan,
+    options: PlanOptions,
+    settings: BenchSettings,
+    *,
+    baseline_path: str | None = None,
+    baseline_chip: str | None = None,
+    speedup_metric: str | None = None,
+    report_format: str = "terminal",
+    report_path: str | None = None,
+    history_path: str | Path | None = None,
+    ingest_paths: Sequence[str | Path] = (),
+    profile: ProfileSpec | None = None,
+    profile_dir: str | Path = "optest_profiles",
+    profiler: str = "auto",
+    profile_frequency: int = DEFAULT_FREQUENCY,
+    machine: MachineProfile | None = None,
+    use_color: bool = True,
+) -> int:
+    """Benchmark the selected cases; returns process exit code (0 success, 1 failures).
+
+    Speedups are computed against an earlier report (``baseline_path``, matched by
+    case identifier) or, with ``baseline_chip``, against the same case and shape
+    run on that chip in this invocation. With ``history_path`` the results are also
+    appended to that run history (see ``optest report``). With ``ingest_paths`` no
+    command runs: results come from those JSON reports (e.g. written by a standalone
+    kernel benchmark), matched to the selected cases by identifier. With ``profile``
+    the matching cases are rerun under a sampling profiler (see ``profile.py``).
+    With a ``machine`` profile (``optest calibrate-machine``) the rates of ``host_cpu``
+    backends are also reported as percent of the measured peak.
+    """
+
+    colorama_init()
+    if profile is not None and ingest_paths:
+        raise ValueError("--profile reruns backend commands and cannot be combined with --ingest")
+    if settings.denormals and ingest_paths:
+        raise ValueError("--denormals reruns backend commands and cannot be combined with --ingest")
+    resolved = runner._resolve_cases(plan, options)
+    if options.list_only:
+        for case in resolved:
+            print(runner._format_case_identifier(case))
+        return 0
+    if not resolved:
+        print("No cases matched the provided filters.")
+        return 1
+    if profile is not None and any(item.backend.session is not None for item in resolved):
+        raise ValueError("--profile runs the backend command per case and does not support session backends")
+    if profile is not None and plan.pipeline is not None:
+        raise ValueError("--profile runs the backend command per case and does not support pipeline plans")
+    profiles: Dict[str, ProfileArtifact] = {}
+    sessions = SessionPool()
+    if ingest_paths:
+        results = ingest_results(resolved, [item for path in ingest_paths for item in load_bench_report(path)])
+        if not results:
+            print("No ingested result matched the selected cases.")
+            return 1
+    elif profile is not None:
+        cache_policy = options.cache or plan.cache
+        collector = ProfileCollector(
+            profile,
+            profile_dir,
+            profiler=profiler,
+            frequency=profile_frequency,
+            cache_policy=cache_policy,
+            cache=runner._open_artifact_cache(plan),
+        )
+        results = bench_cases(plan, resolved, settings, options.cache, on_case=collector.case_done)
+        profiles = collector.finish(resolved, results)
+    else:
+        results = bench_cases(plan, resolved, settings, options.cache, sessions=sessions)
+    if history_path:
+        record_bench(history_path, plan, results, settings)
+    ratios: Dict[str, float] = {}
+    if baseline_path:
+        ratios = speedups(results, load_bench_report(baseline_path), speedup_metric)
+    elif baseline_chip:
+        if not any(item.backend.chip == baseline_chip for item in resolved):
+            raise ValueError(f"Baseline chip '{baseline_chip}' matched no selected backend")
+        # Split by identifier rather than by position: ingested results need not cover every case.
+        on_baseline = {runner._format_case_identifier(item) for item in resolved if item.backend.chip == baseline_chip}
+        reference = [result for result in results if result.identifier in on_baseline]
+        measured = [result for result in results if result.identifier not in on_baseline]
+        ratios = speedups(measured, reference, speedup_metric, key=_case_shape_key)
+    efficiency: Dict[str, Dict[str, float]] = {}
+    if machine is not None:
+        # The profile measures this host's CPU: rates of runners on a device are not comparable with it.
+        dtypes = {
+            runner._format_case_identifier(item): item.case.dtypes[0] if item.case.dtypes else "float32"
+            for item in resolved
+            if item.backend.host_cpu
+        }
+        for result in results:
+            if result.identifier not in dtypes:
+                continue
+            found = percent_of_peak(result.metrics, machine, dtypes[result.identifier])
+            if found and result.status == "ok":
+                efficiency[result.identifier] = found
+    return report_bench(
+        results,
+        settings,
+        ratios=ratios,
+        speedup_metric=speedup_metric,
+        report_format=report_format,
+        report_path=report_path,
+        profiles=profiles,
+        efficiency=efficiency,
+        sessions=sessions.summary() if sessions.samples else None,
+        use_color=use_color,
+    )
+
+
+def bench_cases(
+    plan: ExecutionPlan,
+    resolved: Sequence[ResolvedCase],
+    settings: BenchSettings,
+    cache_policy: str | None = None,
+    *,
+    on_case: Optional[Callable[[ResolvedCase, BenchResult], None]] = None,
+    sessions: SessionPool | None = None,
+) -> List[BenchResult]:
+    """Time every case; session backends keep one runner per target alive (closed when done)."""
+
+    cache = runner._open_artifact_cache(plan)
+    pool = sessions or SessionPool()
+    results = []
+    try:
+        for item in resolved:
+            results.append(_bench_case(item, settings, cache_policy or plan.cache, cache, pool))
+            if on_case is not None:
+                on_case(item, results[-1])
+    finally:
+        pool.close()
+    return results
+
+
+def ingest_results(resolved: Sequence[ResolvedCase], ingested: Sequence[BenchResult]) -> List[BenchResult]:
+    """Results measured outside optest, in plan order; unmatched identifiers are reported and dropped."""
+
+    by_id = {item.identifier: item for item in ingested}  # later reports win
+    results = []
+    for case in resolved:
+        result = by_id.pop(runner._format_case_identifier(case), None)
+        if result is not None:
+            results.append(result)
+    for identifier in sorted(by_id):
+        print(f"Ignoring ingested result {identifier}: no selected case/backend/shape has that identifier.")
+    return results
+
+
+def _bench_case(
+    resolved: ResolvedCase,
+    settings: BenchSettings,
+    cache_policy: str,
+    cache: ArtifactCache | None,
+    sessions: SessionPool,
+) -> BenchResult:
+    identifier = runner._format_case_identifier(resolved)
+    try:
+        generator = resolved.case.generator or resolved.plan.generator
+        assertion = resolved.case.assertion or resolved.plan.assertion
+        inputs = runner._prepare_inputs(resolved, generator, cache_policy, cache)
+        runner._ensure_output_dirs(resolved.output_paths)
+        backend = resolved.backend
+        tokens = runner._build_tokens(resolved)
+        env = os.environ.copy()
+        env.update(runner._render_env(backend.env, tokens))
+        passes = CACHE_STATE_PASSES[settings.cache_state]
+        timed: Dict[str, list[float]] = {state: [] for state in passes}
+        metric_samples: Dict[str, list[float]] = {}
+        last_run: pipeline.PipelineRun | None = None
+        env[CACHE_STATE_ENV] = passes[0]
+        env[FTZ_ENV] = tokens["ftz"] = settings.ftz
+        for cmd in backend.prepare:
+            runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+        try:
+            for state in passes:
+                env[CACHE_STATE_ENV] = state
+                pass_tokens = dict(tokens, cache_state=state)
+                # Metrics of a second (cold) pass are reported as cold_<name> next to the warm ones.
+                prefix = "cold_" if state != passes[0] else ""
+                for iteration in range(settings.warmup + settings.repeat):
+                    if state == "cold":
+                        flush_caches()
+                    elapsed, sample_metrics, run = _run_once(resolved, sessions, pass_tokens, env, inputs)
+                    if last_run is not None:
+                        last_run.close()
+                    last_run = run
+                    if iteration < settings.warmup:
+                        continue
+                    timed[state].append(elapsed)
+                    for key, value in sample_metrics.items():
+                        metric_samples.setdefault(prefix + key, []).append(value)
+        finally:
+            for cmd in backend.cleanup:
+                runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+        status, details = "ok", ""
+        try:
+            if settings.verify:
+                checked = _check(resolved, assertion, inputs, cache, last_run)
+                if not checked.ok:
+                    status, details = "failed", checked.details
+        finally:
+            if last_run is not None:
+                last_run.close()
+        denormal = None
+        if settings.denormals:
+            env[CACHE_STATE_ENV] = passes[0]
+            denormal = _bench_denormals(resolved, settings, assertion, inputs, env, sessions)
+        metrics = {key: statistics.median(values) for key, values in metric_samples.items()}
+        return BenchResult(
+            identifier=identifier,
+            status=status,
+            samples=tuple(timed[passes[0]]),
+            metrics=metrics,
+            details=details,
+            cold_samples=tuple(timed["cold"]) if len(passes) > 1 else (),
+            denormal=denormal,
+        )
+    except Exception as exc:
+        return BenchResult(identifier=identifier, status="error", details=str(exc))
+
+
+def _run_once(
+    resolved: ResolvedCase,
+    sessions: SessionPool,
+    tokens: Mapping[str, str],
+    env: Mapping[str, str],
+    inputs: Sequence[np.ndarray],
+) -> tuple[float, Dict[str, float], pipeline.PipelineRun | None]:
+    """One timed execution: (seconds, runner metrics, the run of a pipeline case, which the caller closes).
+
+    Pipeline cases are timed per node (``<node>.wall_ms``, node metrics as ``<node>.<name>``); their sample
+    is the sum of the nodes and handoffs.
+    """
+
+    backend = resolved.backend
+    if resolved.plan.pipeline is not None:
+        run = pipeline.run_pipeline(resolved, inputs, tokens, env, sessions)
+        metrics = {f"{node}.wall_ms": seconds * 1e3 for node, seconds in run.node_seconds.items()}
+        for node, text in run.stdout.items():
+            metrics.update({f"{node}.{key}": value for key, value in parse_metrics(text).items()})
+        return run.elapsed, metrics, run
+    start = time.perf_counter()
+    if backend.session is not None:
+        stdout = runner._run_session_request(resolved, sessions, tokens, env)
+    else:
+        stdout = runner._run_command(backend.command.argv, backend.workdir, env, tokens, backend.timeout).stdout
+    return time.perf_counter() - start, parse_metrics(stdout), None
+
+
+def _check(
+    resolved: ResolvedCase,
+    assertion: AssertionConfig,
+    inputs: Sequence[np.ndarray],
+    cache: ArtifactCache | None,
+    run: pipeline.PipelineRun | None,
+) -> AssertionResult:
+    if run is not None:
+        return pipeline.check_pipeline(resolved, run, cache)
+    outputs = runner._load_outputs(resolved, assertion)
+    return runner._run_assertion(resolved, assertion, inputs, outputs, cache)
+
+
+def _bench_denormals(
+    resolved: ResolvedCase,
+    settings: BenchSettings,
+    assertion: AssertionConfig,
+    inputs: Sequence[np.ndarray],
+    env: Dict[str, str],
+    sessions: SessionPool,
+) -> DenormalRun | None:
+    """Time the case again on private copies of its inputs with ``settings.denormals`` of the floats subnormal.
+
+    The outputs are checked against the reference; with an FTZ/DAZ mode the case runs once more with
+    ``OPTEST_FTZ=off`` and the output elements that changed are counted.
+    """
+
+    fraction = settings.denormals
+    assert fraction is not None
+    if not any(np.issubdtype(np.dtype(dtype), np.floating) for dtype in resolved.case.dtypes):
+        return None
+    rng = np.random.default_rng(0)
+    injected = [generators.inject_denormals(np.asarray(values), fraction, rng) for values in inputs]
+    backend = resolved.backend
+    with tempfile.TemporaryDirectory(prefix="optest-denormal-") as scratch:
+        root = Path(scratch)
+        variant = dataclasses.replace(
+            resolved,
+            input_paths=tuple(root / "inputs" / f"{i}-{path.name}" for i, path in enumerate(resolved.input_paths)),
+            output_paths=tuple(root / "outputs" / f"{i}-{path.name}" for i, path in enumerate(resolved.output_paths)),
+        )
+        runner._write_inputs(variant, injected)
+        runner._ensure_output_dirs(variant.output_paths)
+        tokens = dict(runner._build_tokens(variant), ftz=settings.ftz)
+        variant_inputs = runner._load_inputs(variant)
+        samples: list[float] = []
+        last: pipeline.PipelineRun | None = None
+        for cmd in backend.prepare:
+            runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+        try:
+            for iteration in range(settings.warmup + settings.repeat):
+                elapsed, _, run = _run_once(variant, sessions, tokens, env, variant_inputs)
+                if last is not None:
+                    last.close()
+                last = run
+                if iteration >= settings.warmup:
+                    samples.append(elapsed)
+            checked = _check(variant, assertion, variant_inputs, None, last)
+            outputs = last.outputs(resolved.plan.pipeline) if last else runner._load_outputs(variant, assertion)
+            measured = DenormalRun(fraction, tuple(samples), "" if checked.ok else checked.details)
+            if settings.ftz != "off":
+                flushed = [np.array(values, copy=True) for values in outputs]
+                runner._ensure_output_dirs(variant.output_paths)
+                _, _, rerun = _run_once(
+                    variant, sessions, dict(tokens, ftz="off"), dict(env, **{FTZ_ENV: "off"}), variant_inputs
+                )
+                reference = rerun.outputs(resolved.plan.pipeline) if rerun else runner._load_outputs(variant, assertion)
+                changed, max_abs = _output_difference(flushed, reference)
+                measured = dataclasses.replace(measured, ftz_changed=changed, ftz_max_abs=max_abs)
+                if rerun is not None:
+                    rerun.close()
+        finally:
+            if last is not None:
+                last.close()
+            for cmd in backend.cleanup:
+                runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+    return measured
+
+
+def _output_difference(left: Sequence[np.ndarray], right: Sequence[np.ndarray]) -> tuple[int, float]:
+    # (elements that differ, largest absolute difference); NaNs in the same place are equal.
+    changed, max_abs = 0, 0.0
+    for a, b in zip(left, right):
+        a = np.asarray(a, dtype=np.float64).reshape(-1)
+        b = np.asarray(b, dtype=np.float64).reshape(-1)
+        if a.shape != b.shape:
+            changed += max(a.size, b.size)
+            continue
+        differs = (a != b) & ~(np.isnan(a) & np.isnan(b))
+        changed += int(differs.sum())
+        if differs.any():
+            max_abs = max(max_abs, float(np.nanmax(np.abs(a[differs] - b[differs]))))
+    return changed, max_abs
+
+
+def score(result: BenchResult, metric: str | None = None) -> float | None:
+    """Lower-is-better figure used for speedups: median wall time, or a runner metric."""
+
+    if metric is None:
+        return result.median
+    return result.metrics.get(metric)
+
+
+def _case_shape_key(identifier: str) -> str:
+    # "case@backend:chip/shapeN" -> "case/shapeN"
+    case, _, rest = identifier.partition("@")
+    return f"{case}/{rest.rpartition('/')[2]}"
+
+
+def speedups(
+    results: Sequence[BenchResult],
+    reference: Sequence[BenchResult],
+    metric: str | None = None,
+    *,
+    key: Callable[[str], str] = lambda identifier: identifier,
+) -> Dict[str, float]:
+    """Reference score / new score per result identifier (>1 means faster)."""
+
+    before = {key(item.identifier): score(item, metric) for item in reference if item.status == "ok"}
+    ratios: Dict[str, float] = {}
+    for item in results:
+        old, new = before.get(key(item.identifier)), score(item, metric)
+        if item.status == "ok" and old and new:
+            ratios[item.identifier] = old / new
+    return ratios
+
+
+def report_bench(
+    results: Sequence[BenchResult],
+    settings: BenchSettings,
+    *,
+    ratios: Mapping[str, float] | None = None,
+    speedup_metric: str | None = None,
+    report_format: str = "terminal",
+    report_path: str | None = None,
+    profiles: Mapping[str, ProfileArtifact] | None = None,
+    efficiency: Mapping[str, Mapping[str, float]] | None = None,
+    sessions: Mapping[str, Any] | None = None,
+    use_color: bool = True,
+) -> int:
+    ratios = ratios or {}
+    profiles = profiles or {}
+    efficiency = efficiency or {}
+    failures = sum(1 for item in results if item.status != "ok")
+    if report_format == "terminal":
+        for item in results:
+            _print_bench_result(
+                item,
+                ratios.get(item.identifier),
+                profiles.get(item.identifier),
+                efficiency.get(item.identifier),
+                use_color=use_color,
+            )
+        if sessions:
+            print_sessions(sessions, use_color=use_color)
+        _print_bench_summary(results, ratios, failures, use_color=use_color)
+    else:
+        _write_bench_report(results, settings, ratios, speedup_metric, report_path, profiles, efficiency, sessions)
+    return 0 if failures == 0 else 1
+
+
+def _format_seconds(value: float | None) -> str:
+    if value is None:
+        return "-"
+    if value >= 1.0:
+        return f"{value:.3f}s"
+    return f"{value * 1e3:.3f}ms"
+
+
+def _print_bench_result(
+    result: BenchResult,
+    speedup: float | None,
+    profile: ProfileArtifact | None = None,
+    efficiency: Mapping[str, float] | None = None,
+    *,
+    use_color: bool = True,
+) -> None:
+    color = ""
+    if use_color:
+        color = Fore.GREEN if result.status == "ok" else Fore.RED
+    reset = Style.RESET_ALL if use_color else ""
+    label = {"ok": "BENCH", "failed": "FAIL", "error": "ERROR"}.get(result.status, result.status.upper())
+    line = f"{color}{label:<11}{reset} {result.identifier}"
+    if result.samples:
+        line += (
+            f"  median={_format_seconds(result.median)} min={_format_seconds(result.minimum)} n={len(result.samples)}"
+        )
+    if result.cold_samples:
+        line += f"  cold={_format_seconds(result.cold_median)}"
+        if result.median:
+            line += f" ({result.cold_median / result.median:.2f}x warm)"
+    if speedup is not None:
+        line += f"  speedup={speedup:.2f}x"
+    print(line)
+    if result.details:
+        print(f"    detail: {result.details}")
+    if result.metrics:
+        metrics_text = ", ".join(f"{k}={v:g}" for k, v in result.metrics.items())
+        print(f"    metrics: {metrics_text}")
+    if efficiency:
+        efficiency_text = ", ".join(f"{k} {v:.1f}%" for k, v in efficiency.items())
+        print(f"    of machine peak: {efficiency_text}")
+    if result.denormal is not None:
+        print(f"    {_format_denormal(result)}")
+    if profile is not None:
+        if profile.error:
+            print(f"    profile failed: {profile.error}")
+        else:
+            print(f"    profile: {profile.svg} ({profile.samples} samples; stacks in {profile.folded})")
+
+
+def _format_denormal(result: BenchResult) -> str:
+    run = result.denormal
+    assert run is not None
+    text = f"denormals {run.fraction:.0%}: median={_format_seconds(run.median)}"
+    if result.denormal_slowdown is not None:
+        text += f" ({result.denormal_slowdown:.2f}x normal)"
+    text += f"; outputs {'fail: ' + run.check if run.check else 'pass'}"
+    if run.ftz_changed is not None:
+        text += f"; FTZ changed {run.ftz_changed} output elements (max_abs={run.ftz_max_abs:.3g})"
+    return text
+
+
+def _print_bench_summary(
+    results: Sequence[BenchResult], ratios: Mapping[str, float], failures: int, *, use_color: bool = True
+) -> None:
+    summary_color = Fore.GREEN if failures == 0 and use_color else Fore.RED if use_color else ""
+    reset = Style.RESET_ALL if use_color else ""
+    text = f"{summary_color}Summary{reset}: total={len(results)} measured={len(results) - failures} failed={failures}"
+    if ratios:
+        text += f" geomean_speedup={statistics.geometric_mean(ratios.values()):.3f}x"
+    slowdowns = [item.denormal_slowdown for item in results if item.denormal_slowdown]
+    if slowdowns:
+        text += f" geomean_denormal_slowdown={statistics.geometric_mean(slowdowns):.3f}x"
+    print(text)
+
+
+def _write_bench_report(
+    results: Sequence[BenchResult],
+    settings: BenchSettings,
+    ratios: Mapping[str, float],
+    speedup_metric: str | None,
+    path: str | None,
+    profiles: Mapping[str, ProfileArtifact],
+    efficiency: Mapping[str, Mapping[str, float]],
+    sessions: Mapping[str, Any] | None = None,
+) -> None:
+    summary: Dict[str, Any] = {
+        "total": len(results),
+        "failures": sum(1 for item in results if item.status != "ok"),
+        "warmup": settings.warmup,
+        "repeat": settings.repeat,
+        "cache_state": settings.cache_state,
+    }
+    if ratios:
+        summary["speedup_metric"] = speedup_metric or "wall"
+        summary["geomean_speedup"] = statistics.geometric_mean(ratios.values())
+    if settings.denormals:
+        summary["denormals"] = settings.denormals
+        slowdowns = [item.denormal_slowdown for item in results if item.denormal_slowdown]
+        if slowdowns:
+            summary["geomean_denormal_slowdown"] = statistics.geometric_mean(slowdowns)
+    if settings.ftz != "off":
+        summary["ftz"] = settings.ftz
+    cases: list[Dict[str, Any]] = []
+    for item in results:
+        entry: Dict[str, Any] = {
+            "id": item.identifier,
+            "status": item.status,
+            "details": item.details,
+            "samples_s": list(item.samples),
+            "median_s": item.median,
+            "min_s": item.minimum,
+            "metrics": dict(item.metrics),
+        }
+        if item.cold_samples:
+            entry["cold_samples_s"] = list(item.cold_samples)
+            entry["cold_median_s"] = item.cold_median
+        if item.denormal is not None:
+            entry["denormals"] = {
+                "fraction": item.denormal.fraction,
+                "samples_s": list(item.denormal.samples),
+                "median_s": item.denormal.median,
+                "slowdown": item.denormal_slowdown,
+                "check": item.denormal.check or "pass",
+                "ftz_changed": item.denormal.ftz_changed,
+                "ftz_max_abs": item.denormal.ftz_max_abs,
+            }
+        if item.identifier in ratios:
+            entry["speedup"] = ratios[item.identifier]
+        if item.identifier in efficiency:
+            entry["percent_of_peak"] = dict(efficiency[item.identifier])
+        profile = profiles.get(item.identifier)
+        if profile is not None:
+            entry["profile"] = (
+                {"error": profile.error}
+                if profile.error
+                else {"svg": str(profile.svg), "folded": str(profile.folded), "samples": profile.samples}
+            )
+        cases.append(entry)
+    payload: Dict[str, Any] = {"summary": summary, "cases": cases}
+    if sessions:
+        payload["sessions"] = sessions
+    text = json.dumps(payload, indent=2)
+    if path:
+        Path(path).write_text(text, encoding="utf-8")
+    else:
+        print(text)
+
+
+def load_bench_report(path: str | Path) -> List[BenchResult]:
+    """Read results back from a JSON report written by ``optest bench --report json``."""
+
+    payload = json.loads(Path(path).read_text(encoding="utf-8"))
+    cases = payload.get("cases") if isinstance(payload, Mapping) else None
+    if not isinstance(cases, list):
+        raise ValueError(f"{path} is not an optest bench report")
+    return [
+        BenchResult(
+            identifier=str(entry["id"]),
+            status=str(entry.get("status", "ok")),
+            samples=tuple(float(x) for x in entry.get("samples_s") or ()),
+            metrics={str(k): float(v) for k, v in (entry.get("metrics") or {}).items()},
+            details=str(entry.get("details", "")),
+            cold_samples=tuple(float(x) for x in entry.get("cold_samples_s") or ()),
+            denormal=_load_denormal(entry.get("denormals")),
+        )
+        for entry in cases
+    ]
+
+
+def _load_denormal(entry: Mapping[str, Any] | None) -> DenormalRun | None:
+    if not entry:
+        return None
+    check = str(entry.get("check", "pass"))
+    return DenormalRun(
+        fraction=float(entry["fraction"]),
+        samples=tuple(float(x) for x in entry.get("samples_s") or ()),
+        check="" if check == "pass" else check,
+        ftz_changed=entry.get("ftz_changed"),
+        ftz_max_abs=entry.get("ftz_max_abs"),
+    )
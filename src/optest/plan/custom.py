@@ -1,11 +1,28 @@
 """Helpers for loading user-provided generator/assertion functions."""
 from __future__ import annotations
 
+import ctypes
+import functools
 import importlib.machinery
 import importlib.util
+import json
+import math
 import sys
 from pathlib import Path
-from typing import Callable
+from typing import Any, Callable, Dict, Mapping, Optional, Sequence, Tuple
+
+import numpy as np
+
+from optest.storage.tensorfile import DTYPE_CODES
+
+# Shared-library suffixes loaded as native assertion plugins (sdk/cpp/include/optest/assertion_plugin.h).
+NATIVE_SUFFIXES = frozenset({".so", ".dylib"})
+ASSERTION_ABI_VERSION = 1
+
+NativeAssertion = Callable[
+    [Sequence[np.ndarray], Sequence[np.ndarray], Mapping[str, Any], Optional[float], Optional[float], Optional[str]],
+    Tuple[bool, str, Dict[str, float]],
+]
 
 
 def load_from_source(source: Path, func_name: str) -> Callable:
@@ -29,3 +46,132 @@ def load_from_source(source: Path, func_name: str) -> Callable:
     if not callable(func):
         raise TypeError(f"Attribute '{func_name}' in {path} is not callable")
     return func  # type: ignore[return-value]
+
+
+class _Tensor(ctypes.Structure):
+    _fields_ = [
+        ("data", ctypes.c_void_p),
+        ("dtype", ctypes.c_uint16),
+        ("ndim", ctypes.c_int32),
+        ("shape", ctypes.POINTER(ctypes.c_int64)),
+        ("strides", ctypes.POINTER(ctypes.c_int64)),
+    ]
+
+
+class _Metric(ctypes.Structure):
+    _fields_ = [("name", ctypes.c_char * 64), ("value", ctypes.c_double)]
+
+
+class _Result(ctypes.Structure):
+    _fields_ = [
+        ("ok", ctypes.c_int32),
+        ("details", ctypes.c_char * 1024),
+        ("num_metrics", ctypes.c_int32),
+        ("metrics", _Metric * 32),
+    ]
+
+
+_ASSERTION_ARGTYPES = [
+    ctypes.POINTER(_Tensor),
+    ctypes.c_int32,
+    ctypes.POINTER(_Tensor),
+    ctypes.c_int32,
+    ctypes.c_char_p,
+    ctypes.c_double,
+    ctypes.c_double,
+    ctypes.c_char_p,
+    ctypes.POINTER(_Result),
+]
+
+
+def is_native(source: Path) -> bool:
+    return source.suffix in NATIVE_SUFFIXES
+
+
+@functools.lru_cache(maxsize=None)
+def _load_library(path: Path) -> ctypes.CDLL:
+    library = ctypes.CDLL(str(path))
+    try:
+        version = library.optest_assertion_abi_version
+    except AttributeError:
+        raise ImportError(
+            f"{path} is not an optest assertion plugin (build it with optest/assertion_plugin.h)"
+        ) from None
+    version.restype = ctypes.c_int32
+    if version() != ASSERTION_ABI_VERSION:
+        raise ImportError(f"{path} uses assertion ABI {version()}, optest expects {ASSERTION_ABI_VERSION}")
+    return library
+
+
+def load_native(source: Path, func_name: str) -> NativeAssertion:
+    """Load the C ABI assertion ``func_name`` from a shared library at ``source``.
+
+    The returned callable passes the arrays to the plugin as views of their own memory (no copy; strided
+    layouts included) and returns ``(ok, details, metrics)``.
+    """
+
+    path = source.expanduser().resolve()
+    if not path.exists():
+        raise FileNotFoundError(f"Custom source file not found: {path}")
+    library = _load_library(path)
+    try:
+        func = getattr(library, func_name)
+    except AttributeError:
+        raise AttributeError(f"Function '{func_name}' not found in {path} (declare it with OPTEST_ASSERTION)") from None
+    func.argtypes = _ASSERTION_ARGTYPES
+    func.restype = ctypes.c_int32
+
+    def _call(
+        inputs: Sequence[np.ndarray],
+        outputs: Sequence[np.ndarray],
+        params: Mapping[str, Any],
+        rtol: Optional[float],
+        atol: Optional[float],
+        metric: Optional[str],
+    ) -> Tuple[bool, str, Dict[str, float]]:
+        keep: list = []  # arrays and dims must outlive the call
+        inputs_c = _tensors(inputs, keep)
+        outputs_c = _tensors(outputs, keep)
+        result = _Result()
+        code = func(
+            inputs_c,
+            len(inputs),
+            outputs_c,
+            len(outputs),
+            json.dumps(dict(params)).encode(),
+            math.nan if rtol is None else rtol,
+            math.nan if atol is None else atol,
+            (metric or "").encode(),
+            ctypes.byref(result),
+        )
+        details = result.details.decode(errors="replace")
+        metrics = {
+            entry.name.decode(errors="replace"): float(entry.value)
+            for entry in result.metrics[: max(0, min(result.num_metrics, len(result.metrics)))]
+        }
+        if code != 0:
+            return False, f"native assertion '{func_name}' failed (code {code}): {details}", metrics
+        return bool(result.ok), details, metrics
+
+    return _call
+
+
+def _tensors(arrays: Sequence[np.ndarray], keep: list) -> ctypes.Array:
+    tensors = (_Tensor * max(1, len(arrays)))()
+    for slot, array in zip(tensors, arrays):
+        array = np.asarray(array)
+        if not array.dtype.isnative:
+            # Plugins read elements in host byte order; swapped data is converted (a copy) rather than misread.
+            array = array.astype(array.dtype.newbyteorder("="))
+        code = DTYPE_CODES.get(array.dtype.name)
+        if code is None:
+            raise ValueError(f"dtype {array.dtype.name} cannot be passed to a native assertion")
+        shape = (ctypes.c_int64 * max(1, array.ndim))(*array.shape)
+        strides = (ctypes.c_int64 * max(1, array.ndim))(*array.strides)
+        keep.extend((array, shape, strides))
+        slot.data = array.ctypes.data
+        slot.dtype = code
+        slot.ndim = array.ndim
+        slot.shape = shape
+        slot.strides = strides
+    return tensors
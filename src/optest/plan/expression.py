@@ -0,0 +1,429 @@
+"""Expression assertions: ``assertion: {expr: "x * sigmoid(1.702 * x)"}``.
+
+An expression is a small subset of Python (arithmetic, comparisons, ``a if c else b``,
+``@`` and the functions in ``FUNCTIONS``) over the case inputs, bound by name. It is
+parsed once into an evaluation plan. The elementwise part runs chunk by chunk over the
+broadcast output: each chunk goes through the whole expression, every intermediate
+lives in a chunk-sized buffer that is reused for the next chunk (and by the operation
+that consumes it, when shape and dtype allow), so the inputs are streamed once instead
+of allocating a full-size temporary per operation. Chunks run on a thread pool; NumPy
+releases the GIL inside ufunc loops. Matmul and reductions are not elementwise: their
+operands are evaluated first, chunked the same way, and their results enter the
+elementwise part as inputs.
+
+Broadcasting and dtype promotion are NumPy's. Literals and numeric ``params`` are passed
+as Python scalars, so they do not widen the inputs (``1.702 * x`` stays float32 for a
+float32 ``x``).
+"""
+from __future__ import annotations
+
+import ast
+import functools
+import itertools
+import keyword
+import math
+import os
+import threading
+from collections import Counter
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, Callable, Dict, FrozenSet, List, Mapping, Optional, Sequence, Tuple, Union
+
+import numpy as np
+
+# Elements per chunk of every intermediate: 256 KiB of float32, so a chunk's buffers stay in cache.
+CHUNK_ELEMENTS = 1 << 16
+
+CONSTANTS: Dict[str, float] = {"pi": math.pi, "e": math.e, "inf": math.inf, "nan": math.nan}
+
+_BINARY = {
+    ast.Add: np.add,
+    ast.Sub: np.subtract,
+    ast.Mult: np.multiply,
+    ast.Div: np.true_divide,
+    ast.FloorDiv: np.floor_divide,
+    ast.Mod: np.remainder,
+    ast.Pow: np.power,
+    ast.BitAnd: np.bitwise_and,
+    ast.BitOr: np.bitwise_or,
+    ast.BitXor: np.bitwise_xor,
+}
+_UNARY = {ast.USub: np.negative, ast.Invert: np.invert, ast.Not: np.logical_not}
+_COMPARE = {
+    ast.Lt: np.less,
+    ast.LtE: np.less_equal,
+    ast.Gt: np.greater,
+    ast.GtE: np.greater_equal,
+    ast.Eq: np.equal,
+    ast.NotEq: np.not_equal,
+}
+_UFUNCS = {
+    name: getattr(np, name)
+    for name in (
+        "exp", "exp2", "expm1", "log", "log2", "log10", "log1p", "sqrt", "cbrt", "square", "reciprocal",
+        "sin", "cos", "tan", "arcsin", "arccos", "arctan", "sinh", "cosh", "tanh", "arcsinh", "arccosh", "arctanh",
+        "floor", "ceil", "trunc", "rint", "sign", "isnan", "isinf", "isfinite",
+        "minimum", "maximum", "fmin", "fmax", "arctan2", "hypot", "logaddexp", "copysign",
+    )
+}
+_UFUNCS.update({"abs": np.absolute, "pow": np.power})
+# Not elementwise: the result is computed in full before the elementwise part runs.
+_MATERIALIZED: Dict[str, Callable[..., Any]] = {
+    "matmul": np.matmul,
+    "sum": np.sum,
+    "mean": np.mean,
+    "max": np.max,
+    "min": np.min,
+    "prod": np.prod,
+}
+
+
+def _where(condition: Any, x: Any, y: Any, out: Optional[np.ndarray] = None) -> Any:
+    if out is None:
+        return np.where(condition, x, y)
+    np.copyto(out, y)
+    np.copyto(out, x, where=np.asarray(condition, dtype=bool))
+    return out
+
+
+@dataclass(frozen=True)
+class _Leaf:
+    name: str
+
+
+@dataclass(frozen=True)
+class _Const:
+    value: Union[int, float, complex]
+
+
+@dataclass(frozen=True, eq=False)
+class _Apply:
+    func: Callable[..., Any]
+    args: Tuple["_Node", ...]
+
+
+_Node = Union[_Leaf, _Const, _Apply]
+
+
+def _sigmoid(x: _Node) -> _Node:
+    # 1 / (1 + exp(-x)), as builtin.sigmoid computes it.
+    exp = _Apply(np.exp, (_Apply(np.negative, (x,)),))
+    return _Apply(np.true_divide, (_Const(1), _Apply(np.add, (_Const(1), exp))))
+
+
+# Elementwise functions written in terms of ufuncs: name -> (arity, builder).
+_COMPOSITES: Dict[str, Tuple[int, Callable[..., _Node]]] = {
+    "sigmoid": (1, _sigmoid),
+    "relu": (1, lambda x: _Apply(np.maximum, (x, _Const(0)))),
+    "rsqrt": (1, lambda x: _Apply(np.reciprocal, (_Apply(np.sqrt, (x,)),))),
+    "where": (3, lambda c, x, y: _Apply(_where, (c, x, y))),
+    "clip": (3, lambda x, lo, hi: _Apply(np.clip, (x, lo, hi))),
+}
+
+FUNCTIONS = frozenset(_UFUNCS) | frozenset(_COMPOSITES) | frozenset(_MATERIALIZED)
+
+
+@dataclass(frozen=True)
+class _Materialize:
+    name: str
+    func: Callable[..., Any]
+    operands: Tuple["_Program", ...]
+    kwargs: Mapping[str, Any]
+
+
+class _Program:
+    """An elementwise tree over leaves; ``materialize`` computes its non-elementwise leaves first."""
+
+    def __init__(self, root: _Node, materialize: Sequence[_Materialize]) -> None:
+        self.root = root
+        self.materialize = tuple(materialize)
+        self.leaves = tuple(sorted(_leaf_names(root)))
+        names = {name for name in self.leaves if not name.startswith("@")}
+        for step in self.materialize:
+            for operand in step.operands:
+                names |= operand.names
+        self.names: FrozenSet[str] = frozenset(names)
+
+    def evaluate(self, bindings: Mapping[str, Any], threads: Optional[int]) -> np.ndarray:
+        values = dict(bindings)
+        for step in self.materialize:
+            values[step.name] = step.func(*(op.evaluate(bindings, threads) for op in step.operands), **step.kwargs)
+        if isinstance(self.root, _Leaf):
+            return np.array(values[self.root.name])
+        if isinstance(self.root, _Const):
+            return np.asarray(self.root.value)
+        leaves = {name: values[name] for name in self.leaves}
+        shape = np.broadcast_shapes(*(np.shape(value) for value in leaves.values()))
+        axis = next((index for index, dim in enumerate(shape) if dim > 1), None)
+        if axis is None:
+            return np.asarray(_run(self.root, leaves, {}))
+        rows = max(1, CHUNK_ELEMENTS // max(1, math.prod(shape[axis + 1 :])))
+        starts = range(0, shape[axis], rows)
+
+        def _chunk(index: int) -> Tuple[Dict[str, Any], Tuple[slice, ...]]:
+            window = slice(starts[index], starts[index] + rows)
+            chunk = {}
+            for name, value in leaves.items():
+                dim = axis - (len(shape) - np.ndim(value))
+                sliced = isinstance(value, np.ndarray) and dim >= 0 and value.shape[dim] != 1
+                chunk[name] = value[(slice(None),) * dim + (window,)] if sliced else value
+            return chunk, (slice(None),) * axis + (window,)
+
+        # The first chunk runs with fresh arrays to learn every intermediate's dtype and shape.
+        probe: Dict[int, Tuple[np.dtype, Tuple[int, ...]]] = {}
+        first, region = _chunk(0)
+        head = np.asarray(_run(self.root, first, probe))
+        if len(starts) == 1:
+            return head
+        out = np.empty(shape, dtype=head.dtype)
+        out[region] = head
+        registers: Dict[int, int] = {}
+        _assign_registers(self.root, probe, registers, {}, itertools.count())
+        local = threading.local()
+
+        def _fill(index: int) -> None:
+            if not hasattr(local, "buffers"):
+                local.buffers = {}
+            chunk, window = _chunk(index)
+            _run_into(self.root, chunk, registers, probe, local.buffers, out[window])
+
+        workers = min(len(starts) - 1, threads or os.cpu_count() or 1)
+        if workers <= 1:
+            for index in range(1, len(starts)):
+                _fill(index)
+        else:
+            with ThreadPoolExecutor(max_workers=workers) as pool:
+                list(pool.map(_fill, range(1, len(starts))))
+        return out
+
+
+def _leaf_names(node: _Node) -> set:
+    if isinstance(node, _Leaf):
+        return {node.name}
+    if isinstance(node, _Apply):
+        return set().union(*(_leaf_names(arg) for arg in node.args))
+    return set()
+
+
+def _run(node: _Node, values: Mapping[str, Any], probe: Dict[int, Tuple[np.dtype, Tuple[int, ...]]]) -> Any:
+    """Evaluate with freshly allocated results, recording each operation's dtype and shape."""
+
+    if isinstance(node, _Leaf):
+        return values[node.name]
+    if isinstance(node, _Const):
+        return node.value
+    args = [_run(arg, values, probe) for arg in node.args]
+    if not any(isinstance(arg, np.ndarray) for arg in args):
+        return _scalar(node, args)
+    result = np.asarray(node.func(*args))
+    probe[id(node)] = (result.dtype, result.shape)
+    return result
+
+
+def _scalar(node: _Apply, args: Sequence[Any]) -> Any:
+    # Operations on literals and params only (``2 * pi``) stay Python scalars, so they do not widen the arrays.
+    return node.func(*args).item()
+
+
+def _assign_registers(
+    node: _Node,
+    probe: Mapping[int, Tuple[np.dtype, Tuple[int, ...]]],
+    registers: Dict[int, int],
+    free: Dict[Tuple[np.dtype, Tuple[int, ...]], List[int]],
+    counter: Any,
+) -> None:
+    """Give every operation a buffer, reusing those of consumed operands with the same dtype and shape."""
+
+    if id(node) not in probe:
+        return  # literals, or a scalar-only operation
+    operands = [arg for arg in node.args if id(arg) in probe]
+    for arg in operands:
+        _assign_registers(arg, probe, registers, free, counter)
+    # Ufuncs may write over their own inputs; where() copies its operands in two steps, so it may not.
+    in_place = node.func is not _where
+    if in_place:
+        for arg in operands:
+            free.setdefault(probe[id(arg)], []).append(registers[id(arg)])
+    available = free.get(probe[id(node)])
+    registers[id(node)] = available.pop() if available else next(counter)
+    if not in_place:
+        for arg in operands:
+            free.setdefault(probe[id(arg)], []).append(registers[id(arg)])
+
+
+def _run_into(
+    node: _Node,
+    values: Mapping[str, Any],
+    registers: Mapping[int, int],
+    probe: Mapping[int, Tuple[np.dtype, Tuple[int, ...]]],
+    buffers: Dict[int, np.ndarray],
+    out: Optional[np.ndarray] = None,
+) -> Any:
+    if isinstance(node, _Leaf):
+        value = values[node.name]
+        if out is not None:
+            out[...] = value
+        return value
+    if isinstance(node, _Const):
+        if out is not None:
+            out[...] = node.value
+        return node.value
+    args = [_run_into(arg, values, registers, probe, buffers) for arg in node.args]
+    if id(node) not in probe:
+        value = _scalar(node, args)
+        if out is not None:
+            out[...] = value
+        return value
+    if out is None:
+        shape = np.broadcast_shapes(*(np.shape(arg) for arg in args))
+        register = registers[id(node)]
+        out = buffers.get(register)
+        if out is None or out.shape != shape:
+            # The last chunk may be shorter; its buffers are allocated once per thread.
+            out = buffers[register] = np.empty(shape, dtype=probe[id(node)][0])
+    return node.func(*args, out=out)
+
+
+class _Compiler:
+    def __init__(self, text: str) -> None:
+        self.text = text
+        self.counter = itertools.count()
+
+    def program(self, tree: ast.AST) -> _Program:
+        steps: List[_Materialize] = []
+        return _Program(self.node(tree, steps), steps)
+
+    def error(self, message: str) -> ValueError:
+        return ValueError(f"expression '{self.text}': {message}")
+
+    def node(self, tree: ast.AST, steps: List[_Materialize]) -> _Node:
+        if isinstance(tree, ast.Constant):
+            if isinstance(tree.value, (bool, int, float, complex)):
+                return _Const(tree.value)
+            raise self.error(f"unsupported constant {tree.value!r}")
+        if isinstance(tree, ast.Name):
+            return _Leaf(tree.id)
+        if isinstance(tree, ast.BinOp):
+            if isinstance(tree.op, ast.MatMult):
+                return self.materialize("matmul", [tree.left, tree.right], {}, steps)
+            func = _BINARY.get(type(tree.op))
+            if func is None:
+                raise self.error(f"unsupported operator {type(tree.op).__name__}")
+            return _Apply(func, (self.node(tree.left, steps), self.node(tree.right, steps)))
+        if isinstance(tree, ast.UnaryOp):
+            operand = self.node(tree.operand, steps)
+            if isinstance(tree.op, ast.UAdd):
+                return operand
+            if isinstance(tree.op, ast.USub) and isinstance(operand, _Const):
+                return _Const(-operand.value)
+            return _Apply(_UNARY[type(tree.op)], (operand,))
+        if isinstance(tree, ast.Compare):
+            if len(tree.ops) != 1 or type(tree.ops[0]) not in _COMPARE:
+                raise self.error("only single comparisons (<, <=, >, >=, ==, !=) are supported")
+            operands = (self.node(tree.left, steps), self.node(tree.comparators[0], steps))
+            return _Apply(_COMPARE[type(tree.ops[0])], operands)
+        if isinstance(tree, ast.BoolOp):
+            func = np.logical_and if isinstance(tree.op, ast.And) else np.logical_or
+            operands = [self.node(value, steps) for value in tree.values]
+            return functools.reduce(lambda left, right: _Apply(func, (left, right)), operands)
+        if isinstance(tree, ast.IfExp):
+            return _Apply(_where, tuple(self.node(part, steps) for part in (tree.test, tree.body, tree.orelse)))
+        if isinstance(tree, ast.Call):
+            return self.call(tree, steps)
+        raise self.error(f"unsupported syntax ({type(tree).__name__})")
+
+    def call(self, tree: ast.Call, steps: List[_Materialize]) -> _Node:
+        name = tree.func.id if isinstance(tree.func, ast.Name) else None
+        if name not in FUNCTIONS:
+            raise self.error(f"unknown function {ast.unparse(tree.func)}; available: {', '.join(sorted(FUNCTIONS))}")
+        if name in _MATERIALIZED:
+            return self.materialized_call(name, tree, steps)
+        if tree.keywords:
+            raise self.error(f"{name}() takes no keyword arguments")
+        args = [self.node(arg, steps) for arg in tree.args]
+        arity = _COMPOSITES[name][0] if name in _COMPOSITES else _UFUNCS[name].nin
+        if len(args) != arity:
+            raise self.error(f"{name}() takes {arity} argument(s), got {len(args)}")
+        if name in _COMPOSITES:
+            return _COMPOSITES[name][1](*args)
+        return _Apply(_UFUNCS[name], tuple(args))
+
+    def materialized_call(self, name: str, tree: ast.Call, steps: List[_Materialize]) -> _Node:
+        if name == "matmul":
+            if len(tree.args) != 2 or tree.keywords:
+                raise self.error("matmul() takes 2 arguments")
+            return self.materialize(name, tree.args, {}, steps)
+        if not 1 <= len(tree.args) <= 2:
+            raise self.error(f"{name}() takes an operand and an optional axis")
+        kwargs: Dict[str, Any] = {"axis": self.literal(tree.args[1])} if len(tree.args) == 2 else {}
+        for keyword_arg in tree.keywords:
+            if keyword_arg.arg not in ("axis", "keepdims"):
+                raise self.error(f"{name}() accepts only axis and keepdims keywords")
+            kwargs[keyword_arg.arg] = self.literal(keyword_arg.value)
+        return self.materialize(name, tree.args[:1], kwargs, steps)
+
+    def materialize(
+        self, name: str, operands: Sequence[ast.AST], kwargs: Mapping[str, Any], steps: List[_Materialize]
+    ) -> _Node:
+        leaf = f"@{next(self.counter)}"
+        steps.append(_Materialize(leaf, _MATERIALIZED[name], tuple(self.program(op) for op in operands), dict(kwargs)))
+        return _Leaf(leaf)
+
+    def literal(self, tree: ast.AST) -> Any:
+        try:
+            return ast.literal_eval(tree)
+        except ValueError as exc:
+            raise self.error(f"axis/keepdims must be literals, got {ast.unparse(tree)}") from exc
+
+
+@dataclass(frozen=True)
+class Expression:
+    text: str
+    program: _Program
+
+    @property
+    def names(self) -> FrozenSet[str]:
+        """Free names: inputs, params or constants the bindings must supply."""
+
+        return self.program.names
+
+    def evaluate(self, bindings: Mapping[str, Any], threads: Optional[int] = None) -> np.ndarray:
+        missing = sorted(self.names - set(bindings))
+        if missing:
+            raise ValueError(
+                f"expression '{self.text}' uses unknown name(s) {', '.join(missing)}; "
+                f"bound: {', '.join(sorted(name for name in bindings if name not in CONSTANTS))}"
+            )
+        return self.program.evaluate(bindings, threads)
+
+
+@functools.lru_cache(maxsize=256)
+def compile_expression(text: str) -> Expression:
+    """Parse ``text`` into an evaluation plan; raises ValueError for unsupported syntax."""
+
+    try:
+        tree = ast.parse(text.strip(), mode="eval")
+    except SyntaxError as exc:
+        raise ValueError(f"expression '{text}': {exc.msg}") from exc
+    return Expression(text=text, program=_Compiler(text).program(tree.body))
+
+
+def bind(input_paths: Sequence[Path], inputs: Sequence[np.ndarray], params: Mapping[str, Any]) -> Dict[str, Any]:
+    """Names visible to an expression: constants, numeric ``params``, then inputs as ``input<i>`` and by file stem."""
+
+    values: Dict[str, Any] = dict(CONSTANTS)
+    values.update({key: value for key, value in params.items() if isinstance(value, (int, float))})
+    stems = [Path(path).name.split(".")[0] for path in input_paths]
+    counts = Counter(stems)
+    for index, (stem, array) in enumerate(zip(stems, inputs)):
+        values[f"input{index}"] = array
+        if stem.isidentifier() and not keyword.iskeyword(stem) and counts[stem] == 1:
+            values[stem] = array
+    return values
+
+
+def evaluate_all(
+    texts: Sequence[str], bindings: Mapping[str, Any], threads: Optional[int] = None
+) -> Tuple[np.ndarray, ...]:
+    return tuple(compile_expression(text).evaluate(bindings, threads) for text in texts)
@@ -0,0 +1,288 @@
+"""Built-in input generators.
+
+Every builtin fills a destination array in its final dtype, chunk by chunk.
+Chunk ``i`` draws from its own ``numpy.random.Generator`` spawned from the
+input's ``SeedSequence``, so the output depends only on the seed and the chunk
+size (never on how many threads generated it) and chunks can run in parallel:
+NumPy's bit generators release the GIL while filling buffers.
+"""
+from __future__ import annotations
+
+import functools
+import os
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Callable, Dict, Mapping, Sequence
+
+import numpy as np
+
+from .models import GeneratorConfig
+
+CHUNK_ELEMENTS = 1 << 20
+
+# fill(out_chunk, rng, params, start) writes one flat chunk; ``start`` is its flat offset.
+ChunkFiller = Callable[[np.ndarray, np.random.Generator, Mapping[str, Any], int], None]
+
+_SPECIAL_FLOATS = ("nan", "inf", "-inf", "denormal", "zero", "-zero", "max", "min", "tiny")
+_SPECIAL_INTS = ("zero", "max", "min")
+
+
+def _is_float(dtype: np.dtype) -> bool:
+    return np.issubdtype(dtype, np.floating)
+
+
+def _fill_normal(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    mean = float(params.get("mean", 0.0))
+    std = float(params.get("std", 1.0))
+    if out.dtype in (np.float32, np.float64):
+        rng.standard_normal(out=out, dtype=out.dtype)
+    elif _is_float(out.dtype):
+        out[...] = rng.standard_normal(size=out.size, dtype=np.float32)
+    else:
+        values = rng.standard_normal(size=out.size, dtype=np.float32)
+        values *= std
+        values += mean
+        np.rint(values, out=out, casting="unsafe")
+        return
+    if std != 1.0 or mean != 0.0:
+        out *= std
+        out += mean
+
+
+def _fill_uniform(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    low = params.get("low", -1.0)
+    high = params.get("high", 1.0)
+    if not _is_float(out.dtype):
+        _fill_integers(out, rng, {"low": low, "high": high}, start)
+        return
+    low, high = float(low), float(high)
+    if out.dtype in (np.float32, np.float64):
+        rng.random(out=out, dtype=out.dtype)
+    else:
+        out[...] = rng.random(size=out.size, dtype=np.float32)
+    out *= high - low
+    out += low
+
+
+def _fill_integers(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    low = int(params.get("low", 0))
+    high = int(params.get("high", 100))
+    endpoint = bool(params.get("endpoint", False))
+    if out.dtype == np.bool_:
+        out[...] = rng.integers(0, 2, size=out.size, dtype=np.uint8)
+    elif np.issubdtype(out.dtype, np.integer):
+        info = np.iinfo(out.dtype)
+        low = max(low, int(info.min))
+        high = min(high, int(info.max)) if endpoint else min(high, int(info.max) + 1)
+        out[...] = rng.integers(low, high, size=out.size, dtype=out.dtype, endpoint=endpoint)
+    else:
+        out[...] = rng.integers(low, high, size=out.size, endpoint=endpoint)
+
+
+def _fill_ones(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    out.fill(1)
+
+
+def _fill_arange(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    first = float(params.get("start", 0))
+    step = float(params.get("step", 1))
+    values = np.arange(start, start + out.size, dtype=np.float64)
+    values *= step
+    values += first
+    out[...] = values if _is_float(out.dtype) else np.rint(values)
+
+
+def _fill_mask(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    sparsity = float(params.get("sparsity", 0.5))
+    if not 0.0 <= sparsity <= 1.0:
+        raise ValueError("builtin.mask params.sparsity must be within [0, 1]")
+    keep = rng.random(size=out.size, dtype=np.float32) >= sparsity
+    if out.dtype == np.bool_:
+        out[...] = keep
+    else:
+        out[...] = 0
+        out[keep] = params.get("value", 1)
+
+
+@functools.lru_cache(maxsize=8)
+def _zipf_cdf(count: int, skew: float) -> np.ndarray:
+    weights = np.arange(1, count + 1, dtype=np.float64) ** -skew
+    cdf = np.cumsum(weights)
+    return cdf / cdf[-1]
+
+
+def _fill_indices(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    """Index tensors for gather/scatter/embedding workloads.
+
+    ``skew`` > 0 draws ranks from a bounded Zipf law (rank ``r`` with weight ``(r + 1) ** -skew``,
+    so low ids are hot); ``locality`` is the probability that an index is a short step
+    (within ``window``) from its predecessor instead of a fresh draw.
+    """
+
+    if "high" not in params:
+        raise ValueError("builtin.indices needs params.high (exclusive upper bound, e.g. the table size)")
+    low = int(params.get("low", 0))
+    count = int(params["high"]) - low
+    skew = float(params.get("skew", 0.0))
+    locality = float(params.get("locality", 0.0))
+    window = int(params.get("window", 8))
+    if count <= 0 or skew < 0 or not 0.0 <= locality <= 1.0 or window < 1:
+        raise ValueError("builtin.indices needs high > low, skew >= 0, 0 <= locality <= 1 and window >= 1")
+    if skew > 0:
+        fresh = np.searchsorted(_zipf_cdf(count, skew), rng.random(size=out.size), side="right")
+        fresh = np.minimum(fresh, count - 1)
+    else:
+        fresh = rng.integers(0, count, size=out.size, dtype=np.int64)
+    if locality > 0 and out.size:
+        near = rng.random(size=out.size) < locality
+        near[0] = False
+        steps = np.where(near, rng.integers(-window, window + 1, size=out.size), 0)
+        # Each run of "near" elements walks from the fresh draw that starts it.
+        run_start = np.maximum.accumulate(np.where(near, 0, np.arange(out.size)))
+        walked = np.cumsum(steps)
+        fresh = (fresh[run_start] + walked - walked[run_start]) % count
+    out[...] = fresh + low
+
+
+def special_values(dtype: np.dtype, kinds: Sequence[str]) -> np.ndarray:
+    """Materialize the named special values for ``dtype``."""
+
+    dtype = np.dtype(dtype)
+    values: list[Any] = []
+    if _is_float(dtype):
+        info = np.finfo(dtype)
+        table = {
+            "nan": np.nan,
+            "inf": np.inf,
+            "-inf": -np.inf,
+            "denormal": info.smallest_subnormal,
+            "zero": 0.0,
+            "-zero": -0.0,
+            "max": info.max,
+            "min": info.min,
+            "tiny": info.tiny,
+        }
+    elif dtype == np.bool_:
+        table = {"zero": False, "max": True, "min": False}
+    else:
+        iinfo = np.iinfo(dtype)
+        table = {"zero": 0, "max": iinfo.max, "min": iinfo.min}
+    for kind in kinds:
+        if kind not in table:
+            raise ValueError(f"Special value '{kind}' is not defined for {dtype.name}. Supported: {sorted(table)}")
+        values.append(table[kind])
+    return np.array(values, dtype=dtype)
+
+
+def _fill_special(out: np.ndarray, rng: np.random.Generator, params: Mapping[str, Any], start: int) -> None:
+    density = float(params.get("density", 0.1))
+    default_kinds = _SPECIAL_FLOATS if _is_float(out.dtype) else _SPECIAL_INTS
+    kinds = [str(kind) for kind in params.get("values", default_kinds)]
+    base = str(params.get("base", "normal"))
+    if base not in _FILLERS or base in {"special"}:
+        raise ValueError(f"builtin.special params.base must name another builtin generator, got '{base}'")
+    _FILLERS[base](out, rng, params, start)
+    specials = special_values(out.dtype, kinds)
+    hits = np.flatnonzero(rng.random(size=out.size, dtype=np.float32) < density)
+    out[hits] = specials[rng.integers(0, specials.size, size=hits.size)]
+
+
+def inject_denormals(values: np.ndarray, fraction: float, rng: np.random.Generator) -> np.ndarray:
+    """Copy of a float tensor with ``fraction`` of its elements replaced by subnormals of either sign.
+
+    Other dtypes are returned unchanged. Magnitudes are spread over the upper part of the subnormal
+    range (1% to 99% of the smallest normal), so none of them rounds to zero.
+    """
+
+    if not _is_float(values.dtype):
+        return values
+    out = np.array(values, copy=True)
+    flat = out.reshape(-1)
+    count = int(round(fraction * flat.size))
+    if count == 0:
+        return out
+    hits = rng.choice(flat.size, size=count, replace=False)
+    tiny = float(np.finfo(out.dtype).tiny)
+    magnitudes = tiny * (0.01 + 0.98 * rng.random(size=count))
+    flat[hits] = np.where(rng.random(size=count) < 0.5, -magnitudes, magnitudes).astype(out.dtype)
+    return out
+
+
+_FILLERS: Dict[str, ChunkFiller] = {
+    "random": _fill_normal,
+    "normal": _fill_normal,
+    "uniform": _fill_uniform,
+    "integers": _fill_integers,
+    "ones": _fill_ones,
+    "arange": _fill_arange,
+    "mask": _fill_mask,
+    "special": _fill_special,
+    "indices": _fill_indices,
+}
+
+
+def builtin_names() -> Sequence[str]:
+    return tuple(f"builtin.{name}" for name in sorted({*_FILLERS, "linspace"}))
+
+
+def _resolve_filler(name: str, size: int, params: Mapping[str, Any]) -> tuple[ChunkFiller, Mapping[str, Any]]:
+    key = name.split(".")[-1].lower()
+    if key == "linspace":
+        start = float(params.get("start", 0.0))
+        stop = float(params.get("stop", 1.0))
+        endpoint = bool(params.get("endpoint", True))
+        divisor = (size - 1 if endpoint else size) or 1
+        return _fill_arange, {"start": start, "step": (stop - start) / divisor}
+    if key not in _FILLERS:
+        raise ValueError(
+            f"Unknown generator '{name}'. "
+            f"Supported builtins: {', '.join(builtin_names())}. "
+            "For a custom generator, set both generator.name and generator.source."
+        )
+    return _FILLERS[key], params
+
+
+def generate(
+    config: GeneratorConfig,
+    shape: Sequence[int],
+    dtype: str,
+    seed: np.random.SeedSequence,
+    *,
+    out: np.ndarray | None = None,
+    threads: int | None = None,
+) -> np.ndarray:
+    """Fill ``out`` (allocated when omitted) with the builtin generator named by ``config``."""
+
+    np_dtype = np.dtype(dtype)
+    if out is None:
+        out = np.empty(tuple(shape), dtype=np_dtype)
+    elif not out.flags.c_contiguous:
+        # Strided/pitched destinations: generate densely, then scatter into the view.
+        out[...] = generate(config, shape, dtype, seed, threads=threads)
+        return out
+    flat = out.reshape(-1)
+    constants = config.constants or {}
+    if "value" in constants:
+        flat.fill(constants["value"])
+        return out
+    filler, params = _resolve_filler(config.name, flat.size, config.params)
+    starts = range(0, flat.size, CHUNK_ELEMENTS)
+    chunk_seeds = seed.spawn(len(starts))
+
+    def _fill(index: int) -> None:
+        begin = starts[index]
+        filler(flat[begin : begin + CHUNK_ELEMENTS], np.random.default_rng(chunk_seeds[index]), params, begin)
+
+    workers = min(len(starts), threads or os.cpu_count() or 1)
+    if workers <= 1:
+        for index in range(len(starts)):
+            _fill(index)
+    else:
+        with ThreadPoolExecutor(max_workers=workers) as pool:
+            list(pool.map(_fill, range(len(starts))))
+    if filler is _fill_normal:
+        scale = float(constants.get("scale", 1.0))
+        shift = float(constants.get("shift", 0.0))
+        if scale != 1.0 or shift != 0.0:
+            np.multiply(flat, scale, out=flat, casting="unsafe")
+            np.add(flat, shift, out=flat, casting="unsafe")
+    return out
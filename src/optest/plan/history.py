@@ -0,0 +1,158 @@
+"""Local run history: one JSON line per ``optest bench`` invocation.
+
+Each line records when and where the benchmark ran plus, per case, the timed
+samples and the median runner metrics::
+
+    {"time": 1760781234.5, "plan": "matmul_cpp", "category": "gemm", "host": "node-3",
+     "cases": [{"id": "gemm@cuda:local/shape0", "status": "ok", "samples_s": [...],
+                "metrics": {"kernel_ms": 0.42, "gflops": 118.3}}]}
+
+Appending never rewrites earlier lines, so the file can grow for months;
+``load_history`` streams it and keeps only what the caller asks for.
+"""
+from __future__ import annotations
+
+import json
+import math
+import os
+import platform
+import statistics
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, Iterable, Iterator, List, Mapping, Optional, Sequence
+
+from .models import BenchResult, BenchSettings, ExecutionPlan
+
+HISTORY_ENV = "OPTEST_HISTORY"
+HISTORY_RELPATH = Path(".optest") / "history.jsonl"
+
+
+@dataclass
+class HistoryPoint:
+    """One case measured in one recorded bench run (``median``: of ``samples``, in seconds)."""
+
+    time: float
+    identifier: str
+    status: str
+    median: Optional[float] = None
+    samples: Sequence[float] = field(default_factory=tuple)
+    metrics: Mapping[str, float] = field(default_factory=dict)
+    plan: str = ""
+    host: str = ""
+    category: str = ""
+
+    @property
+    def case(self) -> str:
+        return self.identifier.partition("@")[0]
+
+    @property
+    def target(self) -> str:
+        # "case@backend:chip/shapeN" -> "backend:chip"
+        return self.identifier.partition("@")[2].rpartition("/")[0]
+
+
+def default_history_path(plan: ExecutionPlan | None = None) -> Path:
+    """``$OPTEST_HISTORY``, else ``.optest/history.jsonl`` next to the plan (or in the working directory)."""
+
+    if os.environ.get(HISTORY_ENV):
+        return Path(os.environ[HISTORY_ENV])
+    base = plan.plan_dir if plan is not None else Path.cwd()
+    return base / HISTORY_RELPATH
+
+
+def record_bench(
+    path: str | Path,
+    plan: ExecutionPlan,
+    results: Sequence[BenchResult],
+    settings: BenchSettings,
+    *,
+    timestamp: float | None = None,
+) -> None:
+    """Append the results of one bench invocation to the history file."""
+
+    entry: Dict[str, Any] = {
+        "time": time.time() if timestamp is None else timestamp,
+        "plan": plan.operator,
+        "category": plan.category or plan.operator,
+        "host": platform.node(),
+        "warmup": settings.warmup,
+        "repeat": settings.repeat,
+        "cache_state": settings.cache_state,
+        "cases": [_history_case(item) for item in results],
+    }
+    target = Path(path)
+    target.parent.mkdir(parents=True, exist_ok=True)
+    # A single write of one line: concurrent benches append whole records.
+    with target.open("a", encoding="utf-8") as handle:
+        handle.write(json.dumps(entry, separators=(",", ":")) + "\n")
+
+
+def _history_case(item: BenchResult) -> Dict[str, Any]:
+    case: Dict[str, Any] = {
+        "id": item.identifier,
+        "status": item.status,
+        "samples_s": [float(f"{x:.7g}") for x in item.samples],  # timer noise is far above 7 digits
+        "metrics": dict(item.metrics),
+    }
+    if item.cold_samples:
+        case["cold_samples_s"] = [float(f"{x:.7g}") for x in item.cold_samples]
+    return case
+
+
+def iter_history(paths: Iterable[str | Path], *, since: float | None = None) -> Iterator[HistoryPoint]:
+    """Stream recorded points from one or more history files, skipping truncated lines."""
+
+    for path in paths:
+        path = Path(path)
+        if not path.exists():
+            continue
+        with path.open("r", encoding="utf-8") as handle:
+            for line in handle:
+                if since is not None and _stamp_prefix(line) < since:
+                    continue  # cheap skip of old runs without decoding the line
+                try:
+                    entry = json.loads(line)
+                    stamp = float(entry["time"])
+                except (ValueError, KeyError, TypeError):
+                    continue  # e.g. a line cut short by an interrupted bench
+                if since is not None and stamp < since:
+                    continue
+                plan, host = str(entry.get("plan", "")), str(entry.get("host", ""))
+                category = str(entry.get("category") or plan)
+                for case in entry.get("cases") or ():
+                    # json already yields floats: no per-value conversion, this loop dominates load time.
+                    samples = tuple(case.get("samples_s") or ())
+                    yield HistoryPoint(
+                        stamp,
+                        str(case.get("id", "")),
+                        str(case.get("status", "ok")),
+                        statistics.median(samples) if samples else None,
+                        samples,
+                        case.get("metrics") or {},
+                        plan,
+                        host,
+                        category,
+                    )
+
+
+def _stamp_prefix(line: str) -> float:
+    # record_bench writes "time" first: {"time":1760781234.5,...}; anything else is decoded in full.
+    head, sep, _ = line[8:40].partition(",")
+    if not line.startswith('{"time":') or not sep:
+        return math.inf
+    try:
+        return float(head)
+    except ValueError:
+        return math.inf
+
+
+def load_history(paths: Iterable[str | Path], *, since: float | None = None) -> Dict[str, List[HistoryPoint]]:
+    """Points grouped by case identifier, oldest first."""
+
+    series: Dict[str, List[HistoryPoint]] = {}
+    for point in iter_history(paths, since=since):
+        series.setdefault(point.identifier, []).append(point)
+    for points in series.values():
+        points.sort(key=lambda point: point.time)
+    return series
@@ -1,6 +1,7 @@
 """YAML loader and validation for the redesigned plan format."""
 from __future__ import annotations
 
+import re
 import shlex
 from pathlib import Path
 from typing import Any, Dict, Mapping, Sequence
@@ -8,18 +9,30 @@ from typing import Any, Dict, Mapping, Sequence
 import yaml
 from jsonschema import Draft7Validator, ValidationError
 
+from optest.storage.cache import CompressionPolicy
+
+from . import expression
 from .models import (
     AssertionConfig,
     BackendConfig,
+    BuildConfig,
     CaseBackends,
     CaseConfig,
     CaseShape,
     CommandConfig,
     ExecutionPlan,
     GeneratorConfig,
+    PipelineConfig,
+    PipelineNode,
+    SessionConfig,
+    StorageConfig,
+    TensorLayout,
 )
 
 ALLOWED_BACKENDS = {"cann", "cuda"}
+ALLOWED_FORMATS = {"raw", "optt"}
+PIPELINE_RUN_MODES = {"backend", "builtin"}
+_PIPELINE_INPUT = re.compile(r"input(\d+)$")
 
 
 def load_plan(path: str) -> ExecutionPlan:
@@ -34,6 +47,7 @@ def load_plan(path: str) -> ExecutionPlan:
         raise ValueError(f"Plan schema validation failed: {messages}")
     operator = _require_str(raw, "operator")
     description = str(raw.get("description", ""))
+    category = str(raw.get("category") or operator)
     inputs = _parse_str_list(raw.get("inputs"))
     outputs = _parse_str_list(raw.get("outputs"))
     generator = _parse_generator(raw.get("generator"), plan_path.parent)
@@ -47,7 +61,10 @@ def load_plan(path: str) -> ExecutionPlan:
     priority = raw.get("priority")
     if priority is not None:
         priority = int(priority)
+    storage = _parse_storage(raw.get("storage"), plan_path.parent)
+    pipeline = _parse_pipeline(raw.get("pipeline"), plan_path.parent, inputs, outputs)
     _validate_cases(inputs, outputs, cases)
+    _validate_layouts(storage, cases)
     return ExecutionPlan(
         operator=operator,
         description=description,
@@ -61,6 +78,9 @@ def load_plan(path: str) -> ExecutionPlan:
         tags=tags,
         priority=priority,
         plan_dir=plan_path.parent,
+        storage=storage,
+        category=category,
+        pipeline=pipeline,
     )
 
 
@@ -122,16 +142,23 @@ def _parse_generator(raw: Any, base: Path, default: str = "builtin.random") -> G
     )
 
 
-def _parse_assertion(raw: Any, base: Path, default: str = "builtin.identity") -> AssertionConfig:
+def _parse_assertion(
+    raw: Any, base: Path, default: str = "builtin.identity", default_expr: Sequence[str] | None = None
+) -> AssertionConfig:
     if raw is None:
-        return AssertionConfig(name=default)
+        return AssertionConfig(name=default, expr=default_expr)
     if isinstance(raw, str):
         return AssertionConfig(name=raw)
     if not isinstance(raw, Mapping):
         raise ValueError("assertion must be a string or mapping")
-    name = str(raw.get("name", default))
     source = raw.get("source")
     source_path = base / source if source else None
+    expr = _parse_expr(raw["expr"]) if raw.get("expr") is not None else None
+    if expr is not None and source:
+        raise ValueError("assertion.expr and assertion.source are mutually exclusive")
+    if expr is None and "name" not in raw:
+        expr = default_expr  # a case overriding only tolerances keeps the plan's expression
+    name = str(raw.get("name", "expr" if expr is not None else default))
     rtol = raw.get("rtol")
     atol = raw.get("atol")
     metric = raw.get("metric")
@@ -147,6 +174,62 @@ def _parse_assertion(raw: Any, base: Path, default: str = "builtin.identity") ->
         metric=str(metric) if metric is not None else None,
         output_dtypes=output_dtypes,
         params=params,
+        region=_parse_region(raw.get("region")),
+        equal_nan=bool(raw.get("equal_nan", False)),
+        expr=expr,
+    )
+
+
+def _parse_expr(raw: Any) -> tuple[str, ...]:
+    texts = [raw] if isinstance(raw, str) else raw
+    if not isinstance(texts, list) or not texts or not all(isinstance(text, str) for text in texts):
+        raise ValueError("assertion.expr must be a string or a list of strings (one per output)")
+    for text in texts:
+        expression.compile_expression(text)  # syntax errors surface at load time
+    return tuple(texts)
+
+
+def _parse_storage(raw: Any, base: Path) -> StorageConfig:
+    if raw is None:
+        return StorageConfig()
+    if not isinstance(raw, Mapping):
+        raise ValueError("storage must be a mapping")
+    file_format = str(raw.get("format", "raw"))
+    if file_format not in ALLOWED_FORMATS:
+        raise ValueError(f"storage.format must be one of {sorted(ALLOWED_FORMATS)}")
+    cache_dir = raw.get("cache_dir")
+    compression = _parse_compression(raw.get("compress"))
+    if compression and not cache_dir:
+        raise ValueError("storage.compress requires storage.cache_dir")
+    shared_dir = raw.get("shared_dir")
+    if shared_dir and not cache_dir:
+        raise ValueError("storage.shared_dir requires storage.cache_dir (the local read-through cache)")
+    return StorageConfig(
+        format=file_format,
+        cache_dir=(base / str(cache_dir)).resolve() if cache_dir else None,
+        compression=compression,
+        shared_dir=(base / str(shared_dir)).expanduser().resolve() if shared_dir else None,
+        claim_timeout=float(raw.get("claim_timeout", 900.0)),
+    )
+
+
+def _parse_compression(raw: Any) -> CompressionPolicy | None:
+    if raw is None or raw is False:
+        return None
+    if raw is True:
+        return CompressionPolicy()
+    if not isinstance(raw, Mapping):
+        raise ValueError("storage.compress must be a boolean or mapping")
+    defaults = CompressionPolicy()
+    codec = str(raw.get("codec", defaults.codec))
+    if codec not in {"zlib", "lzma"}:
+        raise ValueError("storage.compress.codec must be 'zlib' or 'lzma'")
+    return CompressionPolicy(
+        codec=codec,
+        level=int(raw.get("level", defaults.level)),
+        min_bytes=int(raw.get("min_bytes", defaults.min_bytes)),
+        chunk_bytes=int(raw.get("chunk_bytes", defaults.chunk_bytes)),
+        max_ratio=float(raw.get("max_ratio", defaults.max_ratio)),
     )
 
 
@@ -179,6 +262,11 @@ def _parse_backends(raw: Any, base: Path) -> tuple[BackendConfig, ...]:
         only_cases = tuple(str(x) for x in entry.get("only_cases", []) or [])
         skip_cases = tuple(str(x) for x in entry.get("skip_cases", []) or [])
         xfail_cases = tuple(str(x) for x in entry.get("xfail_cases", []) or [])
+        build = _parse_build(entry.get("build"), base)
+        session = _parse_session(entry.get("session"))
+        host_cpu = entry.get("host_cpu", False)
+        if not isinstance(host_cpu, bool):
+            raise ValueError(f"Backend {b_type}:{chip} host_cpu must be true or false")
         backends.append(
             BackendConfig(
                 type=b_type,
@@ -193,11 +281,169 @@ def _parse_backends(raw: Any, base: Path) -> tuple[BackendConfig, ...]:
                 only_cases=only_cases,
                 skip_cases=skip_cases,
                 xfail_cases=xfail_cases,
+                build=build,
+                session=session,
+                host_cpu=host_cpu,
             )
         )
     return tuple(backends)
 
 
+def _parse_session(raw: Any) -> SessionConfig | None:
+    if raw is None or raw is False:
+        return None
+    if raw is True:
+        return SessionConfig()
+    if not isinstance(raw, Mapping):
+        raise ValueError("backend.session must be true or a mapping")
+    unknown = set(raw) - {"recycle_rss_mib", "recycle_fds", "leak_kib_per_call"}
+    if unknown:
+        raise ValueError(f"Unknown backend.session keys: {sorted(unknown)}")
+    rss = raw.get("recycle_rss_mib")
+    fds = raw.get("recycle_fds")
+    return SessionConfig(
+        recycle_rss_mib=float(rss) if rss is not None else None,
+        recycle_fds=int(fds) if fds is not None else None,
+        leak_kib_per_call=float(raw.get("leak_kib_per_call", 16.0)),
+    )
+
+
+def _parse_pipeline(
+    raw: Any, base: Path, plan_inputs: Sequence[str], plan_outputs: Sequence[str]
+) -> PipelineConfig | None:
+    if raw is None:
+        return None
+    if not isinstance(raw, Mapping):
+        raise ValueError("pipeline must be a mapping with nodes and outputs")
+    unknown = set(raw) - {"nodes", "outputs", "rtol", "atol"}
+    if unknown:
+        raise ValueError(f"Unknown pipeline keys: {sorted(unknown)}")
+    nodes_raw = raw.get("nodes")
+    if not isinstance(nodes_raw, list) or not nodes_raw:
+        raise ValueError("pipeline.nodes must be a non-empty list")
+    nodes: Dict[str, PipelineNode] = {}
+    for entry in nodes_raw:
+        if not isinstance(entry, Mapping):
+            raise ValueError("pipeline.nodes entries must be mappings")
+        node = _parse_pipeline_node(entry, base)
+        if node.name in nodes:
+            raise ValueError(f"Duplicate pipeline node '{node.name}'")
+        nodes[node.name] = node
+    outputs_raw = raw.get("outputs")
+    if outputs_raw is None:
+        last = list(nodes.values())[-1]
+        outputs = tuple(last.name if last.outputs == 1 else f"{last.name}.{i}" for i in range(last.outputs))
+    elif isinstance(outputs_raw, list) and outputs_raw:
+        outputs = tuple(str(ref) for ref in outputs_raw)
+    else:
+        raise ValueError("pipeline.outputs must be a non-empty list of node references")
+    if len(outputs) != len(plan_outputs):
+        raise ValueError(f"pipeline.outputs lists {len(outputs)} tensors but the plan has {len(plan_outputs)} outputs")
+    for ref in outputs:
+        _check_pipeline_ref(ref, "pipeline.outputs", nodes, len(plan_inputs))
+    for node in nodes.values():
+        for ref in node.inputs:
+            _check_pipeline_ref(ref, f"pipeline node '{node.name}'", nodes, len(plan_inputs))
+    rtol = raw.get("rtol")
+    atol = raw.get("atol")
+    return PipelineConfig(
+        nodes=_order_pipeline_nodes(nodes),
+        outputs=outputs,
+        rtol=float(rtol) if rtol is not None else None,
+        atol=float(atol) if atol is not None else None,
+    )
+
+
+def _parse_pipeline_node(entry: Mapping[str, Any], base: Path) -> PipelineNode:
+    name = _require_str(entry, "name")
+    if "." in name or _PIPELINE_INPUT.match(name):
+        raise ValueError(f"Pipeline node name '{name}' cannot contain '.' or look like a plan input (input<N>)")
+    if "op" not in entry:
+        raise ValueError(f"Pipeline node '{name}' needs an op (its builtin reference)")
+    op = _parse_assertion(entry["op"], base)
+    if op.source is not None or op.expr is not None:
+        raise ValueError(f"Pipeline node '{name}': op must be a builtin operator, not a custom source or expr")
+    inputs = entry.get("inputs")
+    if not isinstance(inputs, list) or not inputs:
+        raise ValueError(f"Pipeline node '{name}' needs a non-empty inputs list")
+    command = _parse_single_command(entry["command"]) if entry.get("command") is not None else None
+    run = str(entry.get("run", "command" if command else "backend"))
+    if command is not None and run != "command":
+        raise ValueError(f"Pipeline node '{name}' has a command, so run must be 'command'")
+    if command is None and run not in PIPELINE_RUN_MODES:
+        raise ValueError(f"Pipeline node '{name}': run must be one of {sorted(PIPELINE_RUN_MODES)} (or give a command)")
+    outputs = int(entry.get("outputs", 1))
+    if outputs < 1:
+        raise ValueError(f"Pipeline node '{name}' must have at least one output")
+    return PipelineNode(
+        name=name,
+        op=op,
+        inputs=tuple(str(ref) for ref in inputs),
+        outputs=outputs,
+        run=run,
+        command=command,
+        check=bool(entry.get("check", True)),
+    )
+
+
+def _check_pipeline_ref(ref: str, where: str, nodes: Mapping[str, PipelineNode], input_count: int) -> None:
+    match = _PIPELINE_INPUT.match(ref)
+    if match:
+        if int(match.group(1)) >= input_count:
+            raise ValueError(f"{where} references {ref} but the plan has {input_count} inputs")
+        return
+    name, _, index = ref.partition(".")
+    node = nodes.get(name)
+    if node is None:
+        raise ValueError(f"{where} references unknown node '{name}'")
+    if index and (not index.isdigit() or int(index) >= node.outputs):
+        raise ValueError(f"{where} references {ref} but node '{name}' has {node.outputs} output(s)")
+
+
+def _order_pipeline_nodes(nodes: Mapping[str, PipelineNode]) -> tuple[PipelineNode, ...]:
+    # Depth-first topological order; listing order is kept wherever dependencies allow it.
+    ordered: list[PipelineNode] = []
+    state: Dict[str, str] = {}
+
+    def visit(name: str, path: tuple[str, ...]) -> None:
+        if state.get(name) == "done":
+            return
+        if state.get(name) == "visiting":
+            raise ValueError(f"pipeline has a cycle: {' -> '.join(path + (name,))}")
+        state[name] = "visiting"
+        for ref in nodes[name].inputs:
+            if not _PIPELINE_INPUT.match(ref):
+                visit(ref.partition(".")[0], path + (name,))
+        state[name] = "done"
+        ordered.append(nodes[name])
+
+    for name in nodes:
+        visit(name, ())
+    return tuple(ordered)
+
+
+def _parse_build(raw: Any, base: Path) -> BuildConfig | None:
+    if raw is None:
+        return None
+    if not isinstance(raw, Mapping):
+        raise ValueError("backend.build must be a mapping")
+    source = raw.get("source")
+    if not source:
+        raise ValueError("backend.build.source must name the CMake source directory")
+    source_dir = (base / str(source)).resolve()
+    build_dir = (base / str(raw.get("dir", Path(str(source)) / "build"))).resolve()
+    args = raw.get("cmake_args") or []
+    if not isinstance(args, list):
+        raise ValueError("backend.build.cmake_args must be a list of strings")
+    target = raw.get("target")
+    return BuildConfig(
+        source_dir=source_dir,
+        build_dir=build_dir,
+        target=str(target) if target else None,
+        cmake_args=tuple(str(arg) for arg in args),
+    )
+
+
 def _parse_single_command(raw: Any) -> CommandConfig:
     argv = _normalize_command(raw)
     return CommandConfig(argv=argv)
@@ -266,11 +512,22 @@ def _parse_cases(
         for shape_entry in shapes_raw:
             if not isinstance(shape_entry, Mapping):
                 raise ValueError("case shapes entries must be mappings")
-            inputs = _parse_shape_list(shape_entry.get("inputs"))
-            outputs = _parse_shape_list(shape_entry.get("outputs"))
-            shapes.append(CaseShape(inputs=inputs, outputs=outputs))
+            inputs, input_layouts = _parse_shape_list(shape_entry.get("inputs"))
+            outputs, output_layouts = _parse_shape_list(shape_entry.get("outputs"))
+            shapes.append(
+                CaseShape(
+                    inputs=inputs,
+                    outputs=outputs,
+                    input_layouts=input_layouts,
+                    output_layouts=output_layouts,
+                )
+            )
         generator = _parse_generator(entry.get("generator"), base, default_generator.name) if "generator" in entry else None
-        assertion = _parse_assertion(entry.get("assertion"), base, default_assertion.name) if "assertion" in entry else None
+        assertion = (
+            _parse_assertion(entry.get("assertion"), base, default_assertion.name, default_assertion.expr)
+            if "assertion" in entry
+            else None
+        )
         inputs_override = tuple(str(x) for x in entry.get("inputs", []) or []) or None
         outputs_override = tuple(str(x) for x in entry.get("outputs", []) or []) or None
         backend_filters = entry.get("backends") or {}
@@ -302,19 +559,91 @@ def _parse_cases(
     return tuple(cases)
 
 
-def _parse_shape_list(raw: Any) -> tuple[tuple[int, ...], ...]:
+def _parse_shape_list(
+    raw: Any,
+) -> tuple[tuple[tuple[int, ...], ...], tuple[TensorLayout | None, ...]]:
     if not isinstance(raw, list) or not raw:
         raise ValueError("shapes inputs/outputs must be non-empty lists")
     shapes: list[tuple[int, ...]] = []
+    layouts: list[TensorLayout | None] = []
     for shape in raw:
+        layout = None
         if isinstance(shape, (list, tuple)):
             dims = tuple(int(dim) for dim in shape)
+        elif isinstance(shape, Mapping):
+            dims = tuple(int(dim) for dim in shape.get("dims") or ())
+            layout = _parse_layout(shape, dims)
         else:
-            raise ValueError("shape entries must be lists")
+            raise ValueError("shape entries must be lists or {dims, strides|pitch, offset} mappings")
         if not dims:
             raise ValueError("shape cannot be empty")
         shapes.append(dims)
-    return tuple(shapes)
+        layouts.append(layout)
+    return tuple(shapes), (tuple(layouts) if any(layouts) else ())
+
+
+def _parse_layout(raw: Mapping[str, Any], dims: tuple[int, ...]) -> TensorLayout | None:
+    strides_raw = raw.get("strides")
+    pitch = raw.get("pitch")
+    offset = int(raw.get("offset", 0))
+    if offset < 0:
+        raise ValueError("shape offset must be >= 0")
+    if strides_raw is not None and pitch is not None:
+        raise ValueError("shape entries accept strides or pitch, not both")
+    strides: tuple[int, ...] | None = None
+    if strides_raw is not None:
+        strides = tuple(int(stride) for stride in strides_raw)
+        if len(strides) != len(dims):
+            raise ValueError(f"strides {list(strides)} must have one entry per dim of {list(dims)}")
+    elif pitch is not None:
+        pitch = int(pitch)
+        if len(dims) < 2 or pitch < dims[-1]:
+            raise ValueError(f"pitch {pitch} needs at least 2 dims and must be >= the row length {dims[-1:]}")
+        values = [1, pitch]
+        for dim in reversed(dims[1:-1]):
+            values.append(values[-1] * dim)
+        strides = tuple(reversed(values))
+    if strides is not None and any(stride <= 0 for stride in strides):
+        raise ValueError("strides must be positive")
+    if strides is None and offset == 0:
+        return None
+    return TensorLayout(strides=strides, offset=offset)
+
+
+def _parse_region(raw: Any) -> tuple[slice, ...] | None:
+    if raw is None:
+        return None
+    items = raw.split(",") if isinstance(raw, str) else raw
+    if not isinstance(items, (list, tuple)) or not items:
+        raise ValueError("assertion.region must be a list of slices like ['0:4', ':'] or a string '0:4, :'")
+    region: list[slice] = []
+    for item in items:
+        text = str(item).strip()
+        try:
+            if ":" not in text:
+                index = int(text)
+                region.append(slice(index, index + 1 if index != -1 else None))
+                continue
+            parts = [int(part) if part.strip() else None for part in text.split(":")]
+        except ValueError as exc:
+            raise ValueError(f"Invalid assertion.region entry '{item}'") from exc
+        if len(parts) > 3:
+            raise ValueError(f"Invalid assertion.region entry '{item}'")
+        region.append(slice(*parts))
+    return tuple(region)
+
+
+def _validate_layouts(storage: StorageConfig, cases: Sequence[CaseConfig]) -> None:
+    # Containers are written dense, so a layout would be silently dropped rather than honoured.
+    if storage.format == "raw":
+        return
+    for case in cases:
+        for idx, shape in enumerate(case.shapes):
+            if shape.input_layouts or shape.output_layouts:
+                raise ValueError(
+                    f"Case '{case.name}' shape index {idx} sets strides/pitch/offset, which storage.format "
+                    f"'{storage.format}' cannot store; use format 'raw'"
+                )
 
 
 def _validate_cases(
@@ -348,6 +677,7 @@ PLAN_SCHEMA = {
     "properties": {
         "operator": {"type": "string", "minLength": 1},
         "description": {"type": "string"},
+        "category": {"type": "string"},
         "inputs": {"type": "array", "minItems": 1, "items": {"type": "string"}},
         "outputs": {"type": "array", "minItems": 1, "items": {"type": "string"}},
         "generator": {"type": ["string", "object"]},
@@ -357,6 +687,8 @@ PLAN_SCHEMA = {
         "cache": {"type": "string"},
         "tags": {"type": "array", "items": {"type": "string"}},
         "priority": {"type": ["number", "integer"]},
+        "storage": {"type": "object"},
+        "pipeline": {"type": "object"},
     },
 }
 _validator = Draft7Validator(PLAN_SCHEMA)
@@ -5,6 +5,8 @@ from dataclasses import dataclass, field
 from pathlib import Path
 from typing import Any, Dict, List, Mapping, Optional, Sequence
 
+from optest.storage.cache import CompressionPolicy
+
 
 @dataclass(frozen=True)
 class GeneratorConfig:
@@ -25,6 +27,9 @@ class AssertionConfig:
     metric: Optional[str] = None
     output_dtypes: Optional[Sequence[str]] = None
     params: Mapping[str, Any] = field(default_factory=dict)
+    region: Optional[Sequence[slice]] = None
+    equal_nan: bool = False
+    expr: Optional[Sequence[str]] = None  # one expression per output, evaluated instead of a builtin reference
 
 
 @dataclass(frozen=True)
@@ -32,6 +37,23 @@ class CommandConfig:
     argv: Sequence[str]
 
 
+@dataclass(frozen=True)
+class BuildConfig:
+    source_dir: Path
+    build_dir: Path
+    target: Optional[str] = None
+    cmake_args: Sequence[str] = field(default_factory=tuple)
+
+
+@dataclass(frozen=True)
+class SessionConfig:
+    """Long-lived runner: ``command`` starts once per backend and serves one case per request on stdin."""
+
+    recycle_rss_mib: Optional[float] = None
+    recycle_fds: Optional[int] = None
+    leak_kib_per_call: float = 16.0
+
+
 @dataclass(frozen=True)
 class BackendConfig:
     type: str
@@ -46,12 +68,25 @@ class BackendConfig:
     only_cases: Sequence[str]
     skip_cases: Sequence[str]
     xfail_cases: Sequence[str]
+    build: Optional[BuildConfig] = None
+    session: Optional[SessionConfig] = None
+    host_cpu: bool = False  # the runner computes on this host's CPU, so the machine profile's ceilings apply
+
+
+@dataclass(frozen=True)
+class TensorLayout:
+    """Placement of a tensor inside a raw file, in elements (``strides=None`` means C-contiguous)."""
+
+    strides: Optional[Sequence[int]] = None
+    offset: int = 0
 
 
 @dataclass(frozen=True)
 class CaseShape:
     inputs: Sequence[Sequence[int]]
     outputs: Sequence[Sequence[int]]
+    input_layouts: Sequence[Optional[TensorLayout]] = field(default_factory=tuple)
+    output_layouts: Sequence[Optional[TensorLayout]] = field(default_factory=tuple)
 
 
 @dataclass(frozen=True)
@@ -75,6 +110,38 @@ class CaseConfig:
     priority: Optional[int] = None
 
 
+@dataclass(frozen=True)
+class PipelineNode:
+    """One pipeline stage; ``op`` is its builtin reference (name, params, tolerances, output dtypes)."""
+
+    name: str
+    op: AssertionConfig
+    inputs: Sequence[str]  # input<N> (plan inputs) or <node> / <node>.<k> (outputs of earlier nodes)
+    outputs: int = 1
+    run: str = "backend"  # backend | builtin (computed in-process by the reference) | command
+    command: Optional[CommandConfig] = None
+    check: bool = True
+
+
+@dataclass(frozen=True)
+class PipelineConfig:
+    """A DAG of operators; ``nodes`` are stored in dependency order."""
+
+    nodes: Sequence[PipelineNode]
+    outputs: Sequence[str]
+    rtol: Optional[float] = None  # end-to-end tolerance; default: the loosest node tolerance
+    atol: Optional[float] = None
+
+
+@dataclass(frozen=True)
+class StorageConfig:
+    format: str = "raw"
+    cache_dir: Optional[Path] = None
+    compression: Optional[CompressionPolicy] = None
+    shared_dir: Optional[Path] = None
+    claim_timeout: float = 900.0
+
+
 @dataclass(frozen=True)
 class ExecutionPlan:
     operator: str
@@ -89,6 +156,9 @@ class ExecutionPlan:
     tags: Sequence[str]
     priority: Optional[int]
     plan_dir: Path
+    storage: StorageConfig = field(default_factory=StorageConfig)
+    category: str = ""
+    pipeline: Optional[PipelineConfig] = None
 
 
 @dataclass(frozen=True)
@@ -130,3 +200,65 @@ class PlanOptions:
     priority_max: Optional[int] = None
     cache: Optional[str] = None
     list_only: bool = False
+
+
+@dataclass(frozen=True)
+class BenchSettings:
+    warmup: int = 1
+    repeat: int = 5
+    verify: bool = True
+    cache_state: str = "warm"  # warm | cold | both (cold samples reported next to warm ones)
+    denormals: Optional[float] = None  # rerun with this fraction of float inputs made subnormal
+    ftz: str = "off"  # OPTEST_FTZ for the runner: off | ftz | daz | on (both)
+
+
+@dataclass(frozen=True)
+class DenormalRun:
+    """A case rerun on inputs with a fraction of subnormal values."""
+
+    fraction: float
+    samples: Sequence[float] = field(default_factory=tuple)
+    check: str = ""  # assertion details when the outputs fail it, "" when they pass
+    ftz_changed: Optional[int] = None  # output elements that differ from an FTZ-off run (with --ftz only)
+    ftz_max_abs: Optional[float] = None
+
+    @property
+    def median(self) -> Optional[float]:
+        return _median(self.samples)
+
+
+@dataclass(frozen=True)
+class BenchResult:
+    identifier: str
+    status: str
+    samples: Sequence[float] = field(default_factory=tuple)
+    metrics: Mapping[str, float] = field(default_factory=dict)
+    details: str = ""
+    cold_samples: Sequence[float] = field(default_factory=tuple)
+    denormal: Optional[DenormalRun] = None
+
+    @property
+    def median(self) -> Optional[float]:
+        return _median(self.samples)
+
+    @property
+    def denormal_slowdown(self) -> Optional[float]:
+        if self.denormal is None or not self.denormal.median or not self.median:
+            return None
+        return self.denormal.median / self.median
+
+    @property
+    def cold_median(self) -> Optional[float]:
+        return _median(self.cold_samples)
+
+    @property
+    def minimum(self) -> Optional[float]:
+        return min(self.samples) if self.samples else None
+
+
+def _median(samples: Sequence[float]) -> Optional[float]:
+    if not samples:
+        return None
+    ordered = sorted(samples)
+    mid = len(ordered) // 2
+    return ordered[mid] if len(ordered) % 2 else (ordered[mid - 1] + ordered[mid]) / 2
@@ -0,0 +1,141 @@
+"""Plan-driven profile-guided optimization for CMake-built runners.
+
+The workflow uses the ``build`` section of each selected backend and the
+``OptestPGO.cmake`` module shipped in ``sdk/cpp/cmake``:
+
+1. configure + build with ``OPTEST_PGO_MODE=off`` (Release) and benchmark: baseline;
+2. rebuild instrumented (``generate``) and run the selected cases as training;
+3. merge LLVM raw profiles when present, rebuild with ``use`` + LTO and benchmark again.
+
+The build directory is left holding the optimized runner.
+"""
+from __future__ import annotations
+
+import os
+import shutil
+import subprocess
+from pathlib import Path
+from typing import Sequence
+
+from colorama import init as colorama_init
+
+from . import bench, runner
+from .models import BenchSettings, BuildConfig, ExecutionPlan, PlanOptions
+
+PROFILE_DIRNAME = "pgo-profile"
+
+
+def profile_dir(build: BuildConfig) -> Path:
+    return build.build_dir / PROFILE_DIRNAME
+
+
+def run_pgo(
+    plan: ExecutionPlan,
+    options: PlanOptions,
+    settings: BenchSettings,
+    *,
+    training_repeat: int = 1,
+    lto: bool = True,
+    speedup_metric: str | None = None,
+    report_format: str = "terminal",
+    report_path: str | None = None,
+    use_color: bool = True,
+) -> int:
+    """Build, train and rebuild the selected backends; returns process exit code."""
+
+    colorama_init()
+    resolved = runner._resolve_cases(plan, options)
+    if not resolved:
+        print("No cases matched the provided filters.")
+        return 1
+    builds: dict[Path, BuildConfig] = {}
+    for item in resolved:
+        build = item.backend.build
+        if build is None:
+            raise ValueError(
+                f"Backend {item.backend.type}:{item.backend.chip} has no build section; "
+                "optest pgo needs backend.build.source to rebuild the runner"
+            )
+        builds.setdefault(build.build_dir, build)
+    verbose = report_format == "terminal"
+
+    _log(verbose, "[pgo] building baseline")
+    for build in builds.values():
+        build_runner(build, "off", lto=False)
+    baseline = bench.bench_cases(plan, resolved, settings, options.cache)
+
+    _log(verbose, "[pgo] building instrumented runner and training")
+    for build in builds.values():
+        shutil.rmtree(profile_dir(build), ignore_errors=True)
+        build_runner(build, "generate", lto=False)
+    training = bench.bench_cases(plan, resolved, BenchSettings(warmup=0, repeat=training_repeat, verify=False))
+    trained = [item for item in training if item.status == "ok"]
+    if not trained:
+        details = "; ".join(f"{item.identifier}: {item.details}" for item in training)
+        raise RuntimeError(f"PGO training produced no successful runs ({details})")
+    for item in training:
+        if item.status != "ok":
+            _log(verbose, f"[pgo] training run failed for {item.identifier}: {item.details}")
+
+    _log(verbose, f"[pgo] rebuilding with profile{' + LTO' if lto else ''}")
+    for build in builds.values():
+        merge_profiles(profile_dir(build))
+        build_runner(build, "use", lto=lto)
+    optimized = bench.bench_cases(plan, resolved, settings, options.cache)
+    return bench.report_bench(
+        optimized,
+        settings,
+        ratios=bench.speedups(optimized, baseline, speedup_metric),
+        speedup_metric=speedup_metric,
+        report_format=report_format,
+        report_path=report_path,
+        use_color=use_color,
+    )
+
+
+def build_runner(build: BuildConfig, mode: str, *, lto: bool) -> None:
+    """Configure and rebuild ``build`` in the given PGO mode (off | generate | use)."""
+
+    configure = [
+        "cmake",
+        "-S",
+        str(build.source_dir),
+        "-B",
+        str(build.build_dir),
+        "-DCMAKE_BUILD_TYPE=Release",
+        f"-DOPTEST_PGO_MODE={mode}",
+        f"-DOPTEST_PGO_DIR={profile_dir(build)}",
+        f"-DOPTEST_LTO={'ON' if lto else 'OFF'}",
+        *build.cmake_args,
+    ]
+    compile_cmd = ["cmake", "--build", str(build.build_dir), "--clean-first"]
+    if build.target:
+        compile_cmd += ["--target", build.target]
+    _check_call(configure)
+    _check_call(compile_cmd)
+
+
+def merge_profiles(directory: Path) -> None:
+    """Merge Clang ``.profraw`` files into ``default.profdata`` (GCC ``.gcda`` need no merge)."""
+
+    raw = sorted(directory.rglob("*.profraw"))
+    if not raw:
+        return
+    tool = os.environ.get("LLVM_PROFDATA") or shutil.which("llvm-profdata")
+    if not tool:
+        raise RuntimeError("llvm-profdata is required to merge Clang profiles (set LLVM_PROFDATA)")
+    _check_call([tool, "merge", "-o", str(directory / "default.profdata"), *map(str, raw)])
+
+
+def _check_call(argv: Sequence[str]) -> None:
+    proc = subprocess.run(list(argv), capture_output=True, text=True)
+    if proc.returncode != 0:
+        raise RuntimeError(
+            f"command '{' '.join(argv)}' failed (code {proc.returncode}): "
+            f"{proc.stderr.strip() or proc.stdout.strip()}"
+        )
+
+
+def _log(enabled: bool, message: str) -> None:
+    if enabled:
+        print(message)
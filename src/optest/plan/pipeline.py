@@ -0,0 +1,432 @@
+"""Operator pipelines: plans whose case runs a DAG of operators.
+
+A plan with ``pipeline:`` describes a sequence such as matmul -> add bias ->
+relu -> softmax the way it runs in production. The plan ``inputs`` are
+generated as usual and are referenced by the nodes as ``input0``, ``input1``,
+...; node outputs as ``<node>`` (first output) or ``<node>.<k>``. Every node
+names its reference ``op`` (a builtin, with params and tolerances as in
+``assertion``) and runs in one of three ways:
+
+- ``run: backend`` (default): the backend command (or session), with the
+  node's tensors as ``{input0}``/``{output0}`` and ``{assertion}``/``{params}``
+  naming the node's operator (``{node}`` is the node name);
+- ``run: builtin``: the reference computes it in-process;
+- ``command: [...]``: its own command, rendered with the same tokens.
+
+Tensors stay in memory between in-process nodes. Commands get files in a
+per-run scratch directory on ``/dev/shm`` (the system temp directory where
+there is none), and what a command writes is mapped straight into the next
+node, so intermediates never touch the disk. The pipeline outputs are also
+written to the plan ``outputs``.
+
+Checks: the pipeline outputs are compared with the end-to-end golden, the
+reference chain from the plan inputs (cached like other goldens). Only when that
+fails is every command node compared with its ``op`` applied to the inputs it
+actually received (so an upstream error is not blamed on it), and the golden of
+every intermediate computed, to report where the pipeline first left the
+reference chain. The shapes and dtypes of what a command node writes are
+learned from its reference once per op and input signature in the process, so
+later cases and runs with the same shapes compute no reference at all.
+"""
+from __future__ import annotations
+
+import json
+import os
+import re
+import tempfile
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, List, Mapping, Optional, Sequence, Tuple
+
+import numpy as np
+
+from optest.operators import builtin_operators
+from optest.storage import allocate_tensor, finalize_tensor, load_array, tensor_digest
+from optest.storage.cache import ArtifactCache, CachedTensor, cache_key
+
+from . import runner
+from .models import AssertionResult, PipelineConfig, PipelineNode, ResolvedCase
+from .session import SessionPool
+
+SHM_ROOT = Path("/dev/shm")
+_PLAN_INPUT = re.compile(r"input\d+$")
+_PER_TENSOR_TOKEN = re.compile(r"(input|output)\d+$")
+
+# (op, params, output dtypes, input shapes, input dtypes) -> (output shapes, output dtypes) of a command node.
+NodeSpecs = Dict[Tuple[Any, ...], Tuple[Tuple[Tuple[int, ...], ...], Tuple[str, ...]]]
+# Learned from the node's reference the first time a signature is seen, then shared by every case and run of the
+# process, so passing runs do not compute references.
+_NODE_SPECS: NodeSpecs = {}
+
+
+@dataclass
+class PipelineRun:
+    """Tensors of one pipeline execution (``input0``, ``<node>.<k>``) and per-node timings and output."""
+
+    values: Dict[str, np.ndarray]
+    node_seconds: Dict[str, float] = field(default_factory=dict)
+    stdout: Dict[str, str] = field(default_factory=dict)
+    scratch: Optional[tempfile.TemporaryDirectory] = None
+
+    @property
+    def elapsed(self) -> float:
+        """Time spent in the nodes and their handoffs (reference runs for shape inference excluded)."""
+
+        return sum(self.node_seconds.values())
+
+    def outputs(self, pipeline: PipelineConfig) -> Tuple[np.ndarray, ...]:
+        return tuple(self.values[value_key(ref)] for ref in pipeline.outputs)
+
+    def close(self) -> None:
+        if self.scratch is not None:
+            self.scratch.cleanup()
+            self.scratch = None
+
+
+def value_key(ref: str) -> str:
+    """``mm`` -> ``mm.0``; plan inputs and explicit ``node.k`` references are kept."""
+
+    if "." in ref or _PLAN_INPUT.match(ref):
+        return ref
+    return f"{ref}.0"
+
+
+def reference_outputs(node: PipelineNode, args: Sequence[np.ndarray]) -> List[np.ndarray]:
+    """The node's builtin reference on ``args``, cast to the node's output dtypes.
+
+    Without ``op.output_dtypes``, float results take the dtype of the first input (as ``run: builtin``
+    hands them on); other results keep the reference dtype. 0-d results become shape ``[1]``.
+    """
+
+    op_cls = _operator(node)
+    produced = [np.atleast_1d(np.asarray(out)) for out in op_cls.run(args, node.op.params)]
+    if node.op.output_dtypes is not None and len(node.op.output_dtypes) != len(produced):
+        raise ValueError(
+            f"pipeline node '{node.name}': output_dtypes lists {len(node.op.output_dtypes)} dtypes "
+            f"for {len(produced)} outputs"
+        )
+    first = np.asarray(args[0]).dtype if args else None
+    cast: List[np.ndarray] = []
+    for index, out in enumerate(produced):
+        if node.op.output_dtypes is not None:
+            dtype = np.dtype(node.op.output_dtypes[index])
+        elif first is not None and out.dtype.kind == "f" and first.kind == "f":
+            dtype = first
+        else:
+            dtype = out.dtype
+        cast.append(out.astype(dtype, copy=False))
+    return cast
+
+
+def run_pipeline(
+    resolved: ResolvedCase,
+    inputs: Sequence[np.ndarray],
+    tokens: Mapping[str, str],
+    env: Mapping[str, str],
+    sessions: SessionPool | None = None,
+) -> PipelineRun:
+    """Execute every node once in dependency order; the caller closes the returned run."""
+
+    pipeline = resolved.plan.pipeline
+    assert pipeline is not None
+    file_format = resolved.plan.storage.format
+    shm = SHM_ROOT.is_dir() and os.access(SHM_ROOT, os.W_OK)
+    scratch = tempfile.TemporaryDirectory(prefix="optest-pipeline-", dir=str(SHM_ROOT) if shm else None)
+    run = PipelineRun(values={f"input{i}": np.asarray(values) for i, values in enumerate(inputs)}, scratch=scratch)
+    # Where each tensor can be read from by a command; in-process results are spilled on demand.
+    paths: Dict[str, Path] = {f"input{i}": path for i, path in enumerate(resolved.input_paths)}
+    layouts = {f"input{i}": layout for i, layout in enumerate(runner._layouts_for(resolved, "inputs"))}
+    final: Dict[str, Path] = {}
+    for ref, path in zip(pipeline.outputs, resolved.output_paths):
+        final.setdefault(value_key(ref), path)
+    try:
+        for node in pipeline.nodes:
+            args = [run.values[value_key(ref)] for ref in node.inputs]
+            keys = [f"{node.name}.{index}" for index in range(node.outputs)]
+            if node.run == "builtin":
+                start = time.perf_counter()
+                produced = reference_outputs(node, args)
+                run.node_seconds[node.name] = time.perf_counter() - start
+            else:
+                shapes, dtypes = _node_spec(node, args)
+                start = time.perf_counter()
+                for ref in node.inputs:
+                    key = value_key(ref)
+                    if key not in paths:
+                        paths[key] = Path(scratch.name) / f"{key}.bin"
+                        _write_value(paths[key], run.values[key], file_format)
+                out_paths = [final.get(key) or Path(scratch.name) / f"{key}.bin" for key in keys]
+                runner._ensure_output_dirs(out_paths)
+                node_tokens = _node_tokens(
+                    tokens, node, args, [paths[value_key(ref)] for ref in node.inputs], out_paths, shapes,
+                    [layouts.get(value_key(ref)) for ref in node.inputs],
+                )
+                run.stdout[node.name] = _run_node(resolved, node, node_tokens, env, sessions)
+                produced = [load_array(path, shape, dtype) for path, shape, dtype in zip(out_paths, shapes, dtypes)]
+                run.node_seconds[node.name] = time.perf_counter() - start
+                paths.update(zip(keys, out_paths))
+            if len(produced) != node.outputs:
+                raise ValueError(
+                    f"pipeline node '{node.name}' declares {node.outputs} output(s) "
+                    f"but its op '{node.op.name}' produces {len(produced)}"
+                )
+            run.values.update(zip(keys, produced))
+        for ref, path in zip(pipeline.outputs, resolved.output_paths):
+            key = value_key(ref)
+            if paths.get(key) != path:
+                _write_value(path, run.values[key], file_format)
+    except BaseException:
+        run.close()
+        raise
+    return run
+
+
+def check_pipeline(resolved: ResolvedCase, run: PipelineRun, cache: ArtifactCache | None = None) -> AssertionResult:
+    """The end-to-end comparison and, on failure, per-node checks of the command nodes and the divergence point."""
+
+    pipeline = resolved.plan.pipeline
+    assert pipeline is not None
+    inputs = [run.values[f"input{i}"] for i in range(len(resolved.input_paths))]
+    problems: List[str] = []
+    metrics: Dict[str, Any] = {}
+    tolerances: Dict[str, Tuple[float, float]] = {}
+    for node in pipeline.nodes:
+        tolerances[node.name] = _tolerance(node, [run.values[value_key(ref)] for ref in node.inputs])
+    outputs = run.outputs(pipeline)
+    for index, (out, shape) in enumerate(zip(outputs, resolved.shape.outputs)):
+        if tuple(out.shape) != tuple(shape):
+            problems.append(f"pipeline output{index} has shape {tuple(out.shape)}, the case expects {tuple(shape)}")
+    if not problems:
+        rtol = pipeline.rtol if pipeline.rtol is not None else max(value[0] for value in tolerances.values())
+        atol = pipeline.atol if pipeline.atol is not None else max(value[1] for value in tolerances.values())
+        expected_outputs = _end_to_end_golden(resolved, inputs, cache)
+        ok, details, found = runner._compare_outputs(outputs, expected_outputs, rtol, atol, "max_abs")
+        metrics.update({f"pipeline.{key}": value for key, value in found.items()})
+        if not ok:
+            problems.append(f"end to end: {details}")
+    if not problems:
+        return AssertionResult(ok=True, metrics=metrics)
+    # Failure path only: blame the command nodes that were wrong on what they received, then find the divergence.
+    problems[:0] = _node_problems(pipeline, run, tolerances, metrics)
+    divergence = _first_divergence(pipeline, run, inputs, tolerances, metrics)
+    if divergence:
+        problems.append(divergence)
+    return AssertionResult(ok=False, details="; ".join(problems), metrics=metrics)
+
+
+def _node_problems(
+    pipeline: PipelineConfig,
+    run: PipelineRun,
+    tolerances: Mapping[str, Tuple[float, float]],
+    metrics: Dict[str, Any],
+) -> List[str]:
+    problems: List[str] = []
+    for node in pipeline.nodes:
+        if node.run == "builtin" or not node.check:
+            continue
+        expected = reference_outputs(node, [run.values[value_key(ref)] for ref in node.inputs])
+        got = [run.values[f"{node.name}.{index}"] for index in range(node.outputs)]
+        rtol, atol = tolerances[node.name]
+        ok, details, found = runner._compare_outputs(
+            got, expected, rtol, atol, node.op.metric or "max_abs", equal_nan=node.op.equal_nan
+        )
+        metrics.update({f"{node.name}.{key}": value for key, value in found.items()})
+        if not ok:
+            problems.append(f"node '{node.name}': {details}")
+    return problems
+
+
+def execute_pipeline(
+    resolved: ResolvedCase,
+    inputs: Sequence[np.ndarray],
+    cache: ArtifactCache | None = None,
+    sessions: SessionPool | None = None,
+) -> AssertionResult:
+    """``optest run`` for a pipeline case: backend prepare, every node, backend cleanup, then the checks."""
+
+    backend = resolved.backend
+    tokens = runner._build_tokens(resolved)
+    env = os.environ.copy()
+    env.update(runner._render_env(backend.env, tokens))
+    for cmd in backend.prepare:
+        runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+    try:
+        run = run_pipeline(resolved, inputs, tokens, env, sessions)
+    finally:
+        for cmd in backend.cleanup:
+            runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+    try:
+        return check_pipeline(resolved, run, cache)
+    finally:
+        run.close()
+
+
+def golden_values(pipeline: PipelineConfig, inputs: Sequence[np.ndarray]) -> Dict[str, np.ndarray]:
+    """The reference chain: every node's reference applied to the reference values of its inputs."""
+
+    values: Dict[str, np.ndarray] = {f"input{i}": np.asarray(values) for i, values in enumerate(inputs)}
+    for node in pipeline.nodes:
+        produced = reference_outputs(node, [values[value_key(ref)] for ref in node.inputs])
+        values.update((f"{node.name}.{index}", out) for index, out in enumerate(produced))
+    return values
+
+
+def _operator(node: PipelineNode) -> type[builtin_operators.BuiltinOperator]:
+    runner._populate_builtin_registry()
+    op_cls = runner._BUILTIN_ASSERTION_REGISTRY.get(runner._normalize_builtin_key(node.op.name))
+    if op_cls is None:
+        supported = ", ".join(sorted({cls.name for cls in runner._BUILTIN_ASSERTION_REGISTRY.values()}))
+        raise ValueError(f"pipeline node '{node.name}': unknown builtin op '{node.op.name}'. Supported: {supported}")
+    return op_cls
+
+
+def _node_spec(node: PipelineNode, args: Sequence[np.ndarray]) -> Tuple[Tuple[Tuple[int, ...], ...], Tuple[str, ...]]:
+    # What a command node writes is raw data: its output shapes and dtypes come from the reference.
+    key = (
+        node.op.name,
+        json.dumps(dict(node.op.params), sort_keys=True, default=str),
+        tuple(node.op.output_dtypes or ()),
+        tuple(tuple(np.shape(arg)) for arg in args),
+        tuple(np.asarray(arg).dtype.name for arg in args),
+    )
+    spec = _NODE_SPECS.get(key)
+    if spec is None:
+        produced = reference_outputs(node, args)
+        spec = (tuple(tuple(out.shape) for out in produced), tuple(out.dtype.name for out in produced))
+        _NODE_SPECS[key] = spec
+    return spec
+
+
+def _tolerance(node: PipelineNode, args: Sequence[np.ndarray]) -> Tuple[float, float]:
+    default = _operator(node).tolerance(args, node.op.params)
+    rtol = node.op.rtol if node.op.rtol is not None else (default.relative if default else 1e-5)
+    atol = node.op.atol if node.op.atol is not None else (default.absolute if default else 1e-4)
+    return rtol, atol
+
+
+def _write_value(path: Path, value: np.ndarray, file_format: str) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    value = np.asarray(value)
+    arr = allocate_tensor(path, value.shape, value.dtype.name, container=file_format == "optt")
+    arr[...] = value
+    if isinstance(arr.base, np.memmap):
+        arr.base.flush()
+    elif isinstance(arr, np.memmap):
+        arr.flush()
+    if file_format == "optt":
+        finalize_tensor(path)
+
+
+def _node_tokens(
+    tokens: Mapping[str, str],
+    node: PipelineNode,
+    args: Sequence[np.ndarray],
+    in_paths: Sequence[Path],
+    out_paths: Sequence[Path],
+    out_shapes: Sequence[Sequence[int]],
+    in_layouts: Sequence[Any],
+) -> Dict[str, str]:
+    # Case-level tokens ({chip}, {case}, {cache_state}, ...) with the tensor tokens of this node.
+    rendered = {key: value for key, value in tokens.items() if not _PER_TENSOR_TOKEN.match(key)}
+    dtypes = [np.asarray(arg).dtype.name for arg in args]
+    rendered["node"] = node.name
+    rendered["assertion"] = node.op.name
+    rendered["params"] = json.dumps(dict(node.op.params))
+    rendered["dtype"] = dtypes[0] if dtypes else ""
+    rendered["dtypes"] = ",".join(dtypes)
+    rendered["shape"] = "x".join(str(dim) for dim in np.shape(args[0])) if args else ""
+    rendered["shapes"] = json.dumps(
+        {"inputs": [list(np.shape(arg)) for arg in args], "outputs": [list(shape) for shape in out_shapes]}
+    )
+    rendered["layouts"] = json.dumps(
+        {"inputs": runner._layouts_json(in_layouts), "outputs": runner._layouts_json([None] * len(out_paths))}
+    )
+    rendered["inputs"] = ",".join(str(path) for path in in_paths)
+    rendered["outputs"] = ",".join(str(path) for path in out_paths)
+    for index, path in enumerate(in_paths):
+        rendered[f"input{index}"] = str(path)
+    for index, path in enumerate(out_paths):
+        rendered[f"output{index}"] = str(path)
+    return rendered
+
+
+def _run_node(
+    resolved: ResolvedCase,
+    node: PipelineNode,
+    tokens: Mapping[str, str],
+    env: Mapping[str, str],
+    sessions: SessionPool | None,
+) -> str:
+    backend = resolved.backend
+    node_env = dict(env)
+    node_env.update(runner._render_env(backend.env, tokens))
+    if node.command is not None:
+        argv = node.command.argv
+    elif backend.session is not None and sessions is not None:
+        return runner._run_session_request(resolved, sessions, tokens, node_env, backend.retries)
+    else:
+        argv = backend.command.argv
+    return runner._run_command(argv, backend.workdir, node_env, tokens, backend.timeout, backend.retries).stdout
+
+
+def _end_to_end_golden(
+    resolved: ResolvedCase, inputs: Sequence[np.ndarray], cache: ArtifactCache | None
+) -> Sequence[CachedTensor]:
+    pipeline = resolved.plan.pipeline
+    assert pipeline is not None
+
+    def compute() -> List[np.ndarray]:
+        values = golden_values(pipeline, inputs)
+        return [values[value_key(ref)] for ref in pipeline.outputs]
+
+    if cache is None:
+        return compute()
+    key = cache_key(
+        "golden",
+        "pipeline",
+        _fingerprint(pipeline),
+        [tensor_digest(path) for path in resolved.input_paths],
+        [list(np.shape(values)) for values in inputs],
+        [np.asarray(values).dtype.name for values in inputs],
+    )
+    return runner._cached_golden(cache, key, compute)
+
+
+def _first_divergence(
+    pipeline: PipelineConfig,
+    run: PipelineRun,
+    inputs: Sequence[np.ndarray],
+    tolerances: Mapping[str, Tuple[float, float]],
+    metrics: Dict[str, Any],
+) -> str:
+    # The intermediate goldens are only needed here, once something already failed.
+    golden = golden_values(pipeline, inputs)
+    first = ""
+    for node in pipeline.nodes:
+        rtol, atol = tolerances[node.name]
+        for index in range(node.outputs):
+            key = f"{node.name}.{index}"
+            got, want = run.values[key], golden[key]
+            if got.shape != want.shape:
+                where = f"node '{node.name}' (shape {got.shape} vs {want.shape})"
+                first = first or f"first divergence from the reference chain at {where}"
+                continue
+            max_abs = float(np.max(runner._abs_diff(got, want, node.op.equal_nan))) if got.size else 0.0
+            metrics[f"{key}.golden_max_abs"] = max_abs
+            if not first and not np.allclose(got, want, rtol=rtol, atol=atol, equal_nan=node.op.equal_nan):
+                first = f"first divergence from the reference chain at node '{node.name}' (max_abs={max_abs})"
+    return first
+
+
+def _fingerprint(pipeline: PipelineConfig) -> List[Dict[str, Any]]:
+    return [
+        {
+            "name": node.name,
+            "op": node.op.name,
+            "params": dict(node.op.params),
+            "inputs": list(node.inputs),
+            "output_dtypes": list(node.op.output_dtypes or ()),
+        }
+        for node in pipeline.nodes
+    ] + [{"outputs": list(pipeline.outputs)}]
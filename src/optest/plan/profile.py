@@ -0,0 +1,294 @@
+"""Sampling-profiler capture for benchmarked cases (``optest bench --profile``).
+
+Selected cases are rerun once with the backend command wrapped in a sampling
+profiler (``perf record -g`` or ``py-spy record``). The stacks are folded into
+``<case>.folded`` (``frame;frame;leaf count`` lines, the flamegraph.pl input
+format) and rendered to a self-contained ``<case>.svg`` flame graph.
+
+Captures run one at a time after every case has been timed: ``cases:GLOB``
+queues a case as soon as its timed runs finish, and ``slowest:N`` picks the N
+slowest medians at the end. They deliberately do not overlap the benchmark or
+each other: a capture reruns the backend's prepare/command/cleanup, and doing
+that next to timed runs competed for the same cores and skewed the medians.
+Each profile run regenerates its inputs into a private directory, so it never
+touches the plan's input/output paths.
+"""
+from __future__ import annotations
+
+import dataclasses
+import fnmatch
+import html
+import os
+import re
+import shutil
+import subprocess
+import zlib
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Callable, Dict, List, Mapping, Optional, Sequence, Tuple
+
+from optest.storage.cache import ArtifactCache
+
+from . import runner
+from .models import BenchResult, ResolvedCase
+
+PROFILERS = ("perf", "py-spy")
+DEFAULT_FREQUENCY = 999
+
+
+@dataclass(frozen=True)
+class ProfileSpec:
+    """``slowest:N`` (count) or ``cases:GLOB[,GLOB...]`` (patterns, matched against case identifiers)."""
+
+    count: int = 0
+    patterns: Tuple[str, ...] = ()
+
+    def matches(self, identifier: str) -> bool:
+        case = identifier.partition("@")[0]
+        return any(fnmatch.fnmatch(identifier, pattern) or fnmatch.fnmatch(case, pattern) for pattern in self.patterns)
+
+
+@dataclass(frozen=True)
+class ProfileArtifact:
+    identifier: str
+    folded: Optional[Path] = None
+    svg: Optional[Path] = None
+    samples: int = 0
+    error: str = ""
+
+
+def parse_profile_spec(text: str) -> ProfileSpec:
+    kind, sep, value = text.partition(":")
+    if sep and kind == "slowest" and value.isdigit() and int(value) > 0:
+        return ProfileSpec(count=int(value))
+    if sep and kind == "cases" and value.strip(","):
+        return ProfileSpec(patterns=tuple(item.strip() for item in value.split(",") if item.strip()))
+    raise ValueError(f"--profile expects slowest:N or cases:GLOB, got '{text}'")
+
+
+def detect_profiler(name: str = "auto") -> str:
+    """Resolve ``auto`` to the first sampling profiler on PATH (perf, then py-spy)."""
+
+    candidates = PROFILERS if name == "auto" else (name,)
+    if name != "auto" and name not in PROFILERS:
+        raise ValueError(f"Unknown profiler '{name}' (choose from auto, {', '.join(PROFILERS)})")
+    for candidate in candidates:
+        if shutil.which(candidate):
+            return candidate
+    raise RuntimeError(f"No sampling profiler found on PATH (tried {', '.join(candidates)})")
+
+
+def fold_perf_script(text: str) -> Dict[str, int]:
+    """Fold ``perf script`` output into ``comm;outer;...;leaf -> samples``."""
+
+    folded: Dict[str, int] = {}
+    comm: Optional[str] = None
+    frames: List[str] = []
+
+    def flush() -> None:
+        if comm is not None:
+            stack = ";".join([comm, *reversed(frames)])
+            folded[stack] = folded.get(stack, 0) + 1
+
+    for line in text.splitlines():
+        if not line.strip():
+            flush()
+            comm, frames = None, []
+        elif line[0] in " \t":
+            if comm is not None:
+                _, _, frame = line.strip().partition(" ")  # "<address> <symbol>+<offset> (<dso>)"
+                frames.append(_perf_frame(frame or "[unknown]"))
+        elif not line.startswith("#"):
+            flush()
+            comm, frames = line.split(None, 1)[0], []
+    flush()
+    return folded
+
+
+_OFFSET = re.compile(r"\+0x[0-9a-f]+$")
+
+
+def _perf_frame(text: str) -> str:
+    # "matmul_kernel<float>+0x30 (/path/matmul_runner)" -> "matmul_kernel<float>"
+    symbol, _, dso = text.rpartition(" (")
+    symbol = _OFFSET.sub("", symbol.strip()) if symbol else text.strip()
+    if symbol in ("", "[unknown]") and dso:
+        return f"[{os.path.basename(dso.rstrip(')'))}]"
+    return symbol.replace(";", ":")
+
+
+def read_folded(path: Path) -> Dict[str, int]:
+    folded: Dict[str, int] = {}
+    for line in path.read_text(encoding="utf-8").splitlines():
+        stack, _, count = line.rpartition(" ")
+        if stack and count.isdigit():
+            folded[stack] = folded.get(stack, 0) + int(count)
+    return folded
+
+
+def write_folded(path: Path, folded: Mapping[str, int]) -> None:
+    path.write_text("".join(f"{stack} {count}\n" for stack, count in sorted(folded.items())), encoding="utf-8")
+
+
+def render_flamegraph(folded: Mapping[str, int], title: str, width: int = 1200, row: int = 16) -> str:
+    """Flame graph SVG (root at the bottom, children sorted by name like flamegraph.pl)."""
+
+    tree: Dict[str, list] = {}  # frame -> [samples, children]
+    for stack, count in folded.items():
+        level = tree
+        for frame in stack.split(";"):
+            node = level.setdefault(frame, [0, {}])
+            node[0] += count
+            level = node[1]
+    total = sum(folded.values())
+    boxes: List[Tuple[float, int, float, str, int]] = []
+
+    def place(level: Mapping[str, list], x: float, depth: int) -> int:
+        deepest = depth
+        for name in sorted(level):
+            count, children = level[name]
+            span = (width - 20) * count / total
+            if span >= 0.1:  # narrower frames are invisible
+                boxes.append((x, depth, span, name, count))
+                deepest = max(deepest, place(children, x, depth + 1))
+            x += span
+        return deepest
+
+    depth = place(tree, 10.0, 0) if total else 0
+    height = (depth + 2) * row + 24
+    parts = [
+        f"<svg xmlns='http://www.w3.org/2000/svg' width='{width}' height='{height}' "
+        f"font-family='Verdana, sans-serif' font-size='11'>",
+        "<rect width='100%' height='100%' fill='#f8f8f8'/>",
+        f"<text x='{width / 2}' y='20' text-anchor='middle' font-size='15'>{html.escape(title)}</text>",
+    ]
+    for x, level, span, name, count in boxes:
+        y = height - (level + 2) * row
+        label = name if len(name) * 7 < span - 6 else name[: max(0, int((span - 6) / 7) - 2)] + ".."
+        parts.append(
+            f"<g><title>{html.escape(name)} ({count} samples, {100 * count / total:.2f}%)</title>"
+            f"<rect x='{x:.1f}' y='{y}' width='{span:.1f}' height='{row - 1}' fill='{_frame_color(name)}' rx='2'/>"
+            + (f"<text x='{x + 3:.1f}' y='{y + row - 4}'>{html.escape(label)}</text>" if len(label) > 2 else "")
+            + "</g>"
+        )
+    if not boxes:
+        parts.append(f"<text x='{width / 2}' y='{height / 2}' text-anchor='middle'>no samples</text>")
+    parts.append("</svg>")
+    return "\n".join(parts) + "\n"
+
+
+def _frame_color(name: str) -> str:
+    # Stable warm palette keyed by the frame name, as in flamegraph.pl's "hot" scheme.
+    seed = zlib.crc32(name.encode("utf-8"))
+    return f"rgb({205 + seed % 50},{(seed >> 8) % 230},{(seed >> 16) % 55})"
+
+
+class ProfileCollector:
+    """Queues profile captures during the benchmark and runs them one by one once timing is done.
+
+    Captures rerun the backend's prepare/command/cleanup in its workdir, so running
+    them alongside the timed runs (or each other) would skew medians and race on
+    shared files.
+    """
+
+    def __init__(
+        self,
+        spec: ProfileSpec,
+        output_dir: str | Path,
+        *,
+        profiler: str = "auto",
+        frequency: int = DEFAULT_FREQUENCY,
+        cache_policy: str = "reuse",
+        cache: ArtifactCache | None = None,
+    ) -> None:
+        self.spec = spec
+        self.output_dir = Path(output_dir)
+        self.profiler = detect_profiler(profiler)
+        self.frequency = frequency
+        self.cache_policy = cache_policy
+        self.cache = cache
+        self._queued: Dict[str, ResolvedCase] = {}
+
+    def case_done(self, resolved: ResolvedCase, result: BenchResult) -> None:
+        """Hook called after each case's timed runs: queues ``cases:`` profiles."""
+
+        if self.spec.patterns and result.status != "failed" and self.spec.matches(result.identifier):
+            self.submit(resolved)
+
+    def finish(self, resolved: Sequence[ResolvedCase], results: Sequence[BenchResult]) -> Dict[str, ProfileArtifact]:
+        """Queue ``slowest:N`` profiles, capture every queued case in turn and return artifacts by identifier."""
+
+        if self.spec.count:
+            timed = [(result.median, case) for case, result in zip(resolved, results) if result.median is not None]
+            timed.sort(key=lambda item: item[0], reverse=True)
+            for _, case in timed[: self.spec.count]:
+                self.submit(case)
+        return {identifier: self._capture(case, identifier) for identifier, case in self._queued.items()}
+
+    def submit(self, resolved: ResolvedCase) -> None:
+        identifier = runner._format_case_identifier(resolved)
+        self._queued.setdefault(identifier, resolved)
+
+    def _capture(self, resolved: ResolvedCase, identifier: str) -> ProfileArtifact:
+        stem = re.sub(r"[^A-Za-z0-9_.-]+", "_", identifier)
+        scratch = self.output_dir / f"{stem}.work"
+        try:
+            shutil.rmtree(scratch, ignore_errors=True)
+            private = dataclasses.replace(
+                resolved,
+                input_paths=[scratch / f"input{idx}{path.suffix}" for idx, path in enumerate(resolved.input_paths)],
+                output_paths=[scratch / f"output{idx}{path.suffix}" for idx, path in enumerate(resolved.output_paths)],
+            )
+            generator = private.case.generator or private.plan.generator
+            runner._prepare_inputs(private, generator, self.cache_policy, self.cache)
+            runner._ensure_output_dirs(private.output_paths)
+            folded = self._record(private, scratch)
+            folded_path = self.output_dir / f"{stem}.folded"
+            svg_path = self.output_dir / f"{stem}.svg"
+            write_folded(folded_path, folded)
+            svg_path.write_text(render_flamegraph(folded, f"{identifier} ({self.profiler})"), encoding="utf-8")
+            return ProfileArtifact(identifier, folded_path, svg_path, sum(folded.values()))
+        except Exception as exc:
+            return ProfileArtifact(identifier, error=str(exc))
+        finally:
+            shutil.rmtree(scratch, ignore_errors=True)
+
+    def _record(self, resolved: ResolvedCase, scratch: Path) -> Dict[str, int]:
+        backend = resolved.backend
+        tokens = runner._build_tokens(resolved)
+        env = os.environ.copy()
+        env.update(runner._render_env(backend.env, tokens))
+        wrap, collect = _PROFILERS[self.profiler](scratch, self.frequency)
+        for cmd in backend.prepare:
+            runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+        try:
+            runner._run_command([*wrap, *backend.command.argv], backend.workdir, env, tokens, backend.timeout)
+        finally:
+            for cmd in backend.cleanup:
+                runner._run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
+        return collect()
+
+
+def _perf(scratch: Path, frequency: int) -> Tuple[List[str], Callable[[], Dict[str, int]]]:
+    data = scratch / "perf.data"
+
+    def collect() -> Dict[str, int]:
+        proc = subprocess.run(["perf", "script", "-i", str(data)], capture_output=True, text=True, check=False)
+        if proc.returncode != 0:
+            raise RuntimeError(f"perf script failed: {proc.stderr.strip()}")
+        return fold_perf_script(proc.stdout)
+
+    return ["perf", "record", "-F", str(frequency), "-g", "-q", "-o", str(data), "--"], collect
+
+
+def _py_spy(scratch: Path, frequency: int) -> Tuple[List[str], Callable[[], Dict[str, int]]]:
+    # py-spy writes folded stacks itself ("raw" format); native frames cover C extensions.
+    out = scratch / "py-spy.folded"
+    wrap = ["py-spy", "record", "--format", "raw", "--native", "-r", str(frequency), "-o", str(out), "--"]
+    return wrap, lambda: read_folded(out)
+
+
+_PROFILERS: Dict[str, Callable[[Path, int], Tuple[List[str], Callable[[], Dict[str, int]]]]] = {
+    "perf": _perf,
+    "py-spy": _py_spy,
+}
@@ -0,0 +1,616 @@
+"""Performance reports over the local run history (``optest report``).
+
+With ``--matrix`` the latest run of every case is joined by plan, case and shape
+across ``backend:chip`` targets (histories from several hosts merge with
+repeated ``--history``), with speedups against a baseline target and their
+geometric mean per operator category (the plan's ``category``).
+
+The HTML page is a single self-contained file: inline CSS and server-rendered
+SVG, no scripts or external assets, so it can be archived or attached as-is.
+Trend lines are downsampled to ``MAX_TREND_POINTS`` per case, which keeps both
+rendering time and page size flat however long the history grows.
+"""
+from __future__ import annotations
+
+import html
+import json
+import math
+import statistics
+import time
+from dataclasses import dataclass, field
+from datetime import datetime
+from pathlib import Path
+from typing import Any, Dict, List, Mapping, Optional, Sequence, Tuple
+
+from optest.machine import rates
+
+from .history import HistoryPoint, load_history
+
+MAX_TREND_POINTS = 240
+THROUGHPUT_SUFFIXES = ("tflops", "gflops", "gbps", "per_s")
+
+
+@dataclass(frozen=True)
+class Regression:
+    """Latest run of a case against the median of the runs before it (lower is better)."""
+
+    identifier: str
+    baseline: float
+    latest: float
+    runs: int
+
+    @property
+    def change(self) -> float:
+        return self.latest / self.baseline - 1.0
+
+
+def latency(point: HistoryPoint, metric: str | None = None) -> Optional[float]:
+    """Median wall time in seconds, or the named runner metric."""
+
+    if point.status != "ok":
+        return None
+    if metric is None:
+        return point.median
+    return point.metrics.get(metric)
+
+
+def throughput_metric(point: HistoryPoint) -> Optional[str]:
+    """First higher-is-better runner metric (``*gflops``, ``*gbps``, ``*per_s``), if any."""
+
+    for suffix in THROUGHPUT_SUFFIXES:
+        for key in point.metrics:
+            if key.endswith(suffix):
+                return key
+    return None
+
+
+def find_regressions(
+    series: Mapping[str, Sequence[HistoryPoint]], *, metric: str | None = None, window: int = 5
+) -> List[Regression]:
+    """Compare every case's latest value with the median of up to ``window`` earlier ones, worst first."""
+
+    found: List[Regression] = []
+    for identifier, points in series.items():
+        values = [value for value in (latency(point, metric) for point in points) if value]
+        if len(values) < 2:
+            continue
+        baseline = statistics.median(values[-1 - window : -1])
+        found.append(Regression(identifier, baseline, values[-1], len(values)))
+    found.sort(key=lambda item: item.change, reverse=True)
+    return found
+
+
+def downsample(points: Sequence[Tuple[float, float]], limit: int = MAX_TREND_POINTS) -> List[Tuple[float, float]]:
+    """At most ``limit`` points: consecutive buckets collapse to their middle time and median value."""
+
+    if len(points) <= limit:
+        return list(points)
+    size = math.ceil(len(points) / limit)
+    buckets = (points[i : i + size] for i in range(0, len(points), size))
+    return [(bucket[len(bucket) // 2][0], sorted(y for _, y in bucket)[len(bucket) // 2]) for bucket in buckets]
+
+
+def print_regressions(
+    paths: Sequence[str | Path],
+    *,
+    metric: str | None = None,
+    window: int = 5,
+    threshold: float = 0.05,
+    since: float | None = None,
+) -> int:
+    """Terminal summary of the history: changed cases and a count of steady ones."""
+
+    series = load_history(paths, since=since)
+    if not series:
+        print("No run history found (run `optest bench` first).")
+        return 1
+    regressions = find_regressions(series, metric=metric, window=window)
+    steady = 0
+    for item in regressions:
+        if abs(item.change) < threshold:
+            steady += 1
+            continue
+        label = "REGRESSED" if item.change > 0 else "IMPROVED"
+        print(
+            f"{label:<11} {item.identifier}  {_format_value(item.baseline, metric)} -> "
+            f"{_format_value(item.latest, metric)} ({item.change:+.1%}, {item.runs} runs)"
+        )
+    slower = sum(1 for item in regressions if item.change >= threshold)
+    print(
+        f"Summary: cases={len(series)} compared={len(regressions)} regressed={slower} "
+        f"improved={len(regressions) - slower - steady} steady={steady}"
+    )
+    return 0
+
+
+@dataclass(frozen=True)
+class MatrixCell:
+    """One case on one target: latency (``latency()``), throughput metric value, speedup vs the baseline."""
+
+    status: str
+    latency: Optional[float] = None
+    throughput: Optional[float] = None
+    speedup: Optional[float] = None
+
+
+@dataclass(frozen=True)
+class MatrixRow:
+    category: str
+    plan: str
+    case: str  # "case/shapeN"
+    throughput_key: Optional[str]
+    cells: Mapping[str, MatrixCell]
+
+
+@dataclass(frozen=True)
+class PerformanceMatrix:
+    """Rows joined across targets; ``targets[0]`` is the baseline, speedups are baseline latency / latency."""
+
+    targets: Sequence[str]
+    baseline: str
+    metric: Optional[str]
+    rows: Sequence[MatrixRow]
+    # category -> target -> geomean speedup over the rows measured on both the target and the baseline
+    geomeans: Mapping[str, Mapping[str, float]] = field(default_factory=dict)
+    overall: Mapping[str, float] = field(default_factory=dict)
+
+
+def build_matrix(
+    series: Mapping[str, Sequence[HistoryPoint]], *, metric: str | None = None, baseline: str | None = None
+) -> PerformanceMatrix:
+    """Join the latest run of every case across targets; ``baseline`` defaults to the most covered target."""
+
+    joined: Dict[Tuple[str, str, str], Dict[str, HistoryPoint]] = {}
+    for identifier, points in series.items():
+        point = points[-1]
+        shape = identifier.rpartition("/")[2]
+        key = (point.category or point.plan, point.plan, f"{point.case}/{shape}")
+        joined.setdefault(key, {})[point.target] = point
+    coverage: Dict[str, int] = {}
+    for cells in joined.values():
+        for target in cells:
+            coverage[target] = coverage.get(target, 0) + 1
+    if not coverage:
+        raise ValueError("No recorded cases to compare")
+    if baseline is None:
+        baseline = min(coverage, key=lambda target: (-coverage[target], target))
+    elif baseline not in coverage:
+        raise ValueError(f"Baseline target '{baseline}' not in history (have: {', '.join(sorted(coverage))})")
+    targets = [baseline] + sorted(target for target in coverage if target != baseline)
+
+    rows: List[MatrixRow] = []
+    ratios: Dict[str, Dict[str, List[float]]] = {}
+    for (category, plan, case), points in sorted(joined.items()):
+        reference = latency(points[baseline], metric) if baseline in points else None
+        key = next((name for name in map(throughput_metric, points.values()) if name), None)
+        cells: Dict[str, MatrixCell] = {}
+        for target, point in points.items():
+            value = latency(point, metric)
+            speedup = reference / value if reference and value else None
+            if speedup is not None and target != baseline:
+                ratios.setdefault(category, {}).setdefault(target, []).append(speedup)
+            throughput = point.metrics.get(key) if key and point.status == "ok" else None
+            cells[target] = MatrixCell(point.status, value, throughput, speedup)
+        rows.append(MatrixRow(category, plan, case, key, cells))
+    geomeans = {
+        category: {target: statistics.geometric_mean(values) for target, values in per_target.items()}
+        for category, per_target in ratios.items()
+    }
+    overall: Dict[str, float] = {}
+    for target in targets[1:]:
+        values = [value for per_target in ratios.values() for value in per_target.get(target, ())]
+        if values:
+            overall[target] = statistics.geometric_mean(values)
+    return PerformanceMatrix(targets, baseline, metric, rows, geomeans, overall)
+
+
+def format_matrix(matrix: PerformanceMatrix) -> str:
+    """Plain-text table: one column per target with latency, throughput and speedup."""
+
+    header = ["category", "case", *matrix.targets]
+    lines = [header]
+    for row in matrix.rows:
+        cells = [_cell_text(row.cells.get(target), matrix.metric) for target in matrix.targets]
+        lines.append([row.category, row.case, *cells])
+    widths = [max(len(line[i]) for line in lines) for i in range(len(header))]
+    text = ["  ".join(value.ljust(width) for value, width in zip(line, widths)).rstrip() for line in lines]
+    text.append(f"Geomean speedup vs {matrix.baseline}:")
+    for category in sorted(matrix.geomeans):
+        text.append(f"  {category:<{widths[0]}}  {_geomean_text(matrix.geomeans[category], matrix.targets[1:])}")
+    if matrix.overall:
+        text.append(f"  {'all':<{widths[0]}}  {_geomean_text(matrix.overall, matrix.targets[1:])}")
+    return "\n".join(text)
+
+
+def matrix_json(matrix: PerformanceMatrix) -> Dict[str, Any]:
+    return {
+        "baseline": matrix.baseline,
+        "metric": matrix.metric or "wall",
+        "targets": list(matrix.targets),
+        "rows": [
+            {
+                "category": row.category,
+                "plan": row.plan,
+                "case": row.case,
+                "throughput_metric": row.throughput_key,
+                "cells": {
+                    target: {
+                        "status": cell.status,
+                        "latency": cell.latency,
+                        "throughput": cell.throughput,
+                        "speedup": cell.speedup,
+                    }
+                    for target, cell in row.cells.items()
+                },
+            }
+            for row in matrix.rows
+        ],
+        "geomean_speedup": {category: dict(values) for category, values in matrix.geomeans.items()},
+        "overall_speedup": dict(matrix.overall),
+    }
+
+
+def print_matrix(
+    paths: Sequence[str | Path],
+    *,
+    metric: str | None = None,
+    baseline: str | None = None,
+    since: float | None = None,
+    report_format: str = "terminal",
+    report_path: str | None = None,
+) -> int:
+    """Cross-backend matrix of the history as a table or JSON (to ``report_path`` or stdout)."""
+
+    series = load_history(paths, since=since)
+    if not series:
+        print("No run history found (run `optest bench` first).")
+        return 1
+    matrix = build_matrix(series, metric=metric, baseline=baseline)
+    text = format_matrix(matrix) if report_format == "terminal" else json.dumps(matrix_json(matrix), indent=2)
+    if report_path:
+        Path(report_path).write_text(text + "\n", encoding="utf-8")
+    else:
+        print(text)
+    return 0
+
+
+def _matrix_section(series: Mapping[str, Sequence[HistoryPoint]], metric: str | None, baseline: str | None) -> str:
+    matrix = build_matrix(series, metric=metric, baseline=baseline) if series else None
+    if matrix is None or len(matrix.targets) < 2:
+        return "<p class='note'>All recorded cases ran on a single backend and chip.</p>"
+    return _matrix_table(matrix)
+
+
+def _matrix_table(matrix: PerformanceMatrix) -> str:
+    labels = [target + (" (baseline)" if target == matrix.baseline else "") for target in matrix.targets]
+    header = "<tr><th>category</th><th>case</th>" + "".join(f"<th>{html.escape(label)}</th>" for label in labels)
+    rows = []
+    for row in matrix.rows:
+        cells = "".join(_cell_html(row.cells.get(target), matrix.metric) for target in matrix.targets)
+        rows.append(f"<tr><td>{html.escape(row.category)}</td><td>{html.escape(row.case)}</td>{cells}</tr>")
+    for category in sorted(matrix.geomeans) + (["all"] if matrix.overall else []):
+        values = matrix.overall if category == "all" else matrix.geomeans[category]
+        cells = "".join(f"<td class='num'>{_speedup_html(values.get(target))}</td>" for target in matrix.targets[1:])
+        rows.append(f"<tr><th>geomean</th><th>{html.escape(category)}</th><td></td>{cells}</tr>")
+    note = (
+        f"<p class='note'>Latest run per target; cells show latency, throughput and speedup against "
+        f"{html.escape(matrix.baseline)} (&gt;1 is faster).</p>"
+    )
+    return note + "<table>" + header + "</tr>" + "".join(rows) + "</table>"
+
+
+def _cell_text(cell: MatrixCell | None, metric: str | None) -> str:
+    if cell is None:
+        return "."
+    if cell.status != "ok":
+        return cell.status.upper()
+    text = _format_value(cell.latency, metric)
+    if cell.throughput is not None:
+        text += f" {cell.throughput:.4g}"
+    if cell.speedup is not None:
+        text += f" {cell.speedup:.2f}x"
+    return text
+
+
+def _geomean_text(values: Mapping[str, float], targets: Sequence[str]) -> str:
+    return "  ".join(f"{target}={values[target]:.3f}x" for target in targets if target in values)
+
+
+def _cell_html(cell: MatrixCell | None, metric: str | None) -> str:
+    if cell is None:
+        return "<td></td>"
+    if cell.status != "ok":
+        return f"<td class='bad'>{html.escape(cell.status)}</td>"
+    throughput = "" if cell.throughput is None else f" · {cell.throughput:.4g}"
+    return (
+        f"<td class='num'>{_format_value(cell.latency, metric)}{throughput}"
+        f"<br>{_speedup_html(cell.speedup)}</td>"
+    )
+
+
+def _speedup_html(value: float | None) -> str:
+    if value is None:
+        return "-"
+    tone = "good" if value >= 1.0 else "bad"
+    return f"<span class='{tone}'>{value:.2f}x</span>"
+
+
+def write_html_report(
+    paths: Sequence[str | Path],
+    output: str | Path,
+    *,
+    metric: str | None = None,
+    window: int = 5,
+    threshold: float = 0.05,
+    since: float | None = None,
+    peak_gflops: float | None = None,
+    peak_gbps: float | None = None,
+    baseline: str | None = None,
+) -> int:
+    """Render the history to a static HTML page; returns the number of cases shown."""
+
+    series = load_history(paths, since=since)
+    page = render_html(
+        series,
+        metric=metric,
+        window=window,
+        threshold=threshold,
+        peak_gflops=peak_gflops,
+        peak_gbps=peak_gbps,
+        baseline=baseline,
+        sources=[str(path) for path in paths],
+    )
+    Path(output).write_text(page, encoding="utf-8")
+    return len(series)
+
+
+def render_html(
+    series: Mapping[str, Sequence[HistoryPoint]],
+    *,
+    metric: str | None = None,
+    window: int = 5,
+    threshold: float = 0.05,
+    peak_gflops: float | None = None,
+    peak_gbps: float | None = None,
+    baseline: str | None = None,
+    sources: Sequence[str] = (),
+) -> str:
+    runs = sorted({point.time for points in series.values() for point in points})
+    span = f"{_format_time(runs[0])} – {_format_time(runs[-1])}" if runs else "no runs"
+    unit = metric or "wall time"
+    body = [
+        "<h1>optest performance report</h1>",
+        f"<p class='meta'>{len(series)} cases, {len(runs)} bench runs ({span}); latency = {html.escape(unit)}; "
+        f"history: {html.escape(', '.join(sources))}; generated {_format_time(time.time())}</p>",
+        "<h2>Regressions</h2>",
+        _regression_table(find_regressions(series, metric=metric, window=window), metric, threshold, window),
+        "<h2>Cross-backend matrix</h2>",
+        _matrix_section(series, metric, baseline),
+        "<h2>Trends</h2>",
+        _trend_table(series, metric),
+        "<h2>Distributions per backend and chip</h2>",
+        _distribution_table(series),
+        "<h2>Roofline</h2>",
+        _roofline(series, peak_gflops, peak_gbps),
+    ]
+    return _PAGE.format(body="\n".join(body))
+
+
+_PAGE = """<!DOCTYPE html>
+<html lang="en"><head><meta charset="utf-8"><title>optest performance report</title>
+<style>
+body {{ font: 13px/1.4 system-ui, sans-serif; margin: 24px; color: #222; }}
+table {{ border-collapse: collapse; margin-bottom: 16px; }}
+th, td {{ border-bottom: 1px solid #ddd; padding: 3px 8px; text-align: left; vertical-align: middle; }}
+td.num {{ text-align: right; font-variant-numeric: tabular-nums; }}
+.meta, .note {{ color: #666; }}
+.bad {{ color: #b00020; font-weight: 600; }} .good {{ color: #1b7f3b; }}
+svg text {{ font: 10px system-ui, sans-serif; fill: #555; }}
+</style></head><body>
+{body}
+</body></html>
+"""
+
+
+
+def _format_time(stamp: float) -> str:
+    return datetime.fromtimestamp(stamp).strftime("%Y-%m-%d %H:%M")
+
+
+def _format_value(value: float | None, metric: str | None) -> str:
+    if value is None:
+        return "-"
+    if metric is None:
+        return f"{value * 1e3:.3f}ms" if value < 1.0 else f"{value:.3f}s"
+    return f"{value:.4g}"
+
+
+def _regression_table(
+    regressions: Sequence[Regression], metric: str | None, threshold: float, window: int
+) -> str:
+    changed = [item for item in regressions if abs(item.change) >= threshold]
+    note = (
+        f"<p class='note'>Latest run against the median of up to {window} earlier runs; "
+        f"{len(regressions) - len(changed)} of {len(regressions)} cases within ±{threshold:.0%}.</p>"
+    )
+    if not changed:
+        return note
+    rows = [
+        f"<tr><td>{html.escape(item.identifier)}</td><td class='num'>{_format_value(item.baseline, metric)}</td>"
+        f"<td class='num'>{_format_value(item.latest, metric)}</td>"
+        f"<td class='num {'bad' if item.change > 0 else 'good'}'>{item.change:+.1%}</td>"
+        f"<td class='num'>{item.runs}</td></tr>"
+        for item in changed
+    ]
+    header = "<tr><th>case</th><th>baseline</th><th>latest</th><th>change</th><th>runs</th></tr>"
+    return note + "<table>" + header + "".join(rows) + "</table>"
+
+
+def _trend_table(series: Mapping[str, Sequence[HistoryPoint]], metric: str | None) -> str:
+    rows = []
+    for identifier in sorted(series):
+        points = series[identifier]
+        lat = [(point.time, value) for point in points if (value := latency(point, metric)) is not None]
+        key = throughput_metric(points[-1])
+        thr = [(point.time, point.metrics[key]) for point in points if key and key in point.metrics]
+        rows.append(
+            f"<tr><td>{html.escape(identifier)}</td><td class='num'>{len(points)}</td>"
+            f"<td class='num'>{_format_value(lat[-1][1] if lat else None, metric)}</td><td>{_sparkline(lat)}</td>"
+            f"<td class='num'>{html.escape(key or '-')}"
+            f"{'' if not thr else f'<br>{thr[-1][1]:.4g}'}</td><td>{_sparkline(thr)}</td></tr>"
+        )
+    if not rows:
+        return "<p class='note'>No recorded cases.</p>"
+    header = "<tr><th>case</th><th>runs</th><th>latency</th><th>trend</th><th>throughput</th><th>trend</th></tr>"
+    return "<table>" + header + "".join(rows) + "</table>"
+
+
+def _sparkline(points: Sequence[Tuple[float, float]], width: int = 240, height: int = 48) -> str:
+    if not points:
+        return ""
+    points = downsample(points)
+    x0, x1 = points[0][0], points[-1][0]
+    lo, hi = min(y for _, y in points), max(y for _, y in points)
+    pad = 4
+
+    def sx(x: float) -> float:
+        return pad + (width - 2 * pad) * ((x - x0) / (x1 - x0) if x1 > x0 else 0.5)
+
+    def sy(y: float) -> float:
+        return height - pad - (height - 2 * pad) * ((y - lo) / (hi - lo) if hi > lo else 0.5)
+
+    path = " ".join(f"{sx(x):.1f},{sy(y):.1f}" for x, y in points)
+    last_x, last_y = points[-1]
+    return (
+        f"<svg width='{width}' height='{height}'>"
+        f"<polyline points='{path}' fill='none' stroke='#3366cc' stroke-width='1.5'/>"
+        f"<circle cx='{sx(last_x):.1f}' cy='{sy(last_y):.1f}' r='2.5' fill='#3366cc'>"
+        f"<title>{_format_time(last_x)}: {last_y:.4g}</title></circle>"
+        f"<text x='{width - pad}' y='10' text-anchor='end'>{hi:.3g}</text>"
+        f"<text x='{width - pad}' y='{height - 2}' text-anchor='end'>{lo:.3g}</text></svg>"
+    )
+
+
+def _distribution_table(series: Mapping[str, Sequence[HistoryPoint]]) -> str:
+    # Rows: case/shape; columns: backend:chip; cells: the latest run's samples.
+    latest: Dict[str, Dict[str, HistoryPoint]] = {}
+    for identifier, points in series.items():
+        point = points[-1]
+        if point.samples:
+            row = f"{point.case}/{identifier.rpartition('/')[2]}"
+            latest.setdefault(row, {})[point.target] = point
+    if not latest:
+        return "<p class='note'>No timed samples recorded.</p>"
+    targets = sorted({target for cells in latest.values() for target in cells})
+    header = "<tr><th>case</th>" + "".join(f"<th>{html.escape(target)}</th>" for target in targets) + "</tr>"
+    rows = []
+    for row in sorted(latest):
+        cells = latest[row]
+        lo = min(min(point.samples) for point in cells.values())
+        hi = max(max(point.samples) for point in cells.values())
+        rows.append(
+            f"<tr><td>{html.escape(row)}</td>"
+            + "".join(
+                f"<td>{_box(cells[target].samples, lo, hi) if target in cells else ''}</td>" for target in targets
+            )
+            + "</tr>"
+        )
+    note = "<p class='note'>Wall-time samples of the latest run; boxes share one scale per row.</p>"
+    return note + "<table>" + header + "".join(rows) + "</table>"
+
+
+def _box(samples: Sequence[float], lo: float, hi: float, width: int = 180, height: int = 22) -> str:
+    ordered = sorted(samples)
+    q1, median, q3 = statistics.quantiles(ordered, n=4) if len(ordered) > 1 else (ordered[0],) * 3
+    pad = 4
+
+    def sx(value: float) -> float:
+        return pad + (width - 2 * pad) * ((value - lo) / (hi - lo) if hi > lo else 0.5)
+
+    mid = height / 2
+    title = f"n={len(ordered)} min={ordered[0] * 1e3:.3f}ms median={median * 1e3:.3f}ms max={ordered[-1] * 1e3:.3f}ms"
+    return (
+        f"<svg width='{width}' height='{height}'><title>{title}</title>"
+        f"<line x1='{sx(ordered[0]):.1f}' x2='{sx(ordered[-1]):.1f}' y1='{mid}' y2='{mid}' stroke='#888'/>"
+        f"<rect x='{sx(q1):.1f}' y='4' width='{max(sx(q3) - sx(q1), 1):.1f}' height='{height - 8}' "
+        f"fill='#c6d8f5' stroke='#3366cc'/>"
+        f"<line x1='{sx(median):.1f}' x2='{sx(median):.1f}' y1='3' y2='{height - 3}' "
+        f"stroke='#b00020' stroke-width='2'/></svg>"
+    )
+
+
+def roofline_point(point: HistoryPoint) -> Optional[Tuple[float, float]]:
+    """(arithmetic intensity in FLOP/byte, GFLOP/s) from runner metrics, if the case reports both.
+
+    Runners either print rates (``gflops`` or ``tflops`` plus a ``*gbps`` bandwidth) or per-call
+    ``flops`` and ``bytes`` next to ``kernel_ms``.
+    """
+
+    gflops, gbps = rates(point.metrics)
+    if not gflops or not gbps:
+        return None
+    return gflops / gbps, gflops
+
+
+def _roofline(
+    series: Mapping[str, Sequence[HistoryPoint]], peak_gflops: float | None, peak_gbps: float | None
+) -> str:
+    points = []
+    for identifier, history in sorted(series.items()):
+        placed = roofline_point(history[-1]) if history[-1].status == "ok" else None
+        if placed:
+            points.append((identifier, *placed))
+    roof = peak_gflops is not None and peak_gbps is not None
+    if not points:
+        return (
+            "<p class='note'>No case reports both a FLOP rate (<code>gflops</code> / <code>flops</code>) and a "
+            "bandwidth (<code>*_gbps</code> / <code>bytes</code>) in its OPTEST_METRIC line.</p>"
+        )
+    xs = [x for _, x, _ in points] + ([peak_gflops / peak_gbps] if roof else [])
+    ys = [y for _, _, y in points] + ([peak_gflops] if roof else [])
+    x_lo, x_hi = math.floor(math.log10(min(xs))) - 1, math.ceil(math.log10(max(xs))) + 1
+    y_lo, y_hi = math.floor(math.log10(min(ys))) - 1, math.ceil(math.log10(max(ys))) + 1
+    width, height, left, bottom = 640, 380, 48, 32
+
+    def sx(x: float) -> float:
+        return left + (width - left - 12) * (math.log10(x) - x_lo) / (x_hi - x_lo)
+
+    def sy(y: float) -> float:
+        return height - bottom - (height - bottom - 12) * (math.log10(y) - y_lo) / (y_hi - y_lo)
+
+    parts = [f"<svg width='{width}' height='{height}'>"]
+    for decade in range(x_lo, x_hi + 1):
+        x = sx(10.0**decade)
+        parts.append(f"<line x1='{x:.1f}' x2='{x:.1f}' y1='12' y2='{height - bottom}' stroke='#eee'/>")
+        parts.append(f"<text x='{x:.1f}' y='{height - bottom + 14}' text-anchor='middle'>1e{decade}</text>")
+    for decade in range(y_lo, y_hi + 1):
+        y = sy(10.0**decade)
+        parts.append(f"<line x1='{left}' x2='{width - 12}' y1='{y:.1f}' y2='{y:.1f}' stroke='#eee'/>")
+        parts.append(f"<text x='{left - 4}' y='{y + 3:.1f}' text-anchor='end'>1e{decade}</text>")
+    parts.append(
+        f"<text x='{(left + width) / 2}' y='{height - 4}' text-anchor='middle'>arithmetic intensity (FLOP/byte)</text>"
+        f"<text x='12' y='{(height - bottom) / 2}' transform='rotate(-90 12 {(height - bottom) / 2})' "
+        f"text-anchor='middle'>GFLOP/s</text>"
+    )
+    if roof:
+        assert peak_gflops is not None and peak_gbps is not None
+        ridge = peak_gflops / peak_gbps
+        start = 10.0**x_lo
+        parts.append(
+            f"<polyline points='{sx(start):.1f},{sy(max(peak_gbps * start, 10.0**y_lo)):.1f} "
+            f"{sx(ridge):.1f},{sy(peak_gflops):.1f} {sx(10.0**x_hi):.1f},{sy(peak_gflops):.1f}' "
+            f"fill='none' stroke='#b00020' stroke-width='1.5'><title>peak {peak_gflops:g} GFLOP/s, "
+            f"{peak_gbps:g} GB/s</title></polyline>"
+        )
+    for identifier, x, y in points:
+        parts.append(
+            f"<circle cx='{sx(x):.1f}' cy='{sy(y):.1f}' r='4' fill='#3366cc' fill-opacity='0.7'>"
+            f"<title>{html.escape(identifier)}: {x:.3g} FLOP/B, {y:.4g} GFLOP/s</title></circle>"
+        )
+    parts.append("</svg>")
+    note = (
+        "<p class='note'>Latest run of every case that reports a FLOP rate and a bandwidth."
+        + ("" if roof else " Pass <code>--peak-gflops</code> and <code>--peak-gbps</code> to draw the roof.")
+        + "</p>"
+    )
+    return note + "".join(parts)
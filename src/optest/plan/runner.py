@@ -7,16 +7,30 @@ import os
 import shlex
 import subprocess
 from pathlib import Path
-from typing import Any, Dict, List, Mapping, Sequence
+from typing import Any, Callable, Dict, List, Mapping, Sequence, Tuple
 
 import numpy as np
 from colorama import Fore, Style, init as colorama_init
 from jsonschema import Draft7Validator
 
 from optest.operators import builtin_operators
-
-from . import custom
-from .models import AssertionConfig, AssertionResult, CaseRunResult, ExecutionPlan, GeneratorConfig, PlanOptions, ResolvedCase
+from optest.storage import allocate_tensor, finalize_tensor, load_array, tensor_digest
+from optest.storage.cache import ArtifactCache, CachedTensor, cache_key, iter_flat_chunks
+from optest.storage.compression import CompressedTensor
+from optest.storage.shared import SharedStore
+
+from . import custom, expression, generators, pipeline
+from .models import (
+    AssertionConfig,
+    AssertionResult,
+    CaseRunResult,
+    ExecutionPlan,
+    GeneratorConfig,
+    PlanOptions,
+    ResolvedCase,
+    TensorLayout,
+)
+from .session import SessionPool, print_sessions, session_tokens
 
 # Registry of built-in operator classes keyed by normalized assertion name.
 _BUILTIN_ASSERTION_REGISTRY: Dict[str, type[builtin_operators.BuiltinOperator]] = {}
@@ -68,17 +82,25 @@ def run_plan(
         print("No cases matched the provided filters.")
         return 1
     cache_policy = options.cache or plan.cache
+    cache = _open_artifact_cache(plan)
+    sessions = SessionPool()
     results: list[CaseRunResult] = []
-    for item in resolved:
-        result = _execute_case(item, cache_policy)
-        results.append(result)
-        if report_format == "terminal":
-            _print_result(result, use_color=use_color)
+    try:
+        for item in resolved:
+            result = _execute_case(item, cache_policy, cache, sessions)
+            results.append(result)
+            if report_format == "terminal":
+                _print_result(result, use_color=use_color)
+    finally:
+        sessions.close()
     failures = sum(1 for r in results if r.status in {"failed", "error", "xfail-pass"})
+    session_summary = sessions.summary() if sessions.samples else None
     if report_format == "terminal":
+        if session_summary:
+            print_sessions(session_summary, use_color=use_color)
         _print_summary(results, failures, use_color=use_color)
     else:
-        _write_json_report(results, report_path)
+        _write_json_report(results, report_path, session_summary)
     return 0 if failures == 0 else 1
 
 
@@ -137,17 +159,33 @@ def _resolve_paths(paths: Sequence[str], base: Path) -> Sequence[Path]:
     return tuple(resolved)
 
 
-def _execute_case(resolved: ResolvedCase, cache_policy: str) -> CaseRunResult:
+def _open_artifact_cache(plan: ExecutionPlan) -> ArtifactCache | None:
+    storage = plan.storage
+    if storage.cache_dir is None:
+        return None
+    shared = SharedStore(storage.shared_dir, claim_timeout=storage.claim_timeout) if storage.shared_dir else None
+    return ArtifactCache(storage.cache_dir, storage.compression, shared)
+
+
+def _execute_case(
+    resolved: ResolvedCase,
+    cache_policy: str,
+    cache: ArtifactCache | None = None,
+    sessions: SessionPool | None = None,
+) -> CaseRunResult:
     identifier = _format_case_identifier(resolved)
     try:
         generator = resolved.case.generator or resolved.plan.generator
         assertion = resolved.case.assertion or resolved.plan.assertion
         cache_policy = cache_policy or resolved.plan.cache
-        inputs = _prepare_inputs(resolved, generator, cache_policy)
+        inputs = _prepare_inputs(resolved, generator, cache_policy, cache)
         _ensure_output_dirs(resolved.output_paths)
-        _run_backend_commands(resolved)
-        outputs = _load_outputs(resolved, assertion)
-        assertion_result = _run_assertion(resolved, assertion, inputs, outputs)
+        if resolved.plan.pipeline is not None:
+            assertion_result = pipeline.execute_pipeline(resolved, inputs, cache, sessions)
+        else:
+            _run_backend_commands(resolved, sessions)
+            outputs = _load_outputs(resolved, assertion)
+            assertion_result = _run_assertion(resolved, assertion, inputs, outputs, cache)
         if assertion_result.ok:
             status = "xfail-pass" if resolved.xfail else "passed"
         else:
@@ -175,34 +213,117 @@ def _format_case_identifier(resolved: ResolvedCase) -> str:
     return f"{resolved.case.name}@{resolved.backend.type}:{resolved.backend.chip}/{shape_desc}"
 
 
-def _prepare_inputs(resolved: ResolvedCase, generator_cfg: GeneratorConfig, cache_policy: str) -> Sequence[np.ndarray]:
-    if cache_policy == "reuse" and all(path.exists() for path in resolved.input_paths):
-        return _load_inputs(resolved)
-    rng_seed = generator_cfg.seed
-    rng = np.random.default_rng(rng_seed)
+def _prepare_inputs(
+    resolved: ResolvedCase,
+    generator_cfg: GeneratorConfig,
+    cache_policy: str,
+    cache: ArtifactCache | None = None,
+) -> Sequence[np.ndarray]:
+    file_format = resolved.plan.storage.format
+    layouts = _layouts_for(resolved, "inputs")
+    # Cached inputs are stored dense, so strided/pitched inputs are always regenerated.
+    cacheable = cache and not generator_cfg.source and not any(layouts)
+    keys = _input_cache_keys(resolved, generator_cfg) if cacheable else None
+    if cache and keys and cache_policy == "reuse":
+        if all(cache.materialize("inputs", key, path, file_format) for key, path in zip(keys, resolved.input_paths)):
+            return _load_inputs(resolved)
+    elif cache_policy == "reuse" and all(path.exists() for path in resolved.input_paths):
+        try:
+            return _load_inputs(resolved)
+        except ValueError:
+            pass  # stale dtype/shape: regenerate below
     if generator_cfg.source:
+        rng = np.random.default_rng(generator_cfg.seed)
         _call_custom_generator(generator_cfg, resolved, rng)
         return _load_inputs(resolved)
+    seeds = np.random.SeedSequence(generator_cfg.seed).spawn(len(resolved.input_paths))
     inputs: list[np.ndarray] = []
-    for index, (path, shape, dtype) in enumerate(
-        zip(resolved.input_paths, resolved.shape.inputs, resolved.case.dtypes)
+    for index, (path, shape, dtype, layout) in enumerate(
+        zip(resolved.input_paths, resolved.shape.inputs, resolved.case.dtypes, layouts)
     ):
-        gen_cfg = generator_cfg.per_input.get(index, generator_cfg)
-        arr = _generate_array(gen_cfg, shape, dtype, rng, resolved)
-        path.parent.mkdir(parents=True, exist_ok=True)
-        arr.astype(dtype).tofile(path)
-        inputs.append(arr.astype(dtype))
-    return tuple(inputs)
+        override = generator_cfg.per_input.get(index)
+        gen_cfg = override or generator_cfg
+        # The plan-level seed is spawned per input; only a per_input seed pins one input's stream.
+        seed = np.random.SeedSequence(override.seed) if override and override.seed is not None else seeds[index]
+        arr = allocate_tensor(path, shape, dtype, container=file_format == "optt", **_layout_kwargs(layout))
+        generators.generate(gen_cfg, shape, dtype, seed, out=arr)
+        if isinstance(arr.base, np.memmap):
+            arr.base.flush()
+        elif isinstance(arr, np.memmap):
+            arr.flush()
+        if file_format == "optt":
+            finalize_tensor(path)
+        inputs.append(arr)
+    if cache and keys:
+        for key, arr in zip(keys, inputs):
+            cache.put("inputs", key, arr)
+    # Hand assertions read-only maps, not the writable ones the generators filled.
+    return _load_inputs(resolved)
+
+
+def _input_cache_keys(resolved: ResolvedCase, generator_cfg: GeneratorConfig) -> Sequence[str]:
+    # Inputs share one seeded stream, so every key covers the whole input set.
+    base = cache_key(
+        "inputs",
+        _generator_fingerprint(generator_cfg),
+        [list(shape) for shape in resolved.shape.inputs],
+        list(resolved.case.dtypes),
+    )
+    return tuple(f"{base}-{index}" for index in range(len(resolved.input_paths)))
+
+
+def _generator_fingerprint(config: GeneratorConfig) -> Dict[str, Any]:
+    return {
+        "name": config.name,
+        "seed": config.seed,
+        "params": dict(config.params),
+        "constants": dict(config.constants),
+        "per_input": {str(k): _generator_fingerprint(v) for k, v in sorted(config.per_input.items())},
+    }
+
+
+def _layouts_for(resolved: ResolvedCase, kind: str) -> Sequence[TensorLayout | None]:
+    # Only raw files carry layouts; load_plan rejects them for containers.
+    count = len(resolved.input_paths if kind == "inputs" else resolved.output_paths)
+    layouts = resolved.shape.input_layouts if kind == "inputs" else resolved.shape.output_layouts
+    if not layouts:
+        return (None,) * count
+    return tuple(layouts)
+
+
+def _layout_kwargs(layout: TensorLayout | None) -> Dict[str, Any]:
+    if layout is None:
+        return {}
+    return {"strides": layout.strides, "offset": layout.offset}
 
 
 def _load_inputs(resolved: ResolvedCase) -> Sequence[np.ndarray]:
     arrays: list[np.ndarray] = []
-    for path, shape, dtype in zip(resolved.input_paths, resolved.shape.inputs, resolved.case.dtypes):
-        data = np.fromfile(path, dtype=dtype)
-        arrays.append(data.reshape(shape))
+    layouts = _layouts_for(resolved, "inputs")
+    for path, shape, dtype, layout in zip(resolved.input_paths, resolved.shape.inputs, resolved.case.dtypes, layouts):
+        arrays.append(load_array(path, shape, dtype, **_layout_kwargs(layout)))
     return tuple(arrays)
 
 
+def _write_inputs(resolved: ResolvedCase, arrays: Sequence[np.ndarray]) -> None:
+    """Write given input values to the case's input paths, in the plan's file format and layouts."""
+
+    file_format = resolved.plan.storage.format
+    layouts = _layouts_for(resolved, "inputs")
+    for path, values, shape, dtype, layout in zip(
+        resolved.input_paths, arrays, resolved.shape.inputs, resolved.case.dtypes, layouts
+    ):
+        path.parent.mkdir(parents=True, exist_ok=True)
+        arr = allocate_tensor(path, shape, dtype, container=file_format == "optt", **_layout_kwargs(layout))
+        arr[...] = values
+        if isinstance(arr.base, np.memmap):
+            arr.base.flush()
+        elif isinstance(arr, np.memmap):
+            arr.flush()
+        if file_format == "optt":
+            finalize_tensor(path)
+
+
 def _call_custom_generator(config: GeneratorConfig, resolved: ResolvedCase, rng: np.random.Generator) -> None:
     func = custom.load_from_source(config.source, config.name)  # type: ignore[arg-type]
     func(
@@ -216,32 +337,6 @@ def _call_custom_generator(config: GeneratorConfig, resolved: ResolvedCase, rng:
     )
 
 
-def _generate_array(
-    config: GeneratorConfig, shape: Sequence[int], dtype: str, rng: np.random.Generator, resolved: ResolvedCase
-) -> np.ndarray | None:
-    name = config.name
-    low = float(config.params.get("low", -1.0))
-    high = float(config.params.get("high", 1.0))
-    constants = config.constants or {}
-    if "value" in constants:
-        return np.full(shape, constants["value"], dtype=dtype)
-    if name.endswith("uniform"):
-        return rng.uniform(low, high, size=shape).astype(dtype)
-    if name.endswith("ones"):
-        return np.ones(shape, dtype=dtype)
-    if name.endswith("random"):
-        data = rng.standard_normal(size=shape).astype(dtype)
-    else:
-        raise ValueError(
-            f"Unknown generator '{name}'. "
-            "Supported builtins: builtin.random, builtin.uniform, builtin.ones. "
-            "For a custom generator, set both generator.name and generator.source."
-        )
-    scale = float(constants.get("scale", 1.0))
-    shift = float(constants.get("shift", 0.0))
-    return (data * scale + shift).astype(dtype)
-
-
 def _ensure_output_dirs(paths: Sequence[Path]) -> None:
     for path in paths:
         path.parent.mkdir(parents=True, exist_ok=True)
@@ -249,18 +344,36 @@ def _ensure_output_dirs(paths: Sequence[Path]) -> None:
             path.unlink()
 
 
-def _run_backend_commands(resolved: ResolvedCase) -> None:
+def _run_backend_commands(resolved: ResolvedCase, sessions: SessionPool | None = None) -> None:
     backend = resolved.backend
     tokens = _build_tokens(resolved)
     env = os.environ.copy()
     env.update(_render_env(backend.env, tokens))
     for cmd in backend.prepare:
         _run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
-    _run_command(backend.command.argv, backend.workdir, env, tokens, backend.timeout, backend.retries)
+    if backend.session is not None and sessions is not None:
+        _run_session_request(resolved, sessions, tokens, env, backend.retries)
+    else:
+        _run_command(backend.command.argv, backend.workdir, env, tokens, backend.timeout, backend.retries)
     for cmd in backend.cleanup:
         _run_command(cmd.argv, backend.workdir, env, tokens, backend.timeout)
 
 
+def _run_session_request(
+    resolved: ResolvedCase,
+    sessions: SessionPool,
+    tokens: Mapping[str, str],
+    env: Mapping[str, str],
+    retries: int = 0,
+) -> str:
+    # The session command and env are rendered with backend-level tokens; per-case tokens travel in the request.
+    backend = resolved.backend
+    fixed = session_tokens(tokens)
+    argv = [_render_token(part, fixed) for part in backend.command.argv]
+    session_env = {**env, **_render_env(backend.env, fixed)}
+    return sessions.call(resolved, _format_case_identifier(resolved), argv, tokens, session_env, retries)
+
+
 def _run_command(
     argv: Sequence[str],
     workdir: Path,
@@ -268,7 +381,7 @@ def _run_command(
     tokens: Mapping[str, str],
     timeout: int | None,
     retries: int = 0,
-) -> None:
+) -> subprocess.CompletedProcess[str]:
     rendered = [_render_token(part, tokens) for part in argv]
     attempts = retries + 1
     last_exc: RuntimeError | None = None
@@ -282,13 +395,13 @@ def _run_command(
             timeout=timeout,
         )
         if proc.returncode == 0:
-            return
+            return proc
         last_exc = RuntimeError(
             f"command '{' '.join(rendered)}' failed (code {proc.returncode}) "
             f"in {workdir}: {proc.stderr.strip() or proc.stdout.strip()}"
         )
-    if last_exc:
-        raise last_exc
+    assert last_exc is not None
+    raise last_exc
 
 
 def _build_tokens(resolved: ResolvedCase) -> Dict[str, str]:
@@ -301,7 +414,20 @@ def _build_tokens(resolved: ResolvedCase) -> Dict[str, str]:
     first_shape = resolved.shape.inputs[0] if resolved.shape.inputs else ()
     tokens["shape"] = "x".join(str(dim) for dim in first_shape)
     tokens["shapes"] = json.dumps({"inputs": resolved.shape.inputs, "outputs": resolved.shape.outputs})
+    tokens["layouts"] = json.dumps(
+        {
+            "inputs": _layouts_json(_layouts_for(resolved, "inputs")),
+            "outputs": _layouts_json(_layouts_for(resolved, "outputs")),
+        }
+    )
+    # The operator and attributes (perm, k, mode, ...) the runner must match, as given to the assertion.
+    assertion = resolved.case.assertion or resolved.plan.assertion
+    tokens["assertion"] = assertion.name
+    tokens["params"] = json.dumps(dict(assertion.params))
     tokens["workdir"] = str(resolved.backend.workdir)
+    tokens["format"] = resolved.plan.storage.format
+    tokens["cache_state"] = "warm"  # `optest bench --cache-state` sets it per timed pass
+    tokens["ftz"] = "off"  # `optest bench --ftz`
     tokens["inputs"] = ",".join(str(p) for p in resolved.input_paths)
     tokens["outputs"] = ",".join(str(p) for p in resolved.output_paths)
     for idx, path in enumerate(resolved.input_paths):
@@ -311,6 +437,16 @@ def _build_tokens(resolved: ResolvedCase) -> Dict[str, str]:
     return tokens
 
 
+def _layouts_json(layouts: Sequence[TensorLayout | None]) -> List[Dict[str, Any] | None]:
+    # null = contiguous; strides are in elements, null strides = contiguous after ``offset``.
+    return [
+        None
+        if layout is None
+        else {"strides": list(layout.strides) if layout.strides is not None else None, "offset": layout.offset}
+        for layout in layouts
+    ]
+
+
 def _render_token(value: str, tokens: Mapping[str, str]) -> str:
     return _render_template(value, tokens, quote=True)
 
@@ -343,11 +479,11 @@ def _render_env(values: Mapping[str, str], tokens: Mapping[str, str]) -> Dict[st
 def _load_outputs(resolved: ResolvedCase, assertion: AssertionConfig) -> Sequence[np.ndarray]:
     dtypes = _resolve_output_dtypes(resolved, assertion)
     outputs: list[np.ndarray] = []
-    for path, shape, dtype in zip(resolved.output_paths, resolved.shape.outputs, dtypes):
+    layouts = _layouts_for(resolved, "outputs")
+    for path, shape, dtype, layout in zip(resolved.output_paths, resolved.shape.outputs, dtypes, layouts):
         if not path.exists():
             raise FileNotFoundError(f"expected output missing at {path} for case {resolved.case.name}")
-        data = np.fromfile(path, dtype=dtype)
-        outputs.append(data.reshape(shape))
+        outputs.append(load_array(path, shape, dtype, **_layout_kwargs(layout)))
     return tuple(outputs)
 
 
@@ -370,7 +506,14 @@ def _run_assertion(
     assertion: AssertionConfig,
     inputs: Sequence[np.ndarray],
     outputs: Sequence[np.ndarray],
+    cache: ArtifactCache | None = None,
 ) -> AssertionResult:
+    if assertion.source and custom.is_native(assertion.source):
+        native = custom.load_native(assertion.source, assertion.name)
+        ok, details, metrics = native(
+            inputs, outputs, assertion.params, assertion.rtol, assertion.atol, assertion.metric
+        )
+        return AssertionResult(ok=ok, details=details, metrics=metrics)
     if assertion.source:
         func = custom.load_from_source(assertion.source, assertion.name)
         result = func(
@@ -390,7 +533,7 @@ def _run_assertion(
             ok, details = result
             return AssertionResult(ok=bool(ok), details=str(details))
         raise TypeError("Custom assertion must return AssertionResult or (ok, details)")
-    return _builtin_assertion(assertion, inputs, outputs, resolved)
+    return _builtin_assertion(assertion, inputs, outputs, resolved, cache)
 
 
 def _builtin_assertion(
@@ -398,11 +541,18 @@ def _builtin_assertion(
     inputs: Sequence[np.ndarray],
     outputs: Sequence[np.ndarray],
     resolved: ResolvedCase,
+    cache: ArtifactCache | None = None,
 ) -> AssertionResult:
     _populate_builtin_registry()
     name = assertion.name
     normalized = _normalize_builtin_key(name)
-    if normalized == "identity":
+    if assertion.expr is not None:
+        try:
+            expected = _expression_outputs(assertion, inputs, resolved, cache)
+        except ValueError as exc:
+            return AssertionResult(ok=False, details=str(exc))
+        default_tol = None
+    elif normalized == "identity":
         expected = outputs
         default_tol = None
     else:
@@ -417,21 +567,137 @@ def _builtin_assertion(
                     "For custom assertions, set both assertion.name and assertion.source."
                 ),
             )
-        expected = op_cls.run(inputs, assertion.params)
-        default_tol = getattr(op_cls, "default_tolerance", None)
+        expected = _reference_outputs(op_cls, inputs, assertion, resolved, cache)
+        default_tol = op_cls.tolerance(inputs, assertion.params)
+        if op_cls.index_outputs:
+            try:
+                outputs, expected = _select_indexed_values(op_cls, inputs, outputs, expected, assertion.params)
+            except ValueError as exc:
+                return AssertionResult(ok=False, details=f"Invalid index output: {exc}")
     rtol = assertion.rtol if assertion.rtol is not None else (default_tol.relative if default_tol else 1e-5)
     atol = assertion.atol if assertion.atol is not None else (default_tol.absolute if default_tol else 1e-4)
     metric_name = assertion.metric or "max_abs"
-    ok, details, metrics = _compare_outputs(outputs, expected, rtol, atol, metric_name)
+    if assertion.region is not None:
+        try:
+            outputs, expected = _restrict_region(outputs, expected, assertion.region)
+        except (IndexError, ValueError) as exc:
+            return AssertionResult(ok=False, details=f"Invalid assertion.region: {exc}")
+    ok, details, metrics = _compare_outputs(outputs, expected, rtol, atol, metric_name, equal_nan=assertion.equal_nan)
     return AssertionResult(ok=ok, details=details, metrics=metrics)
 
 
+def _reference_outputs(
+    op_cls: type[builtin_operators.BuiltinOperator],
+    inputs: Sequence[np.ndarray],
+    assertion: AssertionConfig,
+    resolved: ResolvedCase,
+    cache: ArtifactCache | None,
+) -> Sequence[CachedTensor]:
+    if cache is None:
+        return op_cls.run(inputs, assertion.params)
+    key = cache_key("golden", op_cls.name, dict(assertion.params), *_golden_inputs(inputs, assertion, resolved))
+    return _cached_golden(cache, key, lambda: op_cls.run(inputs, assertion.params))
+
+
+def _expression_outputs(
+    assertion: AssertionConfig,
+    inputs: Sequence[np.ndarray],
+    resolved: ResolvedCase,
+    cache: ArtifactCache | None,
+) -> Sequence[CachedTensor]:
+    assert assertion.expr is not None
+    texts = assertion.expr
+    bindings = expression.bind(resolved.input_paths, inputs, assertion.params)
+    if cache is None:
+        return expression.evaluate_all(texts, bindings)
+    key = cache_key(
+        "golden",
+        "expr",
+        list(texts),
+        dict(assertion.params),
+        *_golden_inputs(inputs, assertion, resolved),
+        # Names bind to input file stems, so renaming an input can change the result.
+        [path.name for path in resolved.input_paths],
+    )
+    return _cached_golden(cache, key, lambda: expression.evaluate_all(texts, bindings))
+
+
+def _golden_inputs(
+    inputs: Sequence[np.ndarray], assertion: AssertionConfig, resolved: ResolvedCase
+) -> Tuple[List[str], List[List[int]], List[str], List[str]]:
+    # Equal bytes under another shape or dtype (or a different output dtype) is a different golden.
+    return (
+        [tensor_digest(path) for path in resolved.input_paths],
+        [list(item.shape) for item in inputs],
+        [str(item.dtype) for item in inputs],
+        list(_resolve_output_dtypes(resolved, assertion)),
+    )
+
+
+def _cached_golden(
+    cache: ArtifactCache, key: str, compute: Callable[[], Sequence[np.ndarray]]
+) -> Sequence[CachedTensor]:
+    cached = cache.get_group("goldens", key)
+    if cached is not None:
+        return cached
+    with cache.claim("goldens", key):
+        # Whether or not we won the claim, another process may have published the golden while we waited.
+        cached = cache.get_group("goldens", key)
+        if cached is not None:
+            return cached
+        expected = compute()
+        cache.put_group("goldens", key, [np.asarray(item) for item in expected])
+    return expected
+
+
+def _select_indexed_values(
+    op_cls: type[builtin_operators.BuiltinOperator],
+    inputs: Sequence[np.ndarray],
+    outputs: Sequence[np.ndarray],
+    expected: Sequence[CachedTensor],
+    params: Mapping[str, Any],
+) -> tuple[Sequence[np.ndarray], Sequence[CachedTensor]]:
+    """Replace index outputs by the input values they select, so equal-valued ties compare equal."""
+
+    got, want = list(outputs), list(expected)
+    for idx in op_cls.index_outputs:
+        if idx >= min(len(got), len(want)) or got[idx].shape != want[idx].shape:
+            continue  # let the comparison report the mismatch
+        ref = want[idx].load() if isinstance(want[idx], CompressedTensor) else want[idx]
+        got[idx] = op_cls.indexed_values(inputs, got[idx], params)
+        want[idx] = op_cls.indexed_values(inputs, ref, params)
+    return tuple(got), tuple(want)
+
+
+def _restrict_region(
+    outputs: Sequence[np.ndarray],
+    expected: Sequence[CachedTensor],
+    region: Sequence[slice],
+) -> tuple[Sequence[np.ndarray], Sequence[np.ndarray]]:
+    """Slice every output and its golden to ``region`` (e.g. the valid part of a padded tile)."""
+
+    if len(outputs) != len(expected) or any(out.shape != ref.shape for out, ref in zip(outputs, expected)):
+        return outputs, expected  # let the comparison report the mismatch
+    index = tuple(region)
+    got: list[np.ndarray] = []
+    want: list[np.ndarray] = []
+    for out, ref in zip(outputs, expected):
+        if len(index) > out.ndim:
+            raise ValueError(f"region has {len(index)} entries but output has {out.ndim} dims")
+        ref = ref.load() if isinstance(ref, CompressedTensor) else np.asarray(ref)
+        got.append(out[index])
+        want.append(ref[index])
+    return tuple(got), tuple(want)
+
+
 def _compare_outputs(
     outputs: Sequence[np.ndarray],
-    expected: Sequence[np.ndarray],
+    expected: Sequence[CachedTensor],
     rtol: float,
     atol: float,
     metric: str,
+    *,
+    equal_nan: bool = False,
 ) -> tuple[bool, str, Dict[str, Any]]:
     metrics: Dict[str, Any] = {}
     if len(outputs) != len(expected):
@@ -439,8 +705,16 @@ def _compare_outputs(
     for idx, (got, want) in enumerate(zip(outputs, expected)):
         if got.shape != want.shape:
             return False, f"Output{idx} shape mismatch {got.shape} vs {want.shape}", metrics
-        if not np.allclose(got, want, rtol=rtol, atol=atol):
-            diff = np.abs(got - want)
+        if isinstance(want, CompressedTensor):
+            ok, max_abs, mean_abs = _compare_streaming(got, want, rtol, atol, equal_nan)
+            if not ok:
+                metrics[f"output{idx}_max_abs"] = max_abs
+                if metric == "mean_abs":
+                    metrics[f"output{idx}_mean_abs"] = mean_abs
+                return False, f"Output{idx} mismatch (max_abs={max_abs})", metrics
+            continue
+        if not np.allclose(got, want, rtol=rtol, atol=atol, equal_nan=equal_nan):
+            diff = _abs_diff(got, want, equal_nan)
             max_abs = float(np.max(diff))
             metrics[f"output{idx}_max_abs"] = max_abs
             if metric == "mean_abs":
@@ -449,6 +723,34 @@ def _compare_outputs(
     return True, "", metrics
 
 
+def _compare_streaming(
+    got: np.ndarray, want: CachedTensor, rtol: float, atol: float, equal_nan: bool = False
+) -> tuple[bool, float, float]:
+    """Compare against a cached golden chunk by chunk, never materializing it in full."""
+
+    flat = np.asarray(got).reshape(-1)
+    ok = True
+    max_abs = 0.0
+    total_abs = 0.0
+    for offset, chunk in iter_flat_chunks(want):
+        part = flat[offset : offset + chunk.size]
+        if not np.allclose(part, chunk, rtol=rtol, atol=atol, equal_nan=equal_nan):
+            ok = False
+        if chunk.size:
+            diff = _abs_diff(part, chunk, equal_nan)
+            max_abs = float(np.maximum(max_abs, np.max(diff)))  # keeps a NaN mismatch visible
+            total_abs += float(np.sum(diff, dtype=np.float64))
+    return ok, max_abs, total_abs / max(flat.size, 1)
+
+
+def _abs_diff(got: np.ndarray, want: np.ndarray, equal_nan: bool) -> np.ndarray:
+    with np.errstate(invalid="ignore"):  # inf - inf
+        diff = np.abs(np.subtract(got, want, dtype=np.float64))
+    if equal_nan:
+        diff[np.isnan(got) & np.isnan(want)] = 0.0  # matching NaNs count as equal
+    return diff
+
+
 def _print_result(result: CaseRunResult, *, use_color: bool = True) -> None:
     status = result.status
     label, color = _format_status(status, use_color=use_color)
@@ -492,8 +794,10 @@ def _format_status(status: str, *, use_color: bool) -> tuple[str, str]:
     return label, color
 
 
-def _write_json_report(results: Sequence[CaseRunResult], path: str | None) -> None:
-    payload = {
+def _write_json_report(
+    results: Sequence[CaseRunResult], path: str | None, sessions: Mapping[str, Any] | None = None
+) -> None:
+    payload: Dict[str, Any] = {
         "summary": {
             "total": len(results),
             "failures": sum(1 for r in results if r.status in {"failed", "error", "xfail-pass"}),
@@ -538,6 +842,8 @@ def _write_json_report(results: Sequence[CaseRunResult], path: str | None) -> No
         },
     }
     Draft7Validator(REPORT_SCHEMA).validate(payload)
+    if sessions:
+        payload["sessions"] = sessions
     text = json.dumps(payload, indent=2)
     if path:
         Path(path).write_text(text, encoding="utf-8")
@@ -0,0 +1,329 @@
+"""Persistent runner sessions and their memory-growth monitoring.
+
+A backend with ``session:`` starts its ``command`` once (command and ``env``
+rendered with the backend-level tokens only: ``{backend}``, ``{chip}``,
+``{workdir}``, ``{format}``) and keeps it running. Each case execution writes one JSON line
+to the runner's stdin::
+
+    {"id": "case@backend:chip/shape0", "tokens": {"input0": "...", "output0": "...", ...}}
+
+and the runner answers with any output (``OPTEST_METRIC`` lines included)
+followed by ``OPTEST_DONE <code> [message]``; a non-zero code fails the case.
+
+After every request the runner's resident set size and open file descriptors
+are sampled from ``/proc``. Growth is attributed to the request that caused it,
+a linear trend is fitted per operator, case and target, and trends above
+``leak_kib_per_call`` (or half a descriptor per call) are flagged as leaks. With
+``recycle_rss_mib`` / ``recycle_fds`` the runner is restarted once it exceeds
+them, so a leaking runner still finishes a long plan. Failed requests are
+retried ``retries`` times (restarting the runner if it exited), and only the
+last ``STDERR_TAIL_BYTES`` of the runner's stderr are kept for error messages.
+"""
+from __future__ import annotations
+
+import collections
+import json
+import os
+import queue
+import subprocess
+import threading
+import time
+from dataclasses import asdict, dataclass
+from pathlib import Path
+from typing import Any, Dict, List, Mapping, Optional, Sequence, Tuple
+
+from colorama import Fore, Style
+
+from .models import ResolvedCase, SessionConfig
+
+DONE_PREFIX = "OPTEST_DONE"
+SESSION_TOKENS = ("backend", "chip", "workdir", "format")
+FD_LEAK_PER_CALL = 0.5
+STDERR_TAIL_BYTES = 64 * 1024
+MIN_TREND_CALLS = 3
+
+
+@dataclass(frozen=True)
+class MemorySample:
+    """Runner footprint right after one request."""
+
+    target: str
+    pid: int
+    operator: str
+    case: str
+    identifier: str
+    rss_kib: int
+    fds: int
+    recycled: bool = False
+
+
+@dataclass(frozen=True)
+class GrowthTrend:
+    """Least-squares growth per call of one operator/case on one target (first call per process excluded)."""
+
+    operator: str
+    case: str
+    target: str
+    calls: int
+    rss_kib_per_call: float
+    fds_per_call: float
+    leak: bool
+
+
+class RunnerSession:
+    """One running runner process; replies are read by a thread so requests can time out."""
+
+    def __init__(self, argv: Sequence[str], workdir: Path, env: Mapping[str, str]) -> None:
+        self.argv = list(argv)
+        self.proc = subprocess.Popen(
+            self.argv,
+            cwd=str(workdir),
+            env=dict(env),
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            text=True,
+            bufsize=1,
+        )
+        self._lines: "queue.Queue[Optional[str]]" = queue.Queue()
+        self._stderr: "collections.deque[str]" = collections.deque()
+        self._stderr_size = 0
+        threading.Thread(target=self._read, daemon=True).start()
+        self._stderr_reader = threading.Thread(target=self._read_stderr, daemon=True)
+        self._stderr_reader.start()
+
+    def _read(self) -> None:
+        assert self.proc.stdout is not None
+        for line in self.proc.stdout:
+            self._lines.put(line)
+        self._lines.put(None)
+
+    def _read_stderr(self) -> None:
+        # A long-lived runner may log without bound; keep only the tail for error messages.
+        assert self.proc.stderr is not None
+        for line in self.proc.stderr:
+            self._stderr.append(line)
+            self._stderr_size += len(line)
+            while self._stderr_size > STDERR_TAIL_BYTES and len(self._stderr) > 1:
+                self._stderr_size -= len(self._stderr.popleft())
+
+    @property
+    def alive(self) -> bool:
+        return self.proc.poll() is None
+
+    def request(self, identifier: str, tokens: Mapping[str, str], timeout: float | None) -> str:
+        """Send one case; returns the runner output that preceded ``OPTEST_DONE``."""
+
+        assert self.proc.stdin is not None
+        try:
+            self.proc.stdin.write(json.dumps({"id": identifier, "tokens": dict(tokens)}) + "\n")
+            self.proc.stdin.flush()
+        except BrokenPipeError:
+            raise RuntimeError(self._exit_message()) from None
+        deadline = time.monotonic() + timeout if timeout else None
+        output: List[str] = []
+        while True:
+            try:
+                line = self._lines.get(timeout=max(deadline - time.monotonic(), 0) if deadline else None)
+            except queue.Empty:
+                self.close()
+                raise RuntimeError(f"session runner '{' '.join(self.argv)}' timed out after {timeout}s") from None
+            if line is None:
+                raise RuntimeError(self._exit_message())
+            if not line.startswith(DONE_PREFIX):
+                output.append(line)
+                continue
+            _, _, rest = line.strip().partition(" ")
+            code_text, _, message = rest.partition(" ")
+            code = int(code_text) if code_text.lstrip("-").isdigit() else 1
+            if code != 0:
+                detail = message or "".join(output).strip()
+                raise RuntimeError(f"session request {identifier} failed (code {code}): {detail}")
+            return "".join(output)
+
+    def usage(self) -> Optional[Tuple[int, int]]:
+        """(RSS in KiB, open descriptors) from /proc; None where that is unavailable."""
+
+        proc_dir = Path("/proc") / str(self.proc.pid)
+        try:
+            status = (proc_dir / "status").read_text(encoding="utf-8")
+            fds = len(os.listdir(proc_dir / "fd"))
+        except OSError:
+            return None
+        rss = next((line.split()[1] for line in status.splitlines() if line.startswith("VmRSS:")), "0")
+        return int(rss), fds
+
+    def close(self) -> None:
+        if self.alive:
+            try:
+                assert self.proc.stdin is not None
+                self.proc.stdin.close()
+                self.proc.wait(timeout=5)
+            except (OSError, subprocess.TimeoutExpired):
+                self.proc.kill()
+                self.proc.wait()
+
+    def _exit_message(self) -> str:
+        code = self.proc.wait()
+        self._stderr_reader.join(timeout=5)
+        stderr = "".join(self._stderr).strip()
+        return f"session runner '{' '.join(self.argv)}' exited (code {code}): {stderr[-2000:]}"
+
+
+class SessionPool:
+    """Sessions keyed by ``backend:chip``, with a memory sample after every request."""
+
+    def __init__(self) -> None:
+        self._sessions: Dict[str, RunnerSession] = {}
+        self._configs: Dict[str, SessionConfig] = {}
+        self.samples: List[MemorySample] = []
+        self.restarts: Dict[str, int] = {}
+
+    def call(
+        self,
+        resolved: ResolvedCase,
+        identifier: str,
+        argv: Sequence[str],
+        tokens: Mapping[str, str],
+        env: Mapping[str, str],
+        retries: int = 0,
+    ) -> str:
+        backend = resolved.backend
+        assert backend.session is not None
+        target = f"{backend.type}:{backend.chip}"
+        last_exc: RuntimeError | None = None
+        for _ in range(retries + 1):
+            session = self._sessions.get(target)
+            if session is None or not session.alive:
+                if session is not None:
+                    session.close()
+                    self.restarts[target] = self.restarts.get(target, 0) + 1
+                session = self._sessions[target] = RunnerSession(argv, backend.workdir, env)
+                self._configs[target] = backend.session
+            try:
+                return session.request(identifier, tokens, backend.timeout)
+            except RuntimeError as exc:
+                last_exc = exc
+            finally:
+                self._sample(session, target, resolved, identifier)
+        assert last_exc is not None
+        raise last_exc
+
+    def _sample(self, session: RunnerSession, target: str, resolved: ResolvedCase, identifier: str) -> None:
+        usage = session.usage() if session.alive else None
+        if usage is None:
+            return
+        rss_kib, fds = usage
+        config = self._configs[target]
+        recycle = (config.recycle_rss_mib is not None and rss_kib > config.recycle_rss_mib * 1024) or (
+            config.recycle_fds is not None and fds > config.recycle_fds
+        )
+        self.samples.append(
+            MemorySample(
+                target=target,
+                pid=session.proc.pid,
+                operator=resolved.plan.operator,
+                case=resolved.case.name,
+                identifier=identifier,
+                rss_kib=rss_kib,
+                fds=fds,
+                recycled=recycle,
+            )
+        )
+        if recycle:
+            session.close()  # restarted (and counted) on the next request
+
+    def close(self) -> None:
+        for session in self._sessions.values():
+            session.close()
+
+    def trends(self) -> List[GrowthTrend]:
+        return growth_trends(
+            self.samples, {target: config.leak_kib_per_call for target, config in self._configs.items()}
+        )
+
+    def summary(self) -> Dict[str, Any]:
+        """JSON-ready per-target footprint plus the per-case trends."""
+
+        targets: Dict[str, Any] = {}
+        for target in sorted({sample.target for sample in self.samples}):
+            mine = [sample for sample in self.samples if sample.target == target]
+            targets[target] = {
+                "requests": len(mine),
+                "restarts": self.restarts.get(target, 0),
+                "peak_rss_kib": max(sample.rss_kib for sample in mine),
+                "final_rss_kib": mine[-1].rss_kib,
+                "peak_fds": max(sample.fds for sample in mine),
+            }
+        return {"targets": targets, "trends": [asdict(trend) for trend in self.trends()]}
+
+
+def session_tokens(tokens: Mapping[str, str]) -> Dict[str, str]:
+    """Tokens that may appear in a session command (the rest change per request)."""
+
+    return {key: tokens[key] for key in SESSION_TOKENS if key in tokens}
+
+
+def growth_trends(
+    samples: Sequence[MemorySample], leak_kib_per_call: Mapping[str, float] | None = None
+) -> List[GrowthTrend]:
+    """Attribute each request's RSS/fd change to its operator, case and target and fit growth per call."""
+
+    thresholds = leak_kib_per_call or {}
+    deltas: Dict[Tuple[str, str, str], List[Tuple[int, int]]] = {}
+    previous: Dict[int, MemorySample] = {}
+    seen: set[Tuple[int, str, str]] = set()
+    for sample in samples:
+        before = previous.get(sample.pid)
+        previous[sample.pid] = sample
+        first_call = (sample.pid, sample.operator, sample.case) not in seen
+        seen.add((sample.pid, sample.operator, sample.case))
+        # The first call of a case in a process pays for lazy initialization, not for a leak.
+        if before is None or first_call:
+            continue
+        key = (sample.operator, sample.case, sample.target)
+        deltas.setdefault(key, []).append((sample.rss_kib - before.rss_kib, sample.fds - before.fds))
+    trends = []
+    for (operator, case, target), values in sorted(deltas.items()):
+        rss_slope = _slope([rss for rss, _ in values])
+        fds_slope = _slope([fds for _, fds in values])
+        leak = len(values) >= MIN_TREND_CALLS and (
+            rss_slope > thresholds.get(target, 16.0) or fds_slope >= FD_LEAK_PER_CALL
+        )
+        trends.append(GrowthTrend(operator, case, target, len(values), rss_slope, fds_slope, leak))
+    return trends
+
+
+def _slope(deltas: Sequence[int]) -> float:
+    # Least-squares slope of the cumulative growth over the call index.
+    count = len(deltas)
+    if count < 2:
+        return float(deltas[0]) if deltas else 0.0
+    total, cumulative = 0, []
+    for delta in deltas:
+        total += delta
+        cumulative.append(total)
+    mean_x = (count - 1) / 2
+    mean_y = sum(cumulative) / count
+    numerator = sum((index - mean_x) * (value - mean_y) for index, value in enumerate(cumulative))
+    denominator = sum((index - mean_x) ** 2 for index in range(count))
+    return numerator / denominator
+
+
+def print_sessions(summary: Mapping[str, Any], *, use_color: bool = True) -> None:
+    reset = Style.RESET_ALL if use_color else ""
+    for target, info in summary["targets"].items():
+        print(
+            f"{'SESSION':<11} {target}  requests={info['requests']} restarts={info['restarts']} "
+            f"peak_rss={info['peak_rss_kib'] / 1024:.1f}MiB final_rss={info['final_rss_kib'] / 1024:.1f}MiB "
+            f"peak_fds={info['peak_fds']}"
+        )
+    for trend in summary["trends"]:
+        if not trend["leak"]:
+            continue
+        color = Fore.YELLOW if use_color else ""
+        print(
+            f"{color}{'LEAK':<11}{reset} {trend['operator']}/{trend['case']}@{trend['target']}  "
+            f"rss={trend['rss_kib_per_call']:+.1f}KiB/call fds={trend['fds_per_call']:+.2f}/call "
+            f"over {trend['calls']} calls"
+        )
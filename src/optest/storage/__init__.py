@@ -0,0 +1,24 @@
+"""Tensor file formats and artifact storage."""
+from .tensorfile import (
+    TensorHeader,
+    allocate_tensor,
+    finalize_tensor,
+    is_tensor_file,
+    load_array,
+    open_tensor,
+    read_header,
+    tensor_digest,
+    write_tensor,
+)
+
+__all__ = [
+    "TensorHeader",
+    "allocate_tensor",
+    "finalize_tensor",
+    "is_tensor_file",
+    "load_array",
+    "open_tensor",
+    "read_header",
+    "tensor_digest",
+    "write_tensor",
+]
@@ -0,0 +1,205 @@
+"""Content-keyed artifact cache for generated inputs and computed goldens.
+
+Two tiers live side by side under ``<root>/<kind>/<key[:2]>/``:
+
+- hot: uncompressed ``.optt`` containers, mapped zero-copy on lookup;
+- cold: chunked ``.optz`` files (see :mod:`optest.storage.compression`) for
+  artifacts at or above ``CompressionPolicy.min_bytes`` that actually compress.
+
+Multi-output artifacts are stored as a group: one entry per tensor plus a
+small manifest written last, so a group is only visible once complete.
+
+With a :class:`~optest.storage.shared.SharedStore` attached, the local cache
+acts as a read-through cache in front of it: misses are fetched from the
+shared store, and new entries are published to it after being written locally.
+"""
+from __future__ import annotations
+
+import contextlib
+import hashlib
+import json
+import shutil
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, ContextManager, Iterator, Sequence, Union
+
+import numpy as np
+
+from .compression import CompressedTensor, compression_ratio, write_compressed
+from .fsutil import atomic_write
+from .shared import SharedStore, group_payload
+from .tensorfile import open_tensor, read_header, write_tensor
+
+CachedTensor = Union[np.ndarray, CompressedTensor]
+
+
+@dataclass(frozen=True)
+class CompressionPolicy:
+    codec: str = "zlib"
+    level: int = 1
+    min_bytes: int = 1 << 20
+    chunk_bytes: int = 4 << 20
+    max_ratio: float = 0.9  # keep the hot copy when compression saves less than 10%
+
+
+def cache_key(*parts: Any) -> str:
+    """Stable hex key for JSON-serializable parts."""
+
+    text = json.dumps(parts, sort_keys=True, default=str, separators=(",", ":"))
+    return hashlib.blake2b(text.encode("utf-8"), digest_size=20).hexdigest()
+
+
+class ArtifactCache:
+    """Local two-tier cache keyed by ``kind`` + content key."""
+
+    def __init__(
+        self,
+        root: Path,
+        compression: CompressionPolicy | None = None,
+        shared: SharedStore | None = None,
+    ) -> None:
+        self.root = Path(root)
+        self.compression = compression
+        self.shared = shared
+
+    def _base(self, kind: str, key: str) -> Path:
+        return self.root / kind / key[:2] / key
+
+    def _hot(self, kind: str, key: str) -> Path:
+        return self._base(kind, key).with_suffix(".optt")
+
+    def _cold(self, kind: str, key: str) -> Path:
+        return self._base(kind, key).with_suffix(".optz")
+
+    def _local_entry(self, kind: str, key: str) -> Path | None:
+        for path in (self._hot(kind, key), self._cold(kind, key)):
+            if path.exists():
+                return path
+        return None
+
+    def get(self, kind: str, key: str) -> CachedTensor | None:
+        path = self._local_entry(kind, key)
+        if path is None and self.shared is not None:
+            ref = self.shared.read_ref(kind, key)
+            if ref is not None:
+                path = self._fetch(kind, key, ref["digest"], ref["suffix"])
+        if path is None:
+            return None
+        return CompressedTensor(path) if path.suffix == ".optz" else open_tensor(path)
+
+    def _fetch(self, kind: str, key: str, digest: str, suffix: str) -> Path | None:
+        assert self.shared is not None
+        local = self._base(kind, key).with_suffix(suffix)
+        return local if self.shared.fetch(digest, suffix, local) else None
+
+    def _publish(self, kind: str, key: str) -> tuple[str, str]:
+        assert self.shared is not None
+        path = self._local_entry(kind, key)
+        assert path is not None
+        return self.shared.publish_object(path), path.suffix
+
+    def claim(self, kind: str, key: str) -> ContextManager[bool]:
+        """Lease for computing ``key`` once across machines (always granted without a shared store)."""
+
+        if self.shared is None:
+            return contextlib.nullcontext(True)
+        return self.shared.claim(kind, key)
+
+    def put(self, kind: str, key: str, array: np.ndarray) -> None:
+        data = np.ascontiguousarray(array)
+        policy = self.compression
+        if policy and data.nbytes >= policy.min_bytes:
+            cold = self._cold(kind, key)
+            ratios: list[float] = []
+
+            def _compress(tmp: Path) -> None:
+                header = write_compressed(
+                    tmp, data, codec=policy.codec, level=policy.level, chunk_bytes=policy.chunk_bytes
+                )
+                ratios.append(compression_ratio(header))
+
+            atomic_write(cold, _compress)
+            if ratios and ratios[0] <= policy.max_ratio:
+                self._hot(kind, key).unlink(missing_ok=True)
+            else:
+                cold.unlink(missing_ok=True)
+                atomic_write(self._hot(kind, key), lambda tmp: write_tensor(tmp, data))
+        else:
+            atomic_write(self._hot(kind, key), lambda tmp: write_tensor(tmp, data))
+        if self.shared is not None:
+            digest, suffix = self._publish(kind, key)
+            self.shared.publish_ref(kind, key, {"digest": digest, "suffix": suffix})
+
+    def get_group(self, kind: str, key: str) -> tuple[CachedTensor, ...] | None:
+        manifest = self._base(kind, key).with_suffix(".json")
+        if not manifest.exists() and not self._fetch_group(kind, key, manifest):
+            return None
+        count = int(json.loads(manifest.read_text(encoding="utf-8"))["count"])
+        items = [self.get(kind, f"{key}-{index}") for index in range(count)]
+        if any(item is None for item in items):
+            return None
+        return tuple(items)  # type: ignore[arg-type]
+
+    def _fetch_group(self, kind: str, key: str, manifest: Path) -> bool:
+        if self.shared is None:
+            return False
+        ref = self.shared.read_ref(kind, key)
+        if ref is None:
+            return False
+        objects = ref["objects"]
+        for index, entry in enumerate(objects):
+            if self._fetch(kind, f"{key}-{index}", entry["digest"], entry["suffix"]) is None:
+                return False
+        payload = json.dumps({"count": len(objects)})
+        atomic_write(manifest, lambda tmp: tmp.write_text(payload, encoding="utf-8"))
+        return True
+
+    def put_group(self, kind: str, key: str, arrays: Sequence[np.ndarray]) -> None:
+        shared, self.shared = self.shared, None  # publish the group ref once, after all members
+        try:
+            for index, array in enumerate(arrays):
+                self.put(kind, f"{key}-{index}", np.asarray(array))
+        finally:
+            self.shared = shared
+        manifest = self._base(kind, key).with_suffix(".json")
+        payload = json.dumps({"count": len(arrays)})
+        atomic_write(manifest, lambda tmp: tmp.write_text(payload, encoding="utf-8"))
+        if self.shared is not None:
+            entries = [self._publish(kind, f"{key}-{index}") for index in range(len(arrays))]
+            self.shared.publish_ref(kind, key, group_payload(entries))
+
+    def materialize(self, kind: str, key: str, destination: Path, file_format: str) -> bool:
+        """Copy a cached tensor to ``destination`` in the requested file format."""
+
+        item = self.get(kind, key)
+        if item is None:
+            return False
+        destination.parent.mkdir(parents=True, exist_ok=True)
+        if isinstance(item, CompressedTensor):
+            if file_format == "optt":
+                write_tensor(destination, item.load())
+            else:
+                with open(destination, "wb") as handle:
+                    for _, chunk in item.iter_chunks():
+                        chunk.tofile(handle)
+            return True
+        hot = self._hot(kind, key)
+        if file_format == "optt":
+            shutil.copyfile(hot, destination)
+        else:
+            header = read_header(hot)
+            with open(hot, "rb") as src, open(destination, "wb") as dst:
+                src.seek(header.data_offset)
+                shutil.copyfileobj(src, dst, length=16 << 20)
+        return True
+
+
+def iter_flat_chunks(item: CachedTensor, chunk_elements: int = 1 << 20) -> Iterator[tuple[int, np.ndarray]]:
+    """Iterate a cached tensor as flat ``(offset, chunk)`` pieces regardless of tier."""
+
+    if isinstance(item, CompressedTensor):
+        yield from item.iter_chunks()
+        return
+    flat = np.asarray(item).reshape(-1)
+    for start in range(0, flat.size, chunk_elements):
+        yield start, flat[start : start + chunk_elements]
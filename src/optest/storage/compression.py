@@ -0,0 +1,217 @@
+"""Chunked compressed tensor files (``.optz``) for the cold cache tier.
+
+Each chunk is compressed independently so chunks can be decompressed in
+parallel (zlib and lzma release the GIL) or streamed one at a time straight
+into a comparison. Layout (little-endian)::
+
+    offset  size  field
+    0       8     magic b"OPTZCHNK"
+    8       2     version (1)
+    10      2     codec (1 = zlib, 2 = lzma)
+    12      2     dtype code (shared with ``tensorfile.DTYPE_CODES``)
+    14      2     ndim
+    16      8     uncompressed chunk size in bytes
+    24      8     total uncompressed size in bytes
+    32      32    blake2b-256 of the uncompressed data
+    64      8*n   shape (int64)
+    ...     16*c  chunk table: (file offset, compressed size) per chunk
+    ...           compressed chunks
+"""
+from __future__ import annotations
+
+import lzma
+import os
+import struct
+import zlib
+from collections import deque
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Iterator
+
+import numpy as np
+
+from .tensorfile import _CODE_DTYPES, DTYPE_CODES, _dtype_name, _hash_buffer
+
+MAGIC = b"OPTZCHNK"
+VERSION = 1
+CODECS = {"zlib": 1, "lzma": 2}
+_CODEC_NAMES = {code: name for name, code in CODECS.items()}
+_FIXED = struct.Struct("<8sHHHHQQ32s")
+
+
+@dataclass(frozen=True)
+class CompressedHeader:
+    codec: str
+    dtype: str
+    shape: tuple[int, ...]
+    chunk_bytes: int
+    nbytes: int
+    digest: bytes
+    chunks: tuple[tuple[int, int], ...]
+
+
+def _compress(codec: str, level: int, block: bytes | memoryview) -> bytes:
+    if codec == "zlib":
+        return zlib.compress(block, level)
+    return lzma.compress(block, preset=level)
+
+
+def _decompress(codec: str, block: bytes) -> bytes:
+    if codec == "zlib":
+        return zlib.decompress(block)
+    return lzma.decompress(block)
+
+
+def _workers(threads: int | None) -> int:
+    return max(1, threads or os.cpu_count() or 1)
+
+
+def write_compressed(
+    path: str | Path,
+    array: np.ndarray,
+    *,
+    codec: str = "zlib",
+    level: int = 1,
+    chunk_bytes: int = 4 << 20,
+    threads: int | None = None,
+) -> CompressedHeader:
+    """Compress ``array`` chunk by chunk (in parallel) into ``path``."""
+
+    if codec not in CODECS:
+        raise ValueError(f"Unsupported codec '{codec}'. Supported: {sorted(CODECS)}")
+    data = np.ascontiguousarray(array)
+    dtype = _dtype_name(data.dtype)
+    itemsize = data.dtype.itemsize
+    chunk_bytes = max(itemsize, chunk_bytes // itemsize * itemsize)
+    view = memoryview(data.reshape(-1).view(np.uint8)) if data.size else memoryview(b"")
+    spans = [view[start : start + chunk_bytes] for start in range(0, len(view), chunk_bytes)]
+    with ThreadPoolExecutor(max_workers=_workers(threads)) as pool:
+        blocks = list(pool.map(lambda block: _compress(codec, level, block), spans))
+    fixed_size = _FIXED.size + 8 * data.ndim
+    cursor = fixed_size + 16 * len(blocks)
+    table: list[tuple[int, int]] = []
+    for block in blocks:
+        table.append((cursor, len(block)))
+        cursor += len(block)
+    header = CompressedHeader(
+        codec=codec,
+        dtype=dtype,
+        shape=tuple(int(dim) for dim in data.shape),
+        chunk_bytes=chunk_bytes,
+        nbytes=int(data.nbytes),
+        digest=_hash_buffer(data),
+        chunks=tuple(table),
+    )
+    path = Path(path)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path, "wb") as handle:
+        handle.write(
+            _FIXED.pack(
+                MAGIC, VERSION, CODECS[codec], DTYPE_CODES[dtype], data.ndim, chunk_bytes, header.nbytes, header.digest
+            )
+        )
+        handle.write(struct.pack(f"<{data.ndim}q", *header.shape))
+        for offset, size in table:
+            handle.write(struct.pack("<QQ", offset, size))
+        for block in blocks:
+            handle.write(block)
+    return header
+
+
+def is_compressed_file(path: str | Path) -> bool:
+    try:
+        with open(path, "rb") as handle:
+            return handle.read(len(MAGIC)) == MAGIC
+    except OSError:
+        return False
+
+
+def read_compressed_header(path: str | Path) -> CompressedHeader:
+    path = Path(path)
+    with open(path, "rb") as handle:
+        fixed = handle.read(_FIXED.size)
+        if len(fixed) < _FIXED.size or fixed[: len(MAGIC)] != MAGIC:
+            raise ValueError(f"{path} is not an optest compressed tensor file")
+        _, version, codec, code, ndim, chunk_bytes, nbytes, digest = _FIXED.unpack(fixed)
+        if version != VERSION or codec not in _CODEC_NAMES or code not in _CODE_DTYPES:
+            raise ValueError(f"{path}: unsupported compressed tensor header")
+        shape = struct.unpack(f"<{ndim}q", handle.read(8 * ndim))
+        count = (nbytes + chunk_bytes - 1) // chunk_bytes if chunk_bytes else 0
+        raw_table = handle.read(16 * count)
+    if len(raw_table) < 16 * count:
+        raise ValueError(f"{path}: truncated chunk table")
+    values = struct.unpack(f"<{2 * count}Q", raw_table)
+    return CompressedHeader(
+        codec=_CODEC_NAMES[codec],
+        dtype=_CODE_DTYPES[code],
+        shape=tuple(shape),
+        chunk_bytes=chunk_bytes,
+        nbytes=nbytes,
+        digest=digest,
+        chunks=tuple(zip(values[0::2], values[1::2])),
+    )
+
+
+class CompressedTensor:
+    """Lazy handle over an ``.optz`` file: stream chunks or decompress in full."""
+
+    def __init__(self, path: str | Path, threads: int | None = None) -> None:
+        self.path = Path(path)
+        self.header = read_compressed_header(self.path)
+        self.threads = threads
+
+    @property
+    def shape(self) -> tuple[int, ...]:
+        return self.header.shape
+
+    @property
+    def dtype(self) -> np.dtype:
+        return np.dtype(self.header.dtype)
+
+    @property
+    def hexdigest(self) -> str:
+        return self.header.digest.hex()
+
+    def _read_block(self, span: tuple[int, int]) -> bytes:
+        offset, size = span
+        with open(self.path, "rb") as handle:
+            handle.seek(offset)
+            return _decompress(self.header.codec, handle.read(size))
+
+    def iter_chunks(self) -> Iterator[tuple[int, np.ndarray]]:
+        """Yield ``(flat_element_offset, chunk)`` in order, decompressing a bounded window ahead in parallel."""
+
+        elements_per_chunk = self.header.chunk_bytes // self.dtype.itemsize
+        workers = _workers(self.threads)
+        spans = list(self.header.chunks)
+        with ThreadPoolExecutor(max_workers=workers) as pool:
+            pending = deque(pool.submit(self._read_block, span) for span in spans[: 2 * workers])
+            next_span = len(pending)
+            index = 0
+            while pending:
+                block = pending.popleft().result()
+                if next_span < len(spans):
+                    pending.append(pool.submit(self._read_block, spans[next_span]))
+                    next_span += 1
+                yield index * elements_per_chunk, np.frombuffer(block, dtype=self.dtype)
+                index += 1
+
+    def read_into(self, out: np.ndarray) -> np.ndarray:
+        """Decompress every chunk (in parallel) directly into ``out``."""
+
+        flat = out.reshape(-1)
+        if flat.dtype != self.dtype or flat.size * self.dtype.itemsize != self.header.nbytes:
+            raise ValueError(f"{self.path}: destination does not match {self.header.dtype}{list(self.shape)}")
+        for offset, chunk in self.iter_chunks():
+            flat[offset : offset + chunk.size] = chunk
+        return out
+
+    def load(self) -> np.ndarray:
+        return self.read_into(np.empty(self.shape, dtype=self.dtype))
+
+
+def compression_ratio(header: CompressedHeader) -> float:
+    if not header.nbytes:
+        return 1.0
+    return sum(size for _, size in header.chunks) / header.nbytes
@@ -0,0 +1,158 @@
+"""Content-addressed artifact store on a shared directory (e.g. an NFS mount).
+
+Layout under the shared root::
+
+    objects/<digest[:2]>/<digest>.optt|.optz   immutable tensor files named by content hash
+    refs/<kind>/<key[:2]>/<key>.json           cache key -> object (or object group) mapping
+    claims/<kind>/<key>.lock                   lease held while one machine computes an entry
+
+Every file is written to a temporary name in its final directory and renamed
+into place, so concurrent readers never take locks and never see partial data.
+Claims use ``O_CREAT | O_EXCL`` so a fleet computes each expensive entry once.
+The holder refreshes the claim's mtime as a heartbeat; a claim whose heartbeat
+is older than the timeout is considered abandoned and is broken by renaming it
+aside (only one waiter's rename can succeed) and re-checking that it was still
+stale, so a live claim is never taken over.
+"""
+from __future__ import annotations
+
+import contextlib
+import json
+import os
+import shutil
+import hashlib
+import socket
+import threading
+import time
+import uuid
+from pathlib import Path
+from typing import Any, Iterator, Mapping, Sequence
+
+from .fsutil import atomic_write
+
+
+class SharedStore:
+    def __init__(self, root: Path, claim_timeout: float = 900.0, poll_interval: float = 0.5) -> None:
+        self.root = Path(root)
+        self.claim_timeout = claim_timeout
+        self.poll_interval = poll_interval
+
+    def _object(self, digest: str, suffix: str) -> Path:
+        return self.root / "objects" / digest[:2] / f"{digest}{suffix}"
+
+    def _ref(self, kind: str, key: str) -> Path:
+        return self.root / "refs" / kind / key[:2] / f"{key}.json"
+
+    def _claim(self, kind: str, key: str) -> Path:
+        return self.root / "claims" / kind / f"{key}.lock"
+
+    def read_ref(self, kind: str, key: str) -> Mapping[str, Any] | None:
+        try:
+            return json.loads(self._ref(kind, key).read_text(encoding="utf-8"))
+        except (FileNotFoundError, ValueError):
+            return None
+
+    def fetch(self, digest: str, suffix: str, destination: Path) -> bool:
+        """Copy an object into ``destination`` (atomically); False when missing."""
+
+        source = self._object(digest, suffix)
+        if not source.exists():
+            return False
+        atomic_write(destination, lambda tmp: shutil.copyfile(source, tmp))
+        return True
+
+    def publish_object(self, source: Path) -> str:
+        """Publish ``source`` under the digest of its whole file (header included); returns the digest."""
+
+        digest = file_digest(source)
+        target = self._object(digest, source.suffix)
+        if not target.exists():  # content-addressed: an existing object is identical
+            atomic_write(target, lambda tmp: shutil.copyfile(source, tmp))
+        return digest
+
+    def publish_ref(self, kind: str, key: str, payload: Mapping[str, Any]) -> None:
+        text = json.dumps(payload, sort_keys=True)
+        atomic_write(self._ref(kind, key), lambda tmp: tmp.write_text(text, encoding="utf-8"))
+
+    @contextlib.contextmanager
+    def claim(self, kind: str, key: str) -> Iterator[bool]:
+        """Hold the compute lease for ``key``; yields False if another holder published meanwhile."""
+
+        path = self._claim(kind, key)
+        path.parent.mkdir(parents=True, exist_ok=True)
+        token = f"{socket.gethostname()}:{os.getpid()}:{uuid.uuid4().hex}"
+        while True:
+            try:
+                fd = os.open(path, os.O_CREAT | os.O_EXCL | os.O_WRONLY, 0o644)
+            except FileExistsError:
+                if self.read_ref(kind, key) is not None:
+                    yield False
+                    return
+                if not self._break_stale_claim(path, token):
+                    time.sleep(self.poll_interval)
+                continue
+            with os.fdopen(fd, "w", encoding="utf-8") as handle:
+                handle.write(token)
+            break
+        stop = threading.Event()
+        heartbeat = threading.Thread(target=self._heartbeat, args=(path, token, stop), daemon=True)
+        heartbeat.start()
+        try:
+            yield True
+        finally:
+            stop.set()
+            heartbeat.join()
+            if _claim_owner(path) == token:
+                path.unlink(missing_ok=True)
+
+    def _heartbeat(self, path: Path, token: str, stop: threading.Event) -> None:
+        while not stop.wait(self.claim_timeout / 4):
+            if _claim_owner(path) == token:
+                with contextlib.suppress(FileNotFoundError):
+                    os.utime(path)
+
+    def _break_stale_claim(self, path: Path, token: str) -> bool:
+        """Remove ``path`` if its heartbeat is stale; True when the caller should retry the claim at once."""
+
+        if not self._claim_is_stale(path):
+            return False
+        aside = path.with_name(f"{path.name}.{token.replace(':', '-')}.stale")
+        try:
+            os.rename(path, aside)  # atomic: of several waiters, one moves the claim and the rest miss it
+        except FileNotFoundError:
+            return True
+        if self._claim_is_stale(aside):
+            aside.unlink(missing_ok=True)
+            return True
+        # The claim was released and re-taken between our check and the rename: hand it back.
+        try:
+            os.link(aside, path)
+        except FileExistsError:
+            pass
+        aside.unlink(missing_ok=True)
+        return False
+
+    def _claim_is_stale(self, path: Path) -> bool:
+        try:
+            return time.time() - path.stat().st_mtime > self.claim_timeout
+        except FileNotFoundError:
+            return False
+
+
+def _claim_owner(path: Path) -> str | None:
+    try:
+        return path.read_text(encoding="utf-8")
+    except FileNotFoundError:
+        return None
+
+
+def file_digest(path: Path, chunk_bytes: int = 1 << 20) -> str:
+    hasher = hashlib.blake2b(digest_size=32)
+    with open(path, "rb") as handle:
+        for chunk in iter(lambda: handle.read(chunk_bytes), b""):
+            hasher.update(chunk)
+    return hasher.hexdigest()
+
+
+def group_payload(entries: Sequence[tuple[str, str]]) -> Mapping[str, Any]:
+    return {"objects": [{"digest": digest, "suffix": suffix} for digest, suffix in entries]}
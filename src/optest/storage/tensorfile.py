@@ -0,0 +1,366 @@
+"""Self-describing tensor container (``.optt``) with a fixed, mmap-friendly header.
+
+Layout (little-endian)::
+
+    offset  size  field
+    0       8     magic b"OPTTENSR"
+    8       2     version (1)
+    10      2     dtype code (see ``DTYPE_CODES``)
+    12      2     ndim
+    14      2     hash algorithm (0 = none, 1 = blake2b-256 over the data region)
+    16      8     data offset (multiple of 64)
+    24      8     data region size in bytes
+    32      32    content hash (zero-filled when absent)
+    64      8*n   shape (int64)
+    64+8n   8*n   strides in bytes (int64)
+    ...           zero padding up to the data offset
+
+Headerless little-endian binaries remain the default file convention; readers
+detect the container by its magic so both forms can be mixed freely.
+"""
+from __future__ import annotations
+
+import hashlib
+import struct
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Sequence
+
+import numpy as np
+
+MAGIC = b"OPTTENSR"
+VERSION = 1
+ALIGNMENT = 64
+HASH_NONE = 0
+HASH_BLAKE2B = 1
+HASH_CHUNK_BYTES = 16 << 20
+
+_FIXED = struct.Struct("<8sHHHHQQ32s")
+
+DTYPE_CODES = {
+    "bool": 1,
+    "int8": 2,
+    "uint8": 3,
+    "int16": 4,
+    "uint16": 5,
+    "int32": 6,
+    "uint32": 7,
+    "int64": 8,
+    "uint64": 9,
+    "float16": 10,
+    "float32": 11,
+    "float64": 12,
+}
+_CODE_DTYPES = {code: name for name, code in DTYPE_CODES.items()}
+
+
+@dataclass(frozen=True)
+class TensorHeader:
+    dtype: str
+    shape: tuple[int, ...]
+    strides: tuple[int, ...]
+    data_offset: int
+    nbytes: int
+    hash_algo: int = HASH_NONE
+    digest: bytes = b""
+
+    @property
+    def hexdigest(self) -> str | None:
+        return self.digest.hex() if self.hash_algo != HASH_NONE else None
+
+    def pack(self) -> bytes:
+        fixed = _FIXED.pack(
+            MAGIC,
+            VERSION,
+            DTYPE_CODES[self.dtype],
+            len(self.shape),
+            self.hash_algo,
+            self.data_offset,
+            self.nbytes,
+            self.digest.ljust(32, b"\0"),
+        )
+        dims = struct.pack(f"<{2 * len(self.shape)}q", *self.shape, *self.strides)
+        return (fixed + dims).ljust(self.data_offset, b"\0")
+
+
+def data_offset_for(ndim: int) -> int:
+    """Return the 64-byte aligned data offset for a tensor of rank ``ndim``."""
+
+    raw = _FIXED.size + 16 * ndim
+    return (raw + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def is_tensor_file(path: str | Path) -> bool:
+    try:
+        with open(path, "rb") as handle:
+            return handle.read(len(MAGIC)) == MAGIC
+    except OSError:
+        return False
+
+
+def read_header(path: str | Path) -> TensorHeader:
+    """Parse and validate the header of a container file."""
+
+    path = Path(path)
+    with open(path, "rb") as handle:
+        fixed = handle.read(_FIXED.size)
+        if len(fixed) < _FIXED.size or fixed[: len(MAGIC)] != MAGIC:
+            raise ValueError(f"{path} is not an optest tensor file")
+        _, version, code, ndim, hash_algo, offset, nbytes, digest = _FIXED.unpack(fixed)
+        if version != VERSION:
+            raise ValueError(f"{path}: unsupported tensor file version {version}")
+        if code not in _CODE_DTYPES:
+            raise ValueError(f"{path}: unknown dtype code {code}")
+        dims_raw = handle.read(16 * ndim)
+    if len(dims_raw) < 16 * ndim:
+        raise ValueError(f"{path}: truncated tensor header")
+    dims = struct.unpack(f"<{2 * ndim}q", dims_raw)
+    header = TensorHeader(
+        dtype=_CODE_DTYPES[code],
+        shape=tuple(dims[:ndim]),
+        strides=tuple(dims[ndim:]),
+        data_offset=offset,
+        nbytes=nbytes,
+        hash_algo=hash_algo,
+        digest=digest if hash_algo != HASH_NONE else b"",
+    )
+    _validate_header(path, header)
+    return header
+
+
+def _validate_header(path: Path, header: TensorHeader) -> None:
+    if header.data_offset % ALIGNMENT or header.data_offset < data_offset_for(len(header.shape)):
+        raise ValueError(f"{path}: invalid data offset {header.data_offset}")
+    if any(dim < 0 for dim in header.shape):
+        raise ValueError(f"{path}: negative dimension in shape {header.shape}")
+    itemsize = np.dtype(header.dtype).itemsize
+    if 0 not in header.shape:
+        extent = sum((dim - 1) * abs(stride) for dim, stride in zip(header.shape, header.strides)) + itemsize
+        if extent > header.nbytes or any(stride < 0 for stride in header.strides):
+            raise ValueError(f"{path}: strides {header.strides} exceed the data region of {header.nbytes} bytes")
+    size = path.stat().st_size
+    if header.data_offset + header.nbytes > size:
+        raise ValueError(
+            f"{path}: truncated data region (expected {header.data_offset + header.nbytes} bytes, found {size})"
+        )
+
+
+def contiguous_strides(shape: Sequence[int], itemsize: int) -> tuple[int, ...]:
+    strides: list[int] = []
+    step = itemsize
+    for dim in reversed(shape):
+        strides.append(step)
+        step *= max(int(dim), 1)
+    return tuple(reversed(strides))
+
+
+def write_tensor(path: str | Path, array: np.ndarray, *, with_hash: bool = True) -> TensorHeader:
+    """Write ``array`` as a container file (C order) and return its header."""
+
+    path = Path(path)
+    data = np.ascontiguousarray(array)
+    dtype = _dtype_name(data.dtype)
+    digest = _hash_buffer(data) if with_hash else b""
+    header = TensorHeader(
+        dtype=dtype,
+        shape=tuple(int(dim) for dim in data.shape),
+        strides=contiguous_strides(data.shape, data.dtype.itemsize),
+        data_offset=data_offset_for(data.ndim),
+        nbytes=int(data.nbytes),
+        hash_algo=HASH_BLAKE2B if with_hash else HASH_NONE,
+        digest=digest,
+    )
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path, "wb") as handle:
+        handle.write(header.pack())
+        data.astype(data.dtype.newbyteorder("<"), copy=False).tofile(handle)
+    return header
+
+
+def strided_extent(shape: Sequence[int], strides: Sequence[int]) -> int:
+    """Number of elements spanned by a tensor with element ``strides`` (0 when empty)."""
+
+    if any(int(dim) == 0 for dim in shape):
+        return 0
+    return sum((int(dim) - 1) * int(stride) for dim, stride in zip(shape, strides)) + 1
+
+
+def _strided_view(region: np.memmap, offset: int, shape: Sequence[int], strides: Sequence[int]) -> np.ndarray:
+    # Built directly on the mapping so ``view.base`` stays the memmap (flushable, read-only when mapped "r").
+    itemsize = region.dtype.itemsize
+    return np.ndarray(
+        tuple(shape),
+        dtype=region.dtype,
+        buffer=region,
+        offset=offset * itemsize,
+        strides=tuple(int(stride) * itemsize for stride in strides),
+    )
+
+
+def allocate_tensor(
+    path: str | Path,
+    shape: Sequence[int],
+    dtype: str,
+    *,
+    container: bool,
+    strides: Sequence[int] | None = None,
+    offset: int = 0,
+) -> np.ndarray:
+    """Create a tensor file of the final size and map its data region writable.
+
+    Producers fill the returned array in place, so a tensor never exists twice in
+    memory; containers start unhashed and are sealed with :func:`finalize_tensor`.
+    Raw files may place the tensor with element ``strides`` and ``offset`` (e.g. a
+    row pitch); padding stays zero and the returned array is a strided view.
+    """
+
+    path = Path(path)
+    np_dtype = np.dtype(dtype).newbyteorder("<")
+    shape = tuple(int(dim) for dim in shape)
+    if strides is not None or offset:
+        if container:
+            raise ValueError(f"{path}: strided layouts are only supported for raw files")
+        strides = tuple(strides) if strides is not None else contiguous_strides(shape, 1)
+        span = offset + strided_extent(shape, strides)
+        path.parent.mkdir(parents=True, exist_ok=True)
+        with open(path, "wb") as handle:
+            handle.truncate(span * np_dtype.itemsize)
+        if not strided_extent(shape, strides):
+            return np.empty(shape, dtype=np_dtype)
+        region = np.memmap(path, dtype=np_dtype, mode="r+", shape=(span,))
+        return _strided_view(region, offset, shape, strides)
+    nbytes = int(np.prod(shape, dtype=np.int64)) * np_dtype.itemsize
+    offset = 0
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with open(path, "wb") as handle:
+        if container:
+            header = TensorHeader(
+                dtype=_dtype_name(np_dtype),
+                shape=shape,
+                strides=contiguous_strides(shape, np_dtype.itemsize),
+                data_offset=data_offset_for(len(shape)),
+                nbytes=nbytes,
+                hash_algo=HASH_NONE,
+                digest=b"",
+            )
+            handle.write(header.pack())
+            offset = header.data_offset
+        handle.truncate(offset + nbytes)
+    if nbytes == 0:
+        return np.empty(shape, dtype=np_dtype)
+    return np.memmap(path, dtype=np_dtype, mode="r+", offset=offset, shape=shape)
+
+
+def finalize_tensor(path: str | Path) -> TensorHeader:
+    """Hash a container's data region in place and record the digest in its header."""
+
+    path = Path(path)
+    header = read_header(path)
+    digest = _hash_buffer(open_tensor(path, header))
+    sealed = TensorHeader(
+        dtype=header.dtype,
+        shape=header.shape,
+        strides=header.strides,
+        data_offset=header.data_offset,
+        nbytes=header.nbytes,
+        hash_algo=HASH_BLAKE2B,
+        digest=digest,
+    )
+    with open(path, "r+b") as handle:
+        handle.write(sealed.pack())
+    return sealed
+
+
+def open_tensor(path: str | Path, header: TensorHeader | None = None) -> np.ndarray:
+    """Map a container file read-only and return a zero-copy view of its tensor."""
+
+    header = header or read_header(path)
+    dtype = np.dtype(header.dtype).newbyteorder("<")
+    if header.nbytes == 0:
+        return np.empty(header.shape, dtype=dtype)
+    region = np.memmap(path, dtype=np.uint8, mode="r", offset=header.data_offset, shape=(header.nbytes,))
+    if header.strides == contiguous_strides(header.shape, dtype.itemsize):
+        return region.view(dtype).reshape(header.shape)
+    return np.lib.stride_tricks.as_strided(
+        region.view(dtype), shape=header.shape, strides=header.strides, writeable=False
+    )
+
+
+def load_array(
+    path: str | Path,
+    shape: Sequence[int],
+    dtype: str,
+    *,
+    strides: Sequence[int] | None = None,
+    offset: int = 0,
+) -> np.ndarray:
+    """Map a raw or container tensor file, validating dtype and shape up front.
+
+    For raw files, element ``strides``/``offset`` describe a tensor placed inside a
+    larger buffer (row pitch, sub-region); the result is a zero-copy strided view.
+    Containers always describe their own strides.
+    """
+
+    path = Path(path)
+    expected_shape = tuple(int(dim) for dim in shape)
+    if is_tensor_file(path):
+        header = read_header(path)
+        if header.dtype != np.dtype(dtype).name:
+            raise ValueError(f"{path}: dtype {header.dtype} does not match expected {np.dtype(dtype).name}")
+        if header.shape != expected_shape:
+            raise ValueError(f"{path}: shape {list(header.shape)} does not match expected {list(expected_shape)}")
+        return open_tensor(path, header)
+    np_dtype = np.dtype(dtype)
+    size = path.stat().st_size
+    if strides is not None or offset:
+        strides = tuple(strides) if strides is not None else contiguous_strides(expected_shape, 1)
+        span = offset + strided_extent(expected_shape, strides)
+        if size < span * np_dtype.itemsize:
+            raise ValueError(
+                f"{path}: file holds {size} bytes but shape {list(expected_shape)} with strides {list(strides)} "
+                f"and offset {offset} of {np_dtype.name} needs {span * np_dtype.itemsize}"
+            )
+        if not strided_extent(expected_shape, strides):
+            return np.empty(expected_shape, dtype=np_dtype)
+        region = np.memmap(path, dtype=np_dtype, mode="r", shape=(span,))
+        return _strided_view(region, offset, expected_shape, strides)
+    expected_bytes = int(np.prod(expected_shape, dtype=np.int64)) * np_dtype.itemsize
+    if size != expected_bytes:
+        raise ValueError(
+            f"{path}: file holds {size} bytes but shape {list(expected_shape)} of {np_dtype.name} "
+            f"needs {expected_bytes}"
+        )
+    if expected_bytes == 0:
+        return np.empty(expected_shape, dtype=np_dtype)
+    return np.memmap(path, dtype=np_dtype, mode="r", shape=expected_shape)
+
+
+def tensor_digest(path: str | Path) -> str:
+    """Return the content hash of a tensor file, trusting an embedded hash when present."""
+
+    path = Path(path)
+    if is_tensor_file(path):
+        header = read_header(path)
+        if header.hash_algo == HASH_BLAKE2B:
+            return header.digest.hex()
+        return _hash_buffer(np.ascontiguousarray(open_tensor(path, header))).hex()
+    hasher = hashlib.blake2b(digest_size=32)
+    with open(path, "rb") as handle:
+        for block in iter(lambda: handle.read(HASH_CHUNK_BYTES), b""):
+            hasher.update(block)
+    return hasher.hexdigest()
+
+
+def _hash_buffer(data: np.ndarray) -> bytes:
+    hasher = hashlib.blake2b(digest_size=32)
+    view = memoryview(data.reshape(-1).view(np.uint8)) if data.size else memoryview(b"")
+    for start in range(0, len(view), HASH_CHUNK_BYTES):
+        hasher.update(view[start : start + HASH_CHUNK_BYTES])
+    return hasher.digest()
+
+
+def _dtype_name(dtype: np.dtype) -> str:
+    name = np.dtype(dtype).name
+    if name not in DTYPE_CODES:
+        raise ValueError(f"dtype {name} is not supported by the tensor container format")
+    return name
@@ -0,0 +1,163 @@
+from __future__ import annotations
+
+import textwrap
+from pathlib import Path
+
+import numpy as np
+import numpy.testing as npt
+import yaml
+
+from optest.plan import PlanOptions, load_plan, run_plan
+from optest.plan import runner as plan_runner
+from optest.storage.cache import ArtifactCache, CompressionPolicy
+from optest.storage.compression import CompressedTensor, write_compressed
+
+
+def test_chunked_compression_roundtrip(tmp_path: Path) -> None:
+    data = np.arange(10_000, dtype=np.int32).reshape(100, 100)
+    path = tmp_path / "x.optz"
+    header = write_compressed(path, data, chunk_bytes=4096, threads=4)
+    assert len(header.chunks) == 10
+    tensor = CompressedTensor(path, threads=3)
+    npt.assert_array_equal(tensor.load(), data)
+    offsets = [offset for offset, _ in tensor.iter_chunks()]
+    assert offsets == list(range(0, 10_000, 1024))
+
+
+def test_cache_tiers_follow_size_and_ratio_policy(tmp_path: Path) -> None:
+    cache = ArtifactCache(tmp_path, CompressionPolicy(min_bytes=1024, chunk_bytes=2048))
+    cache.put("inputs", "aa-ones", np.ones((64, 64), dtype=np.float32))
+    cache.put("inputs", "bb-small", np.ones((4,), dtype=np.float32))
+    noise = np.random.default_rng(0).integers(0, 255, size=8192, dtype=np.uint8)
+    cache.put("inputs", "cc-noise", noise)
+    assert isinstance(cache.get("inputs", "aa-ones"), CompressedTensor)
+    assert isinstance(cache.get("inputs", "bb-small"), np.ndarray)
+    assert isinstance(cache.get("inputs", "cc-noise"), np.ndarray)
+    assert cache.get("inputs", "dd-missing") is None
+    out = tmp_path / "ones.bin"
+    assert cache.materialize("inputs", "aa-ones", out, "raw")
+    npt.assert_array_equal(np.fromfile(out, dtype=np.float32), np.ones(64 * 64, dtype=np.float32))
+
+
+def test_streaming_compare_detects_mismatch(tmp_path: Path) -> None:
+    golden = np.zeros(5000, dtype=np.float32)
+    write_compressed(tmp_path / "g.optz", golden, chunk_bytes=1024)
+    want = CompressedTensor(tmp_path / "g.optz")
+    got = golden.copy()
+    assert plan_runner._compare_outputs((got,), (want,), 0.0, 0.0, "max_abs")[0]
+    got[4321] = 2.5
+    ok, details, metrics = plan_runner._compare_outputs((got,), (want,), 0.0, 0.0, "mean_abs")
+    assert not ok
+    assert metrics["output0_max_abs"] == 2.5
+    assert metrics["output0_mean_abs"] == 2.5 / 5000
+
+
+def test_compare_matches_nans_only_with_equal_nan(tmp_path: Path) -> None:
+    golden = np.array([np.nan, 1.0, -np.inf] * 1000, dtype=np.float32)
+    write_compressed(tmp_path / "g.optz", golden, chunk_bytes=1024)
+    for want in (golden, CompressedTensor(tmp_path / "g.optz")):
+        got = golden.copy()
+        assert not plan_runner._compare_outputs((got,), (want,), 0.0, 0.0, "max_abs")[0]
+        assert plan_runner._compare_outputs((got,), (want,), 0.0, 0.0, "max_abs", equal_nan=True)[0]
+        got[3] = 0.0  # a NaN where the golden has none still fails
+        ok, _, metrics = plan_runner._compare_outputs((got,), (want,), 0.0, 0.0, "max_abs", equal_nan=True)
+        assert not ok and np.isnan(metrics["output0_max_abs"])
+
+
+def test_plan_reuses_cached_inputs_and_goldens(tmp_path: Path) -> None:
+    script = tmp_path / "relu.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import sys
+            import numpy as np
+
+            src, dst = sys.argv[1], sys.argv[2]
+            np.maximum(np.fromfile(src, dtype="float32"), 0).tofile(dst)
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            generator: {{name: builtin.random, seed: 3}}
+            assertion: {{name: builtin.relu}}
+            storage:
+              cache_dir: cache
+              compress: {{min_bytes: 1024, chunk_bytes: 4096}}
+            backends:
+              - type: cuda
+                chip: local
+                command: ["python", "{script.as_posix()}", "{{input0}}", "{{output0}}"]
+            cases:
+              - name: big
+                dtypes: [float32]
+                shapes:
+                  - inputs: [[64, 64]]
+                    outputs: [[64, 64]]
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan = load_plan(str(plan_path))
+    assert run_plan(plan, PlanOptions()) == 0
+    first = np.fromfile(tmp_path / "in0.bin", dtype=np.float32)
+    assert list((tmp_path / "cache" / "goldens").rglob("*.json"))
+    (tmp_path / "in0.bin").unlink()
+    assert run_plan(plan, PlanOptions()) == 0
+    npt.assert_array_equal(np.fromfile(tmp_path / "in0.bin", dtype=np.float32), first)
+
+
+def test_golden_cache_keys_include_input_shapes(tmp_path: Path) -> None:
+    script = tmp_path / "row_sum.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import sys
+            import numpy as np
+
+            shape = [int(dim) for dim in sys.argv[3].split("x")]
+            np.fromfile(sys.argv[1], dtype="float32").reshape(shape).sum(axis=-1).tofile(sys.argv[2])
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: reduce_sum
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            generator: {{name: builtin.ones}}
+            assertion: {{name: builtin.reduce_sum, params: {{axis: -1}}}}
+            storage: {{cache_dir: cache}}
+            backends:
+              - type: cuda
+                chip: local
+                command: ["python", "{script.as_posix()}", "{{input0}}", "{{output0}}", "{{shape}}"]
+            cases:
+              - name: wide
+                dtypes: [float32]
+                shapes: [{{inputs: [[2, 3]], outputs: [[2]]}}]
+              - name: tall
+                dtypes: [float32]
+                shapes: [{{inputs: [[3, 2]], outputs: [[3]]}}]
+            """
+        ),
+        encoding="utf-8",
+    )
+    # Both cases write the same six ones; a golden keyed by bytes alone would replay [3, 3] for the second.
+    assert run_plan(load_plan(str(plan_path)), PlanOptions()) == 0
+    assert len(list((tmp_path / "cache" / "goldens").rglob("*.json"))) == 2
+
+    data = yaml.safe_load(plan_path.read_text(encoding="utf-8"))
+    data["assertion"] = {"expr": "sum(in0, axis=-1)"}
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions()) == 0
+    assert len(list((tmp_path / "cache" / "goldens").rglob("*.json"))) == 4
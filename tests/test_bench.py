@@ -0,0 +1,193 @@
+from __future__ import annotations
+
+import json
+import shutil
+import textwrap
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.plan import BenchSettings, PlanOptions, load_plan, run_pgo
+from optest.plan.bench import load_bench_report, parse_metrics
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+MATMUL_DIR = REPO_ROOT / "examples" / "matmul_cpp"
+
+
+def _relu_plan(tmp_path: Path) -> Path:
+    script = tmp_path / "relu.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import sys
+            import numpy as np
+
+            src, dst = sys.argv[1], sys.argv[2]
+            np.maximum(np.fromfile(src, dtype="float32"), 0).tofile(dst)
+            print("OPTEST_METRIC kernel_ms=0.5 note=fast")
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            generator: {{name: builtin.random, seed: 1}}
+            assertion: {{name: builtin.relu}}
+            backends:
+              - type: cuda
+                chip: local
+                command: ["python", "{script.as_posix()}", "{{input0}}", "{{output0}}"]
+            cases:
+              - name: small
+                dtypes: [float32]
+                shapes:
+                  - inputs: [[8, 8]]
+                    outputs: [[8, 8]]
+            """
+        ),
+        encoding="utf-8",
+    )
+    return plan_path
+
+
+def test_parse_metrics_reads_tagged_lines_only() -> None:
+    text = "warming up\nOPTEST_METRIC kernel_ms=1.5 gflops=20\nOPTEST_METRIC kernel_ms=1.25 label=x\nkernel_ms=9\n"
+    assert parse_metrics(text) == {"kernel_ms": 1.25, "gflops": 20.0}
+
+
+def test_bench_reports_samples_metrics_and_speedups(tmp_path: Path) -> None:
+    plan_path = _relu_plan(tmp_path)
+    first = tmp_path / "first.json"
+    args = ["bench", "--plan", str(plan_path), "--warmup", "1", "--repeat", "3", "--report", "json"]
+    result = CliRunner().invoke(cli, [*args, "--report-path", str(first)])
+    assert result.exit_code == 0, result.output
+    payload = json.loads(first.read_text(encoding="utf-8"))
+    case = payload["cases"][0]
+    assert case["status"] == "ok" and len(case["samples_s"]) == 3
+    assert case["metrics"] == {"kernel_ms": 0.5}
+    assert payload["summary"]["repeat"] == 3
+
+    second = tmp_path / "second.json"
+    result = CliRunner().invoke(
+        cli, [*args, "--report-path", str(second), "--baseline", str(first), "--speedup-metric", "kernel_ms"]
+    )
+    assert result.exit_code == 0, result.output
+    payload = json.loads(second.read_text(encoding="utf-8"))
+    assert payload["cases"][0]["speedup"] == 1.0
+    assert payload["summary"]["geomean_speedup"] == 1.0
+
+
+def test_bench_cache_state_both_reports_cold_next_to_warm(tmp_path: Path) -> None:
+    plan = yaml.safe_load(_relu_plan(tmp_path).read_text(encoding="utf-8"))
+    script = tmp_path / "relu_cache_state.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import os, sys
+            import numpy as np
+
+            np.maximum(np.fromfile(sys.argv[1], dtype="float32"), 0).tofile(sys.argv[2])
+            assert sys.argv[3] == os.environ["OPTEST_CACHE_STATE"]
+            print("OPTEST_METRIC kernel_ms=" + ("3" if sys.argv[3] == "cold" else "1"))
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan["backends"][0]["command"] = ["python", script.as_posix(), "{input0}", "{output0}", "{cache_state}"]
+    plan_path = tmp_path / "plan_cache_state.yaml"
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    report = tmp_path / "report.json"
+    args = ["bench", "--plan", str(plan_path), "--warmup", "1", "--repeat", "2", "--no-history"]
+    args += ["--cache-state", "both"]
+    result = CliRunner().invoke(cli, [*args, "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+    payload = json.loads(report.read_text(encoding="utf-8"))
+    case = payload["cases"][0]
+    assert payload["summary"]["cache_state"] == "both"
+    assert len(case["samples_s"]) == 2 and len(case["cold_samples_s"]) == 2 and case["cold_median_s"] > 0
+    assert case["metrics"] == {"kernel_ms": 1.0, "cold_kernel_ms": 3.0}
+
+    result = CliRunner().invoke(cli, [*args, "--no-color"], env={"OPTEST_CACHE_STATE": "cold"})
+    assert result.exit_code == 0, result.output
+    assert "cold=" in result.output and "x warm)" in result.output
+    args = [*args[:-2], "--report", "json"]
+    result = CliRunner().invoke(cli, args, env={"OPTEST_CACHE_STATE": "cold"})
+    assert result.exit_code == 0, result.output
+    cold_only = json.loads(result.output)
+    assert cold_only["summary"]["cache_state"] == "cold" and cold_only["cases"][0]["metrics"] == {"kernel_ms": 3.0}
+
+
+def test_bench_denormals_reports_slowdown_and_ftz_difference(tmp_path: Path) -> None:
+    plan = yaml.safe_load(_relu_plan(tmp_path).read_text(encoding="utf-8"))
+    script = tmp_path / "relu_denormals.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import os, sys, time
+            import numpy as np
+
+            values = np.fromfile(sys.argv[1], dtype="float32")
+            tiny = (values != 0) & (np.abs(values) < np.finfo(np.float32).tiny)
+            assert sys.argv[3] == os.environ["OPTEST_FTZ"]
+            if sys.argv[3] == "on":
+                values[tiny] = 0  # what DAZ does to the kernel's inputs
+            elif tiny.any():
+                time.sleep(0.2)  # subnormal microcode assists
+            np.maximum(values, 0).tofile(sys.argv[2])
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan["backends"][0]["command"] = ["python", script.as_posix(), "{input0}", "{output0}", "{ftz}"]
+    plan_path = tmp_path / "plan_denormals.yaml"
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    report = tmp_path / "report.json"
+    args = ["bench", "--plan", str(plan_path), "--warmup", "0", "--repeat", "2", "--no-history"]
+    args += ["--denormals", "0.5", "--report", "json", "--report-path", str(report)]
+    result = CliRunner().invoke(cli, args)
+    assert result.exit_code == 0, result.output
+    payload = json.loads(report.read_text(encoding="utf-8"))
+    denormals = payload["cases"][0]["denormals"]
+    assert payload["summary"]["denormals"] == 0.5 and "ftz" not in payload["summary"]
+    assert len(denormals["samples_s"]) == 2 and denormals["slowdown"] > 1.0
+    assert denormals["check"] == "pass" and denormals["ftz_changed"] is None
+    assert load_bench_report(report)[0].denormal.fraction == 0.5
+
+    result = CliRunner().invoke(cli, args, env={"OPTEST_FTZ": "on"})
+    assert result.exit_code == 0, result.output
+    payload = json.loads(report.read_text(encoding="utf-8"))
+    denormals = payload["cases"][0]["denormals"]
+    assert payload["summary"]["ftz"] == "on" and denormals["check"] == "pass"
+    assert denormals["ftz_changed"] > 0 and 0 < denormals["ftz_max_abs"] < np.finfo(np.float32).tiny
+
+
+def test_pgo_rebuilds_runner_with_collected_profile(tmp_path: Path) -> None:
+    if not shutil.which("cmake"):
+        pytest.skip("cmake is required to build the matmul runner")
+    build_dir = tmp_path / "build"
+    data = yaml.safe_load((MATMUL_DIR / "plan.yaml").read_text(encoding="utf-8"))
+    data["inputs"] = [str(tmp_path / "in0.bin"), str(tmp_path / "in1.bin")]
+    data["outputs"] = [str(tmp_path / "out0.bin")]
+    backend = data["backends"][0]
+    backend["workdir"] = str(MATMUL_DIR)
+    backend["build"] = {"source": str(MATMUL_DIR / "operator"), "dir": str(build_dir), "target": "matmul_runner"}
+    backend["command"][0] = str(build_dir / "matmul_runner")
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+
+    plan = load_plan(str(plan_path))
+    options = PlanOptions(cases=("float_small",))
+    exit_code = run_pgo(plan, options, BenchSettings(warmup=0, repeat=1), lto=False, use_color=False)
+    assert exit_code == 0
+    assert any((build_dir / "pgo-profile").iterdir())
+    cache = (build_dir / "CMakeCache.txt").read_text(encoding="utf-8")
+    assert "OPTEST_PGO_MODE:STRING=use" in cache
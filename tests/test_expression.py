@@ -0,0 +1,87 @@
+from __future__ import annotations
+
+import textwrap
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+
+from optest.plan import PlanOptions, expression, load_plan, run_plan
+
+
+def test_chunked_evaluation_matches_numpy(monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setattr(expression, "CHUNK_ELEMENTS", 64)  # 40 rows of 24 -> 2 rows per chunk, 20 chunks
+    rng = np.random.default_rng(0)
+    x = rng.standard_normal((40, 24)).astype(np.float32)
+    w = rng.standard_normal((24, 24)).astype(np.float32)
+    b = rng.standard_normal(24).astype(np.float32)
+    bindings = {**expression.CONSTANTS, "x": x, "w": w, "b": b, "alpha": 0.1}
+    cases = {
+        "x * sigmoid(1.702 * x)": x * (1 / (1 + np.exp(-(1.702 * x)))),
+        "relu(x @ w + b) - 2 * pi": np.maximum(x @ w + b, 0) - 2 * np.pi,
+        "x if x > b else alpha * x": np.where(x > b, x, 0.1 * x),
+        "exp(x - max(x, axis=-1, keepdims=True))": np.exp(x - x.max(axis=-1, keepdims=True)),
+    }
+    for text, expected in cases.items():
+        for threads in (1, 3):
+            got = expression.compile_expression(text).evaluate(bindings, threads=threads)
+            assert got.dtype == np.float32 and got.shape == expected.shape, text
+            assert np.array_equal(got, expected), text
+
+    with pytest.raises(ValueError, match="unknown function foo"):
+        expression.compile_expression("foo(x)")
+    with pytest.raises(ValueError, match="unknown name\\(s\\) y; bound: alpha, b, w, x"):
+        expression.compile_expression("x + y").evaluate(bindings)
+
+
+def test_expression_assertion_binds_inputs_by_name(tmp_path: Path) -> None:
+    script = tmp_path / "gelu_bias.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import sys
+            import numpy as np
+
+            x, b = (np.fromfile(path, dtype="float32") for path in sys.argv[1:3])
+            (x / (1 + np.exp(-1.702 * x)) + float(sys.argv[4]) * b).astype("float32").tofile(sys.argv[3])
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: gelu_bias
+            inputs: ["x.bin", "b.bin"]
+            outputs: ["out0.bin"]
+            generator: {{name: builtin.random, seed: 5}}
+            assertion: {{expr: "x * sigmoid(1.702 * x) + scale * b", params: {{scale: 0.5}}}}
+            backends:
+              - type: cuda
+                chip: local
+                workdir: {tmp_path.as_posix()}
+                command: ["python", "{script.as_posix()}", "{{input0}}", "{{input1}}", "{{output0}}", "0.5"]
+            cases:
+              - name: small
+                dtypes: [float32, float32]
+                shapes: [{{inputs: [[64], [64]], outputs: [[64]]}}]
+                assertion: {{rtol: 1e-4, params: {{scale: 0.5}}}}
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan = load_plan(str(plan_path))
+    assert plan.assertion.name == "expr" and plan.cases[0].assertion.expr == plan.assertion.expr
+    assert run_plan(plan, PlanOptions(), use_color=False) == 0
+
+    data = yaml.safe_load(plan_path.read_text(encoding="utf-8"))
+    data["cases"][0]["assertion"]["params"]["scale"] = 0.25
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 1
+
+    data["assertion"]["expr"] = "x * sigmoid(1.702 * x"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    with pytest.raises(ValueError, match="expression 'x \\* sigmoid\\(1.702 \\* x'"):
+        load_plan(str(plan_path))
@@ -0,0 +1,96 @@
+from __future__ import annotations
+
+import shutil
+import subprocess
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+
+from optest.operators.builtin_operators import EmbeddingBag, ScatterAdd
+from optest.plan import PlanOptions, load_plan, run_plan
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+EXAMPLE_DIR = REPO_ROOT / "examples" / "gather_cpp"
+PLAN_PATH = EXAMPLE_DIR / "plan.yaml"
+RUNNER_PATH = EXAMPLE_DIR / "operator" / "build" / "gather_runner"
+
+
+@pytest.fixture(scope="session")
+def gather_runner() -> Path:
+    """Build the C++ runner once for all gather example tests."""
+
+    if not shutil.which("cmake"):
+        pytest.skip("cmake is required to build the gather example")
+    subprocess.run(["bash", "build.sh"], cwd=EXAMPLE_DIR / "operator", check=True)
+    if not RUNNER_PATH.exists():
+        pytest.skip("gather_runner binary missing after build")
+    return RUNNER_PATH
+
+
+def _relocate(tmp_path: Path, paths: list[str]) -> list[str]:
+    return [str(tmp_path / Path(path).name) for path in paths]
+
+
+def _write_plan(tmp_path: Path, runner: Path) -> Path:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    data["inputs"] = _relocate(tmp_path, data["inputs"])
+    data["outputs"] = _relocate(tmp_path, data["outputs"])
+    for case in data["cases"]:
+        if "inputs" in case:
+            case["inputs"] = _relocate(tmp_path, case["inputs"])
+    backend = data["backends"][0]
+    backend["workdir"] = str(EXAMPLE_DIR)
+    backend["command"][0] = str(runner)
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    return plan_path
+
+
+def test_gather_example_passes_all_ops(gather_runner: Path, tmp_path: Path) -> None:
+    plan = load_plan(str(_write_plan(tmp_path, gather_runner)))
+    assert run_plan(plan, PlanOptions(), use_color=False) == 0
+
+
+def test_runner_embedding_bag_modes_and_index_checks(gather_runner: Path, tmp_path: Path) -> None:
+    rng = np.random.default_rng(0)
+    table = rng.normal(size=(50, 8)).astype(np.float32)
+    idx = np.array([3, 3, 49, 0, 7, 7, 7], dtype=np.int32)
+    offsets = np.array([0, 3, 3, 5], dtype=np.int32)
+    for name, array in (("t", table), ("i", idx), ("o", offsets)):
+        array.tofile(tmp_path / f"{name}.bin")
+    inputs = ",".join(str(tmp_path / f"{name}.bin") for name in "tio")
+    shapes = '{"inputs": [[50, 8], [7], [4]], "outputs": [[4, 8]]}'
+    argv = [str(gather_runner), "--inputs", inputs, "--output0", str(tmp_path / "out.bin")]
+    argv += ["--dtypes", "float32,int32,int32", "--shapes", shapes, "--threads", "3"]
+    for mode in ("sum", "mean", "max"):
+        result = subprocess.run(argv + ["--mode", mode], check=True, capture_output=True, text=True)
+        assert "gather_gbps=" in result.stdout
+        (expected,) = EmbeddingBag.run((table, idx, offsets), {"mode": mode})
+        actual = np.fromfile(tmp_path / "out.bin", dtype=np.float32).reshape(4, 8)
+        np.testing.assert_allclose(actual, expected, rtol=1e-5, atol=1e-6)
+
+    np.array([0, 50], dtype=np.int32).tofile(tmp_path / "i.bin")
+    argv = [str(gather_runner), "--inputs", f"{tmp_path / 't.bin'},{tmp_path / 'i.bin'}", "--output0", str(tmp_path / "g.bin")]
+    argv += ["--dtypes", "float32,int32", "--shapes", '{"inputs": [[50, 8], [2]], "outputs": [[2, 8]]}']
+    bad = subprocess.run(argv, capture_output=True, text=True)
+    assert bad.returncode != 0 and "out of range" in bad.stderr
+
+
+def test_runner_scatter_add_accumulates_duplicates_across_threads(gather_runner: Path, tmp_path: Path) -> None:
+    rng = np.random.default_rng(1)
+    data = rng.normal(size=(10, 4)).astype(np.float32)
+    idx = np.array([9, 0, 9, 4, 4, 4, 1, 9], dtype=np.int32)
+    updates = rng.normal(size=(8, 4)).astype(np.float32)
+    for name, array in (("d", data), ("i", idx), ("u", updates)):
+        array.tofile(tmp_path / f"{name}.bin")
+    inputs = ",".join(str(tmp_path / f"{name}.bin") for name in "diu")
+    shapes = '{"inputs": [[10, 4], [8], [8, 4]], "outputs": [[10, 4]]}'
+    argv = [str(gather_runner), "--inputs", inputs, "--output0", str(tmp_path / "out.bin")]
+    argv += ["--dtypes", "float32,int32,float32", "--shapes", shapes]
+    (expected,) = ScatterAdd.run((data, idx, updates), {})
+    for threads in ("1", "3"):
+        subprocess.run(argv + ["--threads", threads], check=True, capture_output=True, text=True)
+        actual = np.fromfile(tmp_path / "out.bin", dtype=np.float32).reshape(10, 4)
+        np.testing.assert_allclose(actual, expected, rtol=1e-6, atol=1e-6)
@@ -0,0 +1,99 @@
+from __future__ import annotations
+
+import tracemalloc
+from pathlib import Path
+
+import numpy as np
+import numpy.testing as npt
+import pytest
+
+from optest.plan import generators
+from optest.plan.models import GeneratorConfig
+from optest.storage import allocate_tensor, finalize_tensor, load_array, tensor_digest
+
+
+def _gen(name: str, shape, dtype: str, seed: int = 0, threads: int | None = None, **params) -> np.ndarray:
+    config = GeneratorConfig(name=name, params=params)
+    return generators.generate(config, shape, dtype, np.random.SeedSequence(seed), threads=threads)
+
+
+def test_chunked_generation_is_independent_of_thread_count(monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setattr(generators, "CHUNK_ELEMENTS", 1000)
+    single = _gen("builtin.normal", (50, 90), "float32", seed=7, threads=1)
+    many = _gen("builtin.normal", (50, 90), "float32", seed=7, threads=4)
+    assert single.dtype == np.float32
+    npt.assert_array_equal(single, many)
+    assert not np.array_equal(single, _gen("builtin.normal", (50, 90), "float32", seed=8))
+
+
+def test_distribution_parameters_and_dtypes() -> None:
+    normal = _gen("builtin.normal", (200_000,), "float64", mean=3.0, std=0.5)
+    assert abs(normal.mean() - 3.0) < 0.01 and abs(normal.std() - 0.5) < 0.01
+    ints = _gen("builtin.integers", (100_000,), "int8", low=-3, high=3, endpoint=True)
+    assert ints.dtype == np.int8
+    assert set(np.unique(ints)) == set(range(-3, 4))
+    uniform_int = _gen("builtin.uniform", (100_000,), "int32", low=-10, high=10)
+    counts = np.bincount(uniform_int + 10)
+    assert counts.size == 20 and counts.min() > 0.8 * counts.mean()
+    half = _gen("builtin.uniform", (1000,), "float16", low=2.0, high=4.0)
+    assert half.dtype == np.float16 and half.min() >= 2.0 and half.max() <= 4.0
+    npt.assert_array_equal(_gen("builtin.arange", (2, 3), "int32", start=5, step=2), [[5, 7, 9], [11, 13, 15]])
+    npt.assert_allclose(_gen("builtin.linspace", (5,), "float32", start=0, stop=1), [0, 0.25, 0.5, 0.75, 1])
+
+
+def test_masks_and_special_values() -> None:
+    mask = _gen("builtin.mask", (100_000,), "bool", sparsity=0.9)
+    assert mask.dtype == np.bool_ and abs(mask.mean() - 0.1) < 0.01
+    special = _gen("builtin.special", (100_000,), "float32", density=0.2, values=["nan", "denormal"])
+    assert abs(np.isnan(special).mean() - 0.1) < 0.01
+    denormal = np.finfo(np.float32).smallest_subnormal
+    assert abs((special == denormal).mean() - 0.1) < 0.01
+    extremes = _gen("builtin.special", (1000,), "int16", density=1.0, base="integers")
+    assert set(np.unique(extremes)) <= {0, -32768, 32767}
+    with pytest.raises(ValueError, match="Unknown generator"):
+        _gen("builtin.bogus", (4,), "float32")
+
+
+def test_inject_denormals_replaces_a_fraction_of_float_elements() -> None:
+    values = _gen("builtin.normal", (100_000,), "float32")
+    injected = generators.inject_denormals(values, 0.25, np.random.default_rng(3))
+    tiny = np.finfo(np.float32).tiny
+    subnormal = (injected != 0) & (np.abs(injected) < tiny)
+    assert injected.dtype == np.float32 and abs(subnormal.mean() - 0.25) < 0.01
+    assert (injected[subnormal] > 0).mean() > 0.4 and (injected[subnormal] < 0).mean() > 0.4
+    npt.assert_array_equal(injected[~subnormal], values[~subnormal])
+    npt.assert_array_equal(values, _gen("builtin.normal", (100_000,), "float32"))  # the input is left alone
+    ints = np.arange(10, dtype=np.int32)
+    assert generators.inject_denormals(ints, 0.5, np.random.default_rng(0)) is ints
+
+
+def test_generation_fills_mapped_files_in_place(tmp_path: Path) -> None:
+    shape, config = (2048, 2048), GeneratorConfig(name="builtin.normal")
+    expected = generators.generate(config, shape, "float32", np.random.SeedSequence(5))
+    for container in (False, True):
+        path = tmp_path / f"in{int(container)}.bin"
+        tracemalloc.start()
+        out = allocate_tensor(path, shape, "float32", container=container)
+        generators.generate(config, shape, "float32", np.random.SeedSequence(5), out=out, threads=1)
+        _, peak = tracemalloc.get_traced_memory()
+        tracemalloc.stop()
+        assert peak < expected.nbytes // 4
+        out.flush()
+        if container:
+            header = finalize_tensor(path)
+            assert header.hexdigest == tensor_digest(tmp_path / "in0.bin")
+        npt.assert_array_equal(load_array(path, shape, "float32"), expected)
+
+
+def test_indices_generator_controls_range_skew_and_locality() -> None:
+    uniform = _gen("builtin.indices", (100_000,), "int64", high=1000)
+    assert uniform.min() >= 0 and uniform.max() < 1000
+    skewed = _gen("builtin.indices", (100_000,), "int32", high=1000, skew=1.2)
+    # Zipf: the ten hottest ids take far more than their uniform 1% share.
+    assert np.mean(skewed < 10) > 0.5 > np.mean(uniform < 10)
+    local = _gen("builtin.indices", (100_000,), "int64", low=5, high=1005, locality=0.9, window=4)
+    assert local.min() >= 5 and local.max() < 1005
+    steps = np.abs(np.diff(local))
+    assert np.mean((steps <= 4) | (steps >= 996)) > 0.85  # short steps, wrapping at the ends
+    with pytest.raises(ValueError, match="params.high"):
+        _gen("builtin.indices", (4,), "int64")
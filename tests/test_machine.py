@@ -0,0 +1,123 @@
+from __future__ import annotations
+
+import dataclasses
+import json
+import shutil
+import textwrap
+from pathlib import Path
+
+import pytest
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.machine import MachineProfile, load_profile, percent_of_peak, save_profile
+
+
+@pytest.mark.skipif(not any(shutil.which(name) for name in ("c++", "g++", "clang++")), reason="no C++ compiler")
+def test_calibrate_machine_writes_profile(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("XDG_CACHE_HOME", str(tmp_path / "cache"))
+    output = tmp_path / "machine.json"
+    args = ["calibrate-machine", "--output", str(output), "--threads", "1", "--stream-mib", "4", "--fma-ms", "5"]
+    result = CliRunner().invoke(cli, args)
+    assert result.exit_code == 0, result.output
+
+    profile = load_profile(output)
+    assert profile is not None and profile.isas and profile.isas[0] in ("sse2", "generic")
+    assert {item["op"] for item in profile.bandwidth} == {"copy", "triad"}
+    assert {(item["isa"], item["dtype"]) for item in profile.flops} == {
+        (isa, dtype) for isa in profile.isas for dtype in ("float32", "float64")
+    }
+    assert profile.peak_gbps > 0 and profile.peak_gflops("float64") > 0
+    assert json.loads(output.read_text(encoding="utf-8"))["peak_gflops"]["float32"] == profile.peak_gflops("float32")
+
+
+def _profile() -> MachineProfile:
+    return MachineProfile(
+        host="test",
+        created=0.0,
+        cpu="test",
+        cores=4,
+        isas=["sse2", "avx2"],
+        bandwidth=[
+            {"op": "copy", "threads": 4, "node": None, "gbps": 80.0},
+            {"op": "triad", "threads": 4, "node": None, "gbps": 50.0},
+        ],
+        flops=[
+            {"isa": "avx2", "dtype": "float32", "threads": 4, "gflops": 400.0},
+            {"isa": "avx2", "dtype": "float64", "threads": 4, "gflops": 200.0},
+        ],
+    )
+
+
+def test_percent_of_peak() -> None:
+    profile = _profile()
+    # Only the unpinned run is the ceiling; per-node runs count only for profiles without one.
+    profile.bandwidth.append({"op": "triad", "threads": 2, "node": 0, "gbps": 60.0})
+    assert profile.peak_gbps == 50.0
+    assert dataclasses.replace(profile, bandwidth=profile.bandwidth[2:]).peak_gbps == 60.0
+    assert percent_of_peak({"gflops": 100.0, "dram_gbps": 25.0}, profile) == {"gflops": 25.0, "gbps": 50.0}
+    assert percent_of_peak({"tflops": 0.1}, profile, "float64") == {"gflops": 50.0}
+    # flops/bytes per call next to kernel_ms; dtypes without a measured peak fall back to float32.
+    assert percent_of_peak({"flops": 4e6, "bytes": 1e6, "kernel_ms": 0.1}, profile, "int8") == {
+        "gflops": 10.0,
+        "gbps": 20.0,
+    }
+    assert percent_of_peak({"kernel_ms": 1.0}, profile) == {}
+
+
+def test_bench_reports_percent_of_peak(tmp_path: Path) -> None:
+    machine = tmp_path / "machine.json"
+    save_profile(_profile(), machine)
+    runner = tmp_path / "relu.py"
+    runner.write_text(
+        textwrap.dedent(
+            """
+            import sys
+            import numpy as np
+
+            np.maximum(np.fromfile(sys.argv[1], dtype=sys.argv[3]), 0).tofile(sys.argv[2])
+            print("OPTEST_METRIC gflops=100 gbps=10")
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            assertion: {{name: builtin.relu}}
+            backends:
+              - type: cuda
+                chip: local
+                host_cpu: true
+                command: ["python", "{runner.as_posix()}", "{{input0}}", "{{output0}}", "{{dtype}}"]
+              - type: cuda
+                chip: device
+                command: ["python", "{runner.as_posix()}", "{{input0}}", "{{output0}}", "{{dtype}}"]
+            cases:
+              - name: single
+                dtypes: [float32]
+                shapes: [{{inputs: [[8]], outputs: [[8]]}}]
+              - name: double
+                dtypes: [float64]
+                shapes: [{{inputs: [[8]], outputs: [[8]]}}]
+            """
+        ),
+        encoding="utf-8",
+    )
+    report = tmp_path / "report.json"
+    args = ["bench", "--plan", str(plan_path), "--warmup", "0", "--repeat", "1", "--no-history"]
+    args += ["--machine-profile", str(machine), "--report", "json", "--report-path", str(report)]
+    result = CliRunner().invoke(cli, args)
+    assert result.exit_code == 0, result.output
+    cases = {case["id"]: case for case in json.loads(report.read_text(encoding="utf-8"))["cases"]}
+    assert cases["single@cuda:local/shape0"]["percent_of_peak"] == {"gflops": 25.0, "gbps": 20.0}
+    assert cases["double@cuda:local/shape0"]["percent_of_peak"] == {"gflops": 50.0, "gbps": 20.0}
+    assert "percent_of_peak" not in cases["single@cuda:device/shape0"]  # host ceilings do not bound a device
+
+    result = CliRunner().invoke(cli, args[:-4] + ["--machine-profile", str(machine), "--no-color"])
+    assert result.exit_code == 0, result.output
+    assert "of machine peak: gflops 25.0%, gbps 20.0%" in result.output
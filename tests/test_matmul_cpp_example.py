@@ -1,18 +1,25 @@
 from __future__ import annotations
 
+import json
 import shutil
 import subprocess
 from pathlib import Path
 
+import numpy as np
 import pytest
 import yaml
+from click.testing import CliRunner
 
+from optest.cli.main import cli
 from optest.plan import PlanOptions, load_plan, run_plan
+from optest.plan.bench import parse_metrics
+from optest.storage import is_tensor_file
 
 REPO_ROOT = Path(__file__).resolve().parents[1]
 EXAMPLE_DIR = REPO_ROOT / "examples" / "matmul_cpp"
 PLAN_PATH = EXAMPLE_DIR / "plan.yaml"
 RUNNER_PATH = EXAMPLE_DIR / "operator" / "build" / "matmul_runner"
+BENCH_PATH = EXAMPLE_DIR / "operator" / "build" / "matmul_bench"
 
 
 @pytest.fixture(scope="session")
@@ -53,6 +60,10 @@ def _override_backend_for_tmp(tmp_path: Path, data: dict, runner: Path) -> None:
         "{dtype}",
         "--shapes",
         "{shapes}",
+        "--layouts",
+        "{layouts}",
+        "--format",
+        "{format}",
     ]
 
 
@@ -89,3 +100,101 @@ def test_matmul_example_reports_unsupported_dtype(matmul_runner: Path, tmp_path:
     plan = load_plan(str(plan_path))
     exit_code = run_plan(plan, PlanOptions(backend="cuda", chip="local"), use_color=False)
     assert exit_code == 1
+
+
+def test_matmul_example_reads_and_writes_containers(matmul_runner: Path, tmp_path: Path) -> None:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    _override_backend_for_tmp(tmp_path, data, matmul_runner)
+    data["storage"] = {"format": "optt"}
+    plan_path = tmp_path / "plan_optt.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    with pytest.raises(ValueError, match="Case 'pitched' shape index 0 sets strides/pitch/offset"):
+        load_plan(str(plan_path))  # containers are dense; the pitched case cannot be stored
+    data["cases"] = [case for case in data["cases"] if not {"xfail-demo", "layout"} & set(case.get("tags", []))]
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    plan = load_plan(str(plan_path))
+    exit_code = run_plan(plan, PlanOptions(backend="cuda", chip="local"), use_color=False)
+    assert exit_code == 0
+    assert is_tensor_file(tmp_path / "out0.bin")
+
+
+@pytest.mark.parametrize("m,k,n", [(4, 64, 4), (16, 16, 16), (3, 5, 7)])
+def test_small_shape_kernels_match_generic_path(matmul_runner: Path, tmp_path: Path, m: int, k: int, n: int) -> None:
+    rng = np.random.default_rng(0)
+    rng.uniform(-2, 2, size=(m, k)).astype(np.float32).tofile(tmp_path / "a.bin")
+    rng.uniform(-2, 2, size=(k, n)).astype(np.float32).tofile(tmp_path / "b.bin")
+    shapes = json.dumps({"inputs": [[m, k], [k, n]], "outputs": [[m, n]]})
+    outputs = {}
+    for kernel in ("generic", "auto"):
+        out = tmp_path / f"{kernel}.bin"
+        argv = [str(matmul_runner), "--input0", str(tmp_path / "a.bin"), "--input1", str(tmp_path / "b.bin")]
+        argv += ["--output0", str(out), "--dtype", "float32", "--shapes", shapes, "--kernel", kernel]
+        proc = subprocess.run(argv, capture_output=True, text=True, check=True)
+        outputs[kernel] = np.fromfile(out, dtype=np.float32)
+        specialized = parse_metrics(proc.stdout)["specialized"]
+        assert specialized == (1.0 if kernel == "auto" and (m, k, n) != (3, 5, 7) else 0.0)
+    np.testing.assert_array_equal(outputs["auto"], outputs["generic"])
+
+
+def test_matmul_example_handles_pitched_layouts(matmul_runner: Path, tmp_path: Path) -> None:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    _override_backend_for_tmp(tmp_path, data, matmul_runner)
+    data["cases"] = [case for case in data["cases"] if case["name"] == "pitched"]
+    plan_path = tmp_path / "plan_pitched.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    plan = load_plan(str(plan_path))
+    exit_code = run_plan(plan, PlanOptions(backend="cuda", chip="local"), use_color=False)
+    assert exit_code == 0
+    out = np.fromfile(tmp_path / "out0.bin", dtype=np.float32)
+    assert out.size == 2 + 3 * 8 + 5
+    assert not out[:2].any() and not out[7:10].any()  # offset and pitch padding untouched
+
+
+def test_standalone_bench_results_are_ingested_by_optest_bench(matmul_runner: Path, tmp_path: Path) -> None:
+    shapes = ["--case", "small_fixed", "--shape", "4x64x4", "--shape", "8x32x8", "--shape", "16x16x16"]
+    shapes += ["--case", "not_in_plan", "--shape", "2x2x2"]
+    common = ["--warmup", "1", "--repeat", "3", "--min-sample-ms", "0.1"]
+    for kernel, chip in (("auto", "local"), ("generic", "generic")):
+        argv = [str(BENCH_PATH), *shapes, *common, "--kernel", kernel, "--target", f"cuda:{chip}"]
+        subprocess.run([*argv, "--output", str(tmp_path / f"{chip}.json")], check=True, capture_output=True)
+    payload = json.loads((tmp_path / "local.json").read_text(encoding="utf-8"))
+    first = payload["cases"][0]
+    assert first["id"] == "small_fixed@cuda:local/shape0" and len(first["samples_s"]) == 3
+    assert first["metrics"]["specialized"] == 1 and first["metrics"]["gflops"] > 0
+
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    _override_backend_for_tmp(tmp_path, data, matmul_runner)
+    generic = dict(data["backends"][0], chip="generic")
+    generic["command"] = [*generic["command"], "--kernel", "generic"]
+    data["backends"].append(generic)
+    plan_path = tmp_path / "plan_generic.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    report = tmp_path / "ingested.json"
+    args = ["bench", "--plan", str(plan_path), "--cases", "small_fixed", "--no-history", "--report", "json"]
+    args += ["--ingest", str(tmp_path / "local.json"), "--ingest", str(tmp_path / "generic.json")]
+    result = CliRunner().invoke(cli, [*args, "--baseline-chip", "generic", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+    assert "not_in_plan@cuda:local/shape0" in result.output  # reported as unmatched
+    ingested = json.loads(report.read_text(encoding="utf-8"))
+    assert [case["id"] for case in ingested["cases"]] == [
+        f"small_fixed@cuda:{chip}/shape{index}" for chip in ("local", "generic") for index in range(3)
+    ]
+    assert "speedup" in ingested["cases"][0] and ingested["summary"]["geomean_speedup"] > 0
+
+    argv = [str(BENCH_PATH), "--shape", "64x32x16", "--threads", "1,2", *common]
+    threads = subprocess.run(argv, check=True, capture_output=True, text=True)
+    ids = [case["id"] for case in json.loads(threads.stdout)["cases"]]
+    assert ids == ["matmul@cuda:local-t1/shape0", "matmul@cuda:local-t2/shape0"]
+    # Two threads split 8x64x4 into registered 4x64x4 blocks; 8x64x8 blocks (4x64x8) fall back to the generic loop.
+    split_argv = [str(BENCH_PATH), "--shape", "8x64x4", "--shape", "8x64x8", "--threads", "2", *common]
+    split = json.loads(subprocess.run(split_argv, check=True, capture_output=True, text=True).stdout)
+    assert [case["metrics"]["specialized"] for case in split["cases"]] == [1, 0]
+    # 16x16x16 is registered but 8x16x16 is not: it keeps its kernel and runs on one worker.
+    whole_argv = [str(BENCH_PATH), "--shape", "16x16x16", "--threads", "2", *common]
+    whole = json.loads(subprocess.run(whole_argv, check=True, capture_output=True, text=True).stdout)["cases"][0]
+    assert whole["metrics"]["specialized"] == 1 and whole["metrics"]["threads"] == 1
+
+    cold = subprocess.run([*argv[:3], *common, "--cache-state", "both"], check=True, capture_output=True, text=True)
+    payload = json.loads(cold.stdout)
+    assert payload["summary"]["cache_state"] == "both"
+    assert len(payload["cases"][0]["cold_samples_s"]) == 3 and payload["cases"][0]["cold_median_s"] > 0
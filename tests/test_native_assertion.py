@@ -0,0 +1,131 @@
+from __future__ import annotations
+
+import json
+import shutil
+import subprocess
+import textwrap
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.plan.custom import load_native
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+
+PLUGIN = """
+#include <optest/assertion_plugin.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+// The JSON value of top-level key `key` (which must not appear inside other keys or strings), or nullptr.
+static const char* param_value(const char* json, const char* key) {
+    const size_t length = std::strlen(key);
+    for (const char* at = std::strchr(json, '"'); at != nullptr; at = std::strchr(at + 1, '"')) {
+        if (std::strncmp(at + 1, key, length) != 0 || at[length + 1] != '"') {
+            continue;
+        }
+        const char* value = at + length + 2;
+        while (std::isspace(static_cast<unsigned char>(*value))) {
+            ++value;
+        }
+        if (*value++ != ':') {
+            continue;
+        }
+        while (std::isspace(static_cast<unsigned char>(*value))) {
+            ++value;
+        }
+        return value;
+    }
+    return nullptr;
+}
+
+OPTEST_ASSERTION(check_relu) {
+    if (num_inputs != 1 || num_outputs != 1 || optest::dtype_of(outputs[0]) != optest::DType::kFloat32) {
+        optest::set_details(result, "expected one float32 input and output");
+        return 1;
+    }
+    const char* value = param_value(params_json, "leaky");
+    const bool leaky = value != nullptr && std::strncmp(value, "true", 4) == 0;
+    if (value != nullptr && !leaky && std::strncmp(value, "false", 5) != 0) {
+        optest::set_details(result, "params.leaky must be true or false");
+        return 2;
+    }
+    double max_abs = 0;
+    for (int64_t i = 0; i < optest::numel(inputs[0]); ++i) {
+        const float x = optest::element<float>(inputs[0], i);
+        const float want = x > 0 ? x : (leaky ? 0.01f * x : 0.0f);
+        max_abs = std::max(max_abs, double(std::fabs(optest::element<float>(outputs[0], i) - want)));
+    }
+    optest::add_metric(result, "output0_max_abs", max_abs);
+    result->ok = max_abs <= (std::isnan(atol) ? 1e-6 : atol);
+    if (!result->ok) {
+        optest::set_details(result, "relu mismatch (max_abs=%g)", max_abs);
+    }
+    return 0;
+}
+"""
+
+RUNNER = """
+import sys
+import numpy as np
+
+x = np.fromfile(sys.argv[1], dtype="float32").reshape(3, 4)
+out = np.full((3, 5), 99.0, dtype="float32")  # pitched rows; the pad column is never read
+out[:, :4] = np.maximum(x, 0)
+out.tofile(sys.argv[2])
+"""
+
+
+@pytest.mark.skipif(shutil.which("g++") is None, reason="g++ is required to build the plugin")
+def test_native_assertion_plugin_checks_mapped_outputs(tmp_path: Path) -> None:
+    (tmp_path / "check_relu.cpp").write_text(PLUGIN, encoding="utf-8")
+    plugin = tmp_path / "libcheck_relu.so"
+    subprocess.run(
+        ["g++", "-std=c++17", "-O2", "-shared", "-fPIC", f"-I{REPO_ROOT / 'sdk/cpp/include'}",
+         str(tmp_path / "check_relu.cpp"), "-o", str(plugin)],
+        check=True,
+    )
+    (tmp_path / "relu.py").write_text(textwrap.dedent(RUNNER), encoding="utf-8")
+    plan = {
+        "operator": "relu",
+        "inputs": ["in0.bin"],
+        "outputs": ["out0.bin"],
+        "generator": {"name": "builtin.random", "seed": 9},
+        "assertion": {"name": "check_relu", "source": plugin.name},
+        "backends": [{"type": "cuda", "chip": "local",
+                      "command": ["python", str(tmp_path / "relu.py"), "{input0}", "{output0}"]}],
+        "cases": [{"name": "pitched", "dtypes": ["float32"],
+                   "shapes": [{"inputs": [[3, 4]], "outputs": [{"dims": [3, 4], "pitch": 5}]}]}],
+    }
+    plan_path = tmp_path / "plan.yaml"
+    report = tmp_path / "report.json"
+    args = ["run", "--plan", str(plan_path), "--report", "json", "--report-path", str(report)]
+
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    result = CliRunner().invoke(cli, args)
+    assert result.exit_code == 0, result.output
+
+    plan["assertion"]["params"] = {"leaky": True}
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    assert CliRunner().invoke(cli, args).exit_code == 1
+    case = json.loads(report.read_text(encoding="utf-8"))["cases"][0]
+    assert case["details"].startswith("relu mismatch") and case["metrics"]["output0_max_abs"] > 0
+
+    plan["assertion"]["params"] = {"leaky": "maybe"}
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    assert CliRunner().invoke(cli, args).exit_code == 1
+    case = json.loads(report.read_text(encoding="utf-8"))["cases"][0]
+    assert case["details"] == "native assertion 'check_relu' failed (code 2): params.leaky must be true or false"
+
+    # Big-endian tensors reach the plugin in host byte order.
+    x = np.linspace(-1, 1, 12, dtype=">f4").reshape(3, 4)
+    check = load_native(plugin, "check_relu")
+    ok, details, metrics = check([x], [np.maximum(x, 0).astype(">f4")], {}, None, None, None)
+    assert ok and metrics["output0_max_abs"] == 0, details
@@ -0,0 +1,146 @@
+from __future__ import annotations
+
+import json
+import textwrap
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.plan import PlanOptions, load_plan, pipeline, run_plan
+
+RUNNER = """
+import json, sys
+import numpy as np
+
+# JSON tokens arrive shell-quoted.
+op, params, shapes = sys.argv[1], json.loads(sys.argv[2].strip("'")), json.loads(sys.argv[3].strip("'"))
+dtypes = sys.argv[4].split(",")
+paths = sys.argv[5:]
+args = [np.fromfile(path, dtype=dtype).reshape(shape) for path, dtype, shape in zip(paths, dtypes, shapes["inputs"])]
+if op.endswith("matmul"):
+    out = args[0] @ args[1]
+elif op.endswith("relu"):
+    out = np.maximum(args[0], 0) * BUG
+else:
+    shifted = np.exp(args[0] - args[0].max(axis=params.get("axis", -1), keepdims=True))
+    out = shifted / shifted.sum(axis=params.get("axis", -1), keepdims=True)
+out.astype(dtypes[0]).tofile(paths[-1])
+print("OPTEST_METRIC kernel_ms=0.25")
+"""
+
+
+def _pipeline_plan(tmp_path: Path, bug: float = 1.0, **changes) -> Path:
+    script = tmp_path / "ops.py"
+    script.write_text(textwrap.dedent(RUNNER).replace("BUG", repr(bug)), encoding="utf-8")
+    command = ["python", script.as_posix(), "{assertion}", "{params}", "{shapes}", "{dtypes}"]
+    plan = {
+        "operator": "mlp_block",
+        "inputs": ["x.bin", "w.bin", "b.bin"],
+        "outputs": ["probs.bin"],
+        "generator": {"name": "builtin.random", "seed": 3},
+        "backends": [{"type": "cuda", "chip": "local", "command": [*command, "{input0}", "{input1}", "{output0}"]}],
+        "pipeline": {
+            "nodes": [
+                {"name": "probs", "op": {"name": "builtin.softmax", "params": {"axis": -1}}, "inputs": ["act"],
+                 "command": [*command, "{input0}", "{output0}"]},
+                {"name": "mm", "op": "builtin.matmul", "inputs": ["input0", "input1"]},
+                {"name": "bias", "op": "builtin.elementwise_add", "inputs": ["mm", "input2"], "run": "builtin"},
+                {"name": "act", "op": "builtin.relu", "inputs": ["bias"],
+                 "command": [*command, "{input0}", "{output0}"]},
+            ],
+            "outputs": ["probs"],
+        },
+        "cases": [
+            {"name": "small", "dtypes": ["float32"] * 3,
+             "shapes": [{"inputs": [[4, 8], [8, 5], [4, 5]], "outputs": [[4, 5]]}]},
+        ],
+    }
+    plan["pipeline"].update(changes)
+    path = tmp_path / "plan.yaml"
+    path.write_text(yaml.safe_dump(plan, sort_keys=False), encoding="utf-8")
+    return path
+
+
+def test_pipeline_nodes_are_ordered_and_validated(tmp_path: Path) -> None:
+    plan = load_plan(str(_pipeline_plan(tmp_path)))
+    assert plan.pipeline is not None
+    assert [node.name for node in plan.pipeline.nodes] == ["mm", "bias", "act", "probs"]
+    assert [node.run for node in plan.pipeline.nodes] == ["backend", "builtin", "command", "command"]
+
+    data = yaml.safe_load((tmp_path / "plan.yaml").read_text(encoding="utf-8"))
+    data["pipeline"]["nodes"][1]["inputs"] = ["input0", "probs"]  # probs <- act <- bias <- mm <- probs
+    (tmp_path / "cycle.yaml").write_text(yaml.safe_dump(data), encoding="utf-8")
+    with pytest.raises(ValueError, match="cycle: probs -> act -> bias -> mm -> probs"):
+        load_plan(str(tmp_path / "cycle.yaml"))
+    with pytest.raises(ValueError, match="unknown node 'nope'"):
+        load_plan(str(_pipeline_plan(tmp_path, outputs=["nope"])))
+    with pytest.raises(ValueError, match="references input3 but the plan has 3 inputs"):
+        data["pipeline"]["nodes"][1]["inputs"] = ["input0", "input3"]
+        (tmp_path / "bad_input.yaml").write_text(yaml.safe_dump(data), encoding="utf-8")
+        load_plan(str(tmp_path / "bad_input.yaml"))
+
+
+def test_pipeline_run_checks_nodes_and_end_to_end(tmp_path: Path) -> None:
+    plan_path = _pipeline_plan(tmp_path)
+    report = tmp_path / "report.json"
+    args = ["run", "--plan", str(plan_path), "--report", "json", "--report-path", str(report)]
+    result = CliRunner().invoke(cli, args)
+    assert result.exit_code == 0, result.output
+    case = json.loads(report.read_text(encoding="utf-8"))["cases"][0]
+    assert case["status"] == "passed"
+    assert "act.output0_max_abs" not in case["metrics"]  # per-node references only on the failure path
+    x, w, b = (np.fromfile(tmp_path / name, dtype="float32") for name in ("x.bin", "w.bin", "b.bin"))
+    logits = np.maximum(x.reshape(4, 8) @ w.reshape(8, 5) + b.reshape(4, 5), 0)
+    expected = np.exp(logits - logits.max(axis=-1, keepdims=True))
+    expected /= expected.sum(axis=-1, keepdims=True)
+    np.testing.assert_allclose(np.fromfile(tmp_path / "probs.bin", dtype="float32").reshape(4, 5), expected, rtol=1e-5)
+
+    (tmp_path / "broken").mkdir()
+    broken = _pipeline_plan(tmp_path / "broken", bug=1.5)  # relu scales its positive outputs
+    result = CliRunner().invoke(cli, ["run", "--plan", str(broken), "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 1
+    case = json.loads(report.read_text(encoding="utf-8"))["cases"][0]
+    assert case["status"] == "failed"
+    assert case["details"].startswith("node 'act': Output0 mismatch")
+    assert "first divergence from the reference chain at node 'act'" in case["details"]
+    assert case["metrics"]["bias.0.golden_max_abs"] == 0.0 and case["metrics"]["act.0.golden_max_abs"] > 0
+    assert case["metrics"]["act.output0_max_abs"] > 0
+    assert "probs.output0_max_abs" not in case["metrics"]  # softmax is right on what it received
+
+
+def test_passing_pipeline_reruns_compute_no_node_references(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    plan_path = _pipeline_plan(tmp_path)
+    data = yaml.safe_load(plan_path.read_text(encoding="utf-8"))
+    data["storage"] = {"cache_dir": "cache"}
+    plan_path.write_text(yaml.safe_dump(data, sort_keys=False), encoding="utf-8")
+    monkeypatch.setattr(pipeline, "_NODE_SPECS", {})
+    calls: list = []
+    reference = pipeline.reference_outputs
+
+    def counted(node, args):
+        calls.append(node.name)
+        return reference(node, args)
+
+    monkeypatch.setattr(pipeline, "reference_outputs", counted)
+
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 0
+    assert {"mm", "act", "probs"} <= set(calls)
+    calls.clear()
+    # Node output shapes are known and the end-to-end golden is cached: only the in-process node runs its reference.
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 0
+    assert calls == ["bias"]
+
+
+def test_pipeline_bench_times_every_node(tmp_path: Path) -> None:
+    report = tmp_path / "bench.json"
+    args = ["bench", "--plan", str(_pipeline_plan(tmp_path)), "--warmup", "0", "--repeat", "2", "--no-history"]
+    result = CliRunner().invoke(cli, [*args, "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+    case = json.loads(report.read_text(encoding="utf-8"))["cases"][0]
+    assert case["status"] == "ok" and len(case["samples_s"]) == 2
+    assert {f"{node}.wall_ms" for node in ("mm", "bias", "act", "probs")} <= set(case["metrics"])
+    assert case["metrics"]["mm.kernel_ms"] == 0.25 and "bias.kernel_ms" not in case["metrics"]
@@ -4,8 +4,12 @@ import textwrap
 from pathlib import Path
 
 import numpy as np
+import numpy.testing as npt
+import pytest
+import yaml
 
 from optest.plan import PlanOptions, load_plan, run_plan
+from optest.plan import runner as plan_runner
 
 
 def _write_plan(tmp_path: Path) -> Path:
@@ -184,3 +188,90 @@ def test_builtin_assertions_and_backend_templates(tmp_path: Path) -> None:
     assert (tmp_path / "prep.txt").read_text(encoding="utf-8") == "relu-1x4"
     assert (tmp_path / "cleanup.txt").read_text(encoding="utf-8") == "float32"
     assert (tmp_path / "seen_env.txt").read_text(encoding="utf-8") == "cuda-local"
+
+
+def test_layouts_token_and_region_restricted_assertion(tmp_path: Path) -> None:
+    script = tmp_path / "pitched_relu.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import json
+            import sys
+            import numpy as np
+
+            src, dst, layouts = sys.argv[1], sys.argv[2], json.loads(sys.argv[3].strip("'"))
+            layout = layouts["inputs"][0]
+            rows, cols, pitch = 3, 4, layout["strides"][0]
+            data = np.fromfile(src, dtype="float32")[layout["offset"]:]
+            padded = np.zeros((rows, pitch), dtype="float32")
+            padded[:, :cols] = np.maximum([data[r * pitch : r * pitch + cols] for r in range(rows)], 0)
+            padded[:, cols - 1] = 99.0  # garbage outside the asserted region
+            padded.tofile(dst)
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            generator: {{name: builtin.random, seed: 3}}
+            assertion: {{name: builtin.relu, region: ":, 0:3"}}
+            backends:
+              - type: cuda
+                chip: local
+                workdir: {tmp_path.as_posix()}
+                command: ["python", "{script.as_posix()}", "{{input0}}", "{{output0}}", "{{layouts}}"]
+            cases:
+              - name: pitched
+                dtypes: [float32]
+                shapes:
+                  - inputs: [{{dims: [3, 4], pitch: 5, offset: 1}}]
+                    outputs: [{{dims: [3, 4], pitch: 5}}]
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan = load_plan(str(plan_path))
+    assert plan.cases[0].shapes[0].input_layouts[0].strides == (5, 1)
+    assert run_plan(plan, PlanOptions(), use_color=False) == 0
+    assert (tmp_path / "in0.bin").stat().st_size == (1 + 2 * 5 + 4) * 4
+
+    data = yaml.safe_load(plan_path.read_text(encoding="utf-8"))
+    del data["assertion"]["region"]
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 1
+
+
+def test_seeded_inputs_get_independent_streams(tmp_path: Path) -> None:
+    plan_path = _write_plan(tmp_path)
+    data = yaml.safe_load(plan_path.read_text(encoding="utf-8"))
+    data["generator"] = {"name": "builtin.random", "seed": 7}
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions()) == 0
+    first, second = (np.fromfile(tmp_path / "data" / name, dtype="float32") for name in ("in0.bin", "in1.bin"))
+    assert not np.array_equal(first, second)
+
+    data["generator"]["per_input"] = {1: {"seed": 7}}
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(cache="regen")) == 0
+    npt.assert_array_equal(np.fromfile(tmp_path / "data" / "in0.bin", dtype="float32"), first)
+    assert not np.array_equal(np.fromfile(tmp_path / "data" / "in1.bin", dtype="float32"), second)
+
+
+def test_assertions_get_read_only_tensors(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    seen: list[bool] = []
+    builtin = plan_runner._builtin_assertion
+
+    def _record(assertion, inputs, outputs, resolved, cache=None):
+        seen.extend(array.flags.writeable for array in (*inputs, *outputs))
+        return builtin(assertion, inputs, outputs, resolved, cache)
+
+    monkeypatch.setattr(plan_runner, "_builtin_assertion", _record)
+    plan = load_plan(str(_write_plan(tmp_path)))
+    for cache in ("regen", "reuse"):
+        assert run_plan(plan, PlanOptions(cache=cache)) == 0
+    assert seen == [False] * 6
@@ -0,0 +1,144 @@
+from __future__ import annotations
+
+import json
+import os
+import stat
+import textwrap
+from pathlib import Path
+
+import pytest
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.plan.profile import fold_perf_script, parse_profile_spec, read_folded, render_flamegraph
+
+PERF_SCRIPT = """\
+relu 4242 100.000001:     1001001 cpu-clock:pppH:
+\t    55d5c3a0 relu_kernel+0x30 (/opt/relu)
+\t    55d5c100 main+0x12 (/opt/relu)
+\t    7f000001 __libc_start_main+0xf3 (/usr/lib/libc.so.6)
+
+relu 4242 100.001002:     1001001 cpu-clock:pppH:
+\t    55d5c3a8 relu_kernel+0x38 (/opt/relu)
+\t    55d5c100 main+0x12 (/opt/relu)
+\t    7f000001 __libc_start_main+0xf3 (/usr/lib/libc.so.6)
+
+relu 4242 100.002003:     1001001 cpu-clock:pppH:
+\t    7f001234 [unknown] (/usr/lib/libm.so.6)
+\t    55d5c100 main+0x12 (/opt/relu)
+"""
+
+
+def test_perf_script_folding_and_flamegraph() -> None:
+    folded = fold_perf_script(PERF_SCRIPT)
+    assert folded == {
+        "relu;__libc_start_main;main;relu_kernel": 2,
+        "relu;main;[libm.so.6]": 1,
+    }
+    svg = render_flamegraph(folded, "relu@cuda:local/shape0")
+    assert svg.startswith("<svg") and svg.rstrip().endswith("</svg>")
+    assert "relu_kernel (2 samples, 66.67%)" in svg and "relu@cuda:local/shape0" in svg
+
+    assert parse_profile_spec("slowest:2").count == 2
+    assert parse_profile_spec("cases:small*,big").patterns == ("small*", "big")
+    assert parse_profile_spec("cases:small").matches("small@cuda:local/shape1")
+    for bad in ("slowest:0", "cases:", "fastest:1"):
+        with pytest.raises(ValueError):
+            parse_profile_spec(bad)
+
+
+def _fake_perf(bin_dir: Path) -> None:
+    # Stands in for `perf record ... -o DATA -- CMD` (runs CMD, logs it) and `perf script -i DATA`.
+    script = bin_dir / "perf"
+    script.write_text(
+        textwrap.dedent(
+            f"""\
+            #!/usr/bin/env python3
+            import subprocess, sys
+            args = sys.argv[1:]
+            if args[0] == "record":
+                data = args[args.index("-o") + 1]
+                command = args[args.index("--") + 1:]
+                open(data, "w").write(" ".join(command))
+                sys.exit(subprocess.call(command))
+            sys.stdout.write({PERF_SCRIPT!r})
+            """
+        ),
+        encoding="utf-8",
+    )
+    script.chmod(script.stat().st_mode | stat.S_IEXEC)
+
+
+def _plan(tmp_path: Path) -> Path:
+    runner = tmp_path / "relu.py"
+    runner.write_text(
+        textwrap.dedent(
+            f"""
+            import sys, time
+            import numpy as np
+
+            np.maximum(np.fromfile(sys.argv[1], dtype="float32"), 0).tofile(sys.argv[2])
+            time.sleep(float(sys.argv[3]))
+            with open({str(tmp_path / "runs.log")!r}, "a") as log:
+                log.write(sys.argv[1] + "\\n")
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            assertion: {{name: builtin.relu}}
+            backends:
+              - type: cuda
+                chip: local
+                command: ["python", "{runner.as_posix()}", "{{input0}}", "{{output0}}", "{{case}}"]
+            cases:
+              - name: "0.001"
+                dtypes: [float32]
+                shapes: [{{inputs: [[8]], outputs: [[8]]}}]
+              - name: "0.05"
+                dtypes: [float32]
+                shapes: [{{inputs: [[16]], outputs: [[16]]}}, {{inputs: [[4]], outputs: [[4]]}}]
+            """
+        ),
+        encoding="utf-8",
+    )
+    return plan_path
+
+
+@pytest.mark.parametrize(
+    "spec,expected",
+    [
+        ("slowest:2", {"0.05@cuda:local/shape0", "0.05@cuda:local/shape1"}),
+        ("cases:0.001", {"0.001@cuda:local/shape0"}),
+    ],
+)
+def test_bench_profiles_selected_cases(tmp_path: Path, monkeypatch: pytest.MonkeyPatch, spec: str, expected: set) -> None:
+    bin_dir = tmp_path / "bin"
+    bin_dir.mkdir()
+    _fake_perf(bin_dir)
+    monkeypatch.setenv("PATH", f"{bin_dir}{os.pathsep}{os.environ['PATH']}")
+    out_dir = tmp_path / "profiles"
+    report = tmp_path / "report.json"
+    args = ["bench", "--plan", str(_plan(tmp_path)), "--warmup", "0", "--repeat", "2", "--no-history"]
+    args += ["--profile", spec, "--profile-dir", str(out_dir), "--profiler", "perf"]
+    result = CliRunner().invoke(cli, [*args, "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+
+    cases = {case["id"]: case for case in json.loads(report.read_text(encoding="utf-8"))["cases"]}
+    assert {identifier for identifier, case in cases.items() if "profile" in case} == expected
+    for identifier in expected:
+        profile = cases[identifier]["profile"]
+        assert profile["samples"] == 3 and Path(profile["svg"]).read_text(encoding="utf-8").startswith("<svg")
+        assert read_folded(Path(profile["folded"]))["relu;__libc_start_main;main;relu_kernel"] == 2
+    # Profiles are captured after every timed run, never interleaved with them.
+    runs = [".work" in line for line in (tmp_path / "runs.log").read_text(encoding="utf-8").splitlines()]
+    assert runs == sorted(runs) and runs.count(True) == len(expected)
+    # Profile runs use private copies of the inputs; their scratch directories are removed afterwards.
+    artifacts = list(out_dir.iterdir())
+    assert len(artifacts) == 2 * len(expected) and {path.suffix for path in artifacts} == {".folded", ".svg"}
@@ -1,5 +1,6 @@
 import numpy as np
 import numpy.testing as npt
+import pytest
 
 from optest.operators import builtin_operators as ops
 
@@ -57,3 +58,93 @@ def test_broadcast_and_sinh_references() -> None:
     (sinh_out,) = ops.Sinh.run((x,), {})
     npt.assert_allclose(broadcasted, np.broadcast_to(x, (2, 2)))
     npt.assert_allclose(sinh_out, np.sinh(x))
+
+
+def test_topk_reference_matches_full_sort_and_orders_ties_by_index() -> None:
+    x = np.random.default_rng(0).normal(size=(6, 50)).astype(np.float32)
+    values, indices = ops.TopK.run((x,), {"k": 5})
+    npt.assert_array_equal(values, -np.sort(-x, axis=1)[:, :5])
+    npt.assert_array_equal(np.take_along_axis(x, indices, axis=1), values)
+    smallest, _ = ops.TopK.run((x,), {"k": 3, "axis": 0, "largest": False})
+    npt.assert_array_equal(smallest, np.sort(x, axis=0)[:3])
+    ties = np.array([[2, 7, 7, 1, 7]], dtype=np.int32)
+    values, indices = ops.TopK.run((ties,), {"k": 5})
+    npt.assert_array_equal(indices, [[1, 2, 4, 0, 3]])
+    (argmax,) = ops.ArgMax.run((ties,), {})
+    (argmin,) = ops.ArgMin.run((ties,), {"keepdims": True})
+    assert argmax.tolist() == [1] and argmin.tolist() == [[3]]
+
+
+def test_index_outputs_compare_by_selected_values() -> None:
+    x = np.array([[3.0, 9.0, 9.0, 1.0]], dtype=np.float32)
+    # Either tied 9.0 is a valid argmax / top-1.
+    npt.assert_array_equal(ops.ArgMax.indexed_values((x,), np.array([2]), {}), [[9.0]])
+    npt.assert_array_equal(ops.TopK.indexed_values((x,), np.array([[2, 1]]), {}), [[9.0, 9.0]])
+    with pytest.raises(ValueError, match="repeat"):
+        ops.TopK.indexed_values((x,), np.array([[1, 1]]), {})
+    with pytest.raises(ValueError, match="range"):
+        ops.TopK.indexed_values((x,), np.array([[4, 1]]), {})
+
+
+def test_indexing_references_match_loops() -> None:
+    rng = np.random.default_rng(0)
+    table = rng.normal(size=(10, 3)).astype(np.float32)
+    idx = np.array([4, 0, 4, 9, 4], dtype=np.int32)
+    (gathered,) = ops.Gather.run((table, idx), {})
+    npt.assert_array_equal(gathered, table[idx])
+    updates = rng.normal(size=(5, 3)).astype(np.float32)
+    (scattered,) = ops.ScatterAdd.run((table, idx, updates), {})
+    expected = table.copy()
+    np.add.at(expected, idx, updates)
+    npt.assert_allclose(scattered, expected, rtol=1e-6)
+    offsets = np.array([0, 2, 2], dtype=np.int64)  # the middle bag is empty
+    (bags,) = ops.EmbeddingBag.run((table, idx, offsets), {"mode": "mean"})
+    npt.assert_allclose(bags, [table[idx[:2]].mean(0), np.zeros(3), table[idx[2:]].mean(0)], rtol=1e-6)
+    (maxed,) = ops.EmbeddingBag.run((table, idx, offsets), {"mode": "max"})
+    npt.assert_array_equal(maxed[2], table[idx[2:]].max(0))
+    with pytest.raises(ValueError, match="range"):
+        ops.Gather.run((table, np.array([10])), {})
+    with pytest.raises(ValueError, match="offsets"):
+        ops.EmbeddingBag.run((table, idx, np.array([0, 3, 1])), {})
+
+
+def test_transpose_reference_is_a_zero_copy_view() -> None:
+    x = np.arange(24, dtype=np.float32).reshape(2, 3, 4)
+    (reversed_axes,) = ops.Transpose.run((x,), {})
+    assert reversed_axes.shape == (4, 3, 2) and np.shares_memory(reversed_axes, x)
+    (nhwc,) = ops.Permute.run((x,), {"perm": [0, -1, 1]})
+    npt.assert_array_equal(nhwc, x.transpose(0, 2, 1))
+    with pytest.raises(ValueError, match="permutation"):
+        ops.Transpose.run((x,), {"perm": [0, 0, 1]})
+    with pytest.raises(ValueError, match="perm"):
+        ops.Permute.run((x,), {})
+
+
+def test_scan_references_accumulate_wide_and_scale_tolerance() -> None:
+    x = np.full(1 << 20, 0.1, dtype=np.float32)
+    (total,) = ops.CumSum.run((x,), {})
+    # float64 accumulation: the float32 running sum would be off by ~1e2 here.
+    assert abs(float(total[-1]) - 0.1 * x.size) < 1e-2 < abs(float(np.cumsum(x)[-1]) - 0.1 * x.size)
+    (offsets,) = ops.CumSum.run((np.array([[3, 0, 2]], dtype=np.int32),), {"exclusive": True})
+    assert offsets.tolist() == [[0, 3, 3]] and offsets.dtype == np.int32
+    (products,) = ops.CumProd.run((np.array([[1.0, 2.0], [3.0, 4.0]], dtype=np.float32),), {"axis": 0})
+    npt.assert_array_equal(products, [[1.0, 2.0], [3.0, 8.0]])
+    short, long = (ops.CumSum.tolerance((np.ones((2, n), dtype=np.float32),), {}) for n in (16, 1 << 16))
+    assert short.absolute < long.absolute == pytest.approx(2 * np.finfo(np.float32).eps * (1 << 16))
+    assert ops.CumProd.tolerance((np.ones((1 << 16, 2), dtype=np.float32),), {"axis": 0}).relative > 1e-3
+    assert ops.CumSum.tolerance((np.ones(8, dtype=np.int32),), {}).absolute == 0.0
+
+
+def test_sort_references_use_total_order_and_stable_ties() -> None:
+    x = np.array([[1.0, np.nan, -0.0, -np.inf, 0.0, -np.nan, 1.0]], dtype=np.float32)
+    (values,) = ops.Sort.run((x,), {})
+    assert np.signbit(values[0, [0, 2]]).tolist() == [True, True] and not np.signbit(values[0, 3])
+    npt.assert_array_equal(values[0, 1:6], [-np.inf, -0.0, 0.0, 1.0, 1.0])
+    (order,) = ops.ArgSort.run((x,), {"descending": True})
+    assert order.dtype == np.int64 and order.tolist() == [[1, 0, 6, 4, 2, 3, 5]]
+    ties = np.array([[2, 7, 7, 1, 7]], dtype=np.int32)
+    stable = {"descending": True, "stable": True}
+    npt.assert_array_equal(ops.ArgSort.indexed_values((ties,), np.array([[1, 2, 4, 0, 3]]), stable), [[1, 2, 4, 0, 3]])
+    # Unstable: any order of the tied 7s selects the same values.
+    npt.assert_array_equal(ops.ArgSort.indexed_values((ties,), np.array([[4, 1, 2, 0, 3]]), {"descending": True}),
+                           [[7, 7, 7, 2, 1]])
@@ -0,0 +1,176 @@
+from __future__ import annotations
+
+import json
+import textwrap
+from pathlib import Path
+
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.plan import BenchSettings, load_plan
+from optest.plan.history import HistoryPoint, load_history, record_bench
+from optest.plan.models import BenchResult
+from optest.plan.report import build_matrix, downsample, find_regressions, format_matrix, render_html, roofline_point
+
+
+def _relu_plan(tmp_path: Path) -> Path:
+    script = tmp_path / "relu.py"
+    script.write_text(
+        textwrap.dedent(
+            """
+            import sys
+            import numpy as np
+
+            np.maximum(np.fromfile(sys.argv[1], dtype="float32"), 0).tofile(sys.argv[2])
+            print("OPTEST_METRIC kernel_ms=0.5")
+            """
+        ),
+        encoding="utf-8",
+    )
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            generator: {{name: builtin.random, seed: 1}}
+            assertion: {{name: builtin.relu}}
+            backends:
+              - type: cuda
+                chip: local
+                command: ["python", "{script.as_posix()}", "{{input0}}", "{{output0}}"]
+            cases:
+              - name: small
+                dtypes: [float32]
+                shapes:
+                  - inputs: [[8, 8]]
+                    outputs: [[8, 8]]
+            """
+        ),
+        encoding="utf-8",
+    )
+    return plan_path
+
+
+def _record(path: Path, plan_path: Path, stamp: float, seconds: float, gflops: float = 50.0) -> None:
+    result = BenchResult(
+        "gemm@cuda:local/shape0", "ok", [seconds, seconds * 1.01], {"gflops": gflops, "dram_gbps": 10.0}, ""
+    )
+    record_bench(path, load_plan(plan_path), [result], BenchSettings(warmup=0, repeat=2), timestamp=stamp)
+
+
+def test_history_roundtrip_skips_truncated_lines_and_old_runs(tmp_path: Path) -> None:
+    history = tmp_path / "nested" / "history.jsonl"
+    plan_path = _relu_plan(tmp_path)
+    for day, seconds in enumerate([0.010, 0.011, 0.010]):
+        _record(history, plan_path, 1_700_000_000 + day * 86400, seconds)
+    with history.open("a", encoding="utf-8") as handle:
+        handle.write('{"time":1700300000,"plan":"relu","cases":[{"id"')  # interrupted writer
+
+    series = load_history([history])
+    points = series["gemm@cuda:local/shape0"]
+    assert [point.time for point in points] == [1_700_000_000, 1_700_086_400, 1_700_172_800]
+    assert points[0].median == 0.01005 and points[0].plan == "relu"
+    assert points[0].case == "gemm" and points[0].target == "cuda:local"
+    assert len(load_history([history], since=1_700_086_400)["gemm@cuda:local/shape0"]) == 2
+    assert load_history([tmp_path / "missing.jsonl"]) == {}
+
+
+def test_regressions_compare_latest_run_with_windowed_median() -> None:
+    def point(stamp: float, median: float) -> HistoryPoint:
+        return HistoryPoint(stamp, "a@cpu:x/shape0", "ok", median, (median,))
+
+    series = {"a@cpu:x/shape0": [point(t, m) for t, m in enumerate([9.0, 1.0, 1.0, 1.1, 1.0, 1.5])]}
+    (item,) = find_regressions(series, window=4)
+    assert item.baseline == 1.0 and item.latest == 1.5 and item.runs == 6
+    assert abs(item.change - 0.5) < 1e-12
+
+    trend = [(float(i), float(i % 7)) for i in range(1000)]
+    assert len(downsample(trend, limit=100)) == 100
+    assert downsample(trend[:5], limit=100) == trend[:5]
+
+
+def test_html_report_has_all_sections_and_roofline(tmp_path: Path) -> None:
+    history = tmp_path / "history.jsonl"
+    plan_path = _relu_plan(tmp_path)
+    for day, seconds in enumerate([0.010, 0.010, 0.020]):
+        _record(history, plan_path, 1_700_000_000 + day * 86400, seconds)
+    series = load_history([history])
+    assert roofline_point(series["gemm@cuda:local/shape0"][-1]) == (5.0, 50.0)
+
+    page = render_html(series, peak_gflops=200.0, peak_gbps=20.0)
+    for section in ("Regressions", "Trends", "Distributions per backend and chip", "Roofline"):
+        assert f"<h2>{section}</h2>" in page
+    assert "+99.0%" in page or "+100.0%" in page
+    assert page.count("<circle") >= 2 and "peak 200 GFLOP/s" in page
+
+    output = tmp_path / "report.html"
+    result = CliRunner().invoke(cli, ["report", "--history", str(history), "--html", "--output", str(output)])
+    assert result.exit_code == 0, result.output
+    assert "(1 cases)" in result.output and output.read_text(encoding="utf-8").startswith("<!DOCTYPE html>")
+
+    result = CliRunner().invoke(cli, ["report", "--history", str(history)])
+    assert result.exit_code == 0, result.output
+    assert "REGRESSED" in result.output and "regressed=1" in result.output
+
+
+def test_bench_appends_to_history_unless_disabled(tmp_path: Path) -> None:
+    plan_path = _relu_plan(tmp_path)
+    history = tmp_path / "runs.jsonl"
+    args = ["bench", "--plan", str(plan_path), "--warmup", "0", "--repeat", "2"]
+    result = CliRunner().invoke(cli, [*args, "--history", str(history)])
+    assert result.exit_code == 0, result.output
+    result = CliRunner().invoke(cli, [*args, "--no-history"])
+    assert result.exit_code == 0, result.output
+    assert not (tmp_path / ".optest").exists()
+
+    (line,) = history.read_text(encoding="utf-8").splitlines()
+    entry = json.loads(line)
+    assert entry["plan"] == "relu" and entry["repeat"] == 2
+    (case,) = entry["cases"]
+    assert case["status"] == "ok" and len(case["samples_s"]) == 2 and case["metrics"] == {"kernel_ms": 0.5}
+
+
+def test_matrix_joins_targets_and_summarizes_categories(tmp_path: Path) -> None:
+    def point(identifier: str, seconds: float | None, category: str, status: str = "ok") -> HistoryPoint:
+        samples = () if seconds is None else (seconds,)
+        return HistoryPoint(1.0, identifier, status, seconds, samples, {"gbps": 1.0}, "ops", "h", category)
+
+    timings = {
+        "add@cuda:a100/shape0": (0.002, "elementwise"),
+        "add@cann:910b/shape0": (0.001, "elementwise"),
+        "add@cuda:cpu/shape0": (0.008, "elementwise"),
+        "mul@cuda:a100/shape0": (0.004, "elementwise"),
+        "mul@cann:910b/shape0": (0.001, "elementwise"),
+        "mm@cuda:a100/shape0": (0.010, "gemm"),
+        "mm@cann:910b/shape0": (0.020, "gemm"),
+    }
+    series = {key: [point(key, seconds, category)] for key, (seconds, category) in timings.items()}
+    series["mm@cuda:cpu/shape0"] = [point("mm@cuda:cpu/shape0", None, "gemm", status="failed")]
+
+    matrix = build_matrix(series, baseline="cuda:a100")
+    assert matrix.baseline == "cuda:a100" and matrix.targets == ["cuda:a100", "cann:910b", "cuda:cpu"]
+    add = next(row for row in matrix.rows if row.case == "add/shape0")
+    assert add.cells["cann:910b"].speedup == 2.0 and add.cells["cuda:cpu"].speedup == 0.25
+    assert add.throughput_key == "gbps" and add.cells["cuda:cpu"].throughput == 1.0
+    assert abs(matrix.geomeans["elementwise"]["cann:910b"] - 8**0.5) < 1e-9
+    assert matrix.geomeans["gemm"] == {"cann:910b": 0.5}
+    assert abs(matrix.overall["cann:910b"] - 2 ** (2 / 3)) < 1e-9
+    text = format_matrix(matrix)
+    assert "FAILED" in text and "elementwise" in text and "cann:910b=1.587x" in text
+
+    rebased = build_matrix(series)  # most covered target, ties by name
+    assert rebased.targets[0] == "cann:910b" and rebased.geomeans["gemm"] == {"cuda:a100": 2.0}
+    assert "Cross-backend matrix" in render_html(series)
+
+    history = tmp_path / "history.jsonl"
+    plan_path = _relu_plan(tmp_path)
+    _record(history, plan_path, 1.0, 0.01)
+    report = tmp_path / "matrix.json"
+    result = CliRunner().invoke(
+        cli, ["report", "--matrix", "--history", str(history), "--report", "json", "--report-path", str(report)]
+    )
+    assert result.exit_code == 0, result.output
+    payload = json.loads(report.read_text(encoding="utf-8"))
+    assert payload["baseline"] == "cuda:local" and payload["rows"][0]["category"] == "relu"
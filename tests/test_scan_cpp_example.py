@@ -0,0 +1,65 @@
+from __future__ import annotations
+
+import json
+import shutil
+import subprocess
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+
+from optest.operators.builtin_operators import CumProd, CumSum
+from optest.plan import PlanOptions, load_plan, run_plan
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+EXAMPLE_DIR = REPO_ROOT / "examples" / "scan_cpp"
+PLAN_PATH = EXAMPLE_DIR / "plan.yaml"
+RUNNER_PATH = EXAMPLE_DIR / "operator" / "build" / "scan_runner"
+
+
+@pytest.fixture(scope="session")
+def scan_runner() -> Path:
+    """Build the C++ runner once for all scan example tests."""
+
+    if not shutil.which("cmake"):
+        pytest.skip("cmake is required to build the scan example")
+    subprocess.run(["bash", "build.sh"], cwd=EXAMPLE_DIR / "operator", check=True)
+    if not RUNNER_PATH.exists():
+        pytest.skip("scan_runner binary missing after build")
+    return RUNNER_PATH
+
+
+def test_scan_example_passes(scan_runner: Path, tmp_path: Path) -> None:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    data["inputs"] = [str(tmp_path / "in0.bin")]
+    data["outputs"] = [str(tmp_path / "out0.bin")]
+    backend = data["backends"][0]
+    backend["workdir"] = str(EXAMPLE_DIR)
+    backend["command"][0] = str(scan_runner)
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 0
+
+
+@pytest.mark.parametrize(
+    ("op_cls", "shape", "params"),
+    [
+        (CumSum, (2, 100_003), {"axis": -1, "exclusive": True}),  # two-pass path with a ragged last chunk
+        (CumSum, (5, 300, 7), {"axis": 1}),
+        (CumProd, (3, 4099), {"axis": -1}),
+    ],
+)
+def test_runner_matches_reference_with_threads(scan_runner: Path, tmp_path: Path, op_cls, shape, params) -> None:
+    rng = np.random.default_rng(0)
+    x = rng.uniform(0.99, 1.01, size=shape) if op_cls is CumProd else rng.normal(size=shape)
+    x = x.astype(np.float32)
+    x.tofile(tmp_path / "x.bin")
+    argv = [str(scan_runner), "--op", f"builtin.{op_cls.name}", "--input0", str(tmp_path / "x.bin")]
+    argv += ["--output0", str(tmp_path / "y.bin"), "--shapes", json.dumps({"inputs": [shape], "outputs": [shape]})]
+    argv += ["--params", json.dumps(params), "--threads", "4"]
+    subprocess.run(argv, check=True, capture_output=True)
+    (expected,) = op_cls.run((x,), params)
+    tol = op_cls.tolerance((x,), params)
+    actual = np.fromfile(tmp_path / "y.bin", dtype=np.float32).reshape(shape)
+    np.testing.assert_allclose(actual, expected, rtol=tol.relative, atol=tol.absolute)
@@ -0,0 +1,162 @@
+from __future__ import annotations
+
+import json
+import sys
+import textwrap
+from pathlib import Path
+
+import pytest
+import yaml
+from click.testing import CliRunner
+
+from optest.cli.main import cli
+from optest.plan.session import MemorySample, growth_trends
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith("linux"), reason="samples /proc")
+
+SERVER = """
+import json, os, sys
+import numpy as np
+
+hoard, handles = [], []
+for line in sys.stdin:
+    request = json.loads(line)
+    tokens = request["tokens"]
+    if tokens["case"] == "leaky":
+        hoard.append(np.ones(64 * 1024, dtype="float32"))  # 256 KiB, touched
+        handles.append(open(os.devnull))
+    data = np.fromfile(tokens["input0"], dtype=tokens["dtype"])
+    np.maximum(data, 0).tofile(tokens["output0"])
+    print(f"OPTEST_METRIC pid={os.getpid()}")
+    print("OPTEST_DONE 0", flush=True)
+"""
+
+
+def _plan(tmp_path: Path, session: str) -> Path:
+    server = tmp_path / "server.py"
+    server.write_text(textwrap.dedent(SERVER), encoding="utf-8")
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(
+        textwrap.dedent(
+            f"""
+            operator: relu
+            inputs: ["in0.bin"]
+            outputs: ["out0.bin"]
+            assertion: {{name: builtin.relu}}
+            backends:
+              - type: cuda
+                chip: local
+                command: ["python", "{server.as_posix()}"]
+                session: {session}
+            cases:
+              - name: clean
+                dtypes: [float32]
+                shapes: [{{inputs: [[64]], outputs: [[64]]}}]
+              - name: leaky
+                dtypes: [float32]
+                shapes: [{{inputs: [[64]], outputs: [[64]]}}]
+            """
+        ),
+        encoding="utf-8",
+    )
+    return plan_path
+
+
+def test_bench_session_flags_leaking_case(tmp_path: Path) -> None:
+    report = tmp_path / "report.json"
+    args = ["bench", "--plan", str(_plan(tmp_path, "true")), "--warmup", "1", "--repeat", "6", "--no-history"]
+    result = CliRunner().invoke(cli, [*args, "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+
+    payload = json.loads(report.read_text(encoding="utf-8"))
+    # Every request went to the same runner process.
+    assert len({case["metrics"]["pid"] for case in payload["cases"]}) == 1
+    sessions = payload["sessions"]
+    assert sessions["targets"]["cuda:local"]["requests"] == 14
+    assert sessions["targets"]["cuda:local"]["restarts"] == 0
+    trends = {trend["case"]: trend for trend in sessions["trends"]}
+    assert not trends["clean"]["leak"] and trends["leaky"]["leak"]
+    assert trends["leaky"]["rss_kib_per_call"] > 200 and trends["leaky"]["fds_per_call"] == pytest.approx(1.0)
+
+    result = CliRunner().invoke(cli, [*args, "--no-color"])
+    assert result.exit_code == 0, result.output
+    assert "LEAK        relu/leaky@cuda:local" in result.output
+
+
+def test_run_session_recycles_runner(tmp_path: Path) -> None:
+    report = tmp_path / "report.json"
+    plan = _plan(tmp_path, "{recycle_fds: 6}")
+    result = CliRunner().invoke(cli, ["run", "--plan", str(plan), "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+    assert json.loads(report.read_text(encoding="utf-8"))["sessions"]["targets"]["cuda:local"]["requests"] == 2
+    args = ["bench", "--plan", str(plan), "--cases", "leaky", "--warmup", "0", "--repeat", "8", "--no-history"]
+    result = CliRunner().invoke(cli, [*args, "--report", "json", "--report-path", str(report)])
+    assert result.exit_code == 0, result.output
+    target = json.loads(report.read_text(encoding="utf-8"))["sessions"]["targets"]["cuda:local"]
+    assert target["restarts"] >= 1 and target["peak_fds"] <= 8
+
+
+def test_growth_trends_fit() -> None:
+    def sample(case: str, rss: int, fds: int = 4, pid: int = 1) -> MemorySample:
+        return MemorySample("cuda:local", pid, "relu", case, f"{case}@cuda:local/shape0", rss, fds)
+
+    samples = [sample("warm", 1000), sample("warm", 5000), sample("warm", 5000), sample("warm", 5004)]
+    samples += [sample("grow", 5004 + 100 * i) for i in range(6)]
+    samples += [sample("grow", 100, pid=2), sample("grow", 200, pid=2)]  # restart: no delta across processes
+    trends = {trend.case: trend for trend in growth_trends(samples, {"cuda:local": 16.0})}
+    # A one-off jump early on barely moves the fitted slope.
+    assert trends["warm"].calls == 3 and trends["warm"].rss_kib_per_call == pytest.approx(2.0)
+    assert not trends["warm"].leak
+    assert trends["grow"].calls == 6 and trends["grow"].rss_kib_per_call == pytest.approx(100.0)
+    assert trends["grow"].leak
+
+
+FLAKY_SERVER = """
+import json, os, sys
+import numpy as np
+
+marker = sys.argv[1]
+assert os.environ["RUNNER_TARGET"] == "cuda:local"
+for line in sys.stdin:
+    tokens = json.loads(line)["tokens"]
+    if not os.path.exists(marker):
+        open(marker, "w").close()
+        sys.stderr.write("noise\\n" * 100_000)  # far more than the kept tail
+        sys.exit(3)
+    np.maximum(np.fromfile(tokens["input0"], dtype="float32"), 0).tofile(tokens["output0"])
+    print("OPTEST_DONE 0", flush=True)
+"""
+
+
+def test_session_requests_honour_retries_and_backend_level_env(tmp_path: Path) -> None:
+    server = tmp_path / "server.py"
+    server.write_text(textwrap.dedent(FLAKY_SERVER), encoding="utf-8")
+    plan = {
+        "operator": "relu",
+        "inputs": ["in0.bin"],
+        "outputs": ["out0.bin"],
+        "assertion": {"name": "builtin.relu"},
+        "backends": [{"type": "cuda", "chip": "local", "session": True, "retries": 1,
+                      "env": {"RUNNER_TARGET": "{backend}:{chip}"},
+                      "command": ["python", str(server), str(tmp_path / "crashed")]}],
+        "cases": [{"name": "once", "dtypes": ["float32"], "shapes": [{"inputs": [[8]], "outputs": [[8]]}]}],
+    }
+    plan_path = tmp_path / "plan.yaml"
+    report = tmp_path / "report.json"
+    args = ["run", "--plan", str(plan_path), "--report", "json", "--report-path", str(report)]
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    result = CliRunner().invoke(cli, args)
+    assert result.exit_code == 0, result.output
+    assert json.loads(report.read_text(encoding="utf-8"))["sessions"]["targets"]["cuda:local"]["restarts"] == 1
+
+    (tmp_path / "crashed").unlink()
+    plan["backends"][0]["retries"] = 0
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    assert CliRunner().invoke(cli, args).exit_code == 1
+    details = json.loads(report.read_text(encoding="utf-8"))["cases"][0]["details"]
+    assert "exited (code 3)" in details and details.count("noise") < 500
+
+    plan["backends"][0]["env"] = {"RUNNER_TARGET": "{case}"}  # per-case tokens cannot shape a shared process
+    plan_path.write_text(yaml.safe_dump(plan), encoding="utf-8")
+    assert CliRunner().invoke(cli, args).exit_code == 1
+    assert "Unknown token 'case'" in json.loads(report.read_text(encoding="utf-8"))["cases"][0]["details"]
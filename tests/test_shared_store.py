@@ -0,0 +1,95 @@
+from __future__ import annotations
+
+import os
+import threading
+import time
+from pathlib import Path
+
+import numpy as np
+import numpy.testing as npt
+
+from optest.storage.cache import ArtifactCache
+from optest.storage.shared import SharedStore
+
+
+def _machine(tmp_path: Path, name: str, shared: SharedStore) -> ArtifactCache:
+    return ArtifactCache(tmp_path / name, shared=shared)
+
+
+def test_entries_published_by_one_machine_are_read_through_by_another(tmp_path: Path) -> None:
+    shared = SharedStore(tmp_path / "nfs")
+    first = _machine(tmp_path, "ci-a", shared)
+    second = _machine(tmp_path, "ci-b", shared)
+    data = np.arange(12, dtype=np.float32).reshape(3, 4)
+    first.put("inputs", "k1", data)
+    first.put_group("goldens", "g1", [data, data.sum(axis=0)])
+
+    npt.assert_array_equal(second.get("inputs", "k1"), data)
+    assert list((tmp_path / "ci-b" / "inputs").rglob("k1.optt"))
+    group = second.get_group("goldens", "g1")
+    assert group is not None and len(group) == 2
+    npt.assert_array_equal(group[1], data.sum(axis=0))
+    assert not list((tmp_path / "nfs").rglob("*.tmp"))
+
+
+def test_claim_waits_for_the_owner_to_publish(tmp_path: Path) -> None:
+    shared = SharedStore(tmp_path / "nfs", poll_interval=0.01)
+    owner = _machine(tmp_path, "ci-a", shared)
+    waiter = _machine(tmp_path, "ci-b", shared)
+    outcomes: list[bool] = []
+    with owner.claim("goldens", "slow") as granted:
+        assert granted
+
+        def _wait() -> None:
+            with waiter.claim("goldens", "slow") as got:
+                outcomes.append(got)
+
+        thread = threading.Thread(target=_wait)
+        thread.start()
+        time.sleep(0.05)
+        assert not outcomes
+        owner.put_group("goldens", "slow", [np.ones(2, dtype=np.float32)])
+        thread.join(timeout=5)
+    assert outcomes == [False]
+    assert waiter.get_group("goldens", "slow") is not None
+
+
+def test_stale_claims_are_taken_over(tmp_path: Path) -> None:
+    shared = SharedStore(tmp_path / "nfs", claim_timeout=1.0, poll_interval=0.01)
+    lock = tmp_path / "nfs" / "claims" / "goldens" / "dead.lock"
+    lock.parent.mkdir(parents=True)
+    lock.write_text("gone-host:1", encoding="utf-8")
+    old = time.time() - 60
+    os.utime(lock, (old, old))
+    with shared.claim("goldens", "dead") as granted:
+        assert granted
+    assert not lock.exists()
+
+
+def test_objects_are_named_by_the_whole_file(tmp_path: Path) -> None:
+    shared = SharedStore(tmp_path / "nfs")
+    machine = _machine(tmp_path, "ci-a", shared)
+    data = np.arange(6, dtype=np.float32)
+    machine.put("inputs", "flat", data)
+    machine.put("inputs", "square", data.reshape(2, 3))  # same data region, different header
+    refs = [shared.read_ref("inputs", key) for key in ("flat", "square")]
+    assert refs[0]["digest"] != refs[1]["digest"]
+    assert _machine(tmp_path, "ci-b", shared).get("inputs", "square").shape == (2, 3)
+
+
+def test_live_claims_are_not_taken_over(tmp_path: Path) -> None:
+    shared = SharedStore(tmp_path / "nfs", claim_timeout=0.2, poll_interval=0.01)
+    granted: list[bool] = []
+    with shared.claim("goldens", "busy") as owner:
+        assert owner
+
+        def _wait() -> None:
+            with shared.claim("goldens", "busy") as got:
+                granted.append(got)
+
+        thread = threading.Thread(target=_wait)
+        thread.start()
+        time.sleep(0.6)  # three timeouts: the heartbeat keeps the claim fresh
+        assert not granted
+    thread.join(timeout=5)
+    assert granted == [True]
@@ -0,0 +1,58 @@
+from __future__ import annotations
+
+import json
+import shutil
+import subprocess
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+
+from optest.operators.builtin_operators import argsort
+from optest.plan import PlanOptions, load_plan, run_plan
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+EXAMPLE_DIR = REPO_ROOT / "examples" / "sort_cpp"
+PLAN_PATH = EXAMPLE_DIR / "plan.yaml"
+RUNNER_PATH = EXAMPLE_DIR / "operator" / "build" / "sort_runner"
+
+
+@pytest.fixture(scope="session")
+def sort_runner() -> Path:
+    """Build the C++ runner once for all sort example tests."""
+
+    if not shutil.which("cmake"):
+        pytest.skip("cmake is required to build the sort example")
+    subprocess.run(["bash", "build.sh"], cwd=EXAMPLE_DIR / "operator", check=True)
+    if not RUNNER_PATH.exists():
+        pytest.skip("sort_runner binary missing after build")
+    return RUNNER_PATH
+
+
+def test_sort_example_passes(sort_runner: Path, tmp_path: Path) -> None:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    data["inputs"] = [str(tmp_path / "in0.bin")]
+    data["outputs"] = [str(tmp_path / "out0.bin")]
+    # The LLC / DRAM / multi-GB sweep points are benchmarks, too slow for the test suite.
+    data["cases"] = [case for case in data["cases"] if case["name"] not in {"sort_llc", "sort_dram", "sort_multi_gb"}]
+    backend = data["backends"][0]
+    backend["workdir"] = str(EXAMPLE_DIR)
+    backend["command"][0] = str(sort_runner)
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 0
+
+
+@pytest.mark.parametrize("descending", [False, True])
+def test_threaded_argsort_is_stable(sort_runner: Path, tmp_path: Path, descending: bool) -> None:
+    # One long row forces every thread through the shared histogram / scatter path.
+    x = np.random.default_rng(0).integers(-3, 3, size=(1, 300_001), dtype=np.int32)
+    x.tofile(tmp_path / "x.bin")
+    argv = [str(sort_runner), "--op", "builtin.argsort", "--input0", str(tmp_path / "x.bin")]
+    argv += ["--output0", str(tmp_path / "y.bin"), "--dtype", "int32"]
+    argv += ["--shapes", json.dumps({"inputs": [x.shape], "outputs": [x.shape]})]
+    argv += ["--params", json.dumps({"descending": descending}), "--threads", "3"]
+    subprocess.run(argv, check=True, capture_output=True)
+    actual = np.fromfile(tmp_path / "y.bin", dtype=np.int64).reshape(x.shape)
+    np.testing.assert_array_equal(actual, argsort(x, descending=descending))
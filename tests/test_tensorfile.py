@@ -0,0 +1,110 @@
+from __future__ import annotations
+
+import shutil
+import struct
+import subprocess
+from pathlib import Path
+
+import numpy as np
+import numpy.testing as npt
+import pytest
+
+from optest.storage import tensorfile
+
+SDK_INCLUDE = Path(__file__).resolve().parents[1] / "sdk" / "cpp" / "include"
+
+
+def test_container_roundtrip_is_aligned_and_mapped(tmp_path: Path) -> None:
+    path = tmp_path / "x.optt"
+    data = np.arange(24, dtype=np.float32).reshape(2, 3, 4)
+    header = tensorfile.write_tensor(path, data)
+    assert header.data_offset % tensorfile.ALIGNMENT == 0
+    assert tensorfile.is_tensor_file(path)
+    loaded = tensorfile.load_array(path, (2, 3, 4), "float32")
+    assert isinstance(loaded.base, np.memmap) or isinstance(loaded, np.memmap)
+    npt.assert_array_equal(loaded, data)
+    assert tensorfile.read_header(path).strides == (48, 16, 4)
+
+
+def test_embedded_hash_matches_raw_content_hash(tmp_path: Path) -> None:
+    data = np.linspace(-1, 1, 100, dtype=np.float64)
+    container = tmp_path / "x.optt"
+    raw = tmp_path / "x.bin"
+    tensorfile.write_tensor(container, data)
+    data.tofile(raw)
+    assert tensorfile.tensor_digest(container) == tensorfile.tensor_digest(raw)
+    unhashed = tmp_path / "y.optt"
+    tensorfile.write_tensor(unhashed, data, with_hash=False)
+    assert tensorfile.read_header(unhashed).hexdigest is None
+    assert tensorfile.tensor_digest(unhashed) == tensorfile.tensor_digest(raw)
+
+
+def test_load_array_rejects_mismatches(tmp_path: Path) -> None:
+    container = tmp_path / "x.optt"
+    tensorfile.write_tensor(container, np.zeros((2, 2), dtype=np.int32))
+    with pytest.raises(ValueError, match="dtype"):
+        tensorfile.load_array(container, (2, 2), "float32")
+    with pytest.raises(ValueError, match="shape"):
+        tensorfile.load_array(container, (4,), "int32")
+    raw = tmp_path / "x.bin"
+    np.zeros(3, dtype=np.float32).tofile(raw)
+    with pytest.raises(ValueError, match="12 bytes"):
+        tensorfile.load_array(raw, (2, 2), "float32")
+
+
+def test_truncated_container_is_rejected(tmp_path: Path) -> None:
+    path = tmp_path / "x.optt"
+    tensorfile.write_tensor(path, np.ones((8, 8), dtype=np.float32))
+    path.write_bytes(path.read_bytes()[:-4])
+    with pytest.raises(ValueError, match="truncated"):
+        tensorfile.read_header(path)
+
+
+@pytest.mark.skipif(shutil.which("g++") is None, reason="g++ is required to build the header check")
+def test_cpp_reader_rejects_hostile_headers(tmp_path: Path) -> None:
+    source = tmp_path / "read.cpp"
+    source.write_text(
+        '#include <optest/tensor_file.h>\n#include <iostream>\n'
+        "int main(int, char** argv) {\n"
+        "    try { optest::TensorMap<float> map(argv[1], {}); } catch (const std::exception& e) {\n"
+        "        std::cout << e.what(); return 1; }\n"
+        "    return 0;\n}\n",
+        encoding="utf-8",
+    )
+    reader = tmp_path / "read"
+    subprocess.run(["g++", "-std=c++17", f"-I{SDK_INCLUDE}", str(source), "-o", str(reader)], check=True)
+    path = tmp_path / "x.optt"
+    tensorfile.write_tensor(path, np.ones((4, 8), dtype=np.float32))
+    valid = path.read_bytes()
+    assert subprocess.run([str(reader), str(path)]).returncode == 0
+
+    def _patched(offset: int, value: int, fmt: str = "<q") -> str:
+        data = bytearray(valid)
+        struct.pack_into(fmt, data, offset, value)
+        path.write_bytes(bytes(data))
+        proc = subprocess.run([str(reader), str(path)], capture_output=True, text=True)
+        assert proc.returncode == 1
+        return proc.stdout
+
+    shape, strides = 64, 64 + 16  # dims follow the 64-byte fixed header, then the byte strides
+    assert _patched(shape, -4) == f"{path}: negative dimension in tensor shape"
+    assert _patched(strides, -32) == f"{path}: invalid tensor strides"
+    assert _patched(strides, 1 << 62) == f"{path}: invalid tensor strides"  # (4 - 1) * stride overflows
+    assert _patched(strides, 64).startswith(f"{path}: strides exceed the data region of 128 bytes")
+    # data_offset + nbytes wraps around to a small value.
+    assert _patched(24, (1 << 64) - 64, "<Q") == f"{path}: corrupt or truncated tensor header"
+
+
+def test_raw_strided_layout_maps_pitched_rows(tmp_path: Path) -> None:
+    path = tmp_path / "pitched.bin"
+    view = tensorfile.allocate_tensor(path, (3, 4), "float32", container=False, strides=(6, 1), offset=2)
+    view[...] = np.arange(12, dtype=np.float32).reshape(3, 4)
+    view.base.flush()
+    assert path.stat().st_size == (2 + 2 * 6 + 4) * 4
+    raw = np.fromfile(path, dtype=np.float32)
+    npt.assert_array_equal(raw[2:6], [0, 1, 2, 3])
+    npt.assert_array_equal(raw[6:8], [0, 0])  # pitch padding stays zero
+    loaded = tensorfile.load_array(path, (3, 4), "float32", strides=(6, 1), offset=2)
+    npt.assert_array_equal(loaded, np.arange(12, dtype=np.float32).reshape(3, 4))
+    with pytest.raises(ValueError, match="strides"):
+        tensorfile.load_array(path, (3, 4), "float32", strides=(8, 1), offset=2)
@@ -0,0 +1,63 @@
+from __future__ import annotations
+
+import shutil
+import subprocess
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+
+from optest.operators.builtin_operators import topk
+from optest.plan import PlanOptions, load_plan, run_plan
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+EXAMPLE_DIR = REPO_ROOT / "examples" / "topk_cpp"
+PLAN_PATH = EXAMPLE_DIR / "plan.yaml"
+RUNNER_PATH = EXAMPLE_DIR / "operator" / "build" / "topk_runner"
+
+
+@pytest.fixture(scope="session")
+def topk_runner() -> Path:
+    """Build the C++ runner once for all top-k example tests."""
+
+    if not shutil.which("cmake"):
+        pytest.skip("cmake is required to build the top-k example")
+    subprocess.run(["bash", "build.sh"], cwd=EXAMPLE_DIR / "operator", check=True)
+    if not RUNNER_PATH.exists():
+        pytest.skip("topk_runner binary missing after build")
+    return RUNNER_PATH
+
+
+def _write_plan(tmp_path: Path, runner: Path) -> Path:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    data["inputs"] = [str(tmp_path / "in0.bin")]
+    data["outputs"] = [str(tmp_path / "values.bin"), str(tmp_path / "indices.bin")]
+    for case in data["cases"]:
+        if "outputs" in case:
+            case["outputs"] = [str(tmp_path / "arg_indices.bin")]
+    backend = data["backends"][0]
+    backend["workdir"] = str(EXAMPLE_DIR)
+    backend["command"][0] = str(runner)
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    return plan_path
+
+
+def test_topk_example_passes_including_ties(topk_runner: Path, tmp_path: Path) -> None:
+    plan = load_plan(str(_write_plan(tmp_path, topk_runner)))
+    assert run_plan(plan, PlanOptions(), use_color=False) == 0
+
+
+def test_runner_breaks_ties_by_earliest_index(topk_runner: Path, tmp_path: Path) -> None:
+    x = np.tile(np.array([5, 1, 5, 5, 0, 5], dtype=np.int32), (3, 1))
+    x.tofile(tmp_path / "x.bin")
+    shapes = '{"inputs": [[3, 6]], "outputs": [[3, 2], [3, 2]]}'
+    outputs = f"{tmp_path / 'v.bin'},{tmp_path / 'i.bin'}"
+    argv = [str(topk_runner), "--input0", str(tmp_path / "x.bin"), "--outputs", outputs]
+    argv += ["--dtype", "int32", "--shapes", shapes, "--threads", "2"]
+    subprocess.run(argv, check=True, capture_output=True)
+    indices = np.fromfile(tmp_path / "i.bin", dtype=np.int64).reshape(3, 2)
+    assert indices.tolist() == [[0, 2]] * 3  # earliest ties win in the heap
+    values, _ = topk(x, 2)
+    np.testing.assert_array_equal(np.fromfile(tmp_path / "v.bin", dtype=np.int32).reshape(3, 2), values)
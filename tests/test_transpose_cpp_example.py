@@ -0,0 +1,57 @@
+from __future__ import annotations
+
+import itertools
+import json
+import shutil
+import subprocess
+from pathlib import Path
+
+import numpy as np
+import pytest
+import yaml
+
+from optest.plan import PlanOptions, load_plan, run_plan
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+EXAMPLE_DIR = REPO_ROOT / "examples" / "transpose_cpp"
+PLAN_PATH = EXAMPLE_DIR / "plan.yaml"
+RUNNER_PATH = EXAMPLE_DIR / "operator" / "build" / "transpose_runner"
+
+
+@pytest.fixture(scope="session")
+def transpose_runner() -> Path:
+    """Build the C++ runner once for all transpose example tests."""
+
+    if not shutil.which("cmake"):
+        pytest.skip("cmake is required to build the transpose example")
+    subprocess.run(["bash", "build.sh"], cwd=EXAMPLE_DIR / "operator", check=True)
+    if not RUNNER_PATH.exists():
+        pytest.skip("transpose_runner binary missing after build")
+    return RUNNER_PATH
+
+
+def test_transpose_example_passes(transpose_runner: Path, tmp_path: Path) -> None:
+    data = yaml.safe_load(PLAN_PATH.read_text(encoding="utf-8"))
+    data["inputs"] = [str(tmp_path / "in0.bin")]
+    data["outputs"] = [str(tmp_path / "out0.bin")]
+    backend = data["backends"][0]
+    backend["workdir"] = str(EXAMPLE_DIR)
+    backend["command"][0] = str(transpose_runner)
+    plan_path = tmp_path / "plan.yaml"
+    plan_path.write_text(yaml.safe_dump(data), encoding="utf-8")
+    assert run_plan(load_plan(str(plan_path)), PlanOptions(), use_color=False) == 0
+
+
+@pytest.mark.parametrize("dtype", ["float32", "int16"])
+def test_runner_applies_every_permutation(transpose_runner: Path, tmp_path: Path, dtype: str) -> None:
+    shape = (3, 1, 19, 10)  # unit and odd dims exercise the simplifier and tile edges
+    x = (np.random.default_rng(0).normal(size=shape) * 100).astype(dtype)
+    x.tofile(tmp_path / "x.bin")
+    for perm in itertools.permutations(range(len(shape))):
+        out_shape = [shape[axis] for axis in perm]
+        argv = [str(transpose_runner), "--input0", str(tmp_path / "x.bin"), "--output0", str(tmp_path / "y.bin")]
+        argv += ["--dtype", dtype, "--shapes", json.dumps({"inputs": [list(shape)], "outputs": [out_shape]})]
+        argv += ["--params", json.dumps({"perm": list(perm)}), "--threads", "2"]
+        result = subprocess.run(argv, check=True, capture_output=True, text=True)
+        assert "copy_fraction=" in result.stdout
+        np.testing.assert_array_equal(np.fromfile(tmp_path / "y.bin", dtype=dtype).reshape(out_shape), x.transpose(perm))